@@ -142,6 +142,36 @@ class SppMirror(object):
                 # TODO(yasufum) should change 'unuse' to 'unused'
                 print("  - core:%d '' (type: unuse)" % worker['core'])
 
+        # Latency of packets sent to ports
+        if len(json_obj.get('latency', [])) > 0:
+            print('Latency:')
+        for lat in json_obj.get('latency', []):
+            print('  - %s: %d pkts, avg %d ns, p50 %d ns, p99 %d ns, '
+                  'p99.9 %d ns, max %d ns' % (
+                      lat['port'], lat['count'], lat['avg_ns'], lat['p50_ns'],
+                      lat['p99_ns'], lat['p999_ns'], lat['max_ns']))
+
+        # Ratio of cycles of polls receiving packets on each of lcores
+        if len(json_obj.get('lcore_usage', [])) > 0:
+            print('Lcore Usage:')
+        for usage in json_obj.get('lcore_usage', []):
+            print('  - core:%d: %d%% (busy %d cycles, idle %d cycles)' % (
+                  usage['lcore'], usage['usage'], usage['busy_cycles'],
+                  usage['idle_cycles']))
+            for comp in usage['components']:
+                print("    - '%s': %d%% (busy %d cycles, idle %d cycles)" % (
+                      comp['name'], comp['usage'], comp['busy_cycles'],
+                      comp['idle_cycles']))
+
+        # Packets dropped on each of lcores for each of reasons
+        drops = [d for d in json_obj.get('drops', [])
+                 if sum(v for k, v in d.items() if k != 'lcore') > 0]
+        if len(drops) > 0:
+            print('Drops:')
+        for drop in drops:
+            print('  - core:%d: %s' % (drop['lcore'], ', '.join(
+                  '%s %d' % (k, v) for k, v in drop.items() if k != 'lcore')))
+
     def complete(self, sec_ids, text, line, begidx, endidx):
         """Completion for spp_mirrorcommands.
 
@@ -95,6 +95,23 @@ class SppNfv(object):
             else:
                 print('  - {} -> {}'.format(port, dst))
 
+        # Latency of packets sent to ports
+        if len(nfv_attr.get('latency', [])) > 0:
+            print('- latency:')
+        for lat in nfv_attr.get('latency', []):
+            print('  - %s: %d pkts, avg %d ns, p50 %d ns, p99 %d ns, '
+                  'p99.9 %d ns, max %d ns' % (
+                      lat['port'], lat['count'], lat['avg_ns'], lat['p50_ns'],
+                      lat['p99_ns'], lat['p999_ns'], lat['max_ns']))
+
+        # Ratio of cycles of polls receiving packets on each of lcores
+        if len(nfv_attr.get('lcore_usage', [])) > 0:
+            print('- lcore_usage:')
+        for usage in nfv_attr.get('lcore_usage', []):
+            print('  - %d: %d%% (busy %d cycles, idle %d cycles)' % (
+                  usage['lcore'], usage['usage'], usage['busy_cycles'],
+                  usage['idle_cycles']))
+
     # TODO(yasufum) change name starts with '_' as private
     def get_ports(self):
         """Get all of ports as a list."""
@@ -403,6 +420,9 @@ class SppNfv(object):
                 self.ports = self.get_ports()
 
             req_params = {'action': 'add', 'port': params[0]}
+            if len(params) == 2:
+                # add ring:X mpsc
+                req_params['mode'] = params[1]
 
             res = self.spp_ctl_cli.put('nfvs/%d/ports' %
                                        self.sec_id, req_params)
@@ -161,6 +161,18 @@ class SppPcap(object):
                 else:
                     print('    - filename: {}'.format(worker['filename']))
 
+                if 'usage' in worker.keys():
+                    msg = '    - usage: {usage}% (busy {busy} cycles, ' + \
+                          'idle {idle} cycles)'
+                    print(msg.format(usage=worker['usage'],
+                                     busy=worker['busy_cycles'],
+                                     idle=worker['idle_cycles']))
+
+                drops = worker.get('drops', {})
+                if sum(drops.values()) > 0:
+                    print('    - drops: {}'.format(', '.join(
+                        '{} {}'.format(k, v) for k, v in drops.items())))
+
     def complete(self, sec_ids, text, line, begidx, endidx):
         """Completion for spp_pcap commands.
 
@@ -238,11 +238,23 @@ class SppPrimary(object):
                     else:
                         print('    - {} -> {}'.format(port, dst))
 
+                usages = json_obj['forwarder'].get('lcore_usage', [])
+                if len(usages) > 0:
+                    print('  - lcore_usage:')
+                for usage in usages:
+                    print('    - %d: %d%% (busy %d cycles, idle %d cycles)' % (
+                          usage['lcore'], usage['usage'],
+                          usage['busy_cycles'], usage['idle_cycles']))
+
             if ('pipes' in json_obj):
                 print('- pipes:')
                 for pipe in json_obj['pipes']:
+                    rx_rings = self._pipe_rings(pipe['rx'],
+                                                pipe.get('nof_rx', 1))
+                    tx_rings = self._pipe_rings(pipe['tx'],
+                                                pipe.get('nof_tx', 1))
                     print('  - pipe:{} ring:{} ring:{}'.format(pipe['id'],
-                        pipe['rx'], pipe['tx']))
+                        rx_rings, tx_rings))
 
             if ('phy_ports' in json_obj) or ('ring_ports' in json_obj):
                 print('- stats')
@@ -279,6 +291,13 @@ class SppPrimary(object):
         except KeyError as e:
             logger.error('{} is not defined!'.format(e))
 
+    def _pipe_rings(self, ring_id, nof_rings):
+        """Return ring ID of pipe, or range of IDs such as `0-3`."""
+
+        if nof_rings > 1:
+            return '{}-{}'.format(ring_id, ring_id + nof_rings - 1)
+        return '{}'.format(ring_id)
+
     # TODO(yasufum) make methods start with '_get' to be shared
     # because it is similar to nfv. _get_ports(self) is changed as
     # _get_ports(self, proc_type).
@@ -817,6 +836,9 @@ class SppPrimary(object):
                 # add pipe:X ring:A ring:B
                 req_params['rx'] = params[1]
                 req_params['tx'] = params[2]
+            elif len(params) == 2:
+                # add ring:X mpsc
+                req_params['mode'] = params[1]
 
             res = self.spp_ctl_cli.put('primary/ports', req_params)
             if res is not None:
@@ -16,7 +16,8 @@ class SppPrimaryFlow(object):
     """
 
     # All of flow commands
-    FLOW_CMDS = ["validate", "create", "destroy", "list", "status"]
+    FLOW_CMDS = ["validate", "create", "destroy", "list", "status", "query",
+                 "stats"]
 
     # Attribute commands of flow rule
     ATTR_CMDS = ["group", "priority", "ingress", "egress", "transfer",
@@ -28,11 +29,19 @@ class SppPrimaryFlow(object):
     FLOW_API_CREATE = "primary/flow_rules/port_id/{port_id}"
     FLOW_API_DESTROY = "primary/flow_rules/{rule_id}/port_id/{port_id}"
     FLOW_API_ALL_DESTROY = "primary/flow_rules/port_id/{port_id}"
+    FLOW_API_COUNT = "primary/flow_rules/{rule_id}/port_id/{port_id}/count"
+    FLOW_API_STATS = "primary/flow_rules/port_id/{port_id}/stats"
 
     # Completion class relevant to the pattern item type
     PTN_COMPL_CLASSES = {
         "eth": flow_compl_ptn.ComplEth,
         "vlan": flow_compl_ptn.ComplVlan,
+        "ipv4": flow_compl_ptn.ComplIpv4,
+        "ipv6": flow_compl_ptn.ComplIpv6,
+        "udp": flow_compl_ptn.ComplUdp,
+        "tcp": flow_compl_ptn.ComplTcp,
+        "vxlan": flow_compl_ptn.ComplVxlan,
+        "gtp": flow_compl_ptn.ComplGtp,
     }
 
     # Completion class relevant to the action type
@@ -43,6 +52,11 @@ class SppPrimaryFlow(object):
         "of_set_vlan_pcp": flow_compl_act.ComplOfSetVlanPCP,
         "of_set_vlan_vid": flow_compl_act.ComplOfSetVlanVID,
         "queue": flow_compl_act.ComplQueue,
+        "rss": flow_compl_act.ComplRss,
+        "mark": flow_compl_act.ComplMark,
+        "count": flow_compl_act.ComplCount,
+        "drop": flow_compl_act.ComplDrop,
+        "port_id": flow_compl_act.ComplPortId,
     }
 
     def __init__(self, spp_ctl_cli):
@@ -77,6 +91,12 @@ class SppPrimaryFlow(object):
         elif params[0] == "status":
             self._run_flow_status(params[1:])
 
+        elif params[0] == "query":
+            self._run_flow_query(params[1:])
+
+        elif params[0] == "stats":
+            self._run_flow_stats(params[1:])
+
     def complete_flow(self, tokens):
         """Completion for flow commands."""
         candidates = []
@@ -102,6 +122,12 @@ class SppPrimaryFlow(object):
             elif tokens[1] == "status":
                 candidates = self._compl_flow_status(tokens[2:])
 
+            elif tokens[1] == "query":
+                candidates = self._compl_flow_query(tokens[2:])
+
+            elif tokens[1] == "stats":
+                candidates = self._compl_flow_list(tokens[2:])
+
         return candidates
 
     def _compl_flow_rule(self, tokens):
@@ -287,6 +313,24 @@ class SppPrimaryFlow(object):
 
         return candidates
 
+    def _compl_flow_query(self, tokens):
+        """Completion for query command."""
+        candidates = []
+
+        if len(tokens) == 1:
+            candidates = self._create_candidacy_phy_ports(tokens[0])
+
+        elif len(tokens) == 2:
+            rule_ids = self._get_rule_ids(tokens[0])
+
+            if rule_ids is not None:
+                candidates = rule_ids
+
+        elif len(tokens) == 3:
+            candidates = ["count"]
+
+        return candidates
+
     def _run_flow_validate(self, params):
         """Run `validate` command."""
         if len(params) == 0:
@@ -489,6 +533,123 @@ class SppPrimaryFlow(object):
 
         self._print_flow_status(target_flow)
 
+    def _run_flow_query(self, params):
+        """Run `query` command.
+
+        Only `count` action is supported. Print example.
+        -----
+        spp > pri; flow query phy:0 0 count
+        hits: 1024
+        bytes: 65536
+        -----
+        """
+        if len(params) == 0:
+            print("RES_UID is NULL")
+            return None
+
+        port_id = self._parse_phy_res_uid_to_port_id(params[0])
+        if port_id is None:
+            print("RES_UID is invalid")
+            return None
+
+        if len(params) < 2:
+            print("RULE_ID is NULL")
+            return None
+
+        try:
+            rule_id = int(params[1])
+        except Exception as _:
+            print("RULE_ID is invalid")
+            return None
+
+        if len(params) < 3 or params[2] != "count":
+            print("Only `count` action can be queried")
+            return None
+
+        url = self.FLOW_API_COUNT.format(port_id=port_id, rule_id=rule_id)
+
+        response = self.spp_ctl_cli.get(url)
+        if response is None or response.status_code != 200:
+            print("Error: API execution failed for flow query")
+            return None
+
+        try:
+            res_body = response.json()
+        except Exception as _:
+            print("Error: API response is not json")
+            return None
+
+        count = res_body.get("count")
+        if count is None:
+            message = res_body.get("message")
+            if message is not None:
+                print(message)
+            else:
+                print("Error: result message is None")
+            return None
+
+        hits = count.get("hits") if count.get("hits_set") else "-"
+        nof_bytes = count.get("bytes") if count.get("bytes_set") else "-"
+        print("hits: {0}".format(hits))
+        print("bytes: {0}".format(nof_bytes))
+
+    def _run_flow_stats(self, params):
+        """Run `stats` command.
+
+        Print hit counters of each rule. Counter not supported by the
+        device is shown as `-`. Print example.
+        -----
+        spp > pri; flow stats phy:0
+        ID      Packets         Bytes
+        0       1024            65536
+        1       -               -
+        -----
+        """
+        if len(params) != 1:
+            print("RES_UID is NULL")
+            return None
+
+        port_id = self._parse_phy_res_uid_to_port_id(params[0])
+        if port_id is None:
+            print("RES_UID is invalid")
+            return None
+
+        url = self.FLOW_API_STATS.format(port_id=port_id)
+
+        response = self.spp_ctl_cli.get(url)
+        if response is None or response.status_code != 200:
+            print("Error: API execution failed for flow stats")
+            return None
+
+        try:
+            res_body = response.json()
+        except Exception as _:
+            print("Error: API response is not json")
+            return None
+
+        stats = res_body.get("stats")
+        if stats is None:
+            message = res_body.get("message")
+            if message is not None:
+                print(message)
+            else:
+                print("Error: result message is None")
+            return None
+
+        print("ID      Packets         Bytes")
+        for stat in stats:
+            count = stat.get("count", {})
+            print("{0} {1} {2}".format(
+                str(stat.get("rule_id")).ljust(7),
+                self._count_to_str(count.get("packets")).ljust(15),
+                self._count_to_str(count.get("bytes"))))
+
+    def _count_to_str(self, value):
+        """Return counter as string, or `-` if it is not supported."""
+        if value is None:
+            return "-"
+        return str(value)
+
     def _get_pri_status(self):
         """Get primary status."""
         try:
@@ -778,6 +939,12 @@ class SppPrimaryFlow(object):
 
     def _print_flow_status(self, flow):
         """Print details of flow information."""
+        # Engine print, rule is installed in the device or in software
+        if flow.get("engine") == "sw":
+            print("Engine: software")
+        else:
+            print("Engine: device")
+
         # Attribute print
         self._print_flow_status_attribute(flow.get("attr"))
 
@@ -787,6 +954,9 @@ class SppPrimaryFlow(object):
         # Actions print
         self._print_flow_status_actions(flow.get("actions"))
 
+        # Counters print
+        self._print_flow_status_count(flow.get("count"))
+
     def _print_flow_status_attribute(self, attr):
         """Print attribute in the details of flow information.
 
@@ -906,6 +1076,26 @@ class SppPrimaryFlow(object):
                   "from spp-ctl is invalid")
             return
 
+    def _print_flow_status_count(self, count):
+        """Print hit counters in the details of flow information.
+
+        Print example.
+        -----
+        Count:
+          - packets: 1024
+          - bytes: 65536
+        -----
+        """
+        count_fields_indent = 2
+
+        if count is None:
+            return
+
+        print("Count:")
+        for key in ["packets", "bytes"]:
+            self._print_key_value(key, self._count_to_str(count.get(key)),
+                                  count_fields_indent)
+
     def _print_item_fields(self, fields_dic):
         """Print each field (spec, last or mask) of flow item."""
         item_elements_indent = 6
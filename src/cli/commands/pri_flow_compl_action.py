@@ -113,3 +113,128 @@ class ComplQueue(BaseComplAction):
     DATA_FIELDS_VALUES = {
         "index": "UNSIGNED_INT"
     }
+
+
+class ComplRss(BaseComplAction):
+    """Complete action `rss`.
+
+    `types` and `queues` take a list of values terminated with `end`,
+    for example `types ipv4-udp ipv4-tcp end queues 0 1 end`.
+    """
+
+    # Rss data fields
+    DATA_FIELDS = ["func", "level", "types", "queues"]
+
+    # Data fields which take a list of values
+    LIST_FIELDS = ["types", "queues"]
+
+    # Hash functions and types
+    FUNCS = ["default", "toeplitz", "simple_xor"]
+    TYPES = ["ip", "udp", "tcp", "sctp", "tunnel",
+             "ipv4", "ipv4-frag", "ipv4-tcp", "ipv4-udp", "ipv4-sctp",
+             "ipv4-other",
+             "ipv6", "ipv6-frag", "ipv6-tcp", "ipv6-udp", "ipv6-sctp",
+             "ipv6-other",
+             "l2-payload", "vxlan", "nvgre"]
+
+    # DATA_FIELDS value candidates
+    DATA_FIELDS_VALUES = {
+        "level": "UNSIGNED_INT"
+    }
+
+    def compl_action(self, tokens, index):
+        """Completion for rss action including lists of values."""
+        candidates = []
+        list_field = None
+
+        while index < len(tokens):
+            if list_field is not None:
+                # In the list of values until `end` is specified
+                if tokens[index - 1] == "end":
+                    list_field = None
+                    candidates = copy.deepcopy(self.DATA_FIELDS)
+                    candidates.append("/")
+                elif list_field == "types":
+                    candidates = self.TYPES + ["end"]
+                else:
+                    candidates = ["QUEUE_INDEX", "end"]
+
+            elif tokens[index - 1] == "/":
+                # Completion processing end when "/" is specified
+                candidates = []
+                break
+
+            elif tokens[index - 1] in self.LIST_FIELDS:
+                list_field = tokens[index - 1]
+                if list_field == "types":
+                    candidates = self.TYPES
+                else:
+                    candidates = ["QUEUE_INDEX"]
+
+            elif tokens[index - 1] == "func":
+                candidates = self.FUNCS
+
+            elif tokens[index - 1] in self.DATA_FIELDS:
+                tmp_token = self.DATA_FIELDS_VALUES.get(tokens[index - 1])
+                if tmp_token is not None:
+                    candidates = [tmp_token]
+                else:
+                    candidates = []
+
+            else:
+                # Data fields candidate and end token
+                candidates = copy.deepcopy(self.DATA_FIELDS)
+                candidates.append("/")
+
+            index += 1
+
+        return (candidates, index)
+
+
+class ComplMark(BaseComplAction):
+    """Complete action `mark`."""
+
+    # Mark data fields
+    DATA_FIELDS = ["id"]
+
+    # DATA_FIELDS value candidates
+    DATA_FIELDS_VALUES = {
+        "id": "UNSIGNED_INT"
+    }
+
+
+class ComplCount(BaseComplAction):
+    """Complete action `count`."""
+
+    # Count data fields
+    DATA_FIELDS = ["shared", "id"]
+
+    # DATA_FIELDS value candidates
+    DATA_FIELDS_VALUES = {
+        "shared": "UNSIGNED_INT",
+        "id": "UNSIGNED_INT"
+    }
+
+
+class ComplDrop(BaseComplAction):
+    """Complete action `drop`."""
+
+    # Drop data fields
+    DATA_FIELDS = []
+
+    # DATA_FIELDS value candidates
+    DATA_FIELDS_VALUES = {
+    }
+
+
+class ComplPortId(BaseComplAction):
+    """Complete action `port_id`."""
+
+    # Port_id data fields
+    DATA_FIELDS = ["original", "id"]
+
+    # DATA_FIELDS value candidates
+    DATA_FIELDS_VALUES = {
+        "original": "UNSIGNED_INT",
+        "id": "UNSIGNED_INT"
+    }
@@ -82,3 +82,87 @@ class ComplVlan(BaseComplPatternItem):
         "vid": "UNSIGNED_INT",
         "inner_type": "UNSIGNED_INT"
     }
+
+
+class ComplIpv4(BaseComplPatternItem):
+    """Complete pattern item `ipv4`."""
+
+    # Ipv4 data fields
+    DATA_FIELDS = ["tos", "ttl", "proto", "src", "dst"]
+
+    # DATA_FIELDS value candidates
+    DATA_FIELDS_VALUES = {
+        "tos": "UNSIGNED_INT",
+        "ttl": "UNSIGNED_INT",
+        "proto": "UNSIGNED_INT",
+        "src": "IPV4_ADDRESS",
+        "dst": "IPV4_ADDRESS"
+    }
+
+
+class ComplIpv6(BaseComplPatternItem):
+    """Complete pattern item `ipv6`."""
+
+    # Ipv6 data fields
+    DATA_FIELDS = ["proto", "hop", "src", "dst"]
+
+    # DATA_FIELDS value candidates
+    DATA_FIELDS_VALUES = {
+        "proto": "UNSIGNED_INT",
+        "hop": "UNSIGNED_INT",
+        "src": "IPV6_ADDRESS",
+        "dst": "IPV6_ADDRESS"
+    }
+
+
+class ComplUdp(BaseComplPatternItem):
+    """Complete pattern item `udp`."""
+
+    # Udp data fields
+    DATA_FIELDS = ["src", "dst"]
+
+    # DATA_FIELDS value candidates
+    DATA_FIELDS_VALUES = {
+        "src": "UNSIGNED_INT",
+        "dst": "UNSIGNED_INT"
+    }
+
+
+class ComplTcp(BaseComplPatternItem):
+    """Complete pattern item `tcp`."""
+
+    # Tcp data fields
+    DATA_FIELDS = ["src", "dst", "flags"]
+
+    # DATA_FIELDS value candidates
+    DATA_FIELDS_VALUES = {
+        "src": "UNSIGNED_INT",
+        "dst": "UNSIGNED_INT",
+        "flags": "UNSIGNED_INT"
+    }
+
+
+class ComplVxlan(BaseComplPatternItem):
+    """Complete pattern item `vxlan`."""
+
+    # Vxlan data fields
+    DATA_FIELDS = ["flags", "vni"]
+
+    # DATA_FIELDS value candidates
+    DATA_FIELDS_VALUES = {
+        "flags": "UNSIGNED_INT",
+        "vni": "UNSIGNED_INT"
+    }
+
+
+class ComplGtp(BaseComplPatternItem):
+    """Complete pattern item `gtp`."""
+
+    # Gtp data fields
+    DATA_FIELDS = ["msg_type", "teid"]
+
+    # DATA_FIELDS value candidates
+    DATA_FIELDS_VALUES = {
+        "msg_type": "UNSIGNED_INT",
+        "teid": "UNSIGNED_INT"
+    }
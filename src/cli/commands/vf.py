@@ -20,7 +20,9 @@ class SppVf(object):
             'port': ['add', 'del'],
             'classifier_table': ['add', 'del']}
 
-    WORKER_TYPES = ['forward', 'merge', 'classifier']
+    WORKER_TYPES = ['forward', 'merge', 'classifier', 'classifier_5tuple',
+                    'distributor']
+    MERGE_POLICIES = ['rr', 'wfq', 'prio']
 
     def __init__(self, spp_ctl_cli, sec_id, use_cache=False):
         self.spp_ctl_cli = spp_ctl_cli
@@ -154,6 +156,38 @@ class SppVf(object):
                 # TODO(yasufum) should change 'unuse' to 'unused'
                 print("  - core:%d '' (type: unuse)" % worker['core'])
 
+        # Counters of RX ports of mergers
+        if len(json_obj.get('merge_stats', [])) > 0:
+            print('Merge Stats:')
+        for mrg in json_obj.get('merge_stats', []):
+            print("  - '%s' (policy: %s)" % (mrg['name'], mrg['policy']))
+            for rx in mrg['rx_port']:
+                print('    - %s (weight: %d): rx %d pkts %d bytes, '
+                      'tx %d pkts, drop %d pkts' % (
+                          rx['port'], rx['weight'], rx['rx_pkts'],
+                          rx['rx_bytes'], rx['tx_pkts'], rx['drop_pkts']))
+
+        # Latency of packets sent to ports
+        if len(json_obj.get('latency', [])) > 0:
+            print('Latency:')
+        for lat in json_obj.get('latency', []):
+            print('  - %s: %d pkts, avg %d ns, p50 %d ns, p99 %d ns, '
+                  'p99.9 %d ns, max %d ns' % (
+                      lat['port'], lat['count'], lat['avg_ns'], lat['p50_ns'],
+                      lat['p99_ns'], lat['p999_ns'], lat['max_ns']))
+
+        # Ratio of cycles of polls receiving packets on each of lcores
+        if len(json_obj.get('lcore_usage', [])) > 0:
+            print('Lcore Usage:')
+        for usage in json_obj.get('lcore_usage', []):
+            print('  - core:%d: %d%% (busy %d cycles, idle %d cycles)' % (
+                  usage['lcore'], usage['usage'], usage['busy_cycles'],
+                  usage['idle_cycles']))
+            for comp in usage['components']:
+                print("    - '%s': %d%% (busy %d cycles, idle %d cycles)" % (
+                      comp['name'], comp['usage'], comp['busy_cycles'],
+                      comp['idle_cycles']))
+
     def complete(self, sec_ids, text, line, begidx, endidx):
         """Completion for spp_vf commands.
 
@@ -257,6 +291,12 @@ class SppVf(object):
         if params[0] == 'start':
             req_params = {'name': params[1], 'core': int(params[2]),
                           'type': params[3]}
+            # Options are merge policy or burst size of any order.
+            for opt in params[4:]:
+                if opt.isdigit():
+                    req_params['burst'] = int(opt)
+                else:
+                    req_params['policy'] = opt
             res = self.spp_ctl_cli.post('vfs/%d/components' % self.sec_id,
                                         req_params)
             if res is not None:
@@ -377,7 +417,7 @@ class SppVf(object):
         flg_vlan = False
 
         # The list elements are:
-        #       action, type, vlan, mac,  port
+        #       action, type, vlan, mac, rule or weight,  port
         values = [None, None, None, None, None]
         values_index = 0
 
@@ -388,15 +428,26 @@ class SppVf(object):
 
             elif params_index == 1:
                 req_params["type"] = params[params_index]
-                if (req_params["type"] != "vlan" and
-                        req_params["type"] != "mac"):
-                    print("Error: Type is only vlan or mac")
+                if req_params["type"] not in ["vlan", "mac", "ipv4", "ipv6",
+                                              "weight"]:
+                    print("Error: Type is only vlan, mac, ipv4, ipv6 " +
+                          "or weight")
                     return None
 
             elif params_index == 2 and req_params["type"] == "vlan":
                 req_params["vlan"] = params[params_index]
                 flg_vlan = True
 
+            elif params_index == 2 and req_params["type"] in ["ipv4", "ipv6"]:
+                req_params["rule"] = params[params_index]
+
+            elif params_index == 2 and req_params["type"] == "weight":
+                try:
+                    req_params["weight"] = int(params[params_index])
+                except ValueError:
+                    print("Error: Weight should be an integer")
+                    return None
+
             elif ((params_index == 2 and flg_vlan is False) or
                     (params_index == 3 and flg_vlan is True)):
                 req_params["mac_address"] = params[params_index]
@@ -439,7 +490,7 @@ class SppVf(object):
                 print('Error: unknown response.')
 
     def _compl_component(self, sub_tokens):
-        if len(sub_tokens) < 6:
+        if len(sub_tokens) < 8:
             subsub_cmds = ['start', 'stop']
             res = []
             if len(sub_tokens) == 2:
@@ -466,6 +517,15 @@ class SppVf(object):
                     for wk_type in self.WORKER_TYPES:
                         if wk_type.startswith(sub_tokens[4]):
                             res.append(wk_type)
+            elif len(sub_tokens) in [6, 7]:
+                if sub_tokens[1] == 'start' and sub_tokens[4] == 'merge':
+                    for policy in self.MERGE_POLICIES:
+                        if policy.startswith(sub_tokens[-1]):
+                            res.append(policy)
+                if (sub_tokens[1] == 'start' and
+                        sub_tokens[4] in ['forward', 'merge']):
+                    if 'BURST'.startswith(sub_tokens[-1]):
+                        res.append('BURST')
             return res
 
     def _compl_port(self, sub_tokens):
@@ -585,9 +645,11 @@ class SppVf(object):
         index = 0
 
         # compl_phase "add_del"  : candidate is add or del
-        # compl_phase "vlan_mac" : candidate is vlan or mac
+        # compl_phase "vlan_mac" : candidate is vlan, mac, ipv4, ipv6 or weight
         # compl_phase "vid"      : candidate is VID
         # compl_phase "mac_addr" : candidate is MAC_ADDR or default
+        # compl_phase "rule"     : candidate is RULE or default
+        # compl_phase "weight"   : candidate is WEIGHT
         # compl_phase "res_uid"  : candidate is RES_UID
         # compl_phase "nq"       : candidate is nq
         # compl_phase "queue_no" : candidate is queue_no
@@ -598,6 +660,11 @@ class SppVf(object):
 
             if compl_phase == "vid" and sub_tokens[index - 1] == "mac":
                 compl_phase = "mac_addr"
+            elif (compl_phase == "vid" and
+                    sub_tokens[index - 1] in ["ipv4", "ipv6"]):
+                compl_phase = "rule"
+            elif compl_phase == "vid" and sub_tokens[index - 1] == "weight":
+                compl_phase = "weight"
 
             if compl_phase == "nq":
                 queue_no_list = self._get_candidate_phy_queue_no(
@@ -611,7 +678,7 @@ class SppVf(object):
                 compl_phase = "vlan_mac"
 
             elif compl_phase == "vlan_mac":
-                res = ["vlan", "mac"]
+                res = ["vlan", "mac", "ipv4", "ipv6", "weight"]
                 compl_phase = "vid"
 
             elif compl_phase == "vid" and sub_tokens[index - 1] == "vlan":
@@ -622,6 +689,14 @@ class SppVf(object):
                 res = ["MAC_ADDR", "default"]
                 compl_phase = "res_uid"
 
+            elif compl_phase == "rule":
+                res = ["RULE", "default"]
+                compl_phase = "res_uid"
+
+            elif compl_phase == "weight":
+                res = ["WEIGHT"]
+                compl_phase = "res_uid"
+
             elif compl_phase == "res_uid":
                 res = ["RES_UID"]
                 compl_phase = "nq"
@@ -668,10 +743,20 @@ class SppVf(object):
         # (2) launch or terminate a worker thread with arbitrary name
         #   NAME: arbitrary name used as identifier
         #   CORE_ID: one of unused cores referred from status
-        #   ROLE: role of workers, 'forward', 'merge' or 'classifier'
+        #   ROLE: role of workers, 'forward', 'merge', 'classifier',
+        #     'classifier_5tuple' or 'distributor'
         spp > vf 1; component start NAME CORE_ID ROLE
         spp > vf 1; component stop NAME CORE_ID ROLE
 
+        #   POLICY: scheduling of RX ports of 'merge', 'rr' (default),
+        #     'wfq' or 'prio', in which weight of RX port is referred
+        spp > vf 1; component start NAME CORE_ID merge POLICY
+
+        #   BURST: max num of packets in a burst of 'forward' or 'merge',
+        #     from 1 to 256 and 32 by default
+        spp > vf 1; component start NAME CORE_ID forward BURST
+        spp > vf 1; component start NAME CORE_ID merge POLICY BURST
+
         # (3) add or delete a port to worker of NAME
         #   RES_UID: resource UID such as 'ring:0' or 'vhost:1'
         #   DIR: 'rx' or 'tx'
@@ -694,6 +779,19 @@ class SppVf(object):
         # (7) add or delete an entry of MAC address and resource with vlan ID
         spp > vf 1; classifier_table add vlan VID MAC_ADDR RES_UID
         spp > vf 1; classifier_table del vlan VID MAC_ADDR RES_UID
+
+        # (8) add or delete an entry of 5-tuple rule for classifier_5tuple
+        #   RULE: 'PROTO,SRC_ADDR[/LEN],DST_ADDR[/LEN],SPORT[-MAX],DPORT[-MAX]'
+        #     such as 'tcp,10.0.0.0/8,any,any,80', or 'default'
+        spp > vf 1; classifier_table add ipv4 RULE RES_UID
+        spp > vf 1; classifier_table del ipv6 RULE RES_UID
+
+        # (9) set or reset weight of TX port of distributor or RX port of
+        #   merge, default is 1
+        #   WEIGHT: share of flows of distributor, or quota, share or
+        #     priority of merge, from 1 to 255
+        spp > vf 1; classifier_table add weight WEIGHT RES_UID
+        spp > vf 1; classifier_table del weight WEIGHT RES_UID
         """
 
         print(msg)
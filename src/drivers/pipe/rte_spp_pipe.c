@@ -13,14 +13,14 @@
 #include <rte_bus_vdev.h>
 #include <rte_kvargs.h>
 #include <rte_errno.h>
+#include <stddef.h>
 #include <string.h>
 
 #define ETH_PIPE_RX_ARG	"rx"
 #define ETH_PIPE_TX_ARG	"tx"
 
-/* TODO: define in config */
-#define PMD_PIPE_MAX_RX_RINGS 1
-#define PMD_PIPE_MAX_TX_RINGS 1
+#define PMD_PIPE_MAX_RX_RINGS 16
+#define PMD_PIPE_MAX_TX_RINGS 16
 
 static const char * const valid_arguments[] = {
 	ETH_PIPE_RX_ARG,
@@ -28,13 +28,54 @@ static const char * const valid_arguments[] = {
 	NULL
 };
 
+/*
+ * Bins of histogram of burst size for power of 2, 1, 2-3, 4-7, 8-15, 16-31
+ * and 32 or more. Empty bursts are not counted.
+ */
+#define PIPE_BURST_HIST_BINS 6
+
+/*
+ * Counters of a queue. Each of queues is used from one lcore, so counters are
+ * updated without atomic operations.
+ */
 struct ring_queue {
 	struct rte_ring *rng;
-	rte_atomic64_t rx_pkts;
-	rte_atomic64_t tx_pkts;
-	rte_atomic64_t err_pkts;
+	uint64_t rx_pkts;
+	uint64_t tx_pkts;
+	uint64_t err_pkts;
+	uint64_t enq_full;  /* Number of bursts failed to enqueue all. */
+	uint64_t occupancy_hwm;  /* High-water mark of entries in ring. */
+	uint64_t burst_hist[PIPE_BURST_HIST_BINS];
+} __rte_cache_aligned;
+
+/* Name and offset of counter in ring_queue, used for xstats. */
+struct pipe_xstats_name_off {
+	char name[RTE_ETH_XSTATS_NAME_SIZE];
+	unsigned int offset;
+};
+
+#define PIPE_BURST_HIST_XSTATS \
+	{"burst_1", offsetof(struct ring_queue, burst_hist[0])}, \
+	{"burst_2_3", offsetof(struct ring_queue, burst_hist[1])}, \
+	{"burst_4_7", offsetof(struct ring_queue, burst_hist[2])}, \
+	{"burst_8_15", offsetof(struct ring_queue, burst_hist[3])}, \
+	{"burst_16_31", offsetof(struct ring_queue, burst_hist[4])}, \
+	{"burst_32_or_more", offsetof(struct ring_queue, burst_hist[5])}
+
+static const struct pipe_xstats_name_off pipe_rxq_xstats[] = {
+	{"occupancy_hwm", offsetof(struct ring_queue, occupancy_hwm)},
+	PIPE_BURST_HIST_XSTATS,
 };
 
+static const struct pipe_xstats_name_off pipe_txq_xstats[] = {
+	{"occupancy_hwm", offsetof(struct ring_queue, occupancy_hwm)},
+	{"enqueue_full", offsetof(struct ring_queue, enq_full)},
+	PIPE_BURST_HIST_XSTATS,
+};
+
+#define PIPE_NB_RXQ_XSTATS RTE_DIM(pipe_rxq_xstats)
+#define PIPE_NB_TXQ_XSTATS RTE_DIM(pipe_txq_xstats)
+
 struct pipe_private {
 	uint16_t nb_rx_queues;
 	uint16_t nb_tx_queues;
@@ -55,22 +96,38 @@ static int eth_pipe_logtype;
 	rte_log(RTE_LOG_ ## level, eth_pipe_logtype, \
 		"%s(): " fmt "\n", __func__, ##args)
 
+/* Count burst of nb_pkts in the histogram, nb_pkts should be 1 or more. */
+static inline void
+count_burst(struct ring_queue *r, uint16_t nb_pkts)
+{
+	unsigned int bin = 31 - __builtin_clz(nb_pkts);
+
+	if (bin >= PIPE_BURST_HIST_BINS)
+		bin = PIPE_BURST_HIST_BINS - 1;
+	r->burst_hist[bin]++;
+}
+
 static uint16_t
 eth_pipe_rx(void *q, struct rte_mbuf **bufs, uint16_t nb_bufs)
 {
 	void **ptrs = (void *)&bufs[0];
 	struct ring_queue *r = q;
+	unsigned int avail;
 	uint16_t nb_rx;
 
 	if (!q)
 		return 0;
 
-	nb_rx = (uint16_t)rte_ring_dequeue_burst(r->rng, ptrs, nb_bufs, NULL);
+	nb_rx = (uint16_t)rte_ring_dequeue_burst(r->rng, ptrs, nb_bufs,
+			&avail);
+	if (nb_rx == 0)
+		return 0;
 
-	if (r->rng->flags & RING_F_SC_DEQ)
-		r->rx_pkts.cnt += nb_rx;
-	else
-		rte_atomic64_add(&(r->rx_pkts), nb_rx);
+	r->rx_pkts += nb_rx;
+	count_burst(r, nb_rx);
+	/* Entries in the ring before dequeued. */
+	if (unlikely(nb_rx + avail > r->occupancy_hwm))
+		r->occupancy_hwm = nb_rx + avail;
 
 	return nb_rx;
 }
@@ -80,20 +137,26 @@ eth_pipe_tx(void *q, struct rte_mbuf **bufs, uint16_t nb_bufs)
 {
 	void **ptrs = (void *)&bufs[0];
 	struct ring_queue *r = q;
+	unsigned int free_space, used;
 	uint16_t nb_tx;
 
-	if (!q)
+	if (!q || nb_bufs == 0)
 		return 0;
 
-	nb_tx = (uint16_t)rte_ring_enqueue_burst(r->rng, ptrs, nb_bufs, NULL);
+	nb_tx = (uint16_t)rte_ring_enqueue_burst(r->rng, ptrs, nb_bufs,
+			&free_space);
 
-	if (r->rng->flags & RING_F_SP_ENQ) {
-		r->tx_pkts.cnt += nb_tx;
-		r->err_pkts.cnt += nb_bufs - nb_tx;
-	} else {
-		rte_atomic64_add(&(r->tx_pkts), nb_tx);
-		rte_atomic64_add(&(r->err_pkts), nb_bufs - nb_tx);
+	r->tx_pkts += nb_tx;
+	if (unlikely(nb_tx < nb_bufs)) {
+		r->err_pkts += nb_bufs - nb_tx;
+		r->enq_full++;
 	}
+	if (nb_tx > 0)
+		count_burst(r, nb_tx);
+	/* Entries in the ring after enqueued. */
+	used = rte_ring_get_capacity(r->rng) - free_space;
+	if (unlikely(used > r->occupancy_hwm))
+		r->occupancy_hwm = used;
 
 	return nb_tx;
 }
@@ -166,14 +229,14 @@ eth_stats_get(struct rte_eth_dev *dev, struct rte_eth_stats *stats)
 
 	for (i = 0; i < RTE_ETHDEV_QUEUE_STAT_CNTRS &&
 			i < dev->data->nb_rx_queues; i++) {
-		stats->q_ipackets[i] = pipe_priv->rx_ring_queues[i].rx_pkts.cnt;
+		stats->q_ipackets[i] = pipe_priv->rx_ring_queues[i].rx_pkts;
 		rx_total += stats->q_ipackets[i];
 	}
 
 	for (i = 0; i < RTE_ETHDEV_QUEUE_STAT_CNTRS &&
 			i < dev->data->nb_tx_queues; i++) {
-		stats->q_opackets[i] = pipe_priv->tx_ring_queues[i].tx_pkts.cnt;
-		stats->q_errors[i] = pipe_priv->tx_ring_queues[i].err_pkts.cnt;
+		stats->q_opackets[i] = pipe_priv->tx_ring_queues[i].tx_pkts;
+		stats->q_errors[i] = pipe_priv->tx_ring_queues[i].err_pkts;
 		tx_total += stats->q_opackets[i];
 		tx_err_total += stats->q_errors[i];
 	}
@@ -191,12 +254,112 @@ eth_stats_reset(struct rte_eth_dev *dev)
 	unsigned int i;
 	struct pipe_private *pipe_priv = dev->data->dev_private;
 	for (i = 0; i < dev->data->nb_rx_queues; i++)
-		pipe_priv->rx_ring_queues[i].rx_pkts.cnt = 0;
+		pipe_priv->rx_ring_queues[i].rx_pkts = 0;
+	for (i = 0; i < dev->data->nb_tx_queues; i++) {
+		pipe_priv->tx_ring_queues[i].tx_pkts = 0;
+		pipe_priv->tx_ring_queues[i].err_pkts = 0;
+	}
+
+	return 0;
+}
+
+static unsigned int
+get_nb_xstats(const struct rte_eth_dev *dev)
+{
+	return dev->data->nb_rx_queues * PIPE_NB_RXQ_XSTATS +
+		dev->data->nb_tx_queues * PIPE_NB_TXQ_XSTATS;
+}
+
+static int
+eth_xstats_get_names(struct rte_eth_dev *dev,
+		struct rte_eth_xstat_name *xstats_names,
+		unsigned int size __rte_unused)
+{
+	unsigned int i, j, count = 0;
+
+	if (xstats_names == NULL)
+		return get_nb_xstats(dev);
+
+	for (i = 0; i < dev->data->nb_rx_queues; i++) {
+		for (j = 0; j < PIPE_NB_RXQ_XSTATS; j++) {
+			snprintf(xstats_names[count].name,
+					sizeof(xstats_names[count].name),
+					"rx_q%u_%s", i,
+					pipe_rxq_xstats[j].name);
+			count++;
+		}
+	}
+
+	for (i = 0; i < dev->data->nb_tx_queues; i++) {
+		for (j = 0; j < PIPE_NB_TXQ_XSTATS; j++) {
+			snprintf(xstats_names[count].name,
+					sizeof(xstats_names[count].name),
+					"tx_q%u_%s", i,
+					pipe_txq_xstats[j].name);
+			count++;
+		}
+	}
+
+	return count;
+}
+
+static int
+eth_xstats_get(struct rte_eth_dev *dev, struct rte_eth_xstat *xstats,
+		unsigned int n)
+{
+	unsigned int i, j, count = 0;
+	const struct pipe_private *pipe_priv = dev->data->dev_private;
+	const char *q;
+
+	if (n < get_nb_xstats(dev))
+		return get_nb_xstats(dev);
+
+	for (i = 0; i < dev->data->nb_rx_queues; i++) {
+		q = (const char *)&pipe_priv->rx_ring_queues[i];
+		for (j = 0; j < PIPE_NB_RXQ_XSTATS; j++) {
+			xstats[count].id = count;
+			xstats[count].value = *(const uint64_t *)
+				(q + pipe_rxq_xstats[j].offset);
+			count++;
+		}
+	}
+
 	for (i = 0; i < dev->data->nb_tx_queues; i++) {
-		pipe_priv->tx_ring_queues[i].tx_pkts.cnt = 0;
-		pipe_priv->tx_ring_queues[i].err_pkts.cnt = 0;
+		q = (const char *)&pipe_priv->tx_ring_queues[i];
+		for (j = 0; j < PIPE_NB_TXQ_XSTATS; j++) {
+			xstats[count].id = count;
+			xstats[count].value = *(const uint64_t *)
+				(q + pipe_txq_xstats[j].offset);
+			count++;
+		}
 	}
 
+	return count;
+}
+
+/* Clear all of counters of a queue, following `rng` in ring_queue. */
+static void
+reset_queue_counters(struct ring_queue *r)
+{
+	memset(&r->rx_pkts, 0,
+		sizeof(*r) - offsetof(struct ring_queue, rx_pkts));
+}
+
+/*
+ * Basic stats are also cleared because ethdev does not call stats_reset
+ * if xstats_reset is defined.
+ */
+static int
+eth_xstats_reset(struct rte_eth_dev *dev)
+{
+	unsigned int i;
+	struct pipe_private *pipe_priv = dev->data->dev_private;
+
+	for (i = 0; i < dev->data->nb_rx_queues; i++)
+		reset_queue_counters(&pipe_priv->rx_ring_queues[i]);
+	for (i = 0; i < dev->data->nb_tx_queues; i++)
+		reset_queue_counters(&pipe_priv->tx_ring_queues[i]);
+
 	return 0;
 }
 
@@ -224,6 +387,9 @@ static const struct eth_dev_ops ops = {
 	.link_update = eth_link_update,
 	.stats_get = eth_stats_get,
 	.stats_reset = eth_stats_reset,
+	.xstats_get = eth_xstats_get,
+	.xstats_get_names = eth_xstats_get_names,
+	.xstats_reset = eth_xstats_reset,
 };
 
 static char *get_rx_queue_name(unsigned int id)
@@ -235,63 +401,85 @@ static char *get_rx_queue_name(unsigned int id)
 	return buffer;
 }
 
+/*
+ * Validate ring name such as `ring:0`, or range of rings such as `ring:0-3`,
+ * and get the first and the last ring IDs.
+ */
 static int
-validate_ring_name(const char *value, unsigned int *num)
+validate_ring_name(const char *value, unsigned int *first, unsigned int *last)
 {
 	const char *ring_name = "ring:";
 	size_t len = strlen(ring_name);
-	const char *num_start = value + len;
+	const char *num_start;
 	char *end;
 
 	if (value == NULL || strncmp(ring_name, value, len) != 0)
 		return -1;
 
-	*num = (unsigned int)strtoul(num_start, &end, 10);
-	if (*num_start == '\0' || *end != '\0')
+	num_start = value + len;
+	if (*num_start == '\0')
+		return -1;
+
+	*first = (unsigned int)strtoul(num_start, &end, 10);
+	if (*end == '-') {
+		num_start = end + 1;
+		if (*num_start == '\0')
+			return -1;
+		*last = (unsigned int)strtoul(num_start, &end, 10);
+	} else
+		*last = *first;
+
+	if (*end != '\0' || *last < *first)
 		return -1;
 
 	return 0;
 }
 
+/* Add rings given as rx or tx arg to queues in the order of ring IDs. */
 static int
 parse_rings(const char *key, const char *value, void *data)
 {
 	struct pipe_private *pipe_priv = data;
-	unsigned int num;
+	unsigned int num, first, last;
 	struct rte_ring *r;
 
-	if (validate_ring_name(value, &num) == -1) {
+	if (validate_ring_name(value, &first, &last) == -1) {
 		PMD_PIPE_LOG(ERR, "invalid ring name %s", value);
 		return -1;
 	}
 
-	r = rte_ring_lookup(get_rx_queue_name(num));
-	if (r == NULL) {
-		PMD_PIPE_LOG(ERR, "ring %s does not exist", value);
-		return -1;
-	}
-
-	PMD_PIPE_LOG(DEBUG, "%s %s cons.head: %u cons.tail: %u "
-			"prod.head: %u prod.tail: %u",
-			key, value, r->cons.head, r->cons.tail,
-			r->prod.head, r->prod.tail);
-
-	if (strcmp(key, ETH_PIPE_RX_ARG) == 0) {
-		if (pipe_priv->nb_rx_queues >= PMD_PIPE_MAX_RX_RINGS) {
-			PMD_PIPE_LOG(ERR, "rx rings exceeds max(%d)",
-					PMD_PIPE_MAX_RX_RINGS);
+	for (num = first; num <= last; num++) {
+		r = rte_ring_lookup(get_rx_queue_name(num));
+		if (r == NULL) {
+			PMD_PIPE_LOG(ERR, "ring %s does not exist",
+					get_rx_queue_name(num));
 			return -1;
 		}
-		pipe_priv->rx_ring_queues[pipe_priv->nb_rx_queues].rng = r;
-		pipe_priv->nb_rx_queues++;
-	} else { /* ETH_PIPE_TX_ARG */
-		if (pipe_priv->nb_tx_queues >= PMD_PIPE_MAX_TX_RINGS) {
-			PMD_PIPE_LOG(ERR, "tx rings exceeds max(%d)",
-					PMD_PIPE_MAX_TX_RINGS);
-			return -1;
+
+		PMD_PIPE_LOG(DEBUG, "%s %s cons.head: %u cons.tail: %u "
+				"prod.head: %u prod.tail: %u",
+				key, r->name, r->cons.head, r->cons.tail,
+				r->prod.head, r->prod.tail);
+
+		if (strcmp(key, ETH_PIPE_RX_ARG) == 0) {
+			if (pipe_priv->nb_rx_queues >= PMD_PIPE_MAX_RX_RINGS) {
+				PMD_PIPE_LOG(ERR, "rx rings exceeds max(%d)",
+						PMD_PIPE_MAX_RX_RINGS);
+				return -1;
+			}
+			pipe_priv->rx_ring_queues[
+				pipe_priv->nb_rx_queues].rng = r;
+			pipe_priv->nb_rx_queues++;
+		} else { /* ETH_PIPE_TX_ARG */
+			if (pipe_priv->nb_tx_queues >= PMD_PIPE_MAX_TX_RINGS) {
+				PMD_PIPE_LOG(ERR, "tx rings exceeds max(%d)",
+						PMD_PIPE_MAX_TX_RINGS);
+				return -1;
+			}
+			pipe_priv->tx_ring_queues[
+				pipe_priv->nb_tx_queues].rng = r;
+			pipe_priv->nb_tx_queues++;
 		}
-		pipe_priv->tx_ring_queues[pipe_priv->nb_tx_queues].rng = r;
-		pipe_priv->nb_tx_queues++;
 	}
 
 	return 0;
@@ -379,7 +567,9 @@ rte_pmd_pipe_probe(struct rte_vdev_device *dev)
 	rte_eth_dev_probing_finish(eth_dev);
 
 	PMD_PIPE_LOG(DEBUG, "%s created", name);
-	PMD_PIPE_LOG(DEBUG, "port_id = %d", eth_dev->data->port_id);
+	PMD_PIPE_LOG(DEBUG, "port_id = %d, rx queues = %u, tx queues = %u",
+			eth_dev->data->port_id, pipe_priv->nb_rx_queues,
+			pipe_priv->nb_tx_queues);
 
 	return 0;
 }
@@ -416,7 +606,8 @@ static struct rte_vdev_driver pmd_pipe_drv = {
 };
 
 RTE_PMD_REGISTER_VDEV(spp_pipe, pmd_pipe_drv);
-RTE_PMD_REGISTER_PARAM_STRING(spp_pipe, "rx=<rx_ring> tx=<tx_ring>");
+RTE_PMD_REGISTER_PARAM_STRING(spp_pipe,
+		"rx=<rx_ring>[-<last_rx_ring>] tx=<tx_ring>[-<last_tx_ring>]");
 
 RTE_INIT(eth_pipe_init_log)
 {
@@ -3,12 +3,14 @@
  */
 
 #include "spp_mirror.h"
+#include "shared/lcore_usage.h"
 #include "shared/secondary/return_codes.h"
 #include "shared/secondary/string_buffer.h"
 #include "shared/secondary/json_helper.h"
 #include "shared/secondary/spp_worker_th/cmd_parser.h"
 #include "shared/secondary/spp_worker_th/cmd_runner.h"
 #include "shared/secondary/spp_worker_th/cmd_res_formatter.h"
+#include "shared/secondary/spp_worker_th/comp_service.h"
 #include "shared/secondary/spp_worker_th/port_capability.h"
 #include "shared/secondary/spp_worker_th/mirror_deps.h"
 
@@ -61,10 +63,27 @@ update_comp(enum sppwk_action wk_action, const char *name,
 			return SPPWK_RET_NG;
 		}
 
+		if (sppwk_is_service_lcore(lcore_id) &&
+				!sppwk_comp_service_available()) {
+			RTE_LOG(ERR, MIR_CMD_RUNNER,
+					"No more service for component on "
+					"lcore %d.\n", lcore_id);
+			return SPPWK_RET_NG;
+		}
+
 		core = &info->core[info->upd_index];
 
 		comp_info = (comp_info_base + comp_lcore_id);
+		if (unlikely(backup_mng_obj(comp_info,
+				sizeof(struct sppwk_comp_info)) !=
+				SPPWK_RET_OK) ||
+				unlikely(backup_mng_obj(core,
+				sizeof(struct core_info)) != SPPWK_RET_OK))
+			return SPPWK_RET_NG;
 		memset(comp_info, 0x00, sizeof(struct sppwk_comp_info));
+		/* Usage of previous component of the same ID is cleared. */
+		memset(&comp_usages[comp_lcore_id], 0x00,
+				sizeof(struct lcore_usage));
 		strcpy(comp_info->name, name);
 		comp_info->wk_type = wk_type;
 		comp_info->lcore_id = lcore_id;
@@ -84,10 +103,18 @@ update_comp(enum sppwk_action wk_action, const char *name,
 
 		comp_info = (comp_info_base + comp_lcore_id);
 		tmp_lcore_id = comp_info->lcore_id;
-		memset(comp_info, 0x00, sizeof(struct sppwk_comp_info));
-
 		info = (core_info + tmp_lcore_id);
 		core = &info->core[info->upd_index];
+		if (unlikely(backup_mng_obj(comp_info,
+				sizeof(struct sppwk_comp_info)) !=
+				SPPWK_RET_OK) ||
+				unlikely(backup_mng_obj(core,
+				sizeof(struct core_info)) != SPPWK_RET_OK))
+			return SPPWK_RET_NG;
+		if (unlikely(sppwk_release_comp_ports(comp_info) !=
+				SPPWK_RET_OK))
+			return SPPWK_RET_NG;
+		memset(comp_info, 0x00, sizeof(struct sppwk_comp_info));
 
 		/* The latest lcore is released if worker thread is stopped. */
 		ret_del = del_comp_info(comp_lcore_id, core->num, core->id);
@@ -156,8 +183,15 @@ update_port(enum sppwk_action wk_action,
 	sppwk_get_mng_data(NULL, &comp_info_base, NULL, NULL,
 			&change_component, NULL);
 	comp_info = (comp_info_base + comp_lcore_id);
-	port_info = get_sppwk_port(port->iface_type, port->iface_no,
+	port_info = sppwk_prepare_port(port->iface_type, port->iface_no,
 			port->queue_no);
+	if (unlikely(port_info == NULL))
+		return SPPWK_RET_NG;
+	if (unlikely(backup_mng_obj(comp_info,
+			sizeof(struct sppwk_comp_info)) != SPPWK_RET_OK) ||
+			unlikely(backup_mng_obj(port_info,
+			sizeof(struct sppwk_port_info)) != SPPWK_RET_OK))
+		return SPPWK_RET_NG;
 	if (dir == SPPWK_PORT_DIR_RX) {
 		nof_ports = &comp_info->nof_rx;
 		ports = comp_info->rx_ports;
@@ -203,6 +237,12 @@ update_port(enum sppwk_action wk_action,
 			return SPPWK_RET_NG;
 		}
 
+		/* Array of ports might be moved to extend it. */
+		ports = sppwk_prepare_comp_ports(comp_info, dir,
+				*nof_ports + 1);
+		if (unlikely(ports == NULL))
+			return SPPWK_RET_NG;
+
 		if (port_attrs->ops != SPPWK_PORT_OPS_NONE) {
 			while ((cnt < PORT_CAPABL_MAX) &&
 					(port_info->port_attrs[cnt].ops !=
@@ -236,6 +276,12 @@ update_port(enum sppwk_action wk_action,
 					sizeof(struct sppwk_port_attrs));
 		}
 
+		if (*nof_ports > 0) {
+			ports = sppwk_prepare_comp_ports(comp_info, dir,
+					*nof_ports);
+			if (unlikely(ports == NULL))
+				return SPPWK_RET_NG;
+		}
 		ret_del = delete_port_info(port_info, *nof_ports, ports);
 		if (ret_del == 0)
 			(*nof_ports)--; /* If deleted, decrement number. */
@@ -270,6 +316,8 @@ exec_one_cmd(const struct sppwk_cmd_attrs *cmd)
 		if (ret == 0) {
 			RTE_LOG(INFO, MIR_CMD_RUNNER, "Exec flush.\n");
 			ret = flush_cmd();
+		} else {
+			cancel_cmd();
 		}
 		break;
 
@@ -283,6 +331,8 @@ exec_one_cmd(const struct sppwk_cmd_attrs *cmd)
 		if (ret == 0) {
 			RTE_LOG(INFO, MIR_CMD_RUNNER, "Exec flush.\n");
 			ret = flush_cmd();
+		} else {
+			cancel_cmd();
 		}
 		break;
 
@@ -305,7 +355,7 @@ iterate_lcore_info(struct sppwk_lcore_params *params)
 	struct sppwk_comp_info *comp_info_base = NULL;
 	struct sppwk_comp_info *comp_info = NULL;
 
-	RTE_LCORE_FOREACH_SLAVE(lcore_id) {
+	SPPWK_LCORE_FOREACH_WORKER(lcore_id) {
 		if (sppwk_get_lcore_status(lcore_id) == SPPWK_LCORE_UNUSED)
 			continue;
 
@@ -349,27 +399,27 @@ add_core(const char *name, char **output,
 {
 	int ret = SPPWK_RET_NG;
 	struct sppwk_lcore_params lcore_params;
-	char *tmp_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
-	if (unlikely(tmp_buff == NULL)) {
-		RTE_LOG(ERR, MIR_CMD_RUNNER,
-				/* TODO(yasufum) refactor no meaning err msg */
-				"allocate error. (name = %s)\n",
-				name);
+
+	ret = append_json_begin_array(output, name);
+	if (unlikely(ret != SPPWK_RET_OK))
 		return SPPWK_RET_NG;
-	}
 
-	lcore_params.output = tmp_buff;
+	lcore_params.output = *output;
 	lcore_params.lcore_proc = append_core_element_value;
 
+	/* Buffer might be reallocated while appending entries. */
 	ret = iterate_lcore_info(&lcore_params);
-	if (unlikely(ret != SPPWK_RET_OK)) {
-		spp_strbuf_free(lcore_params.output);
+	*output = lcore_params.output;
+	if (unlikely(ret != SPPWK_RET_OK) || unlikely(*output == NULL))
 		return SPPWK_RET_NG;
-	}
 
-	ret = append_json_array_brackets(output, name, lcore_params.output);
-	spp_strbuf_free(lcore_params.output);
-	return ret;
+	return append_json_end_array(output);
+}
+
+/* Nothing to release, mirror info is kept for reusing the ID. */
+void
+sync_comp_info(void)
+{
 }
 
 /* Activate temporarily stored component info while flushing. */
@@ -437,6 +487,9 @@ int get_status_ops(struct cmd_res_formatter_ops *ops_list)
 		{ "ring", add_interface },
 		{ "master-lcore", add_master_lcore},
 		{ "core", add_core},
+		{ "latency", add_latency},
+		{ "lcore_usage", add_lcore_usage},
+		{ "drops", add_drops},
 		{ "", NULL }
 	};
 	memcpy(ops_list, tmp_ops_list, sizeof(tmp_ops_list));
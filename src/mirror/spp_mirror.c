@@ -8,9 +8,14 @@
 
 #include <rte_common.h>
 #include <rte_cycles.h>
+#include <rte_malloc.h>
 
 #include "spp_mirror.h"
 #include "shared/secondary/common.h"
+#include "shared/latency.h"
+#include "shared/lcore_usage.h"
+#include "shared/trace.h"
+#include "shared/dp_event.h"
 #include "shared/secondary/add_port.h"
 #include "shared/secondary/return_codes.h"
 #include "shared/secondary/utils.h"
@@ -18,6 +23,7 @@
 #include "shared/secondary/spp_worker_th/cmd_runner.h"
 #include "shared/secondary/spp_worker_th/cmd_parser.h"
 #include "shared/secondary/spp_worker_th/cmd_utils.h"
+#include "shared/secondary/spp_worker_th/comp_service.h"
 #include "shared/secondary/spp_worker_th/port_capability.h"
 
 
@@ -31,13 +37,20 @@
 #define MIR_RX_DESC_DEFAULT 1024
 #define MIR_TX_DESC_DEFAULT 1024
 
+/* Max num of ports of mirror, a RX port and two TX ports. */
+#define MIR_MAX_PORTS 2
+
 /* getopt_long return value for long option */
 enum SPP_LONGOPT_RETVAL {
 	SPP_LONGOPT_RETVAL__ = 127,
 
 	/* Return value definition for getopt_long(). Only for long option. */
 	SPP_LONGOPT_RETVAL_CLIENT_ID,    /* For `--client-id` */
-	SPP_LONGOPT_RETVAL_VHOST_CLIENT  /* For `--vhost-client` */
+	SPP_LONGOPT_RETVAL_VHOST_CLIENT, /* For `--vhost-client` */
+	SPP_LONGOPT_RETVAL_LATENCY,      /* For `--latency` */
+	SPP_LONGOPT_RETVAL_TRACE,        /* For `--trace` */
+	SPP_LONGOPT_RETVAL_TRACE_DIR,    /* For `--trace-dir` */
+	SPP_LONGOPT_RETVAL_BALANCE_INTERVAL  /* For `--balance-interval` */
 };
 
 /* A set of port info of rx and tx */
@@ -52,7 +65,7 @@ struct mirror_path {
 	volatile enum sppwk_worker_type wk_type;
 	int nof_rx;  /* number of receive ports */
 	int nof_tx;  /* number of mirror ports */
-	struct mirror_rxtx ports[RTE_MAX_ETHPORTS];  /* used for mirror */
+	struct mirror_rxtx ports[MIR_MAX_PORTS];  /* used for mirror */
 };
 
 /* Information for mirror. */
@@ -69,23 +82,26 @@ static uint16_t nb_txd = MIR_TX_DESC_DEFAULT;
 /* Interface management information */
 static struct iface_info g_iface_info;
 
-/* Component management information */
-static struct sppwk_comp_info g_component_info[RTE_MAX_LCORE];
-
-/* Core management information */
-static struct core_mng_info g_core_info[RTE_MAX_LCORE];
-
-/* Array of update indicator for core management information */
-static int g_change_core[RTE_MAX_LCORE];
-
-/* Array of update indicator for component management information */
-static int g_change_component[RTE_MAX_LCORE];
+/**
+ * Component and core management information, and arrays of update
+ * indicator of them. They are allocated on the socket of master lcore.
+ */
+static struct sppwk_comp_info *g_component_info;
+static struct core_mng_info *g_core_info;
+static int *g_change_core;
+static int *g_change_component;
 
 /* Backup information for cancel command */
 static struct cancel_backup_info g_backup_info;
 
-/* mirror info */
-static struct mirror_info g_mirror_info[RTE_MAX_LCORE];
+/* Interval of balancing components on service lcores in sec, or 0. */
+static int g_balance_interval;
+
+/**
+ * mirror info, allocated on the socket of the lcore of a component when it
+ * is updated for the first time. It is kept for reusing the ID.
+ */
+static struct mirror_info *g_mirror_info[RTE_MAX_LCORE];
 
 /* mirror mbuf pool */
 static struct rte_mempool *g_mirror_pool;
@@ -97,11 +113,22 @@ usage(const char *progname)
 	RTE_LOG(INFO, MIRROR, "Usage: %s [EAL args] --"
 			" --client-id CLIENT_ID"
 			" -s SERVER_IP:SERVER_PORT"
-			" [--vhost-client]\n"
+			" [--vhost-client]"
+			" [--latency SAMPLE_RATE]"
+			" [--trace EVENTS [--trace-dir DIR]]"
+			" [--balance-interval SEC]\n"
 			" --client-id CLIENT_ID   : My client ID\n"
 			" -s SERVER_IP:SERVER_PORT  : "
 				"Access information to the server\n"
 			" --vhost-client            : Run vhost on client\n"
+			" --latency SAMPLE_RATE     :"
+			" Record latency of one of SAMPLE_RATE packets\n"
+			" --trace EVENTS            :"
+			" Trace EVENTS, such as `rx,tx,drop` or `all`\n"
+			" --trace-dir DIR           :"
+			" Save trace in DIR, `/tmp` as default\n"
+			" --balance-interval SEC    :"
+			" Balance components on service lcores every SEC\n"
 			, progname);
 }
 
@@ -112,6 +139,9 @@ parse_app_args(int argc, char *argv[])
 	int cli_id;  /* Client ID. */
 	char *ctl_ip;  /* IP address of spp_ctl. */
 	int ctl_port;  /* Port num to connect spp_ctl. */
+	unsigned int sample_rate;
+	uint32_t trace_events = 0;
+	const char *trace_dir = NULL;
 	int ret;
 	int cnt;
 	int option_index, opt;
@@ -128,6 +158,14 @@ parse_app_args(int argc, char *argv[])
 					SPP_LONGOPT_RETVAL_CLIENT_ID },
 			{ "vhost-client", no_argument, NULL,
 					SPP_LONGOPT_RETVAL_VHOST_CLIENT },
+			{ "latency", required_argument, NULL,
+					SPP_LONGOPT_RETVAL_LATENCY },
+			{ "trace", required_argument, NULL,
+					SPP_LONGOPT_RETVAL_TRACE },
+			{ "trace-dir", required_argument, NULL,
+					SPP_LONGOPT_RETVAL_TRACE_DIR },
+			{ "balance-interval", required_argument, NULL,
+					SPP_LONGOPT_RETVAL_BALANCE_INTERVAL },
 			{ 0 },
 	};
 
@@ -159,6 +197,31 @@ parse_app_args(int argc, char *argv[])
 		case SPP_LONGOPT_RETVAL_VHOST_CLIENT:
 			set_vhost_cli_mode(1);
 			break;
+		case SPP_LONGOPT_RETVAL_LATENCY:
+			if (latency_parse_sample_rate(optarg,
+					&sample_rate) != 0) {
+				usage(progname);
+				return SPPWK_RET_NG;
+			}
+			if (latency_init(sample_rate) != 0)
+				return SPPWK_RET_NG;
+			break;
+		case SPP_LONGOPT_RETVAL_TRACE:
+			if (trace_parse_events(optarg, &trace_events) != 0) {
+				usage(progname);
+				return SPPWK_RET_NG;
+			}
+			break;
+		case SPP_LONGOPT_RETVAL_TRACE_DIR:
+			trace_dir = optarg;
+			break;
+		case SPP_LONGOPT_RETVAL_BALANCE_INTERVAL:
+			if (spp_atoi(optarg, &g_balance_interval) != 0 ||
+					g_balance_interval < 0) {
+				usage(progname);
+				return SPPWK_RET_NG;
+			}
+			break;
 		case 's':
 			ret = parse_server(&ctl_ip, &ctl_port, optarg);
 			if (ret != SPPWK_RET_OK) {
@@ -180,6 +243,10 @@ parse_app_args(int argc, char *argv[])
 		usage(progname);
 		return SPPWK_RET_NG;
 	}
+
+	if (trace_events != 0 &&
+			trace_init("spp_mirror", trace_events, trace_dir) != 0)
+		return SPPWK_RET_NG;
 	RTE_LOG(INFO, MIRROR,
 			"Parsed app args (client_id=%d, server=%s:%d, "
 			"vhost_client=%d)\n",
@@ -229,11 +296,36 @@ static void
 mirror_proc_init(void)
 {
 	int cnt = 0;
-	memset(&g_mirror_info, 0x00, sizeof(g_mirror_info));
 	for (cnt = 0; cnt < RTE_MAX_LCORE; cnt++) {
-		g_mirror_info[cnt].ref_index = 0;
-		g_mirror_info[cnt].upd_index = 1;
+		if (g_mirror_info[cnt] == NULL)
+			continue;
+		memset(g_mirror_info[cnt], 0x00, sizeof(struct mirror_info));
+		g_mirror_info[cnt]->ref_index = 0;
+		g_mirror_info[cnt]->upd_index = 1;
+	}
+}
+
+/* Get mirror info of component, or allocate it if it is not yet. */
+static struct mirror_info *
+get_mirror_info(const struct sppwk_comp_info *wk_comp)
+{
+	struct mirror_info *info = g_mirror_info[wk_comp->comp_id];
+
+	if (likely(info != NULL))
+		return info;
+
+	info = rte_zmalloc_socket("mirror_info", sizeof(struct mirror_info),
+			RTE_CACHE_LINE_SIZE,
+			rte_lcore_to_socket_id(wk_comp->lcore_id));
+	if (unlikely(info == NULL)) {
+		RTE_LOG(ERR, MIRROR, "Failed to alloc mirror info (id=%d)\n",
+				wk_comp->comp_id);
+		return NULL;
 	}
+	info->ref_index = 0;
+	info->upd_index = 1;
+	g_mirror_info[wk_comp->comp_id] = info;
+	return info;
 }
 
 /* Update mirror info */
@@ -243,8 +335,12 @@ update_mirror(struct sppwk_comp_info *wk_comp)
 	int cnt = 0;
 	int nof_rx = wk_comp->nof_rx;
 	int nof_tx = wk_comp->nof_tx;
-	struct mirror_info *info = &g_mirror_info[wk_comp->comp_id];
-	struct mirror_path *path = &info->path[info->upd_index];
+	struct mirror_info *info = get_mirror_info(wk_comp);
+	struct mirror_path *path;
+
+	if (unlikely(info == NULL))
+		return SPPWK_RET_NG;
+	path = &info->path[info->upd_index];
 
 	/* Check mirror has just one RX and two TX port. */
 	if (unlikely(nof_rx > 1)) {
@@ -253,7 +349,7 @@ update_mirror(struct sppwk_comp_info *wk_comp)
 			wk_comp->comp_id, wk_comp->wk_type, nof_rx);
 		return SPPWK_RET_NG;
 	}
-	if (unlikely(nof_tx > 2)) {
+	if (unlikely(nof_tx > MIR_MAX_PORTS)) {
 		RTE_LOG(ERR, MIRROR,
 			"Invalid num of TX (id=%d, type=%d, nof_tx=%d)\n",
 			wk_comp->comp_id, wk_comp->wk_type, nof_tx);
@@ -279,9 +375,13 @@ update_mirror(struct sppwk_comp_info *wk_comp)
 		memcpy(&path->ports[cnt].tx, wk_comp->tx_ports[cnt],
 				sizeof(struct sppwk_port_info));
 
+	/**
+	 * Publish update side. Retired side is reused after a grace period
+	 * waited in flush_cmd().
+	 */
+	rte_smp_wmb();
 	info->upd_index = info->ref_index;
-	while (likely(info->ref_index == info->upd_index))
-		rte_delay_us_block(SPPWK_UPDATE_INTERVAL);
+	info->ref_index = (info->upd_index + 1) % TWO_SIDES;
 
 	RTE_LOG(INFO, MIRROR,
 			"Done update mirror (id=%d, name=%s, type=%d)\n",
@@ -290,18 +390,6 @@ update_mirror(struct sppwk_comp_info *wk_comp)
 	return SPPWK_RET_OK;
 }
 
-/* Change index of mirror info */
-static inline void
-change_mirror_index(int id)
-{
-	struct mirror_info *info = &g_mirror_info[id];
-	if (info->ref_index == info->upd_index) {
-	/* Change reference index of port ability. */
-		sppwk_swap_two_sides(SPPWK_SWAP_REF, 0, 0);
-		info->ref_index = (info->upd_index+1) % TWO_SIDES;
-	}
-}
-
 /**
  * Mirroring packets as mirror_proc
  *
@@ -316,15 +404,18 @@ mirror_proc(int id)
 	int nb_tx = 0;
 	int nb_tx1 = 0;
 	int nb_tx2 = 0;
-	struct mirror_info *info = &g_mirror_info[id];
+	struct mirror_info *info = g_mirror_info[id];
 	struct mirror_path *path = NULL;
 	struct sppwk_port_info *rx = NULL;
 	struct sppwk_port_info *tx = NULL;
 	struct rte_mbuf *bufs[MAX_PKT_BURST];
 	struct rte_mbuf *copybufs[MAX_PKT_BURST];
 	struct rte_mbuf *org_mbuf = NULL;
+	uint64_t stamps[MAX_PKT_BURST];
 
-	change_mirror_index(id);
+	/* Not updated if it is failed to alloc info. */
+	if (unlikely(info == NULL))
+		return SPPWK_RET_OK;
 	path = &info->path[info->ref_index];
 
 	/* Practice condition check */
@@ -338,6 +429,11 @@ mirror_proc(int id)
 
 	if (unlikely(nb_rx == 0))
 		return SPPWK_RET_OK;
+	trace_burst_rx(rx->ethdev_port_id, rx->queue_no, nb_rx);
+	lcore_usage_add_rx(nb_rx);
+	latency_stamp_burst(bufs, nb_rx);
+	/* Copies have the same stamp as original ones. */
+	latency_load_stamps(bufs, nb_rx, stamps);
 
 	/* mirror */
 	tx = &path->ports[1].tx;
@@ -360,8 +456,6 @@ mirror_proc(int id)
 				if (unlikely(copy_mbuf == NULL)) {
 					rte_pktmbuf_free(mirror_mbuf);
 					mirror_mbuf = NULL;
-					RTE_LOG(INFO, MIRROR,
-						"copy mbuf alloc NG!\n");
 					break;
 				}
 
@@ -388,25 +482,47 @@ mirror_proc(int id)
 			copybufs[cnt] = mirror_mbuf;
 
 #endif /* SPP_MIRROR_SHALLOWCOPY */
+			if (copybufs[cnt] != NULL)
+				latency_copy_stamp(copybufs[cnt], bufs[cnt]);
+			else {
+				trace_drop(tx->ethdev_port_id,
+						TRACE_DROP_NO_MBUF, 1);
+				dp_event_add(DP_EVENT_NO_MBUF, 1);
+			}
 		}
 
-		if (cnt != 0)
+		if (cnt != 0) {
 			nb_tx2 = rte_eth_tx_burst(tx->ethdev_port_id,
 					tx->queue_no, copybufs, cnt);
+			latency_record_stamps(tx->ethdev_port_id, stamps,
+					nb_tx2);
+			trace_burst_tx(tx->ethdev_port_id, tx->queue_no,
+					cnt, nb_tx2);
+			if (unlikely(nb_tx2 < cnt)) {
+				trace_drop(tx->ethdev_port_id,
+						TRACE_DROP_TX_FULL,
+						cnt - nb_tx2);
+				dp_event_add(DP_EVENT_TX_FULL, cnt - nb_tx2);
+			}
+		}
 	}
 
 	/* orginal */
 	tx = &path->ports[0].tx;
-	if (tx->ethdev_port_id >= 0)
+	if (tx->ethdev_port_id >= 0) {
 		nb_tx1 = rte_eth_tx_burst(tx->ethdev_port_id, tx->queue_no,
 				bufs, nb_rx);
+		latency_record_stamps(tx->ethdev_port_id, stamps, nb_tx1);
+		trace_burst_tx(tx->ethdev_port_id, tx->queue_no, nb_rx,
+				nb_tx1);
+		if (unlikely(nb_tx1 < nb_rx)) {
+			trace_drop(tx->ethdev_port_id, TRACE_DROP_TX_FULL,
+					nb_rx - nb_tx1);
+			dp_event_add(DP_EVENT_TX_FULL, nb_rx - nb_tx1);
+		}
+	}
 	nb_tx = nb_tx1;
 
-	if (nb_tx1 != nb_tx2)
-		RTE_LOG(INFO, MIRROR,
-			"mirror paket drop nb_rx=%d nb_tx1=%d nb_tx2=%d\n",
-							nb_rx, nb_tx1, nb_tx2);
-
 	/* Discard remained packets to release mbuf */
 	if (nb_tx1 < nb_tx2)
 		nb_tx = nb_tx2;
@@ -428,24 +544,36 @@ slave_main(void *arg __attribute__ ((unused)))
 	int ret = SPPWK_RET_OK;
 	int cnt = 0;
 	unsigned int lcore_id = rte_lcore_id();
+	int is_online = 0;
 	enum sppwk_lcore_status status = SPPWK_LCORE_STOPPED;
-	struct core_mng_info *info = &g_core_info[lcore_id];
-	struct core_info *core = get_core_info(lcore_id);
+	struct core_info *core = NULL;
+	struct lcore_usage_poll lcore_poll, comp_poll;
 
 	RTE_LOG(INFO, MIRROR, "Slave started on lcore %d.\n", lcore_id);
+	sppwk_qsbr_register(lcore_id);
 	set_core_status(lcore_id, SPPWK_LCORE_IDLING);
 
 	while ((status = sppwk_get_lcore_status(lcore_id)) !=
 			SPPWK_LCORE_REQ_STOP) {
-		if (status != SPPWK_LCORE_RUNNING)
+		if (status != SPPWK_LCORE_RUNNING) {
+			/* Master does not wait for idling lcore to flush. */
+			if (is_online) {
+				sppwk_qsbr_offline(lcore_id);
+				is_online = 0;
+			}
 			continue;
-
-		if (sppwk_is_lcore_updated(lcore_id) == 1) {
-			/* Setting with the flush command trigger. */
-			info->ref_index = (info->upd_index+1) % TWO_SIDES;
-			core = get_core_info(lcore_id);
+		}
+		if (!is_online) {
+			sppwk_qsbr_online(lcore_id);
+			is_online = 1;
+			/* Time of idling lcore is not included in usage. */
+			lcore_usage_poll_begin(&lcore_poll);
 		}
 
+		/* Reference side is published by master while flushing. */
+		core = get_core_info(lcore_id);
+		comp_poll = lcore_poll;
+
 		for (cnt = 0; cnt < core->num; cnt++) {
 			/*
 			 * mirror returns at once.
@@ -454,6 +582,8 @@ slave_main(void *arg __attribute__ ((unused)))
 			ret = mirror_proc(core->id[cnt]);
 			if (unlikely(ret != 0))
 				break;
+			lcore_usage_poll_end(&comp_usages[core->id[cnt]],
+					&comp_poll);
 		}
 		if (unlikely(ret != 0)) {
 			RTE_LOG(ERR, MIRROR,
@@ -461,8 +591,14 @@ slave_main(void *arg __attribute__ ((unused)))
 					lcore_id, core->id[cnt]);
 			break;
 		}
+
+		/* No data of components is referred until next iteration. */
+		sppwk_qsbr_quiescent(lcore_id);
+		lcore_usage_poll_end(&lcore_usages[lcore_id], &lcore_poll);
 	}
 
+	/* Stopped lcore is no longer waited by master. */
+	sppwk_qsbr_unregister(lcore_id);
 	set_core_status(lcore_id, SPPWK_LCORE_STOPPED);
 	RTE_LOG(INFO, MIRROR, "Terminated slave on lcore %d.\n", lcore_id);
 	return ret;
@@ -520,6 +656,11 @@ main(int argc, char *argv[])
 		if (unlikely(ret_parse != 0))
 			break;
 
+		if (unlikely(sppwk_alloc_mng_tables(&g_component_info,
+				&g_core_info, &g_change_core,
+				&g_change_component) != SPPWK_RET_OK))
+			break;
+
 		if (sppwk_set_mng_data(&g_iface_info, g_component_info,
 					g_core_info, g_change_core,
 					g_change_component,
@@ -551,6 +692,10 @@ main(int argc, char *argv[])
 		if (unlikely(ret_cmd_init != SPPWK_RET_OK))
 			break;
 
+		/* Components on service lcores are run as services. */
+		if (unlikely(sppwk_init_comp_services(mirror_proc,
+				g_balance_interval) != SPPWK_RET_OK))
+			break;
 
 		/* Start worker threads of classifier and forwarder */
 		lcore_id = 0;
@@ -587,6 +732,11 @@ main(int argc, char *argv[])
 			ret_do = sppwk_run_cmd();
 			if (unlikely(ret_do != SPPWK_RET_OK))
 				break;
+
+			if (unlikely(sppwk_balance_comp_services() !=
+					SPPWK_RET_OK))
+				RTE_LOG(ERR, MIRROR,
+					"Failed to balance components.\n");
 			/*
 			 * To avoid making CPU busy, this thread waits
 			 * here for 100 ms.
@@ -605,10 +755,18 @@ main(int argc, char *argv[])
 	}
 
 	/* Finalize to exit */
-	g_core_info[master_lcore].status = SPPWK_LCORE_STOPPED;
-	int ret_core_end = check_core_status_wait(SPPWK_LCORE_STOPPED);
-	if (unlikely(ret_core_end != 0))
-		RTE_LOG(ERR, MIRROR, "Failed to terminate master thread.\n");
+	if (likely(g_core_info != NULL)) {
+		g_core_info[master_lcore].status = SPPWK_LCORE_STOPPED;
+		int ret_core_end = check_core_status_wait(
+				SPPWK_LCORE_STOPPED);
+		if (unlikely(ret_core_end != 0))
+			RTE_LOG(ERR, MIRROR,
+				"Failed to terminate master thread.\n");
+	}
+	sppwk_fini_comp_services();
+
+	/* Workers are stopped and no more events are recorded. */
+	trace_save();
 
 	 /* Remove vhost sock file if not running in vhost-client mode. */
 	del_vhost_sockfile(g_iface_info.vhost);
@@ -626,11 +784,18 @@ get_mirror_status(unsigned int lcore_id, int id,
 	int ret = SPPWK_RET_NG;
 	int cnt;
 	const char *component_type = NULL;
-	struct mirror_info *info = &g_mirror_info[id];
-	struct mirror_path *path = &info->path[info->ref_index];
+	struct mirror_info *info = g_mirror_info[id];
+	struct mirror_path *path;
 	struct sppwk_port_idx rx_ports[RTE_MAX_ETHPORTS];
 	struct sppwk_port_idx tx_ports[RTE_MAX_ETHPORTS];
 
+	if (unlikely(info == NULL)) {
+		RTE_LOG(ERR, MIRROR,
+			"Mirror is not updated. (id=%d, lcore=%d)\n",
+			id, lcore_id);
+		return SPPWK_RET_NG;
+	}
+	path = &info->path[info->ref_index];
 	if (unlikely(path->wk_type == SPPWK_TYPE_NONE)) {
 		RTE_LOG(ERR, MIRROR,
 			"Mirror is not used. (id=%d, lcore=%d, type=%d)\n",
@@ -19,42 +19,33 @@
 static int
 do_del(char *p_type, int p_id, uint16_t queue_id)
 {
+	enum port_type type = get_port_type(p_type);
 	uint16_t port_id = PORT_RESET;
 
-	if (!strcmp(p_type, "vhost")) {
-		port_id = find_port_id(p_id, VHOST);
-		if (port_id == PORT_RESET)
-			return -1;
-		dev_detach_by_port_id(port_id);
+	switch (type) {
+	case VHOST:
+	case RING:
+	case PCAP:
+	case MEMIF:
+	case NULLPMD:
+		port_id = find_port_id(p_id, type);
+		break;
+	default:
+		break;
+	}
+	if (port_id == PORT_RESET)
+		return -1;
 
-	} else if (!strcmp(p_type, "ring")) {
-		port_id = find_port_id(p_id, RING);
-		if (port_id == PORT_RESET)
-			return -1;
+	/* Forwarder should leave the port before it is destroyed. */
+	forward_array_remove(port_id, queue_id);
+	publish_fwd_array();
+
+	if (type == RING) {
 		rte_eth_dev_stop(port_id);
 		rte_eth_dev_close(port_id);
-
-	} else if (!strcmp(p_type, "pcap")) {
-		port_id = find_port_id(p_id, PCAP);
-		if (port_id == PORT_RESET)
-			return -1;
+	} else
 		dev_detach_by_port_id(port_id);
 
-	} else if (!strcmp(p_type, "memif")) {
-		port_id = find_port_id(p_id, MEMIF);
-		if (port_id == PORT_RESET)
-			return -1;
-		dev_detach_by_port_id(port_id);
-
-	} else if (!strcmp(p_type, "nullpmd")) {
-		port_id = find_port_id(p_id, NULLPMD);
-		if (port_id == PORT_RESET)
-			return -1;
-		dev_detach_by_port_id(port_id);
-
-	}
-
-	forward_array_remove(port_id, queue_id);
 	port_map_init_one(port_id);
 
 	return 0;
@@ -62,10 +53,11 @@ do_del(char *p_type, int p_id, uint16_t queue_id)
 
 /**
  * Add a port to this process. Port is described with resource UID which is a
- * combination of port type and ID like as 'ring:0'.
+ * combination of port type and ID like as 'ring:0'. For ring, sync mode such
+ * as 'mpsc' can be given optionally as `ring_mode`, or NULL to keep it.
  */
 static int
-do_add(char *p_type, int p_id, uint16_t queue_id)
+do_add(char *p_type, int p_id, uint16_t queue_id, const char *ring_mode)
 {
 	enum port_type type = UNDEF;
 	uint16_t port_id = PORT_RESET;
@@ -77,7 +69,10 @@ do_add(char *p_type, int p_id, uint16_t queue_id)
 
 	} else if (!strcmp(p_type, "ring")) {
 		type = RING;
-		res = add_ring_pmd(p_id);
+		if (ring_mode != NULL)
+			res = add_ring_pmd_with_mode(p_id, ring_mode);
+		else
+			res = add_ring_pmd(p_id);
 
 	} else if (!strcmp(p_type, "pcap")) {
 		type = PCAP;
@@ -98,8 +93,11 @@ do_add(char *p_type, int p_id, uint16_t queue_id)
 	port_id = (uint16_t) res;
 	port_map[port_id].id = p_id;
 	port_map[port_id].port_type = type;
-	if (type == RING)
+	if (type == RING) {
 		port_map[port_id].stats = &ports->client_stats[p_id];
+		port_map[port_id].ring = rte_ring_lookup(
+				get_rx_queue_name(p_id));
+	}
 	/* NOTE: port_map[].stats points to &port_map[].default_stats
 	 * other than RING. There is no support to show/clear this stats
 	 * at the moment.
@@ -151,6 +149,37 @@ do_connection(int *connected, int *sock)
 	return ret;
 }
 
+/**
+ * Execute `patch` commands given as a batch such as
+ * `batch patch phy:0 ring:0;patch ring:0 phy:1` and publish them at once.
+ * Response is written to given str.
+ */
+static int
+do_batch(char *str)
+{
+	char err_msg[128] = { 0 };
+	int nof_cmds;
+
+	nof_cmds = exec_patch_batch(str + strlen(BATCH_CMD_PREFIX),
+			err_msg, sizeof(err_msg));
+
+	memset(str, '\0', MSG_SIZE);
+	if (nof_cmds < 0) {
+		RTE_LOG(ERR, SPP_NFV, "Failed to exec batch, %s.\n", err_msg);
+		sprintf(str, "{%s:%s,%s:%s,%s:\"%s\"}",
+				"\"result\"", "\"failed\"",
+				"\"command\"", "\"batch\"",
+				"\"error\"", err_msg);
+		return -1;
+	}
+
+	sprintf(str, "{%s:%s,%s:%s,%s:%d}",
+			"\"result\"", "\"succeeded\"",
+			"\"command\"", "\"batch\"",
+			"\"nof_cmds\"", nof_cmds);
+	return 0;
+}
+
 /* Return -1 if exit command is called to terminate the process */
 static int
 parse_command(char *str)
@@ -170,6 +199,13 @@ parse_command(char *str)
 	if (!str)
 		return 0;
 
+	/* Commands in batch are separated with `;` and not tokenized here. */
+	if (!strncmp(str, BATCH_CMD_PREFIX, strlen(BATCH_CMD_PREFIX))) {
+		RTE_LOG(DEBUG, SPP_NFV, "batch\n");
+		do_batch(str);
+		return 0;
+	}
+
 	/* tokenize user command from controller */
 	token_list[max_token] = strtok(str, " ");
 	while (token_list[max_token] != NULL) {
@@ -250,11 +286,12 @@ parse_command(char *str)
 		if (ret < 0)
 			return ret;
 
-		if (do_add(p_type, p_id, queue_id) < 0) {
+		if (do_add(p_type, p_id, queue_id, token_list[2]) < 0) {
 			RTE_LOG(ERR, SPP_NFV, "Failed to do_add()\n");
 			sprintf(result, "%s", "\"failed\"");
 		} else
 			sprintf(result, "%s", "\"succeeded\"");
+		publish_fwd_array();
 
 		sprintf(port_set, "\"%s:%d\"", p_type, p_id);
 		memset(str, '\0', MSG_SIZE);
@@ -272,6 +309,7 @@ parse_command(char *str)
 		if (strncmp(token_list[1], "reset", 5) == 0) {
 			/* reset forward array*/
 			forward_array_reset();
+			publish_fwd_array();
 		} else {
 			uint16_t in_port;
 			uint16_t out_port;
@@ -343,6 +381,7 @@ parse_command(char *str)
 
 			if (add_patch(in_port, in_queue_id, out_port,
 				out_queue_id) == 0) {
+				publish_fwd_array();
 				RTE_LOG(INFO, SPP_NFV,
 					"Patched '%s' and '%s'\n",
 					in_res_uid, out_res_uid);
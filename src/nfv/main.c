@@ -17,6 +17,9 @@
 #include "shared/secondary/common.h"
 #include "shared/common.h"
 #include "shared/basic_forwarder.h"
+#include "shared/lcore_usage.h"
+#include "shared/latency.h"
+#include "shared/trace.h"
 
 #include "params.h"
 #include "nfv_status.h"
@@ -38,10 +41,16 @@ uint8_t lcore_id_used[RTE_MAX_LCORE] = {};
 enum {
 	CMD_LINE_OPT_MIN_NUM = 256,
 	CMD_OPT_ENABLE_VHOST_CLI,
+	CMD_OPT_LATENCY,
+	CMD_OPT_TRACE,
+	CMD_OPT_TRACE_DIR,
 };
 
 static struct option lgopts[] = {
 	{"vhost-client", no_argument, NULL, CMD_OPT_ENABLE_VHOST_CLI},
+	{"latency", required_argument, NULL, CMD_OPT_LATENCY},
+	{"trace", required_argument, NULL, CMD_OPT_TRACE},
+	{"trace-dir", required_argument, NULL, CMD_OPT_TRACE_DIR},
 	{0}
 };
 
@@ -52,9 +61,10 @@ static void
 usage(const char *progname)
 {
 	RTE_LOG(INFO, SPP_NFV,
-		"Usage: %s [EAL args] -- %s %s %s\n\n",
+		"Usage: %s [EAL args] -- %s %s %s %s %s %s\n\n",
 		progname, "-n <client_id>", "-s <ipaddr:port>",
-		"--vhost-client");
+		"--vhost-client", "--latency <sample_rate>",
+		"--trace <events>", "--trace-dir <dir>");
 }
 
 /*
@@ -69,6 +79,9 @@ parse_app_args(int argc, char *argv[])
 	const char *progname = argv[0];
 	char *ctl_ip;  /* IP address of spp_ctl. */
 	int ctl_port;  /* Port num to connect spp_ctl. */
+	unsigned int sample_rate;
+	uint32_t trace_events = 0;
+	const char *trace_dir = NULL;
 	int ret;
 
 	/* vhost_cli is disabled as default. */
@@ -80,6 +93,24 @@ parse_app_args(int argc, char *argv[])
 		case CMD_OPT_ENABLE_VHOST_CLI:
 			set_vhost_cli_mode(1);
 			break;
+		case CMD_OPT_LATENCY:
+			if (latency_parse_sample_rate(optarg,
+					&sample_rate) != 0) {
+				usage(progname);
+				return -1;
+			}
+			if (latency_init(sample_rate) != 0)
+				return -1;
+			break;
+		case CMD_OPT_TRACE:
+			if (trace_parse_events(optarg, &trace_events) != 0) {
+				usage(progname);
+				return -1;
+			}
+			break;
+		case CMD_OPT_TRACE_DIR:
+			trace_dir = optarg;
+			break;
 		case 'n':
 			if (parse_client_id(&cli_id, optarg) != 0) {
 				usage(progname);
@@ -102,6 +133,10 @@ parse_app_args(int argc, char *argv[])
 		}
 	}
 
+	if (trace_events != 0 &&
+			trace_init("spp_nfv", trace_events, trace_dir) != 0)
+		return -1;
+
 	return 0;
 }
 
@@ -110,16 +145,21 @@ static void
 nfv_loop(void)
 {
 	unsigned int lcore_id = rte_lcore_id();
+	struct lcore_usage_poll poll;
 
 	RTE_LOG(INFO, SPP_NFV, "entering main loop on lcore %u\n", lcore_id);
 
+	lcore_usage_poll_begin(&poll);
 	while (1) {
 		if (unlikely(cmd == STOP)) {
 			sleep(1);
+			/* Time of sleeping is not included in usage. */
+			lcore_usage_poll_begin(&poll);
 			/*RTE_LOG(INFO, SPP_NFV, "Idling\n");*/
 			continue;
 		} else if (cmd == FORWARD) {
 			forward();
+			lcore_usage_poll_end(&lcore_usages[lcore_id], &poll);
 		}
 	}
 }
@@ -241,6 +281,7 @@ main(int argc, char *argv[])
 				port_type, port_id);
 
 	}
+	publish_fwd_array();
 
 	/* Inspect lcores in use. */
 	RTE_LCORE_FOREACH(lcore_id) {
@@ -290,6 +331,7 @@ main(int argc, char *argv[])
 	/* exit */
 	close(sock);
 	sock = SOCK_RESET;
+	trace_save();
 	RTE_LOG(INFO, SPP_NFV, "spp_nfv exit.\n");
 	return 0;
 }
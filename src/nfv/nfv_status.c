@@ -5,11 +5,17 @@
 #define RTE_LOGTYPE_SHARED RTE_LOGTYPE_USER1
 
 #include <arpa/inet.h>
+#include <inttypes.h>
 #include "shared/common.h"
 #include "shared/basic_forwarder.h"
 #include "shared/port_manager.h"
+#include "shared/latency.h"
+#include "shared/lcore_usage.h"
 #include "nfv_status.h"
 
+/* Max length of latency of a port including all of buckets. */
+#define LATENCY_JSON_LEN 16384
+
 /*
  * Get status of spp_nfv as JSON format. It consists of running
  * status and patch info of ports.
@@ -24,6 +30,12 @@
  *     "patches": [
  *       {"src":"phy:0","dst": "ring:0"},
  *       {"src":"ring:0","dst": "vhost:0"}
+ *     ],
+ *     "latency": [
+ *       {"port":"ring:0","count":1000,...,"hist":[...]}
+ *     ],
+ *     "lcore_usage": [
+ *       {"lcore":2,"busy_cycles":1200,"idle_cycles":4800,"usage":20}
  *     ]
  *   }
  */
@@ -44,6 +56,18 @@ get_sec_stats_json(char *str, int cli_id,
 	sprintf(str + strlen(str), ",");
 
 	append_patch_info_json(str);
+	sprintf(str + strlen(str), ",");
+
+	/*
+	 * Reserve space of lcore usage, and comma and closing bracket around
+	 * it, before latency which can fill the rest of the message.
+	 */
+	append_latency_info_json(str,
+			MSG_SIZE - lcore_usage_json_len(lcore_id_used) - 2);
+	sprintf(str + strlen(str), ",");
+
+	if (append_lcore_usage_json(str, MSG_SIZE - 1, lcore_id_used) < 0)
+		RTE_LOG(WARNING, SHARED, "No space for usage of lcores.\n");
 	sprintf(str + strlen(str), "}");
 
 	/* Make sure to be terminated with null character. */
@@ -271,3 +295,117 @@ append_patch_info_json(char *str)
 
 	return 0;
 }
+
+/* Format latency of packets sent to a port, and return its length. */
+static int
+format_latency_json(char *str, size_t len, const char *port_str,
+		const struct latency_hist *hist)
+{
+	unsigned int idx;
+	int has_bucket = 0;
+	int ret;
+	size_t pos;
+
+	ret = snprintf(str, len, "{\"port\":%s,\"count\":%" PRIu64 ","
+			"\"avg_ns\":%" PRIu64 ",\"p50_ns\":%" PRIu64 ","
+			"\"p99_ns\":%" PRIu64 ",\"p999_ns\":%" PRIu64 ","
+			"\"max_ns\":%" PRIu64 ",\"hist\":[",
+			port_str, hist->count,
+			latency_cycles_to_ns(hist->sum / hist->count),
+			latency_percentile_ns(hist, 500),
+			latency_percentile_ns(hist, 990),
+			latency_percentile_ns(hist, 999),
+			latency_cycles_to_ns(hist->max));
+	if (ret < 0 || (size_t)ret >= len)
+		return -1;
+	pos = ret;
+
+	for (idx = 0; idx < LATENCY_NOF_BUCKETS; idx++) {
+		if (hist->buckets[idx] == 0)
+			continue;
+
+		ret = snprintf(str + pos, len - pos,
+				"%s{\"ns\":%" PRIu64 ",\"count\":%" PRIu64 "}",
+				has_bucket ? "," : "",
+				latency_cycles_to_ns(
+					latency_bucket_cycles(idx)),
+				hist->buckets[idx]);
+		if (ret < 0 || (size_t)ret >= len - pos)
+			return -1;
+		pos += ret;
+		has_bucket = 1;
+	}
+
+	ret = snprintf(str + pos, len - pos, "]}");
+	if (ret < 0 || (size_t)ret >= len - pos)
+		return -1;
+	return pos + ret;
+}
+
+/*
+ * Append latency of packets sent to each of ports to sec status. Ports
+ * without packets recorded are not included, and ports are also skipped if
+ * the rest of `len` bytes of the message is not enough. Here is an example.
+ *
+ *     "latency": [
+ *       {"port":"ring:0","count":1000,"avg_ns":820,"p50_ns":768,
+ *        "p99_ns":1536,"p999_ns":2048,"max_ns":2210,
+ *        "hist":[{"ns":704,"count":480},{"ns":768,"count":502},...]}
+ *     ]
+ */
+int
+append_latency_info_json(char *str, size_t len)
+{
+	static char lat_str[LATENCY_JSON_LEN];
+	static struct latency_hist hist;
+	char port_str[32];
+	unsigned int has_port = 0;
+	unsigned int i;
+	size_t pos;
+	int ret;
+
+	/* Keep space for closing bracket and null character. */
+	pos = strlen(str);
+	if (pos + sizeof("\"latency\":[]") > len)
+		return -1;
+	len -= 1;
+
+	pos += sprintf(str + pos, "\"latency\":[");
+	for (i = 0; i < RTE_MAX_ETHPORTS; i++) {
+		if (port_map[i].port_type == UNDEF)
+			continue;
+		latency_sum_hist(i, &hist);
+		if (hist.count == 0)
+			continue;
+
+		/* Name of port is not given for some types, such as pipe. */
+		port_str[0] = '\0';
+		append_port_string(port_str, port_map[i].port_type,
+				port_map[i].id, 0, 1);
+		if (port_str[0] == '\0')
+			continue;
+
+		ret = format_latency_json(lat_str, sizeof(lat_str), port_str,
+				&hist);
+		if (ret < 0) {
+			RTE_LOG(WARNING, SHARED,
+				"No space for latency of %s.\n", port_str);
+			continue;
+		}
+
+		ret = snprintf(str + pos, len - pos, "%s%s",
+				has_port ? "," : "", lat_str);
+		if (ret < 0 || (size_t)ret >= len - pos) {
+			/* Drop the entry truncated. */
+			str[pos] = '\0';
+			RTE_LOG(WARNING, SHARED,
+				"No space for latency of %s.\n", port_str);
+			continue;
+		}
+		pos += ret;
+		has_port = 1;
+	}
+	strcpy(str + pos, "]");
+
+	return 0;
+}
@@ -19,4 +19,10 @@ int append_port_info_json(char *str);
 /* Append patch info to sec status, called from get_sec_stats_json(). */
 int append_patch_info_json(char *str);
 
+/**
+ * Append latency of ports to sec status within `len` bytes of buffer,
+ * called from get_sec_stats_json().
+ */
+int append_latency_info_json(char *str, size_t len);
+
 #endif
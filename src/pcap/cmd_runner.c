@@ -4,12 +4,15 @@
 
 #include <unistd.h>
 #include <string.h>
+#include <inttypes.h>
 
 #include <rte_log.h>
 
 #include "cmd_parser.h"
 #include "cmd_runner.h"
 #include "spp_pcap.h"
+#include "shared/lcore_usage.h"
+#include "shared/dp_event.h"
 #include "shared/secondary/return_codes.h"
 #include "shared/secondary/utils.h"
 #include "shared/secondary/string_buffer.h"
@@ -104,19 +107,35 @@ append_json_comma(char **output)
 static int
 append_json_uint_value(const char *name, char **output, unsigned int value)
 {
-	int len = strlen(*output);
-	/* extend the buffer */
-	*output = spp_strbuf_append(*output, "",
-			strlen(name) + CMD_TAG_APPEND_SIZE*2);
+	*output = spp_strbuf_appendf(*output, JSON_APPEND_VALUE("%u"),
+			JSON_APPEND_COMMA(spp_strbuf_len(*output)),
+			name, value);
 	if (unlikely(*output == NULL)) {
 		RTE_LOG(ERR, PCAP_RUNNER,
 				"JSON's numeric format failed to add. "
 				"(name = %s, uint = %u)\n", name, value);
 		return SPPWK_RET_NG;
 	}
+	return SPPWK_RET_OK;
+}
 
-	sprintf(&(*output)[len], JSON_APPEND_VALUE("%u"),
-			JSON_APPEND_COMMA(len), name, value);
+/**
+ * Append JSON formatted tag and its value of uint64 to given `output` val,
+ * such as `"busy_cycles": 1200`.
+ */
+static int
+append_json_uint64_value(const char *name, char **output, uint64_t value)
+{
+	*output = spp_strbuf_appendf(*output, JSON_APPEND_VALUE("%" PRIu64),
+			JSON_APPEND_COMMA(spp_strbuf_len(*output)),
+			name, value);
+	if (unlikely(*output == NULL)) {
+		RTE_LOG(ERR, PCAP_RUNNER,
+				"JSON's numeric format failed to add. "
+				"(name = %s, uint64 = %" PRIu64 ")\n",
+				name, value);
+		return SPPWK_RET_NG;
+	}
 	return SPPWK_RET_OK;
 }
 
@@ -128,19 +147,15 @@ append_json_uint_value(const char *name, char **output, unsigned int value)
 static int
 append_json_int_value(const char *name, char **output, int value)
 {
-	int len = strlen(*output);
-	/* extend the buffer */
-	*output = spp_strbuf_append(*output, "",
-			strlen(name) + CMD_TAG_APPEND_SIZE*2);
+	*output = spp_strbuf_appendf(*output, JSON_APPEND_VALUE("%d"),
+			JSON_APPEND_COMMA(spp_strbuf_len(*output)),
+			name, value);
 	if (unlikely(*output == NULL)) {
 		RTE_LOG(ERR, PCAP_RUNNER,
 				"JSON's numeric format failed to add. "
 				"(name = %s, int = %d)\n", name, value);
 		return SPPWK_RET_NG;
 	}
-
-	sprintf(&(*output)[len], JSON_APPEND_VALUE("%d"),
-			JSON_APPEND_COMMA(len), name, value);
 	return SPPWK_RET_OK;
 }
 
@@ -152,19 +167,15 @@ append_json_int_value(const char *name, char **output, int value)
 static int
 append_json_str_value(const char *name, char **output, const char *str)
 {
-	int len = strlen(*output);
-	/* extend the buffer */
-	*output = spp_strbuf_append(*output, "",
-			strlen(name) + strlen(str) + CMD_TAG_APPEND_SIZE);
+	*output = spp_strbuf_appendf(*output, JSON_APPEND_VALUE("\"%s\""),
+			JSON_APPEND_COMMA(spp_strbuf_len(*output)),
+			name, str);
 	if (unlikely(*output == NULL)) {
 		RTE_LOG(ERR, PCAP_RUNNER,
 				"JSON's string format failed to add. "
 				"(name = %s, str = %s)\n", name, str);
 		return SPPWK_RET_NG;
 	}
-
-	sprintf(&(*output)[len], JSON_APPEND_VALUE("\"%s\""),
-			JSON_APPEND_COMMA(len), name, str);
 	return SPPWK_RET_OK;
 }
 
@@ -176,19 +187,15 @@ append_json_str_value(const char *name, char **output, const char *str)
 static int
 append_json_array_brackets(const char *name, char **output, const char *str)
 {
-	int len = strlen(*output);
-	/* extend the buffer */
-	*output = spp_strbuf_append(*output, "",
-			strlen(name) + strlen(str) + CMD_TAG_APPEND_SIZE);
+	*output = spp_strbuf_appendf(*output, JSON_APPEND_ARRAY,
+			JSON_APPEND_COMMA(spp_strbuf_len(*output)),
+			name, str);
 	if (unlikely(*output == NULL)) {
 		RTE_LOG(ERR, PCAP_RUNNER,
 				"JSON's square bracket failed to add. "
 				"(name = %s, str = %s)\n", name, str);
 		return SPPWK_RET_NG;
 	}
-
-	sprintf(&(*output)[len], JSON_APPEND_ARRAY,
-			JSON_APPEND_COMMA(len), name, str);
 	return SPPWK_RET_OK;
 }
 
@@ -196,23 +203,21 @@ append_json_array_brackets(const char *name, char **output, const char *str)
 static int
 append_json_block_brackets(const char *name, char **output, const char *str)
 {
-	int len = strlen(*output);
-	/* extend the buffer */
-	*output = spp_strbuf_append(*output, "",
-			strlen(name) + strlen(str) + CMD_TAG_APPEND_SIZE);
+	if (name[0] == '\0')
+		*output = spp_strbuf_appendf(*output,
+				JSON_APPEND_BLOCK_NONAME,
+				JSON_APPEND_COMMA(spp_strbuf_len(*output)),
+				name, str);
+	else
+		*output = spp_strbuf_appendf(*output, JSON_APPEND_BLOCK,
+				JSON_APPEND_COMMA(spp_strbuf_len(*output)),
+				name, str);
 	if (unlikely(*output == NULL)) {
 		RTE_LOG(ERR, PCAP_RUNNER,
 				"JSON's curly bracket failed to add. "
 				"(name = %s, str = %s)\n", name, str);
 		return SPPWK_RET_NG;
 	}
-
-	if (name[0] == '\0')
-		sprintf(&(*output)[len], JSON_APPEND_BLOCK_NONAME,
-				JSON_APPEND_COMMA(len), name, str);
-	else
-		sprintf(&(*output)[len], JSON_APPEND_BLOCK,
-				JSON_APPEND_COMMA(len), name, str);
 	return SPPWK_RET_OK;
 }
 
@@ -444,6 +449,32 @@ append_process_type_value(const char *name, char **output,
 	return append_json_str_value(name, output, "pcap");
 }
 
+/* Append packets of errors on data path of an lcore for each of reasons. */
+static int
+append_drops_value(const char *name, char **output, unsigned int lcore_id)
+{
+	int ret = SPPWK_RET_OK;
+	int reason;
+	char *tmp_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
+
+	if (unlikely(tmp_buff == NULL)) {
+		RTE_LOG(ERR, PCAP_RUNNER,
+				"allocate error. (name = %s)\n", name);
+		return SPPWK_RET_NG;
+	}
+
+	for (reason = 0; ret == SPPWK_RET_OK &&
+			reason < DP_EVENT_NOF_REASONS; reason++)
+		ret = append_json_uint64_value(dp_event_name(reason),
+				&tmp_buff,
+				dp_event_stats[lcore_id].pkts[reason]);
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_block_brackets(name, output, tmp_buff);
+
+	spp_strbuf_free(tmp_buff);
+	return ret;
+}
+
 static int
 append_pcap_core_element_value(
 		struct sppwk_lcore_params *params,
@@ -488,6 +519,26 @@ append_pcap_core_element_value(
 	if (unlikely(ret < 0))
 		return ret;
 
+	/* Cycles of polls receiving or reading packets are counted as busy. */
+	ret = append_json_uint64_value("busy_cycles", &tmp_buff,
+			lcore_usages[lcore_id].busy_cycles);
+	if (unlikely(ret < SPPWK_RET_OK))
+		return ret;
+
+	ret = append_json_uint64_value("idle_cycles", &tmp_buff,
+			lcore_usages[lcore_id].idle_cycles);
+	if (unlikely(ret < SPPWK_RET_OK))
+		return ret;
+
+	ret = append_json_uint_value("usage", &tmp_buff,
+			lcore_usage_percent(&lcore_usages[lcore_id]));
+	if (unlikely(ret < SPPWK_RET_OK))
+		return ret;
+
+	ret = append_drops_value("drops", &tmp_buff, lcore_id);
+	if (unlikely(ret < SPPWK_RET_OK))
+		return ret;
+
 	ret = append_json_block_brackets("", &buff, tmp_buff);
 	spp_strbuf_free(tmp_buff);
 	params->output = buff;
@@ -549,7 +600,7 @@ append_response_list_value(char **output,
 	}
 
 	for (i = 0; list[i].tag_name[0] != '\0'; i++) {
-		tmp_buff[0] = '\0';
+		spp_strbuf_clear(tmp_buff);
 		ret = list[i].func(list[i].tag_name, &tmp_buff, tmp);
 		if (unlikely(ret < SPPWK_RET_OK)) {
 			spp_strbuf_free(tmp_buff);
@@ -575,7 +626,7 @@ append_response_list_value(char **output,
 		}
 
 		*output = spp_strbuf_append(*output, tmp_buff,
-				strlen(tmp_buff));
+				spp_strbuf_len(tmp_buff));
 		if (unlikely(*output == NULL)) {
 			spp_strbuf_free(tmp_buff);
 			RTE_LOG(ERR, PCAP_RUNNER,
@@ -635,7 +686,7 @@ append_command_results_value(const char *name, char **output,
 	}
 
 	for (i = 0; i < num; i++) {
-		tmp_buff1[0] = '\0';
+		spp_strbuf_clear(tmp_buff1);
 		ret = append_response_list_value(&tmp_buff1,
 				response_result_list, &results[i]);
 		if (unlikely(ret < 0)) {
@@ -730,7 +781,7 @@ send_parse_error_response(int *sock,
 			"response_str=\n%s\n", msg);
 
 	/* send response to requester */
-	ret = send_ctl_msg(sock, msg, strlen(msg));
+	ret = send_ctl_msg(sock, msg, spp_strbuf_len(msg));
 	if (unlikely(ret != SPPWK_RET_OK)) {
 		RTE_LOG(ERR, PCAP_RUNNER,
 				"Failed to send parse error response.\n");
@@ -824,7 +875,7 @@ send_command_result_response(int *sock,
 			"response_str=\n%s\n", msg);
 
 	/* send response to requester */
-	ret = send_ctl_msg(sock, msg, strlen(msg));
+	ret = send_ctl_msg(sock, msg, spp_strbuf_len(msg));
 	if (unlikely(ret != SPPWK_RET_OK)) {
 		RTE_LOG(ERR, PCAP_RUNNER,
 			"Failed to send command result response.\n");
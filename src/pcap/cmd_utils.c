@@ -7,6 +7,7 @@
 
 #include <rte_eth_ring.h>
 #include <rte_log.h>
+#include <rte_malloc.h>
 
 #include "cmd_utils.h"
 #include "shared/secondary/return_codes.h"
@@ -144,10 +145,33 @@ stop_process(int signal)
 	set_all_core_status(SPPWK_LCORE_REQ_STOP);
 }
 
+/* Allocate port info of ring on the local socket. */
+static struct sppwk_port_info *
+alloc_ring_port(int iface_no)
+{
+	struct sppwk_port_info *port;
+
+	port = rte_zmalloc_socket("pcap_ring_port", sizeof(*port),
+			RTE_CACHE_LINE_SIZE, rte_socket_id());
+	if (unlikely(port == NULL)) {
+		RTE_LOG(ERR, PCAP_UTILS, "Failed to alloc ring:%d.\n",
+				iface_no);
+		return NULL;
+	}
+
+	port->iface_type = UNDEF;
+	port->iface_no = iface_no;
+	port->queue_no = DEFAULT_QUEUE_ID;
+	port->ethdev_port_id = -1;
+	port->cls_attrs.vlantag.vid = ETH_VLAN_ID_MAX;
+	return port;
+}
+
 /**
  * Return port info of given type and num of interface
  *
- * It returns NULL value if given type is invalid.
+ * It returns NULL value if given type is invalid. Port info of ring is
+ * allocated if it does not exist, because it is given as capture port.
  */
 struct sppwk_port_info *
 get_iface_info(enum port_type iface_type, int iface_no, int queue_no)
@@ -156,9 +180,15 @@ get_iface_info(enum port_type iface_type, int iface_no, int queue_no)
 
 	switch (iface_type) {
 	case PHY:
+		/* Queues are allocated only for existing phy ports. */
+		if (unlikely(queue_no < 0) || unlikely(queue_no >=
+				iface_info->nof_phy_queues[iface_no]))
+			return NULL;
 		return &iface_info->phy[iface_no][queue_no];
 	case RING:
-		return &iface_info->ring[iface_no];
+		if (iface_info->ring[iface_no] == NULL)
+			iface_info->ring[iface_no] = alloc_ring_port(iface_no);
+		return iface_info->ring[iface_no];
 	default:
 		return NULL;
 	}
@@ -167,37 +197,14 @@ get_iface_info(enum port_type iface_type, int iface_no, int queue_no)
 /**
  * Initialize g_iface_info
  *
- * Clear g_iface_info and set initial value.
+ * Clear g_iface_info. Queues of phy ports and existing rings are allocated
+ * in init_host_port_info().
  */
 static void
 init_iface_info(void)
 {
-	int port_cnt;  /* increment ether ports */
-	int queue_cnt;  /* increment queues per port */
 	struct iface_info *p_iface_info = g_mng_data_addr.p_iface_info;
 	memset(p_iface_info, 0x00, sizeof(struct iface_info));
-	for (port_cnt = 0; port_cnt < RTE_MAX_ETHPORTS; port_cnt++) {
-		for (queue_cnt = 0; queue_cnt < RTE_MAX_QUEUES_PER_PORT;
-				queue_cnt++) {
-			p_iface_info->phy[port_cnt][queue_cnt].iface_type =
-					UNDEF;
-			p_iface_info->phy[port_cnt][queue_cnt].iface_no =
-					port_cnt;
-			p_iface_info->phy[port_cnt][queue_cnt].queue_no =
-					queue_cnt;
-			p_iface_info->phy[port_cnt][queue_cnt]
-					.ethdev_port_id = -1;
-			p_iface_info->phy[port_cnt][queue_cnt]
-					.cls_attrs.vlantag.vid =
-					ETH_VLAN_ID_MAX;
-		}
-		p_iface_info->ring[port_cnt].iface_type = UNDEF;
-		p_iface_info->ring[port_cnt].iface_no   = port_cnt;
-		p_iface_info->ring[port_cnt].queue_no   = DEFAULT_QUEUE_ID;
-		p_iface_info->ring[port_cnt].ethdev_port_id  = -1;
-		p_iface_info->ring[port_cnt].cls_attrs.vlantag.vid =
-				ETH_VLAN_ID_MAX;
-	}
 }
 
 /* Initialize g_core_info */
@@ -213,15 +220,55 @@ init_core_info(void)
 	*g_mng_data_addr.p_capture_status = SPP_CAPTURE_IDLE;
 }
 
+/**
+ * Allocate port info of queues of phy port `iface_no` on the socket of
+ * `ethdev_port_id`, as many as the num of queues of the port.
+ */
+static int
+init_phy_queues(struct iface_info *iface_info, int iface_no,
+		uint16_t ethdev_port_id)
+{
+	struct sppwk_port_info *queues;
+	int nof_queues, queue_id;
+
+	nof_queues = get_port_max_queues(PHY, iface_no);
+	if (nof_queues < 1)
+		nof_queues = 1;
+
+	queues = rte_zmalloc_socket("pcap_phy_queues",
+			sizeof(struct sppwk_port_info) * nof_queues,
+			RTE_CACHE_LINE_SIZE,
+			rte_eth_dev_socket_id(ethdev_port_id));
+	if (unlikely(queues == NULL)) {
+		RTE_LOG(ERR, PCAP_UTILS,
+				"Failed to alloc queues of phy:%d.\n",
+				iface_no);
+		return SPPWK_RET_NG;
+	}
+
+	for (queue_id = 0; queue_id < nof_queues; queue_id++) {
+		queues[queue_id].iface_type = PHY;
+		queues[queue_id].iface_no = iface_no;
+		queues[queue_id].queue_no = queue_id;
+		queues[queue_id].ethdev_port_id = iface_no;
+		queues[queue_id].cls_attrs.vlantag.vid = ETH_VLAN_ID_MAX;
+	}
+
+	iface_info->phy[iface_no] = queues;
+	iface_info->nof_phy_queues[iface_no] = nof_queues;
+	return SPPWK_RET_OK;
+}
+
 /* Initialize mng data of ports on host */
 static int
 init_host_port_info(void)
 {
 	int port_type, port_id;
-	int i, ret, queue_id;
+	int i, ret;
 	int nof_phys = 0;
 	char dev_name[RTE_DEV_NAME_MAX_LEN] = { 0 };
 	struct iface_info *p_iface_info = g_mng_data_addr.p_iface_info;
+	struct sppwk_port_info *port;
 
 	for (i = 0; i < RTE_MAX_ETHPORTS; i++) {
 		if (!rte_eth_dev_is_valid_port(i))
@@ -239,17 +286,17 @@ init_host_port_info(void)
 
 		switch (port_type) {
 		case PHY:
-			for (queue_id = 0; queue_id < RTE_MAX_QUEUES_PER_PORT;
-					queue_id++) {
-				p_iface_info->phy[port_id][queue_id]
-						.iface_type = port_type;
-				p_iface_info->phy[port_id][queue_id]
-						.ethdev_port_id = port_id;
-			}
+			ret = init_phy_queues(p_iface_info, port_id, i);
+			if (unlikely(ret != SPPWK_RET_OK))
+				return SPPWK_RET_NG;
 			break;
 		case RING:
-			p_iface_info->ring[port_id].iface_type = port_type;
-			p_iface_info->ring[port_id].ethdev_port_id = port_id;
+			port = alloc_ring_port(port_id);
+			if (unlikely(port == NULL))
+				return SPPWK_RET_NG;
+			port->iface_type = port_type;
+			port->ethdev_port_id = port_id;
+			p_iface_info->ring[port_id] = port;
 			break;
 		default:
 			RTE_LOG(ERR, PCAP_UTILS, "Unsupported port on host, "
@@ -13,6 +13,8 @@
 #include <lz4frame.h>
 
 #include "shared/common.h"
+#include "shared/lcore_usage.h"
+#include "shared/dp_event.h"
 #include "data_types.h"
 #include "cmd_utils.h"
 #include "spp_pcap.h"
@@ -848,14 +850,14 @@ static int pcap_proc_receive(int lcore_id)
 			MAX_PCAP_BURST);
 	if (unlikely(nb_rx == 0))
 		return SPPWK_RET_OK;
+	lcore_usage_add_rx(nb_rx);
 
 	/* Forward to ring for writer thread */
 	nb_tx = rte_ring_enqueue_burst(write_ring, (void *)bufs, nb_rx, NULL);
 
 	/* Discard remained packets to release mbuf */
 	if (unlikely(nb_tx < nb_rx)) {
-		RTE_LOG(ERR, SPP_PCAP, "drop packets(receve) %d\n",
-							(nb_rx - nb_tx));
+		dp_event_add(DP_EVENT_RING_FULL, nb_rx - nb_tx);
 		for (buf = nb_tx; buf < nb_rx; buf++)
 			rte_pktmbuf_free(bufs[buf]);
 	}
@@ -914,6 +916,7 @@ static int pcap_proc_write(int lcore_id)
 		}
 		return SPPWK_RET_OK;
 	}
+	lcore_usage_add_rx(nb_rx);
 
 	for (buf = 0; buf < nb_rx; buf++) {
 		mbuf = bufs[buf];
@@ -946,6 +949,7 @@ slave_main(void *arg __attribute__ ((unused)))
 	int ret = SPPWK_RET_OK;
 	unsigned int lcore_id = rte_lcore_id();
 	struct pcap_mng_info *pcap_info = &g_pcap_info[lcore_id];
+	struct lcore_usage_poll poll;
 
 	if (pcap_info->thread_no == 0) {
 		RTE_LOG(INFO, SPP_PCAP, "Receiver started on lcore %d.\n",
@@ -957,6 +961,7 @@ slave_main(void *arg __attribute__ ((unused)))
 		pcap_info->type = PCAP_WRITE;
 	}
 	set_core_status(lcore_id, SPPWK_LCORE_IDLING);
+	lcore_usage_poll_begin(&poll);
 
 	while (1) {
 		if (sppwk_get_lcore_status(lcore_id) == SPPWK_LCORE_REQ_STOP) {
@@ -976,6 +981,7 @@ slave_main(void *arg __attribute__ ((unused)))
 					lcore_id);
 			break;
 		}
+		lcore_usage_poll_end(&lcore_usages[lcore_id], &poll);
 	}
 
 	set_core_status(lcore_id, SPPWK_LCORE_STOPPED);
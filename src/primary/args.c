@@ -20,6 +20,9 @@ int server_port;
 /* Flag for deciding to forward */
 int do_forwarding;
 
+/* Flag for installing flow rules rejected by the device in software */
+static int do_flow_sw_fallback;
+
 /*
  * Long options mapped to a short option.
  *
@@ -30,11 +33,13 @@ enum {
 	CMD_LINE_OPT_MIN_NUM = 256,
 	CMD_OPT_DISP_STATS,
 	CMD_OPT_PORT_NUM, /* For `--port-num` */
+	CMD_OPT_FLOW_SW_FALLBACK, /* For `--flow-sw-fallback` */
 };
 
 struct option lgopts[] = {
 	{"disp-stats", no_argument, NULL, CMD_OPT_DISP_STATS},
 	{"port-num", required_argument, NULL, CMD_OPT_PORT_NUM},
+	{"flow-sw-fallback", no_argument, NULL, CMD_OPT_FLOW_SW_FALLBACK},
 	{0}
 };
 
@@ -49,12 +54,15 @@ usage(void)
 	RTE_LOG(INFO, PRIMARY,
 	    "%s [EAL options] -- -p PORTMASK -n NUM_CLIENTS [-s NUM_SOCKETS]"
 		" [--port-num NUM_PORT"
-		" rxq NUM_RX_QUEUE txq NUM_TX_QUEUE]...\n"
+		" rxq NUM_RX_QUEUE txq NUM_TX_QUEUE]..."
+		" [--flow-sw-fallback]\n"
 	    " -p PORTMASK: hexadecimal bitmask of ports to use\n"
 	    " -n NUM_RINGS: number of ring ports used from secondaries\n"
 		" --port-num NUM_PORT: number of ports for multi-queue setting\n"
 		" rxq NUM_RX_QUEUE: number of receive queues\n"
 		" txq NUM_TX_QUEUE number of transmit queues\n"
+		" --flow-sw-fallback: install flow rules rejected by"
+		" device in software\n"
 	    , progname);
 }
 
@@ -78,6 +86,11 @@ int get_forwarding_flg(void)
 	return do_forwarding;
 }
 
+int get_flow_sw_fallback_flg(void)
+{
+	return do_flow_sw_fallback;
+}
+
 /**
  * The ports to be used by the application are passed in
  * the form of a bitmask. This function parses the bitmask
@@ -293,6 +306,9 @@ parse_app_args(uint16_t max_ports, int argc, char *argv[])
 				return -1;
 			}
 			break;
+		case CMD_OPT_FLOW_SW_FALLBACK:
+			do_flow_sw_fallback = 1;
+			break;
 		case CMD_OPT_PORT_NUM:
 			ret = parse_nof_queues(arg_queues, optarg, optind,
 					max_ports, argc, argv);
@@ -31,6 +31,15 @@ int set_forwarding_flg(int flg);
  */
 int get_forwarding_flg(void);
 
+/**
+ * Get flag of software fallback of flow rules, which is enabled with
+ * `--flow-sw-fallback` option.
+ *
+ * @return 1 if flow rules rejected by the device are installed in
+ *   software, or 0 if disabled.
+ */
+int get_flow_sw_fallback_flg(void);
+
 int parse_portmask(struct port_info *ports, uint16_t max_ports,
 		const char *portmask);
 int parse_app_args(uint16_t max_ports, int argc, char *argv[]);
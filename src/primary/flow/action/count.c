@@ -0,0 +1,78 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2020 Nippon Telegraph and Telephone Corporation
+ */
+
+#include <rte_flow.h>
+
+#include "primary/flow/flow.h"
+#include "primary/flow/common.h"
+#include "count.h"
+
+/*
+ * Set "shared" bit-field of count action. Offset of bit-field cannot be
+ * given with offsetof(), so output is the head of the conf.
+ */
+static int
+set_count_shared(char *shared_str, void *output)
+{
+	char *end;
+	unsigned long shared;
+	struct rte_flow_action_count *count = output;
+
+	shared = strtoul(shared_str, &end, 0);
+	if (end == NULL || *end != '\0')
+		return -1;
+
+	/* 1bit check */
+	if (shared > 0x1)
+		return -1;
+
+	count->shared = shared;
+
+	return 0;
+}
+
+/* Define action "count" operations */
+struct flow_detail_ops count_ops_list[] = {
+	{
+		.token = "shared",
+		.offset = 0,
+		.size = sizeof(uint32_t),
+		.flg_value = 1,
+		.parse_detail = set_count_shared,
+	},
+	{
+		.token = "id",
+		.offset = offsetof(struct rte_flow_action_count, id),
+		.size = sizeof(uint32_t),
+		.flg_value = 1,
+		.parse_detail = str_to_uint32_t,
+	},
+	{
+		.token = NULL,
+	},
+};
+
+int
+append_action_count_json(const void *conf, int buf_size, char *action_str)
+{
+	const struct rte_flow_action_count *count = conf;
+	char tmp_str[64] = { 0 };
+
+	/* Conf of count is optional and default counter is used if NULL. */
+	if (count == NULL)
+		return append_action_null_json(conf, buf_size, action_str);
+
+	snprintf(tmp_str, 64,
+		"{\"shared\":%u,"
+		"\"id\":%u}",
+		count->shared, count->id);
+
+	if ((int)strlen(action_str) + (int)strlen(tmp_str)
+		> buf_size)
+		return -1;
+
+	strncat(action_str, tmp_str, strlen(tmp_str));
+
+	return 0;
+}
@@ -0,0 +1,13 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2020 Nippon Telegraph and Telephone Corporation
+ */
+
+#ifndef _PRIMARY_FLOW_ACTION_COUNT_H_
+#define _PRIMARY_FLOW_ACTION_COUNT_H_
+
+extern struct flow_detail_ops count_ops_list[];
+
+int append_action_count_json(const void *conf, int buf_size,
+	char *action_str);
+
+#endif
@@ -0,0 +1,75 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2020 Nippon Telegraph and Telephone Corporation
+ */
+
+#include <rte_flow.h>
+
+#include "primary/flow/flow.h"
+#include "primary/flow/common.h"
+#include "port_id.h"
+
+/*
+ * Set "original" bit-field of port_id action. Offset of bit-field cannot
+ * be given with offsetof(), so output is the head of the conf.
+ */
+static int
+set_port_id_original(char *original_str, void *output)
+{
+	char *end;
+	unsigned long original;
+	struct rte_flow_action_port_id *port_id = output;
+
+	original = strtoul(original_str, &end, 0);
+	if (end == NULL || *end != '\0')
+		return -1;
+
+	/* 1bit check */
+	if (original > 0x1)
+		return -1;
+
+	port_id->original = original;
+
+	return 0;
+}
+
+/* Define action "port_id" operations */
+struct flow_detail_ops port_id_ops_list[] = {
+	{
+		.token = "original",
+		.offset = 0,
+		.size = sizeof(uint32_t),
+		.flg_value = 1,
+		.parse_detail = set_port_id_original,
+	},
+	{
+		.token = "id",
+		.offset = offsetof(struct rte_flow_action_port_id, id),
+		.size = sizeof(uint32_t),
+		.flg_value = 1,
+		.parse_detail = str_to_uint32_t,
+	},
+	{
+		.token = NULL,
+	},
+};
+
+int
+append_action_port_id_json(const void *conf, int buf_size,
+	char *action_str)
+{
+	const struct rte_flow_action_port_id *port_id = conf;
+	char tmp_str[64] = { 0 };
+
+	snprintf(tmp_str, 64,
+		"{\"original\":%u,"
+		"\"id\":%u}",
+		port_id->original, port_id->id);
+
+	if ((int)strlen(action_str) + (int)strlen(tmp_str)
+		> buf_size)
+		return -1;
+
+	strncat(action_str, tmp_str, strlen(tmp_str));
+
+	return 0;
+}
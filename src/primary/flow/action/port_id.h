@@ -0,0 +1,13 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2020 Nippon Telegraph and Telephone Corporation
+ */
+
+#ifndef _PRIMARY_FLOW_ACTION_PORT_ID_H_
+#define _PRIMARY_FLOW_ACTION_PORT_ID_H_
+
+extern struct flow_detail_ops port_id_ops_list[];
+
+int append_action_port_id_json(const void *conf, int buf_size,
+	char *action_str);
+
+#endif
@@ -0,0 +1,295 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2020 Nippon Telegraph and Telephone Corporation
+ */
+
+#include <inttypes.h>
+
+#include <rte_flow.h>
+#include <rte_ethdev.h>
+
+#include "primary/flow/flow.h"
+#include "primary/flow/common.h"
+#include "rss.h"
+
+/* Name of hash functions */
+static const char *const rss_func_list[] = {
+	[RTE_ETH_HASH_FUNCTION_DEFAULT] = "default",
+	[RTE_ETH_HASH_FUNCTION_TOEPLITZ] = "toeplitz",
+	[RTE_ETH_HASH_FUNCTION_SIMPLE_XOR] = "simple_xor",
+};
+
+/* Name of hash types and its ETH_RSS_* value */
+static const struct {
+	const char *str;
+	uint64_t rss_type;
+} rss_type_list[] = {
+	{ "ip", ETH_RSS_IP },
+	{ "udp", ETH_RSS_UDP },
+	{ "tcp", ETH_RSS_TCP },
+	{ "sctp", ETH_RSS_SCTP },
+	{ "tunnel", ETH_RSS_TUNNEL },
+	{ "ipv4", ETH_RSS_IPV4 },
+	{ "ipv4-frag", ETH_RSS_FRAG_IPV4 },
+	{ "ipv4-tcp", ETH_RSS_NONFRAG_IPV4_TCP },
+	{ "ipv4-udp", ETH_RSS_NONFRAG_IPV4_UDP },
+	{ "ipv4-sctp", ETH_RSS_NONFRAG_IPV4_SCTP },
+	{ "ipv4-other", ETH_RSS_NONFRAG_IPV4_OTHER },
+	{ "ipv6", ETH_RSS_IPV6 },
+	{ "ipv6-frag", ETH_RSS_FRAG_IPV6 },
+	{ "ipv6-tcp", ETH_RSS_NONFRAG_IPV6_TCP },
+	{ "ipv6-udp", ETH_RSS_NONFRAG_IPV6_UDP },
+	{ "ipv6-sctp", ETH_RSS_NONFRAG_IPV6_SCTP },
+	{ "ipv6-other", ETH_RSS_NONFRAG_IPV6_OTHER },
+	{ "l2-payload", ETH_RSS_L2_PAYLOAD },
+	{ "vxlan", ETH_RSS_VXLAN },
+	{ "nvgre", ETH_RSS_NVGRE },
+};
+
+/*
+ * Convert string to hash function.
+ * This function is intended to be called as a function pointer to
+ * 'parse_detail' in 'struct flow_detail_ops'.
+ */
+static int
+str_to_rss_func(char *func_str, void *output)
+{
+	uint32_t i;
+	enum rte_eth_hash_function *func = output;
+
+	for (i = 0; i < RTE_DIM(rss_func_list); i++) {
+		if (rss_func_list[i] != NULL &&
+				!strcmp(func_str, rss_func_list[i])) {
+			*func = (enum rte_eth_hash_function)i;
+			return 0;
+		}
+	}
+
+	return -1;
+}
+
+/* Define action "rss" operations, except for lists of types and queues */
+struct flow_detail_ops rss_ops_list[] = {
+	{
+		.token = "func",
+		.offset = offsetof(struct rte_flow_action_rss, func),
+		.size = sizeof(enum rte_eth_hash_function),
+		.flg_value = 1,
+		.parse_detail = str_to_rss_func,
+	},
+	{
+		.token = "level",
+		.offset = offsetof(struct rte_flow_action_rss, level),
+		.size = sizeof(uint32_t),
+		.flg_value = 1,
+		.parse_detail = str_to_uint32_t,
+	},
+	{
+		.token = NULL,
+	},
+};
+
+/*
+ * Parse list of hash types terminated with "end", for example
+ * "types ipv4-udp ipv4-tcp end". Index is moved to "end".
+ */
+static int
+parse_rss_types(char *token_list[], int *index,
+	struct rte_flow_action_rss *rss)
+{
+	uint32_t i;
+
+	(*index)++;
+	while (token_list[*index] != NULL) {
+		if (!strcmp(token_list[*index], "end"))
+			return 0;
+
+		for (i = 0; i < RTE_DIM(rss_type_list); i++) {
+			if (!strcmp(token_list[*index], rss_type_list[i].str))
+				break;
+		}
+		if (i == RTE_DIM(rss_type_list)) {
+			RTE_LOG(ERR, SPP_FLOW,
+				"Invalid rss type %s(%s:%d)\n",
+				token_list[*index], __func__, __LINE__);
+			return -1;
+		}
+
+		rss->types |= rss_type_list[i].rss_type;
+		(*index)++;
+	}
+
+	RTE_LOG(ERR, SPP_FLOW,
+		"rss types is not terminated with end(%s:%d)\n",
+		__func__, __LINE__);
+	return -1;
+}
+
+/*
+ * Parse list of queue indices terminated with "end", for example
+ * "queues 0 1 2 3 end". Index is moved to "end".
+ */
+static int
+parse_rss_queues(char *token_list[], int *index,
+	struct rss_action_conf *conf)
+{
+	int ret;
+
+	(*index)++;
+	while (token_list[*index] != NULL) {
+		if (!strcmp(token_list[*index], "end"))
+			return 0;
+
+		if (conf->rss.queue_num >= RTE_MAX_QUEUES_PER_PORT) {
+			RTE_LOG(ERR, SPP_FLOW,
+				"Too many rss queues(%s:%d)\n",
+				__func__, __LINE__);
+			return -1;
+		}
+
+		ret = str_to_uint16_t(token_list[*index],
+			&conf->queue[conf->rss.queue_num]);
+		if (ret != 0) {
+			RTE_LOG(ERR, SPP_FLOW,
+				"Invalid rss queue %s(%s:%d)\n",
+				token_list[*index], __func__, __LINE__);
+			return -1;
+		}
+
+		conf->rss.queue_num++;
+		(*index)++;
+	}
+
+	RTE_LOG(ERR, SPP_FLOW,
+		"rss queues is not terminated with end(%s:%d)\n",
+		__func__, __LINE__);
+	return -1;
+}
+
+int
+parse_action_rss(char *token_list[], int *index,
+	struct rte_flow_action *action,
+	struct flow_action_ops *ops)
+{
+	int ret = 0;
+	int i = 0;
+	struct rss_action_conf *conf = NULL;
+	struct flow_detail_ops *detail_list = ops->detail_list;
+
+	ret = malloc_object((void **)&conf, ops->size);
+	if (ret != 0)
+		return -1;
+
+	/*
+	 * Hash key is not supported and default one of the device is
+	 * used because key_len is 0.
+	 */
+	conf->rss.queue = conf->queue;
+
+	/* Next to word */
+	(*index)++;
+
+	while (token_list[*index] != NULL) {
+
+		/* Exit if "/" */
+		if (!strcmp(token_list[*index], "/"))
+			break;
+
+		if (!strcmp(token_list[*index], "types")) {
+			ret = parse_rss_types(token_list, index, &conf->rss);
+			if (ret != 0)
+				break;
+
+			(*index)++;
+			continue;
+
+		} else if (!strcmp(token_list[*index], "queues")) {
+			ret = parse_rss_queues(token_list, index, conf);
+			if (ret != 0)
+				break;
+
+			(*index)++;
+			continue;
+		}
+
+		i = 0;
+		while (detail_list[i].token != NULL) {
+			if (!strcmp(token_list[*index],
+				detail_list[i].token)) {
+				break;
+			}
+
+			i++;
+		}
+		if (detail_list[i].token == NULL) {
+			RTE_LOG(ERR, SPP_FLOW,
+				"Invalid \"%s\" action arguments(%s:%d)\n",
+				ops->str_type, __func__, __LINE__);
+			ret = -1;
+			break;
+		}
+
+		/* Parse token value */
+		(*index)++;
+		ret = detail_list[i].parse_detail(token_list[*index],
+			(char *)conf + detail_list[i].offset);
+		if (ret != 0) {
+			RTE_LOG(ERR, SPP_FLOW,
+				"Invalid \"%s\" action arguments(%s:%d)\n",
+				detail_list[i].token, __func__, __LINE__);
+			ret = -1;
+			break;
+		}
+
+		(*index)++;
+	}
+
+	/* Free memory allocated in case of failure. */
+	if (ret != 0) {
+		free(conf);
+		conf = NULL;
+	}
+
+	/* Parse result to action. */
+	action->conf = conf;
+
+	return ret;
+}
+
+int
+append_action_rss_json(const void *conf, int buf_size, char *action_str)
+{
+	const struct rte_flow_action_rss *rss = conf;
+	const char *func_str = "unknown";
+	int len, ret;
+	uint32_t i;
+
+	if ((unsigned int)rss->func < RTE_DIM(rss_func_list) &&
+			rss_func_list[rss->func] != NULL)
+		func_str = rss_func_list[rss->func];
+
+	/* List of queues can be long, so append it to the output directly. */
+	len = strlen(action_str);
+	ret = snprintf(action_str + len, buf_size - len,
+		"{\"func\":\"%s\","
+		"\"level\":%u,"
+		"\"types\":\"0x%016"PRIx64"\","
+		"\"queues\":[",
+		func_str, rss->level, rss->types);
+	if (ret < 0 || ret >= buf_size - len)
+		return -1;
+	len += ret;
+
+	for (i = 0; i < rss->queue_num; i++) {
+		ret = snprintf(action_str + len, buf_size - len, "%s%u",
+			(i == 0) ? "" : ",", rss->queue[i]);
+		if (ret < 0 || ret >= buf_size - len)
+			return -1;
+		len += ret;
+	}
+
+	ret = snprintf(action_str + len, buf_size - len, "]}");
+	if (ret < 0 || ret >= buf_size - len)
+		return -1;
+
+	return 0;
+}
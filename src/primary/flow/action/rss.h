@@ -0,0 +1,30 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2020 Nippon Telegraph and Telephone Corporation
+ */
+
+#ifndef _PRIMARY_FLOW_ACTION_RSS_H_
+#define _PRIMARY_FLOW_ACTION_RSS_H_
+
+#include <rte_flow.h>
+#include <rte_ethdev.h>
+
+/*
+ * Conf of "rss" action. Queues are stored in the same memory for freeing
+ * it at once as other actions, so `rss` must be the first member.
+ */
+struct rss_action_conf {
+	struct rte_flow_action_rss rss;
+	uint16_t queue[RTE_MAX_QUEUES_PER_PORT];
+};
+
+extern struct flow_detail_ops rss_ops_list[];
+
+/* Parse "rss" action which has lists of types and queues. */
+int parse_action_rss(char *token_list[], int *index,
+	struct rte_flow_action *action,
+	struct flow_action_ops *ops);
+
+int append_action_rss_json(const void *conf, int buf_size,
+	char *action_str);
+
+#endif
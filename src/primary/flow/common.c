@@ -2,6 +2,8 @@
  * Copyright(c) 2019 Nippon Telegraph and Telephone Corporation
  */
 
+#include <arpa/inet.h>
+
 #include <rte_ethdev.h>
 
 #include "shared/secondary/spp_worker_th/data_types.h"
@@ -282,6 +284,103 @@ str_to_uint32_t(char *target_str, void *output)
 	return 0;
 }
 
+/*
+ * Convert string to uint8_t.
+ * This function is intended to be called as a function pointer to
+ * 'parse_detail' in 'struct flow_detail_ops'.
+ */
+int
+str_to_uint8_t(char *target_str, void *output)
+{
+	char *end;
+	unsigned long value;
+
+	value = strtoul(target_str, &end, 0);
+	if (end == NULL || *end != '\0')
+		return -1;
+
+	if (value > UINT8_MAX)
+		return -1;
+
+	*(uint8_t *)output = (uint8_t)value;
+
+	return 0;
+}
+
+/*
+ * Convert string to rte_be32_t.
+ * This function is intended to be called as a function pointer to
+ * 'parse_detail' in 'struct flow_detail_ops'.
+ */
+int
+str_to_rte_be32_t(char *target_str, void *output)
+{
+	char *end;
+	rte_be32_t *value = output;
+
+	*value = rte_cpu_to_be_32((uint32_t)strtoul(target_str, &end, 0));
+	if (end == NULL || *end != '\0')
+		return -1;
+
+	return 0;
+}
+
+/*
+ * Convert dotted decimal string to IPv4 address in network byte order.
+ * This function is intended to be called as a function pointer to
+ * 'parse_detail' in 'struct flow_detail_ops'.
+ */
+int
+str_to_ipv4_addr(char *addr_str, void *output)
+{
+	if (inet_pton(AF_INET, addr_str, output) != 1)
+		return -1;
+
+	return 0;
+}
+
+/*
+ * Convert string to 16 bytes IPv6 address.
+ * This function is intended to be called as a function pointer to
+ * 'parse_detail' in 'struct flow_detail_ops'.
+ */
+int
+str_to_ipv6_addr(char *addr_str, void *output)
+{
+	if (inet_pton(AF_INET6, addr_str, output) != 1)
+		return -1;
+
+	return 0;
+}
+
+/*
+ * Convert string to 24bits VXLAN network identifier stored in 3 bytes
+ * array in network byte order.
+ * This function is intended to be called as a function pointer to
+ * 'parse_detail' in 'struct flow_detail_ops'.
+ */
+int
+str_to_vni(char *vni_str, void *output)
+{
+	char *end;
+	uint32_t vni;
+	uint8_t *vni_bytes = output;
+
+	vni = (uint32_t)strtoul(vni_str, &end, 0);
+	if (end == NULL || *end != '\0')
+		return -1;
+
+	/* 24bit check */
+	if (vni > 0xffffff)
+		return -1;
+
+	vni_bytes[0] = (uint8_t)(vni >> 16);
+	vni_bytes[1] = (uint8_t)(vni >> 8);
+	vni_bytes[2] = (uint8_t)vni;
+
+	return 0;
+}
+
 int
 parse_rte_flow_item_field(char *token_list[], int *index,
 	struct flow_detail_ops *detail_list, size_t size,
@@ -17,6 +17,11 @@ int str_to_pcp(char *pcp_str, void *output);
 int str_to_rte_be16_t(char *target_str, void *output);
 int str_to_uint16_t(char *target_str, void *output);
 int str_to_uint32_t(char *target_str, void *output);
+int str_to_uint8_t(char *target_str, void *output);
+int str_to_rte_be32_t(char *target_str, void *output);
+int str_to_ipv4_addr(char *addr_str, void *output);
+int str_to_ipv6_addr(char *addr_str, void *output);
+int str_to_vni(char *vni_str, void *output);
 
 /* Functions for setting string to data */
 int set_pcp_in_tci(char *pcp_str, void *output);
@@ -2,6 +2,8 @@
  * Copyright(c) 2019 Nippon Telegraph and Telephone Corporation
  */
 
+#include <stdarg.h>
+
 #include <rte_flow.h>
 #include <rte_common.h>
 #include <rte_ether.h>
@@ -11,23 +13,56 @@
 #include "shared/secondary/utils.h"
 #include "shared/secondary/spp_worker_th/data_types.h"
 #include "primary/primary.h"
+#include "primary/args.h"
 #include "flow.h"
 #include "attr.h"
 #include "common.h"
 
 #include "primary/flow/pattern/eth.h"
 #include "primary/flow/pattern/vlan.h"
+#include "primary/flow/pattern/ipv4.h"
+#include "primary/flow/pattern/ipv6.h"
+#include "primary/flow/pattern/udp.h"
+#include "primary/flow/pattern/tcp.h"
+#include "primary/flow/pattern/vxlan.h"
+#include "primary/flow/pattern/gtp.h"
 
 #include "primary/flow/action/jump.h"
 #include "primary/flow/action/queue.h"
 #include "primary/flow/action/of_push_vlan.h"
 #include "primary/flow/action/of_set_vlan_vid.h"
 #include "primary/flow/action/of_set_vlan_pcp.h"
+#include "primary/flow/action/rss.h"
+#include "primary/flow/action/mark.h"
+#include "primary/flow/action/count.h"
+#include "primary/flow/action/port_id.h"
+
+
+/* Initial number of entries of flow rules array of a port. */
+#define FLOW_RULES_INIT_SLOTS 64
+
+/* Initial size of buffer for flow rules in JSON, extended if required. */
+#define FLOW_JSON_BUF_INIT_SIZE 4096
 
+/*
+ * Size reserved for an attr, item or action given to status callbacks.
+ * It is large enough for rss action with queues up to
+ * RTE_MAX_QUEUES_PER_PORT.
+ */
+#define FLOW_JSON_ELEM_SIZE 8192
+
+/* Growable buffer for flow rules in JSON. */
+struct flow_json_buf {
+	char *str;
+	size_t len;  /* Length of str without terminating null. */
+	size_t size;  /* Allocated size of str. */
+};
 
-/* Flow list for each port */
+/* Flow rules for each port */
 static struct port_flow port_list[RTE_MAX_ETHPORTS] = { 0 };
 
+static int make_flow_stats_json(int port_id, struct flow_json_buf *buf);
+
 /* Define item operations */
 static struct flow_item_ops flow_item_ops_list[] = {
 	{
@@ -52,6 +87,54 @@ static struct flow_item_ops flow_item_ops_list[] = {
 		.detail_list = vlan_ops_list,
 		.status = append_item_vlan_json,
 	},
+	{
+		.str_type = "ipv4",
+		.type = RTE_FLOW_ITEM_TYPE_IPV4,
+		.size = sizeof(struct rte_flow_item_ipv4),
+		.parse = parse_item_common,
+		.detail_list = ipv4_ops_list,
+		.status = append_item_ipv4_json,
+	},
+	{
+		.str_type = "ipv6",
+		.type = RTE_FLOW_ITEM_TYPE_IPV6,
+		.size = sizeof(struct rte_flow_item_ipv6),
+		.parse = parse_item_common,
+		.detail_list = ipv6_ops_list,
+		.status = append_item_ipv6_json,
+	},
+	{
+		.str_type = "udp",
+		.type = RTE_FLOW_ITEM_TYPE_UDP,
+		.size = sizeof(struct rte_flow_item_udp),
+		.parse = parse_item_common,
+		.detail_list = udp_ops_list,
+		.status = append_item_udp_json,
+	},
+	{
+		.str_type = "tcp",
+		.type = RTE_FLOW_ITEM_TYPE_TCP,
+		.size = sizeof(struct rte_flow_item_tcp),
+		.parse = parse_item_common,
+		.detail_list = tcp_ops_list,
+		.status = append_item_tcp_json,
+	},
+	{
+		.str_type = "vxlan",
+		.type = RTE_FLOW_ITEM_TYPE_VXLAN,
+		.size = sizeof(struct rte_flow_item_vxlan),
+		.parse = parse_item_common,
+		.detail_list = vxlan_ops_list,
+		.status = append_item_vxlan_json,
+	},
+	{
+		.str_type = "gtp",
+		.type = RTE_FLOW_ITEM_TYPE_GTP,
+		.size = sizeof(struct rte_flow_item_gtp),
+		.parse = parse_item_common,
+		.detail_list = gtp_ops_list,
+		.status = append_item_gtp_json,
+	},
 };
 
 /* Define action operations */
@@ -112,6 +195,46 @@ static struct flow_action_ops flow_action_ops_list[] = {
 		.detail_list = of_set_vlan_pcp_ops_list,
 		.status = append_action_of_set_vlan_pcp_json,
 	},
+	{
+		.str_type = "rss",
+		.type = RTE_FLOW_ACTION_TYPE_RSS,
+		.size = sizeof(struct rss_action_conf),
+		.parse = parse_action_rss,
+		.detail_list = rss_ops_list,
+		.status = append_action_rss_json,
+	},
+	{
+		.str_type = "mark",
+		.type = RTE_FLOW_ACTION_TYPE_MARK,
+		.size = sizeof(struct rte_flow_action_mark),
+		.parse = parse_action_common,
+		.detail_list = mark_ops_list,
+		.status = append_action_mark_json,
+	},
+	{
+		.str_type = "count",
+		.type = RTE_FLOW_ACTION_TYPE_COUNT,
+		.size = sizeof(struct rte_flow_action_count),
+		.parse = parse_action_common,
+		.detail_list = count_ops_list,
+		.status = append_action_count_json,
+	},
+	{
+		.str_type = "drop",
+		.type = RTE_FLOW_ACTION_TYPE_DROP,
+		.size = 0,
+		.parse = NULL,
+		.detail_list = NULL,
+		.status = append_action_null_json,
+	},
+	{
+		.str_type = "port_id",
+		.type = RTE_FLOW_ACTION_TYPE_PORT_ID,
+		.size = sizeof(struct rte_flow_action_port_id),
+		.parse = parse_action_common,
+		.detail_list = port_id_ops_list,
+		.status = append_action_port_id_json,
+	},
 };
 
 /* Free memory of "flow_args". */
@@ -457,6 +580,52 @@ parse_flow_destroy(char *token_list[], struct flow_args *input)
 	return 0;
 }
 
+/* Parse arguments of stats command, for example "flow stats phy:0". */
+static int
+parse_flow_stats(char *token_list[], struct flow_args *input)
+{
+	return parse_phy_port_id(token_list[2], &input->port_id);
+}
+
+/*
+ * Parse arguments of query command. Only "count" action is supported
+ * for query, for example "flow query phy:0 1 count".
+ */
+static int
+parse_flow_query(char *token_list[], struct flow_args *input)
+{
+	int ret;
+	char *end;
+
+	ret = parse_phy_port_id(token_list[2], &input->port_id);
+	if (ret < 0)
+		return -1;
+
+	if (token_list[3] == NULL) {
+		RTE_LOG(ERR, SPP_FLOW,
+			"rule_id is not specified(%s:%d)\n",
+			__func__, __LINE__);
+		return -1;
+	}
+
+	input->args.query.rule_id = strtoul(token_list[3], &end, 10);
+	if (end == NULL || *end != '\0') {
+		RTE_LOG(ERR, SPP_FLOW,
+			"rule_id is not a number(%s:%d)\n",
+			__func__, __LINE__);
+		return -1;
+	}
+
+	if (token_list[4] == NULL || strcmp(token_list[4], "count")) {
+		RTE_LOG(ERR, SPP_FLOW,
+			"Only count action can be queried(%s:%d)\n",
+			__func__, __LINE__);
+		return -1;
+	}
+
+	return 0;
+}
+
 /** Generate a flow_rule entry from attributes/pattern/actions. */
 static struct flow_rule *
 create_flow_rule(struct rte_flow_attr *attr,
@@ -503,58 +672,280 @@ exec_flow_validate(int port_id,
 	char *response)
 {
 	int ret;
+	char mes[128];
+	const char *err_msg;
 	struct rte_flow_error error;
 
 	memset(&error, 0, sizeof(error));
 
 	ret = rte_flow_validate(port_id, attr, pattern, actions, &error);
-	if (ret != 0)
-		make_error_response(response, "Flow validate error", error,
-			NULL);
-	else
+	if (ret == 0) {
 		make_response(response, "success", "Flow rule validated",
 			NULL);
+		return;
+	}
+
+	if (get_flow_sw_fallback_flg() == 1) {
+		ret = sw_flow_validate(port_id, attr, pattern, actions,
+			&err_msg);
+		if (ret == 0) {
+			make_response(response, "success",
+				"Flow rule validated for software", NULL);
+			return;
+		}
+		snprintf(mes, sizeof(mes), "Flow validate error, "
+			"software: %s", err_msg);
+		make_error_response(response, mes, error, NULL);
+		return;
+	}
+
+	make_error_response(response, "Flow validate error", error, NULL);
 }
 
-/* Execute rte_flow_create(). Save flow rules globally */
+/*
+ * Double the number of entries of flow rules array and free rule ID array
+ * of given port. It is extended only if all of rule IDs are in use, so
+ * the number of entries does not exceed twice of the peak of live rules.
+ */
+static int
+extend_flow_rules(struct port_flow *port)
+{
+	uint32_t nof_slots;
+	uint32_t *free_ids;
+	struct flow_rule **rules;
+
+	if (port->nof_slots == 0)
+		nof_slots = FLOW_RULES_INIT_SLOTS;
+	else if (port->nof_slots > UINT32_MAX / 2)
+		nof_slots = UINT32_MAX;
+	else
+		nof_slots = port->nof_slots * 2;
+
+	rules = realloc(port->rules, sizeof(struct flow_rule *) * nof_slots);
+	if (rules == NULL) {
+		RTE_LOG(ERR, SPP_FLOW,
+			"Memory allocation failure(%s:%d)\n",
+			__func__, __LINE__);
+		return -1;
+	}
+	memset(rules + port->nof_slots, 0,
+		sizeof(struct flow_rule *) * (nof_slots - port->nof_slots));
+	port->rules = rules;
+
+	free_ids = realloc(port->free_ids, sizeof(uint32_t) * nof_slots);
+	if (free_ids == NULL) {
+		RTE_LOG(ERR, SPP_FLOW,
+			"Memory allocation failure(%s:%d)\n",
+			__func__, __LINE__);
+		return -1;
+	}
+	port->free_ids = free_ids;
+	port->nof_slots = nof_slots;
+	return 0;
+}
+
+/* Find "count" action in actions, or return NULL if it is not included. */
+static const struct rte_flow_action *
+find_count_action(const struct rte_flow_action *actions)
+{
+	const struct rte_flow_action *act;
+
+	for (act = actions; act->type != RTE_FLOW_ACTION_TYPE_END; act++) {
+		if (act->type == RTE_FLOW_ACTION_TYPE_COUNT)
+			return act;
+	}
+
+	return NULL;
+}
+
+/*
+ * Return actions with "count" appended if it is not included and accepted
+ * by the PMD, so that hit counters of the rule can be retrieved. Returned
+ * actions must be freed if it is not the given one.
+ */
+static struct rte_flow_action *
+attach_count_action(int port_id,
+	struct rte_flow_attr *attr,
+	struct rte_flow_item *pattern,
+	struct rte_flow_action *actions)
+{
+	int ret;
+	int nof_actions = 0;
+	struct rte_flow_action *new_actions;
+	struct rte_flow_error error;
+
+	if (find_count_action(actions) != NULL)
+		return actions;
+
+	while (actions[nof_actions].type != RTE_FLOW_ACTION_TYPE_END)
+		nof_actions++;
+
+	new_actions = calloc(nof_actions + 2, sizeof(struct rte_flow_action));
+	if (new_actions == NULL)
+		return actions;
+
+	/* Default counter is used because conf of count is NULL. */
+	memcpy(new_actions, actions,
+		sizeof(struct rte_flow_action) * nof_actions);
+	new_actions[nof_actions].type = RTE_FLOW_ACTION_TYPE_COUNT;
+	new_actions[nof_actions + 1].type = RTE_FLOW_ACTION_TYPE_END;
+
+	memset(&error, 0, sizeof(error));
+	ret = rte_flow_validate(port_id, attr, pattern, new_actions, &error);
+	if (ret != 0) {
+		RTE_LOG(DEBUG, SPP_FLOW,
+			"Count action is not supported on port %d(%s:%d)\n",
+			port_id, __func__, __LINE__);
+		free(new_actions);
+		return actions;
+	}
+
+	return new_actions;
+}
+
+/*
+ * Save a flow rule globally indexed with a new rule ID. Rule ID of
+ * destroyed flow is reused if exists. Return the rule ID, or -1 if failed.
+ */
+static int64_t
+save_flow_rule(int port_id, struct flow_rule *rule, const char **err_msg)
+{
+	int ret;
+	uint32_t rule_id;
+	struct port_flow *port = &port_list[port_id];
+
+	if (port->nof_free_ids > 0)
+		rule_id = port->free_ids[--port->nof_free_ids];
+	else {
+		if (port->next_rule_id >= UINT32_MAX) {
+			*err_msg = "No more rule ID is available";
+			return -1;
+		}
+		if (port->next_rule_id >= port->nof_slots) {
+			ret = extend_flow_rules(port);
+			if (ret != 0) {
+				*err_msg = "Failed to extend flow rules";
+				return -1;
+			}
+		}
+		rule_id = port->next_rule_id++;
+	}
+
+	rule->rule_id = rule_id;
+	port->rules[rule_id] = rule;
+
+	/* Append to the tail of live rules. */
+	rule->next = NULL;
+	rule->prev = port->tail;
+	if (port->tail != NULL)
+		port->tail->next = rule;
+	else
+		port->head = rule;
+	port->tail = rule;
+	port->nof_rules++;
+
+	return rule_id;
+}
+
+/* Remove a saved flow rule and make its rule ID free for next one. */
 static void
-exec_flow_create(int port_id,
+remove_flow_rule(struct port_flow *port, struct flow_rule *rule)
+{
+	if (rule->prev != NULL)
+		rule->prev->next = rule->next;
+	else
+		port->head = rule->next;
+	if (rule->next != NULL)
+		rule->next->prev = rule->prev;
+	else
+		port->tail = rule->prev;
+
+	port->rules[rule->rule_id] = NULL;
+	port->free_ids[port->nof_free_ids++] = rule->rule_id;
+	port->nof_rules--;
+}
+
+/*
+ * Install a flow rule rejected by the device in software flow engine, and
+ * save it globally. `error` is the reason of rejection by the device.
+ */
+static void
+create_sw_flow(int port_id,
 	struct rte_flow_attr *attr,
 	struct rte_flow_item *pattern,
 	struct rte_flow_action *actions,
+	struct rte_flow_error error,
 	char *response)
 {
-	uint32_t rule_id;
+	int64_t rule_id;
+	char mes[128];
+	char rule_id_str[11] = {0};
+	const char *err_msg;
+	struct flow_rule *rule;
+
+	rule = create_flow_rule(attr, pattern, actions, &error);
+	if (rule == NULL) {
+		make_error_response(response, "Flow create error", error,
+			rule_id_str);
+		return;
+	}
+
+	/* Rule ID is assigned first because counters are indexed with it. */
+	rule_id = save_flow_rule(port_id, rule, &err_msg);
+	if (rule_id < 0) {
+		free(rule);
+		make_response(response, "error", err_msg, rule_id_str);
+		return;
+	}
+
+	rule->sw_rule = sw_flow_create(port_id, (uint32_t)rule_id, attr,
+		pattern, actions, &err_msg);
+	if (rule->sw_rule == NULL) {
+		remove_flow_rule(&port_list[port_id], rule);
+		free(rule);
+		snprintf(mes, sizeof(mes), "Flow create error, software: %s",
+			err_msg);
+		make_error_response(response, mes, error, rule_id_str);
+		return;
+	}
+
+	sprintf(mes, "Flow rule #%d created in software", (int)rule_id);
+	sprintf(rule_id_str, "%d", (int)rule_id);
+	make_response(response, "success", mes, rule_id_str);
+}
+
+/*
+ * Create flow and save it globally with given actions as is. If the device
+ * rejects it, it is installed in software flow engine if enabled.
+ */
+static void
+create_flow(int port_id,
+	struct rte_flow_attr *attr,
+	struct rte_flow_item *pattern,
+	struct rte_flow_action *actions,
+	char *response)
+{
+	int64_t rule_id;
 	char mes[32];
 	char rule_id_str[11] = {0};
+	const char *err_msg;
 	struct rte_flow_error error;
 	struct rte_flow *flow;
 	struct flow_rule *rule;
-	struct port_flow *port;
 
 	memset(&error, 0, sizeof(error));
 
 	flow = rte_flow_create(port_id, attr, pattern, actions, &error);
 	if (flow == NULL) {
-		make_error_response(response, "Flow create error", error,
-			rule_id_str);
+		if (get_flow_sw_fallback_flg() == 1)
+			create_sw_flow(port_id, attr, pattern, actions, error,
+				response);
+		else
+			make_error_response(response, "Flow create error",
+				error, rule_id_str);
 		return;
 	}
 
-	port = &port_list[port_id];
-	if (port->flow_list != NULL) {
-		if (port->flow_list->rule_id >= UINT32_MAX) {
-			make_response(response, "error",
-				"Rule ID must be less than %"PRIu32,
-				rule_id_str);
-			rte_flow_destroy(port_id, flow, NULL);
-			return;
-		}
-		rule_id = port->flow_list->rule_id + 1;
-	} else {
-		rule_id = 0;
-	}
-
 	rule = create_flow_rule(attr, pattern, actions, &error);
 	if (rule == NULL) {
 		rte_flow_destroy(port_id, flow, NULL);
@@ -562,31 +953,51 @@ exec_flow_create(int port_id,
 			rule_id_str);
 		return;
 	}
-
-	/* Keep it globally as a list */
-	rule->rule_id = rule_id;
 	rule->flow_handle = flow;
 
-	if (port->flow_list == NULL)
-		rule->prev = NULL;
-	else
-		rule->prev = port->flow_list;
-
-	port->flow_list = rule;
+	/* Keep it globally indexed with rule ID */
+	rule_id = save_flow_rule(port_id, rule, &err_msg);
+	if (rule_id < 0) {
+		rte_flow_destroy(port_id, flow, NULL);
+		free(rule);
+		make_response(response, "error", err_msg, rule_id_str);
+		return;
+	}
 
-	sprintf(mes, "Flow rule #%d created", rule_id);
-	sprintf(rule_id_str, "%d", rule_id);
+	sprintf(mes, "Flow rule #%d created", (int)rule_id);
+	sprintf(rule_id_str, "%d", (int)rule_id);
 	make_response(response, "success", mes, rule_id_str);
 }
 
+/*
+ * Execute rte_flow_create(). Save flow rules globally. "count" action is
+ * attached if possible for getting hit counters of each rule.
+ */
+static void
+exec_flow_create(int port_id,
+	struct rte_flow_attr *attr,
+	struct rte_flow_item *pattern,
+	struct rte_flow_action *actions,
+	char *response)
+{
+	struct rte_flow_action *flow_actions;
+
+	flow_actions = attach_count_action(port_id, attr, pattern, actions);
+
+	create_flow(port_id, attr, pattern, flow_actions, response);
+
+	if (flow_actions != actions)
+		free(flow_actions);
+}
+
 /* Execute rte_flow_destroy(). Destroying a globally saved flow rule */
 static void
 exec_flow_destroy(int port_id, uint32_t rule_id, char *response)
 {
 	int ret;
-	int found_flg = 0;
 	char mes[64];
-	struct flow_rule *rule, **next_ptr;
+	struct flow_rule *rule;
+	struct port_flow *port;
 	struct rte_flow_error error;
 
 	memset(&error, 0, sizeof(error));
@@ -598,38 +1009,122 @@ exec_flow_destroy(int port_id, uint32_t rule_id, char *response)
 		return;
 	}
 
-	next_ptr = &(port_list[port_id].flow_list);
-	rule = port_list[port_id].flow_list;
+	port = &port_list[port_id];
+	if (rule_id >= port->nof_slots || port->rules[rule_id] == NULL) {
+		sprintf(mes, "Flow rule #%d not found", rule_id);
+		make_response(response, "error", mes, NULL);
+		return;
+	}
+	rule = port->rules[rule_id];
 
-	while (rule != NULL) {
-		if (rule->rule_id != rule_id) {
-			next_ptr = &(rule->prev);
-			rule = rule->prev;
-			continue;
+	if (rule->sw_rule != NULL) {
+		ret = sw_flow_destroy(port_id, rule->sw_rule);
+		if (ret != 0) {
+			make_response(response, "error",
+				"Flow destroy error, software", NULL);
+			return;
 		}
-
+	} else {
 		ret = rte_flow_destroy(port_id, rule->flow_handle, &error);
 		if (ret != 0) {
 			make_error_response(response, "Flow destroy error",
 				error, NULL);
 			return;
 		}
+	}
 
-		/* Remove flow from global list */
-		*next_ptr = rule->prev;
-		free(rule);
-		found_flg = 1;
+	/* Remove flow from global rules */
+	remove_flow_rule(port, rule);
+	free(rule);
 
-		sprintf(mes, "Flow rule #%d destroyed", rule_id);
-		make_response(response, "success", mes, NULL);
-		break;
+	sprintf(mes, "Flow rule #%d destroyed", rule_id);
+	make_response(response, "success", mes, NULL);
+}
+
+/* Execute rte_flow_query() for "count" action of a saved flow rule */
+static void
+exec_flow_query(int port_id, uint32_t rule_id, char *response)
+{
+	int ret;
+	char mes[64];
+	struct flow_rule *rule;
+	struct port_flow *port;
+	const struct rte_flow_action *action;
+	struct rte_flow_query_count count;
+	struct rte_flow_error error;
+
+	memset(&error, 0, sizeof(error));
+	memset(&count, 0, sizeof(count));
+
+	ret = is_portid_used(port_id);
+	if (ret != 0) {
+		sprintf(mes, "Invalid port %d", port_id);
+		make_response(response, "error", mes, NULL);
+		return;
 	}
 
-	/* Rule_id not found */
-	if (found_flg == 0) {
+	port = &port_list[port_id];
+	if (rule_id >= port->nof_slots || port->rules[rule_id] == NULL) {
 		sprintf(mes, "Flow rule #%d not found", rule_id);
 		make_response(response, "error", mes, NULL);
+		return;
+	}
+	rule = port->rules[rule_id];
+
+	action = find_count_action(rule->rule.actions_ro);
+	if (rule->sw_rule != NULL) {
+		/* Packets are always counted in software. */
+		sw_flow_query_count(port_id, rule->sw_rule, &count);
+	} else if (action == NULL) {
+		sprintf(mes, "Flow rule #%d has no count action", rule_id);
+		make_response(response, "error", mes, NULL);
+		return;
+	} else {
+		ret = rte_flow_query(port_id, rule->flow_handle, action,
+			&count, &error);
+		if (ret != 0) {
+			make_error_response(response, "Flow query error",
+				error, NULL);
+			return;
+		}
+	}
+
+	snprintf(response, MSG_SIZE,
+		"{\"result\": \"success\", "
+		"\"message\": \"Flow rule #%d queried\", "
+		"\"rule_id\": \"%d\", "
+		"\"count\": {\"hits_set\": %d, \"bytes_set\": %d, "
+		"\"hits\": %"PRIu64", \"bytes\": %"PRIu64"}}",
+		rule_id, rule_id, count.hits_set, count.bytes_set,
+		count.hits, count.bytes);
+}
+
+/* Send hit counters of all flow rules of the port */
+static void
+exec_flow_stats(int port_id, char *response)
+{
+	int ret;
+	char mes[64];
+	struct flow_json_buf buf = { 0 };
+
+	ret = is_portid_used(port_id);
+	if (ret != 0) {
+		sprintf(mes, "Invalid port %d", port_id);
+		make_response(response, "error", mes, NULL);
+		return;
 	}
+
+	ret = make_flow_stats_json(port_id, &buf);
+	if (ret == 0 && (int)buf.len > MSG_SIZE - 1)
+		ret = -1;
+
+	if (ret == 0)
+		memcpy(response, buf.str, buf.len + 1);
+	else
+		make_response(response, "error",
+			"Cannot send all of flow stats", NULL);
+
+	free(buf.str);
 }
 
 /* Delete all globally saved flow rules */
@@ -638,7 +1133,8 @@ exec_flow_flush(int port_id, char *response)
 {
 	int ret;
 	char mes[64];
-	struct flow_rule *rule;
+	struct flow_rule *rule, *next;
+	struct port_flow *port;
 	struct rte_flow_error error;
 
 	memset(&error, 0, sizeof(error));
@@ -650,7 +1146,15 @@ exec_flow_flush(int port_id, char *response)
 		return;
 	}
 
+	/* Rules in software flow engine are released with the saved ones. */
+	sw_flow_flush(port_id);
+
+	/* Device without flow API can have rules only in software. */
 	ret = rte_flow_flush(port_id, &error);
+	if (ret != 0 && rte_errno == ENOSYS &&
+			get_flow_sw_fallback_flg() == 1)
+		ret = 0;
+
 	if (ret != 0)
 		make_error_response(response, "Flow destroy error",
 			error, NULL);
@@ -660,14 +1164,21 @@ exec_flow_flush(int port_id, char *response)
 
 	/*
 	 * Even if a failure occurs, flow handle is invalidated,
-	 * so delete flow_list.
+	 * so delete all of rules.
 	 */
-
-	while (port_list[port_id].flow_list != NULL) {
-		rule = port_list[port_id].flow_list->prev;
-		free(port_list[port_id].flow_list);
-		port_list[port_id].flow_list = rule;
+	port = &port_list[port_id];
+	rule = port->head;
+	while (rule != NULL) {
+		next = rule->next;
+		port->rules[rule->rule_id] = NULL;
+		free(rule);
+		rule = next;
 	}
+	port->head = NULL;
+	port->tail = NULL;
+	port->nof_free_ids = 0;
+	port->next_rule_id = 0;
+	port->nof_rules = 0;
 }
 
 static void
@@ -696,6 +1207,14 @@ exec_flow(struct flow_args *input, char *response)
 	case FLUSH:
 		exec_flow_flush(input->port_id, response);
 		break;
+	case QUERY:
+		exec_flow_query(input->port_id,
+			input->args.query.rule_id,
+			response);
+		break;
+	case STATS:
+		exec_flow_stats(input->port_id, response);
+		break;
 	}
 
 	/* Argument data is no longer needed and freed */
@@ -721,6 +1240,14 @@ parse_flow(char *token_list[], char *response)
 	} else if (!strcmp(token_list[1], "destroy")) {
 		ret = parse_flow_destroy(token_list, &input);
 
+	} else if (!strcmp(token_list[1], "query")) {
+		input.command = QUERY;
+		ret = parse_flow_query(token_list, &input);
+
+	} else if (!strcmp(token_list[1], "stats")) {
+		input.command = STATS;
+		ret = parse_flow_stats(token_list, &input);
+
 	} else {
 		ret = -1;
 	}
@@ -737,29 +1264,103 @@ parse_flow(char *token_list[], char *response)
 	return 0;
 }
 
+/* Extend buffer to have free space of given length at least. */
 static int
-append_flow_pattern_json(const struct rte_flow_item *pattern, int buf_size,
-	char *pattern_str)
+flow_json_reserve(struct flow_json_buf *buf, size_t len)
 {
-	uint32_t i, j;
-	uint32_t nof_elems = 3;
-	int ret = 0;
-	char *tmp_str;
-	const char element_str[][5] = { "spec", "last", "mask" };
-	const struct rte_flow_item *ptn = pattern;
-	struct flow_item_ops *ops;
-	const void *tmp_ptr[nof_elems];
+	size_t size;
+	char *str;
+
+	if (buf->len + len + 1 <= buf->size)
+		return 0;
+
+	size = (buf->size == 0) ? FLOW_JSON_BUF_INIT_SIZE : buf->size;
+	while (size < buf->len + len + 1)
+		size *= 2;
 
-	tmp_str = malloc(buf_size);
-	if (tmp_str == NULL) {
+	str = realloc(buf->str, size);
+	if (str == NULL) {
 		RTE_LOG(ERR, SPP_FLOW,
 			"Memory allocation failure(%s:%d)\n",
 			__func__, __LINE__);
 		return -1;
 	}
 
-	while (ptn->type != RTE_FLOW_ITEM_TYPE_END) {
-		memset(tmp_str, 0, buf_size);
+	buf->str = str;
+	buf->size = size;
+	return 0;
+}
+
+/* Append formatted string to the end of buffer. */
+static int
+flow_json_printf(struct flow_json_buf *buf, const char *fmt, ...)
+{
+	int len;
+	va_list ap;
+
+	va_start(ap, fmt);
+	len = vsnprintf(NULL, 0, fmt, ap);
+	va_end(ap);
+	if (len < 0 || flow_json_reserve(buf, len) != 0)
+		return -1;
+
+	va_start(ap, fmt);
+	vsnprintf(buf->str + buf->len, len + 1, fmt, ap);
+	va_end(ap);
+	buf->len += len;
+	return 0;
+}
+
+/*
+ * Append an element with status callback of attr, item or action. It is
+ * given empty space at the end of buffer, so only appended string is
+ * scanned for getting its length.
+ */
+static int
+flow_json_append_elem(struct flow_json_buf *buf,
+	int (*status)(const void *elem, int buf_size, char *str),
+	const void *elem)
+{
+	int ret;
+
+	if (flow_json_reserve(buf, FLOW_JSON_ELEM_SIZE) != 0)
+		return -1;
+
+	buf->str[buf->len] = '\0';
+	ret = status(elem, FLOW_JSON_ELEM_SIZE, buf->str + buf->len);
+	if (ret != 0)
+		return ret;
+
+	buf->len += strlen(buf->str + buf->len);
+	return 0;
+}
+
+/* Wrapper of append_flow_attr_json() called from flow_json_append_elem(). */
+static int
+append_attr_elem_json(const void *attr, int buf_size, char *attr_str)
+{
+	return append_flow_attr_json(attr, buf_size, attr_str);
+}
+
+static int
+append_flow_pattern_json(const struct rte_flow_item *pattern,
+	struct flow_json_buf *buf)
+{
+	uint32_t i, j;
+	uint32_t nof_elems = 3;
+	int ret = 0;
+	const char element_str[][5] = { "spec", "last", "mask" };
+	const struct rte_flow_item *ptn;
+	struct flow_item_ops *ops;
+	const void *tmp_ptr[nof_elems];
+
+	for (ptn = pattern; ptn->type != RTE_FLOW_ITEM_TYPE_END; ptn++) {
+		/* Add ',' before the item if it is not the first one. */
+		if (ptn != pattern) {
+			ret = flow_json_printf(buf, ",");
+			if (ret != 0)
+				break;
+		}
 
 		tmp_ptr[0] = ptn->spec;
 		tmp_ptr[1] = ptn->last;
@@ -770,276 +1371,272 @@ append_flow_pattern_json(const struct rte_flow_item *pattern, int buf_size,
 			if (ptn->type != ops->type)
 				continue;
 
-			snprintf(tmp_str, buf_size,
-				"{\"type\":\"%s\",",
+			ret = flow_json_printf(buf, "{\"type\":\"%s\"",
 				ops->str_type);
 
-			for (j = 0; j < nof_elems; j++) {
-				snprintf(tmp_str + strlen(tmp_str), buf_size,
-					"\"%s\":",
+			for (j = 0; j < nof_elems && ret == 0; j++) {
+				ret = flow_json_printf(buf, ",\"%s\":",
 					element_str[j]);
-
-				if (tmp_ptr[j] != NULL)
-					ret = ops->status(tmp_ptr[j],
-						buf_size - (int)strlen(tmp_str),
-						tmp_str + strlen(tmp_str));
-				else
-					snprintf(tmp_str + strlen(tmp_str),
-						buf_size,
-						"null");
-
 				if (ret != 0)
 					break;
 
-				if (j < nof_elems - 1)
-					tmp_str[strlen(tmp_str)] = ',';
+				if (tmp_ptr[j] != NULL)
+					ret = flow_json_append_elem(buf,
+						ops->status, tmp_ptr[j]);
+				else
+					ret = flow_json_printf(buf, "null");
 			}
 
-			tmp_str[strlen(tmp_str)] = '}';
-
+			if (ret == 0)
+				ret = flow_json_printf(buf, "}");
 			break;
 		}
 
 		if (ret != 0)
 			break;
-
-		if ((int)strlen(pattern_str) + (int)strlen(tmp_str)
-			> buf_size - 1) {
-			ret = -1;
-			break;
-		}
-		strncat(pattern_str, tmp_str, strlen(tmp_str));
-
-		/*
-		 * If there is the following pattern, add ',' to
-		 * pattern_str
-		 */
-		ptn++;
-		if (ptn->type != RTE_FLOW_ITEM_TYPE_END) {
-			if ((int)strlen(pattern_str) + 1 > buf_size - 1) {
-				ret = -1;
-				break;
-			}
-			pattern_str[strlen(pattern_str)] = ',';
-		}
 	}
 
-	if (tmp_str != NULL)
-		free(tmp_str);
-
 	return ret;
 }
 
 static int
-append_flow_action_json(const struct rte_flow_action *actions, int buf_size,
-	char *actions_str)
+append_flow_action_json(const struct rte_flow_action *actions,
+	struct flow_json_buf *buf)
 {
 	uint32_t i;
 	int ret = 0;
-	char *tmp_str;
-	const struct rte_flow_action *act = actions;
+	const struct rte_flow_action *act;
 	struct flow_action_ops *ops;
 
-	tmp_str = malloc(buf_size);
-	if (tmp_str == NULL) {
-		RTE_LOG(ERR, SPP_FLOW,
-			"Memory allocation failure(%s:%d)\n",
-			__func__, __LINE__);
-		return -1;
-	}
-
-	while (act->type != RTE_FLOW_ACTION_TYPE_END) {
-		memset(tmp_str, 0, buf_size);
+	for (act = actions; act->type != RTE_FLOW_ACTION_TYPE_END; act++) {
+		/* Add ',' before the action if it is not the first one. */
+		if (act != actions) {
+			ret = flow_json_printf(buf, ",");
+			if (ret != 0)
+				break;
+		}
 
 		for (i = 0; i < RTE_DIM(flow_action_ops_list); i++) {
 			ops = &flow_action_ops_list[i];
 			if (act->type != ops->type)
 				continue;
 
-			snprintf(tmp_str, buf_size,
+			ret = flow_json_printf(buf,
 				"{\"type\":\"%s\",\"conf\":",
 				ops->str_type);
-
-			ret = ops->status(act->conf,
-				buf_size - (int)strlen(tmp_str),
-				tmp_str + strlen(tmp_str));
-			tmp_str[strlen(tmp_str)] = '}';
+			if (ret == 0)
+				ret = flow_json_append_elem(buf, ops->status,
+					act->conf);
+			if (ret == 0)
+				ret = flow_json_printf(buf, "}");
 			break;
 		}
 
 		if (ret != 0)
 			break;
+	}
 
-		if ((int)strlen(actions_str) + (int)strlen(tmp_str)
-			> buf_size - 1) {
-			ret = -1;
-			break;
+	return ret;
+}
+
+/*
+ * Query hit counters of all flow rules of the port. rte_flow does not
+ * have API for querying several flows at once, so query each of rules
+ * in a loop and keep the results in the rules.
+ */
+static void
+query_flow_counts(int port_id)
+{
+	int ret;
+	struct flow_rule *rule;
+	const struct rte_flow_action *action;
+	struct rte_flow_error error;
+	struct port_flow *port = &port_list[port_id];
+
+	for (rule = port->head; rule != NULL; rule = rule->next) {
+		if (rule->sw_rule != NULL) {
+			sw_flow_query_count(port_id, rule->sw_rule,
+				&rule->count);
+			continue;
 		}
-		strncat(actions_str, tmp_str, strlen(tmp_str));
 
-		/*
-		 * If there is the following pattern, add ',' to
-		 * actions_str
-		 */
-		act++;
-		if (act->type != RTE_FLOW_ACTION_TYPE_END) {
-			if ((int)strlen(actions_str) + 1 > buf_size - 1) {
-				ret = -1;
-				break;
-			}
-			actions_str[strlen(actions_str)] = ',';
+		memset(&rule->count, 0, sizeof(rule->count));
+		action = find_count_action(rule->rule.actions_ro);
+		if (action == NULL)
+			continue;
+
+		memset(&error, 0, sizeof(error));
+		ret = rte_flow_query(port_id, rule->flow_handle, action,
+			&rule->count, &error);
+		if (ret != 0) {
+			RTE_LOG(DEBUG, SPP_FLOW,
+				"Failed to query flow rule #%d(%s:%d)\n",
+				rule->rule_id, __func__, __LINE__);
+			memset(&rule->count, 0, sizeof(rule->count));
 		}
 	}
+}
+
+/*
+ * Append hit counters of the rule as `{"packets":N,"bytes":N}`. Counter
+ * which is not supported by the PMD is null.
+ */
+static int
+append_flow_count_json(struct flow_rule *flow, struct flow_json_buf *buf)
+{
+	int ret;
 
-	if (tmp_str != NULL)
-		free(tmp_str);
+	if (flow->count.hits_set)
+		ret = flow_json_printf(buf, "{\"packets\":%"PRIu64,
+			flow->count.hits);
+	else
+		ret = flow_json_printf(buf, "{\"packets\":null");
+	if (ret != 0)
+		return ret;
+
+	if (flow->count.bytes_set)
+		ret = flow_json_printf(buf, ",\"bytes\":%"PRIu64"}",
+			flow->count.bytes);
+	else
+		ret = flow_json_printf(buf, ",\"bytes\":null}");
 
 	return ret;
 }
 
 static int
-append_flow_rule_json(struct flow_rule *flow, int buf_size, char *flow_str)
+append_flow_rule_json(struct flow_rule *flow, struct flow_json_buf *buf)
 {
-	int ret = 0;
-	struct rte_flow_conv_rule rule;
-	char *tmp_str, *attr_str, *pattern_str, *actions_str;
-
-	while (1) {
-		tmp_str = malloc(buf_size);
-		attr_str = malloc(buf_size);
-		pattern_str = malloc(buf_size);
-		actions_str = malloc(buf_size);
-		if (tmp_str == NULL || attr_str == NULL
-			|| pattern_str == NULL || actions_str == NULL) {
-			RTE_LOG(ERR, SPP_FLOW,
-				"Memory allocation failure(%s:%d)\n",
-				__func__, __LINE__);
-			ret = -1;
-			break;
-		}
-		memset(tmp_str, 0, buf_size);
-		memset(attr_str, 0, buf_size);
-		memset(pattern_str, 0, buf_size);
-		memset(actions_str, 0, buf_size);
+	int ret;
+	const struct rte_flow_conv_rule *rule = &flow->rule;
 
-		rule = flow->rule;
+	ret = flow_json_printf(buf, "{\"rule_id\":%d,\"engine\":\"%s\","
+		"\"attr\":", flow->rule_id,
+		flow->sw_rule != NULL ? "sw" : "hw");
+	if (ret != 0)
+		return ret;
 
-		ret = append_flow_attr_json(rule.attr_ro, buf_size, attr_str);
-		if (ret != 0)
-			break;
+	ret = flow_json_append_elem(buf, append_attr_elem_json,
+		rule->attr_ro);
+	if (ret != 0)
+		return ret;
 
-		ret = append_flow_pattern_json(rule.pattern_ro, buf_size,
-			pattern_str);
-		if (ret != 0)
-			break;
+	ret = flow_json_printf(buf, ",\"patterns\":[");
+	if (ret != 0)
+		return ret;
 
-		ret = append_flow_action_json(rule.actions_ro, buf_size,
-			actions_str);
-		if (ret != 0)
-			break;
+	ret = append_flow_pattern_json(rule->pattern_ro, buf);
+	if (ret != 0)
+		return ret;
 
-		snprintf(tmp_str, buf_size,
-			"{\"rule_id\":%d,"
-			"\"attr\":%s,"
-			"\"patterns\":[%s],"
-			"\"actions\":[%s]}",
-			flow->rule_id, attr_str, pattern_str, actions_str);
+	ret = flow_json_printf(buf, "],\"actions\":[");
+	if (ret != 0)
+		return ret;
 
-		if ((int)strlen(tmp_str) > buf_size - 1) {
-			ret = -1;
-			break;
-		}
+	ret = append_flow_action_json(rule->actions_ro, buf);
+	if (ret != 0)
+		return ret;
 
-		snprintf(flow_str, buf_size, "%s", tmp_str);
-		break;
-	}
+	ret = flow_json_printf(buf, "],\"count\":");
+	if (ret != 0)
+		return ret;
 
-	if (tmp_str != NULL)
-		free(tmp_str);
-	if (attr_str != NULL)
-		free(attr_str);
-	if (pattern_str != NULL)
-		free(pattern_str);
-	if (actions_str != NULL)
-		free(actions_str);
+	ret = append_flow_count_json(flow, buf);
+	if (ret != 0)
+		return ret;
 
-	return ret;
+	return flow_json_printf(buf, "}");
 }
 
-int
-append_flow_json(int port_id, int buf_size, char *output)
+/*
+ * Serialize all of flow rules of the port in JSON. Rules are appended in
+ * order of creation with a single pass over live rules into growable buffer.
+ */
+static int
+make_flow_list_json(int port_id, struct flow_json_buf *buf)
 {
-	int ret = 0;
-	int str_size = 0;
-	char *flow_str, *tmp_str;
-	struct flow_rule *flow;
+	int ret;
+	int is_first = 1;
+	struct flow_rule *rule;
+	struct port_flow *port = &port_list[port_id];
 
-	flow_str = malloc(buf_size);
-	tmp_str = malloc(buf_size);
-	if (flow_str == NULL || tmp_str == NULL) {
-		RTE_LOG(ERR, SPP_FLOW,
-			"Memory allocation failure(%s:%d)\n",
-			__func__, __LINE__);
-		return -1;
-	}
+	query_flow_counts(port_id);
 
-	flow = port_list[port_id].flow_list;
+	ret = flow_json_printf(buf, "[");
+	if (ret != 0)
+		return ret;
 
-	while (flow != NULL) {
-		memset(flow_str, 0, buf_size);
+	for (rule = port->head; rule != NULL; rule = rule->next) {
+		if (!is_first) {
+			ret = flow_json_printf(buf, ",");
+			if (ret != 0)
+				return ret;
+		}
+		is_first = 0;
 
-		ret = append_flow_rule_json(flow, buf_size, flow_str);
+		ret = append_flow_rule_json(rule, buf);
 		if (ret != 0)
-			break;
+			return ret;
+	}
 
-		if (str_size == 0) {
-			snprintf(output, buf_size, "%s", flow_str);
-			str_size += (int)strlen(flow_str);
+	return flow_json_printf(buf, "]");
+}
 
-		} else {
-			str_size += ((int)strlen(flow_str) + 1);
-			if (str_size > buf_size - 1) {
-				ret = -1;
-				break;
-			}
+/*
+ * Serialize hit counters of all flow rules of the port as a response of
+ * stats command.
+ */
+static int
+make_flow_stats_json(int port_id, struct flow_json_buf *buf)
+{
+	int ret;
+	int is_first = 1;
+	struct flow_rule *rule;
+	struct port_flow *port = &port_list[port_id];
 
-			/*
-			 * Since flow_list is in descending order,
-			 * concatenate the strings in front.
-			 */
-			memset(tmp_str, 0, buf_size);
-			strncpy(tmp_str, output, buf_size);
-			memset(output, 0, buf_size);
+	query_flow_counts(port_id);
 
-			snprintf(output, buf_size, "%s,%s",
-				flow_str, tmp_str);
-		}
+	ret = flow_json_printf(buf,
+		"{\"result\": \"success\", \"port_id\": %d, \"stats\": [",
+		port_id);
+	if (ret != 0)
+		return ret;
 
-		flow = flow->prev;
-	}
+	for (rule = port->head; rule != NULL; rule = rule->next) {
+		ret = flow_json_printf(buf, "%s{\"rule_id\":%d,\"count\":",
+			is_first ? "" : ",", rule->rule_id);
+		if (ret != 0)
+			return ret;
+		is_first = 0;
 
-	if (ret == 0) {
-		if ((int)strlen("[]") + (int)strlen(flow_str)
-			> buf_size - 1)
-			ret = -1;
-		else {
-			memset(tmp_str, 0, buf_size);
-			strncpy(tmp_str, output, buf_size);
-			memset(output, 0, buf_size);
-
-			snprintf(output, buf_size, "[%s]", tmp_str);
-		}
+		ret = append_flow_count_json(rule, buf);
+		if (ret != 0)
+			return ret;
+
+		ret = flow_json_printf(buf, "}");
+		if (ret != 0)
+			return ret;
 	}
 
-	if (ret != 0)
+	return flow_json_printf(buf, "]}");
+}
+
+int
+append_flow_json(int port_id, int buf_size, char *output)
+{
+	int ret;
+	struct flow_json_buf buf = { 0 };
+
+	ret = make_flow_list_json(port_id, &buf);
+	if (ret == 0 && (int)buf.len > buf_size - 1)
+		ret = -1;
+
+	if (ret == 0)
+		memcpy(output, buf.str, buf.len + 1);
+	else
 		RTE_LOG(ERR, SPP_FLOW,
 			"Cannot send all of flow stats(%s:%d)\n",
 			__func__, __LINE__);
 
-	if (flow_str != NULL)
-		free(flow_str);
-	if (tmp_str != NULL)
-		free(tmp_str);
-
+	free(buf.str);
 	return ret;
 }
@@ -7,13 +7,17 @@
 
 #include <rte_log.h>
 
+#include "primary/flow/sw_flow.h"
+
 #define RTE_LOGTYPE_SPP_FLOW RTE_LOGTYPE_USER1
 
 enum flow_command {
 	VALIDATE = 0,
 	CREATE,
 	DESTROY,
-	FLUSH
+	FLUSH,
+	QUERY,
+	STATS
 };
 
 /* Parser result of flow command arguments */
@@ -29,6 +33,9 @@ struct flow_args {
 		struct {
 			uint32_t rule_id;
 		} destroy; /* destroy arguments. */
+		struct {
+			uint32_t rule_id;
+		} query; /* query arguments. */
 	} args;
 };
 
@@ -37,20 +44,46 @@ struct flow_rule {
 	/* Flow rule ID */
 	uint32_t rule_id;
 
-	/* Previous flow in list. */
+	/* Previous and next flows in list of live rules. */
 	struct flow_rule *prev;
+	struct flow_rule *next;
 
 	/* Opaque flow object returned by PMD. */
 	struct rte_flow *flow_handle;
 
+	/* Rule installed in software flow engine, or NULL if in the device. */
+	struct sw_flow_rule *sw_rule;
+
+	/* Hit counters retrieved with the latest query of "count" action. */
+	struct rte_flow_query_count count;
+
 	/* Saved flow rule description. */
 	struct rte_flow_conv_rule rule;
 };
 
-/* Flow rule list of the port */
+/* Flow rules of the port, indexed with rule ID */
 struct port_flow {
-	/* Associated flows */
-	struct flow_rule *flow_list;
+	/* Associated flows, or NULL for free rule ID. */
+	struct flow_rule **rules;
+
+	/* Number of allocated entries of rules and free_ids. */
+	uint32_t nof_slots;
+
+	/* Rule IDs of destroyed flows, reused before next_rule_id. */
+	uint32_t *free_ids;
+
+	/* Number of entries in free_ids. */
+	uint32_t nof_free_ids;
+
+	/* Rule ID assigned to next created flow if no free ID remains. */
+	uint32_t next_rule_id;
+
+	/* Live flows in order of creation. */
+	struct flow_rule *head;
+	struct flow_rule *tail;
+
+	/* Number of flows currently stored. */
+	uint32_t nof_rules;
 };
 
 /* Detail parse operation for a specific item or action */
@@ -0,0 +1,53 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2020 Nippon Telegraph and Telephone Corporation
+ */
+
+#include <inttypes.h>
+
+#include <rte_flow.h>
+#include <rte_byteorder.h>
+
+#include "primary/flow/flow.h"
+#include "primary/flow/common.h"
+#include "gtp.h"
+
+/* Define item "gtp" operations */
+struct flow_detail_ops gtp_ops_list[] = {
+	{
+		.token = "msg_type",
+		.offset = offsetof(struct rte_flow_item_gtp, msg_type),
+		.size = sizeof(uint8_t),
+		.flg_value = 1,
+		.parse_detail = str_to_uint8_t,
+	},
+	{
+		.token = "teid",
+		.offset = offsetof(struct rte_flow_item_gtp, teid),
+		.size = sizeof(rte_be32_t),
+		.flg_value = 1,
+		.parse_detail = str_to_rte_be32_t,
+	},
+	{
+		.token = NULL,
+	},
+};
+
+int
+append_item_gtp_json(const void *element, int buf_size, char *pattern_str)
+{
+	const struct rte_flow_item_gtp *gtp = element;
+	char tmp_str[64] = { 0 };
+
+	snprintf(tmp_str, 64,
+		"{\"msg_type\":%d,"
+		"\"teid\":%"PRIu32"}",
+		gtp->msg_type, rte_be_to_cpu_32(gtp->teid));
+
+	if ((int)strlen(pattern_str) + (int)strlen(tmp_str)
+		> buf_size)
+		return -1;
+
+	strncat(pattern_str, tmp_str, strlen(tmp_str));
+
+	return 0;
+}
@@ -0,0 +1,85 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2020 Nippon Telegraph and Telephone Corporation
+ */
+
+#include <arpa/inet.h>
+
+#include <rte_flow.h>
+
+#include "primary/flow/flow.h"
+#include "primary/flow/common.h"
+#include "ipv4.h"
+
+/* Define item "ipv4" operations */
+struct flow_detail_ops ipv4_ops_list[] = {
+	{
+		.token = "tos",
+		.offset = offsetof(struct rte_flow_item_ipv4,
+			hdr.type_of_service),
+		.size = sizeof(uint8_t),
+		.flg_value = 1,
+		.parse_detail = str_to_uint8_t,
+	},
+	{
+		.token = "ttl",
+		.offset = offsetof(struct rte_flow_item_ipv4,
+			hdr.time_to_live),
+		.size = sizeof(uint8_t),
+		.flg_value = 1,
+		.parse_detail = str_to_uint8_t,
+	},
+	{
+		.token = "proto",
+		.offset = offsetof(struct rte_flow_item_ipv4,
+			hdr.next_proto_id),
+		.size = sizeof(uint8_t),
+		.flg_value = 1,
+		.parse_detail = str_to_uint8_t,
+	},
+	{
+		.token = "src",
+		.offset = offsetof(struct rte_flow_item_ipv4, hdr.src_addr),
+		.size = sizeof(rte_be32_t),
+		.flg_value = 1,
+		.parse_detail = str_to_ipv4_addr,
+	},
+	{
+		.token = "dst",
+		.offset = offsetof(struct rte_flow_item_ipv4, hdr.dst_addr),
+		.size = sizeof(rte_be32_t),
+		.flg_value = 1,
+		.parse_detail = str_to_ipv4_addr,
+	},
+	{
+		.token = NULL,
+	},
+};
+
+int
+append_item_ipv4_json(const void *element, int buf_size, char *pattern_str)
+{
+	const struct rte_flow_item_ipv4 *ipv4 = element;
+	char src_str[INET_ADDRSTRLEN] = { 0 };
+	char dst_str[INET_ADDRSTRLEN] = { 0 };
+	char tmp_str[128] = { 0 };
+
+	inet_ntop(AF_INET, &ipv4->hdr.src_addr, src_str, INET_ADDRSTRLEN);
+	inet_ntop(AF_INET, &ipv4->hdr.dst_addr, dst_str, INET_ADDRSTRLEN);
+
+	snprintf(tmp_str, 128,
+		"{\"tos\":%d,"
+		"\"ttl\":%d,"
+		"\"proto\":%d,"
+		"\"src\":\"%s\","
+		"\"dst\":\"%s\"}",
+		ipv4->hdr.type_of_service, ipv4->hdr.time_to_live,
+		ipv4->hdr.next_proto_id, src_str, dst_str);
+
+	if ((int)strlen(pattern_str) + (int)strlen(tmp_str)
+		> buf_size)
+		return -1;
+
+	strncat(pattern_str, tmp_str, strlen(tmp_str));
+
+	return 0;
+}
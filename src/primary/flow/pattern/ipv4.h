@@ -0,0 +1,13 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2020 Nippon Telegraph and Telephone Corporation
+ */
+
+#ifndef _PRIMARY_FLOW_PATTERN_IPV4_H_
+#define _PRIMARY_FLOW_PATTERN_IPV4_H_
+
+extern struct flow_detail_ops ipv4_ops_list[];
+
+int append_item_ipv4_json(const void *element, int buf_size,
+	char *pattern_str);
+
+#endif
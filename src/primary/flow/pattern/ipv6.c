@@ -0,0 +1,73 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2020 Nippon Telegraph and Telephone Corporation
+ */
+
+#include <arpa/inet.h>
+
+#include <rte_flow.h>
+
+#include "primary/flow/flow.h"
+#include "primary/flow/common.h"
+#include "ipv6.h"
+
+/* Define item "ipv6" operations */
+struct flow_detail_ops ipv6_ops_list[] = {
+	{
+		.token = "proto",
+		.offset = offsetof(struct rte_flow_item_ipv6, hdr.proto),
+		.size = sizeof(uint8_t),
+		.flg_value = 1,
+		.parse_detail = str_to_uint8_t,
+	},
+	{
+		.token = "hop",
+		.offset = offsetof(struct rte_flow_item_ipv6, hdr.hop_limits),
+		.size = sizeof(uint8_t),
+		.flg_value = 1,
+		.parse_detail = str_to_uint8_t,
+	},
+	{
+		.token = "src",
+		.offset = offsetof(struct rte_flow_item_ipv6, hdr.src_addr),
+		.size = sizeof(((struct rte_ipv6_hdr *)0)->src_addr),
+		.flg_value = 1,
+		.parse_detail = str_to_ipv6_addr,
+	},
+	{
+		.token = "dst",
+		.offset = offsetof(struct rte_flow_item_ipv6, hdr.dst_addr),
+		.size = sizeof(((struct rte_ipv6_hdr *)0)->dst_addr),
+		.flg_value = 1,
+		.parse_detail = str_to_ipv6_addr,
+	},
+	{
+		.token = NULL,
+	},
+};
+
+int
+append_item_ipv6_json(const void *element, int buf_size, char *pattern_str)
+{
+	const struct rte_flow_item_ipv6 *ipv6 = element;
+	char src_str[INET6_ADDRSTRLEN] = { 0 };
+	char dst_str[INET6_ADDRSTRLEN] = { 0 };
+	char tmp_str[160] = { 0 };
+
+	inet_ntop(AF_INET6, ipv6->hdr.src_addr, src_str, INET6_ADDRSTRLEN);
+	inet_ntop(AF_INET6, ipv6->hdr.dst_addr, dst_str, INET6_ADDRSTRLEN);
+
+	snprintf(tmp_str, 160,
+		"{\"proto\":%d,"
+		"\"hop\":%d,"
+		"\"src\":\"%s\","
+		"\"dst\":\"%s\"}",
+		ipv6->hdr.proto, ipv6->hdr.hop_limits, src_str, dst_str);
+
+	if ((int)strlen(pattern_str) + (int)strlen(tmp_str)
+		> buf_size)
+		return -1;
+
+	strncat(pattern_str, tmp_str, strlen(tmp_str));
+
+	return 0;
+}
@@ -0,0 +1,61 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2020 Nippon Telegraph and Telephone Corporation
+ */
+
+#include <rte_flow.h>
+#include <rte_byteorder.h>
+
+#include "primary/flow/flow.h"
+#include "primary/flow/common.h"
+#include "tcp.h"
+
+/* Define item "tcp" operations */
+struct flow_detail_ops tcp_ops_list[] = {
+	{
+		.token = "src",
+		.offset = offsetof(struct rte_flow_item_tcp, hdr.src_port),
+		.size = sizeof(rte_be16_t),
+		.flg_value = 1,
+		.parse_detail = str_to_rte_be16_t,
+	},
+	{
+		.token = "dst",
+		.offset = offsetof(struct rte_flow_item_tcp, hdr.dst_port),
+		.size = sizeof(rte_be16_t),
+		.flg_value = 1,
+		.parse_detail = str_to_rte_be16_t,
+	},
+	{
+		.token = "flags",
+		.offset = offsetof(struct rte_flow_item_tcp, hdr.tcp_flags),
+		.size = sizeof(uint8_t),
+		.flg_value = 1,
+		.parse_detail = str_to_uint8_t,
+	},
+	{
+		.token = NULL,
+	},
+};
+
+int
+append_item_tcp_json(const void *element, int buf_size, char *pattern_str)
+{
+	const struct rte_flow_item_tcp *tcp = element;
+	char tmp_str[64] = { 0 };
+
+	snprintf(tmp_str, 64,
+		"{\"src\":%d,"
+		"\"dst\":%d,"
+		"\"flags\":\"0x%02x\"}",
+		rte_be_to_cpu_16(tcp->hdr.src_port),
+		rte_be_to_cpu_16(tcp->hdr.dst_port),
+		tcp->hdr.tcp_flags);
+
+	if ((int)strlen(pattern_str) + (int)strlen(tmp_str)
+		> buf_size)
+		return -1;
+
+	strncat(pattern_str, tmp_str, strlen(tmp_str));
+
+	return 0;
+}
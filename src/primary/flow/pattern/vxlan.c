@@ -0,0 +1,51 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2020 Nippon Telegraph and Telephone Corporation
+ */
+
+#include <rte_flow.h>
+
+#include "primary/flow/flow.h"
+#include "primary/flow/common.h"
+#include "vxlan.h"
+
+/* Define item "vxlan" operations */
+struct flow_detail_ops vxlan_ops_list[] = {
+	{
+		.token = "flags",
+		.offset = offsetof(struct rte_flow_item_vxlan, flags),
+		.size = sizeof(uint8_t),
+		.flg_value = 1,
+		.parse_detail = str_to_uint8_t,
+	},
+	{
+		.token = "vni",
+		.offset = offsetof(struct rte_flow_item_vxlan, vni),
+		.size = sizeof(((struct rte_flow_item_vxlan *)0)->vni),
+		.flg_value = 1,
+		.parse_detail = str_to_vni,
+	},
+	{
+		.token = NULL,
+	},
+};
+
+int
+append_item_vxlan_json(const void *element, int buf_size, char *pattern_str)
+{
+	const struct rte_flow_item_vxlan *vxlan = element;
+	char tmp_str[64] = { 0 };
+
+	snprintf(tmp_str, 64,
+		"{\"flags\":\"0x%02x\","
+		"\"vni\":%d}",
+		vxlan->flags,
+		(vxlan->vni[0] << 16) | (vxlan->vni[1] << 8) | vxlan->vni[2]);
+
+	if ((int)strlen(pattern_str) + (int)strlen(tmp_str)
+		> buf_size)
+		return -1;
+
+	strncat(pattern_str, tmp_str, strlen(tmp_str));
+
+	return 0;
+}
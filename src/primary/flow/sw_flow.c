@@ -0,0 +1,1289 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2020 Nippon Telegraph and Telephone Corporation
+ */
+
+#include <stdlib.h>
+#include <string.h>
+
+#include <rte_flow.h>
+#include <rte_common.h>
+#include <rte_ethdev.h>
+#include <rte_ether.h>
+#include <rte_ip.h>
+#include <rte_tcp.h>
+#include <rte_udp.h>
+#include <rte_byteorder.h>
+#include <rte_hash.h>
+#include <rte_hash_crc.h>
+#include <rte_lcore.h>
+#include <rte_mbuf.h>
+#include <rte_prefetch.h>
+
+#include "shared/common.h"
+#include "shared/basic_forwarder.h"
+#include "shared/port_manager.h"
+#include "primary/args.h"
+#include "flow.h"
+#include "sw_flow.h"
+
+/* Headers found in a packet, or required by a rule. */
+#define SW_FLOW_LAYER_ETH	(1 << 0)
+#define SW_FLOW_LAYER_VLAN	(1 << 1)
+#define SW_FLOW_LAYER_IPV4	(1 << 2)
+#define SW_FLOW_LAYER_IPV6	(1 << 3)
+#define SW_FLOW_LAYER_UDP	(1 << 4)
+#define SW_FLOW_LAYER_TCP	(1 << 5)
+#define SW_FLOW_LAYER_VXLAN	(1 << 6)
+#define SW_FLOW_LAYER_GTP	(1 << 7)
+
+#define SW_FLOW_LAYER_L3	(SW_FLOW_LAYER_IPV4 | SW_FLOW_LAYER_IPV6)
+#define SW_FLOW_LAYER_L4	(SW_FLOW_LAYER_UDP | SW_FLOW_LAYER_TCP)
+#define SW_FLOW_LAYER_TUNNEL	(SW_FLOW_LAYER_VXLAN | SW_FLOW_LAYER_GTP)
+
+/* UDP ports of tunnel headers parsed in software. */
+#define SW_FLOW_VXLAN_PORT 4789
+#define SW_FLOW_GTPU_PORT 2152
+
+/* Length of VXLAN header and mandatory part of GTP header. */
+#define SW_FLOW_TUNNEL_HDR_LEN 8
+
+/* Number of 64bit words of a key. */
+#define SW_FLOW_KEY_WORDS 10
+
+/* Minimum number of entries of the hash of a group. */
+#define SW_FLOW_HASH_MIN_ENTRIES 64
+
+/* Minimum number of rule IDs of counters of a port. */
+#define SW_FLOW_COUNTS_MIN_ENTRIES 64
+
+/* Maximum rule ID which can be counted. */
+#define SW_FLOW_MAX_RULE_ID (UINT32_MAX >> 1)
+
+/*
+ * Fields of a packet referred for matching. Unused bytes are always zero
+ * so that a key can be masked and compared in words.
+ */
+union sw_flow_key {
+	struct {
+		uint32_t layers;  /* SW_FLOW_LAYER_* */
+		struct rte_ether_addr eth_dst;
+		struct rte_ether_addr eth_src;
+		rte_be16_t eth_type;  /* Type in Ethernet header */
+		rte_be16_t vlan_tci;
+		rte_be16_t vlan_inner_type;
+		uint8_t ip_tos;
+		uint8_t ip_ttl;  /* TTL of IPv4 or hop limits of IPv6 */
+		uint8_t ip_proto;
+		uint8_t tcp_flags;
+		uint8_t ip_src[16];  /* IPv4 address is in the first 4 bytes */
+		uint8_t ip_dst[16];
+		rte_be16_t l4_src;
+		rte_be16_t l4_dst;
+		uint8_t vxlan_flags;
+		uint8_t vxlan_vni[3];
+		uint8_t gtp_msg_type;
+		rte_be32_t gtp_teid;
+	} f;
+	uint64_t words[SW_FLOW_KEY_WORDS];
+};
+
+/* Destination of packets matched with a rule. */
+enum sw_flow_fate {
+	SW_FLOW_FATE_PASSTHRU,  /* Follow the patch of the port */
+	SW_FLOW_FATE_QUEUE,
+	SW_FLOW_FATE_RSS,
+	SW_FLOW_FATE_PORT,
+	SW_FLOW_FATE_DROP,
+};
+
+/* Hit counters of a rule counted by a forwarder lcore. */
+struct sw_flow_count {
+	uint64_t hits;
+	uint64_t bytes;
+};
+
+/*
+ * Hit counters of rules of a port indexed with rule ID. Each of forwarder
+ * lcores has its own array so that counters are updated without atomics.
+ * It is replaced with larger one if a rule ID exceeds nof_entries.
+ */
+struct sw_flow_counts {
+	uint32_t nof_entries;
+	struct sw_flow_count *lcores[RTE_MAX_LCORE];  /* NULL if not forwarder */
+};
+
+struct sw_flow_rule {
+	struct sw_flow_rule *next;  /* Next rule of the group */
+	uint32_t rule_id;  /* Index of counters */
+	uint32_t priority;
+	uint64_t seq;  /* Installed order, earlier one is preferred */
+	union sw_flow_key key;  /* Masked value of fields */
+	union sw_flow_key mask;
+	enum sw_flow_fate fate;
+	uint16_t dest_id;  /* Queue or port ID of destination */
+	uint16_t nof_rss_queues;
+	uint16_t *rss_queues;
+	int has_mark;
+	uint32_t mark_id;
+};
+
+/* Rules of the same mask. Best one of rules of the same key is hashed. */
+struct sw_flow_group {
+	union sw_flow_key mask;
+	uint32_t priority;  /* Highest priority, or lowest value, of rules */
+	struct rte_hash *hash;  /* Masked key to rule */
+};
+
+/* Groups of a port sorted in priority, referred from forwarder. */
+struct sw_flow_table {
+	struct sw_flow_counts *counts;
+	uint32_t nof_groups;
+	struct sw_flow_group groups[0];
+};
+
+/*
+ * Rules of a group managed in control path. Only the hash of the group of
+ * created or destroyed rule is rebuilt, and it is shared with tables.
+ */
+struct sw_flow_group_rules {
+	struct sw_flow_group_rules *next;  /* Next group of the port */
+	struct sw_flow_group group;
+	struct sw_flow_rule *rules;  /* Rules in installed order */
+	uint32_t nof_rules;
+};
+
+struct sw_flow_port {
+	struct sw_flow_group_rules *groups;
+	uint32_t nof_groups;
+	struct sw_flow_counts *counts;
+	/* Counters of replaced counts, in the same size of counts. */
+	struct sw_flow_count *base_counts;
+	struct sw_flow_table *volatile table;
+};
+
+static struct sw_flow_port sw_flow_ports[RTE_MAX_ETHPORTS];
+
+/* Installed order of rules over ports. */
+static uint64_t sw_flow_seq;
+
+/* Generation of hashes used for unique name of them. */
+static uint32_t sw_flow_hash_gen;
+
+/* Return true if rule `a` is preferred to rule `b`. */
+static inline int
+is_prior_rule(const struct sw_flow_rule *a, const struct sw_flow_rule *b)
+{
+	if (a->priority != b->priority)
+		return a->priority < b->priority;
+	return a->seq < b->seq;
+}
+
+/* Set masked value of a field and its mask to the key of a rule. */
+static void
+set_key_field(void *key, void *key_mask, const void *spec, const void *mask,
+		size_t size)
+{
+	uint8_t *k = key, *km = key_mask;
+	const uint8_t *s = spec, *m = mask;
+	size_t i;
+
+	for (i = 0; i < size; i++) {
+		k[i] = s[i] & m[i];
+		km[i] = m[i];
+	}
+}
+
+/* Layer bit of a pattern item, or 0 if not supported. */
+static uint32_t
+get_item_layer(enum rte_flow_item_type type)
+{
+	switch (type) {
+	case RTE_FLOW_ITEM_TYPE_ETH:
+		return SW_FLOW_LAYER_ETH;
+	case RTE_FLOW_ITEM_TYPE_VLAN:
+		return SW_FLOW_LAYER_VLAN;
+	case RTE_FLOW_ITEM_TYPE_IPV4:
+		return SW_FLOW_LAYER_IPV4;
+	case RTE_FLOW_ITEM_TYPE_IPV6:
+		return SW_FLOW_LAYER_IPV6;
+	case RTE_FLOW_ITEM_TYPE_UDP:
+		return SW_FLOW_LAYER_UDP;
+	case RTE_FLOW_ITEM_TYPE_TCP:
+		return SW_FLOW_LAYER_TCP;
+	case RTE_FLOW_ITEM_TYPE_VXLAN:
+		return SW_FLOW_LAYER_VXLAN;
+	case RTE_FLOW_ITEM_TYPE_GTP:
+		return SW_FLOW_LAYER_GTP;
+	default:
+		return 0;
+	}
+}
+
+/* Layer bits which cannot appear with given layer in a packet. */
+static uint32_t
+get_exclusive_layers(uint32_t layer)
+{
+	if (layer & SW_FLOW_LAYER_L3)
+		return SW_FLOW_LAYER_L3;
+	if (layer & SW_FLOW_LAYER_L4)
+		return SW_FLOW_LAYER_L4;
+	if (layer & SW_FLOW_LAYER_TUNNEL)
+		return SW_FLOW_LAYER_TUNNEL;
+	return layer;
+}
+
+/* Set key and mask of a rule from a pattern item. */
+static void
+compile_item(const struct rte_flow_item *item, struct sw_flow_rule *rule)
+{
+	union sw_flow_key *key = &rule->key;
+	union sw_flow_key *mask = &rule->mask;
+
+	if (item->spec == NULL)
+		return;
+
+	switch (item->type) {
+	case RTE_FLOW_ITEM_TYPE_ETH: {
+		const struct rte_flow_item_eth *spec = item->spec;
+		const struct rte_flow_item_eth *m = item->mask != NULL ?
+			item->mask : &rte_flow_item_eth_mask;
+
+		set_key_field(&key->f.eth_dst, &mask->f.eth_dst,
+			&spec->dst, &m->dst, sizeof(spec->dst));
+		set_key_field(&key->f.eth_src, &mask->f.eth_src,
+			&spec->src, &m->src, sizeof(spec->src));
+		set_key_field(&key->f.eth_type, &mask->f.eth_type,
+			&spec->type, &m->type, sizeof(spec->type));
+		break;
+	}
+	case RTE_FLOW_ITEM_TYPE_VLAN: {
+		const struct rte_flow_item_vlan *spec = item->spec;
+		const struct rte_flow_item_vlan *m = item->mask != NULL ?
+			item->mask : &rte_flow_item_vlan_mask;
+
+		set_key_field(&key->f.vlan_tci, &mask->f.vlan_tci,
+			&spec->tci, &m->tci, sizeof(spec->tci));
+		set_key_field(&key->f.vlan_inner_type,
+			&mask->f.vlan_inner_type, &spec->inner_type,
+			&m->inner_type, sizeof(spec->inner_type));
+		break;
+	}
+	case RTE_FLOW_ITEM_TYPE_IPV4: {
+		const struct rte_flow_item_ipv4 *spec = item->spec;
+		const struct rte_flow_item_ipv4 *m = item->mask != NULL ?
+			item->mask : &rte_flow_item_ipv4_mask;
+
+		set_key_field(&key->f.ip_tos, &mask->f.ip_tos,
+			&spec->hdr.type_of_service, &m->hdr.type_of_service,
+			sizeof(spec->hdr.type_of_service));
+		set_key_field(&key->f.ip_ttl, &mask->f.ip_ttl,
+			&spec->hdr.time_to_live, &m->hdr.time_to_live,
+			sizeof(spec->hdr.time_to_live));
+		set_key_field(&key->f.ip_proto, &mask->f.ip_proto,
+			&spec->hdr.next_proto_id, &m->hdr.next_proto_id,
+			sizeof(spec->hdr.next_proto_id));
+		set_key_field(key->f.ip_src, mask->f.ip_src,
+			&spec->hdr.src_addr, &m->hdr.src_addr,
+			sizeof(spec->hdr.src_addr));
+		set_key_field(key->f.ip_dst, mask->f.ip_dst,
+			&spec->hdr.dst_addr, &m->hdr.dst_addr,
+			sizeof(spec->hdr.dst_addr));
+		break;
+	}
+	case RTE_FLOW_ITEM_TYPE_IPV6: {
+		const struct rte_flow_item_ipv6 *spec = item->spec;
+		const struct rte_flow_item_ipv6 *m = item->mask != NULL ?
+			item->mask : &rte_flow_item_ipv6_mask;
+
+		set_key_field(&key->f.ip_proto, &mask->f.ip_proto,
+			&spec->hdr.proto, &m->hdr.proto,
+			sizeof(spec->hdr.proto));
+		set_key_field(&key->f.ip_ttl, &mask->f.ip_ttl,
+			&spec->hdr.hop_limits, &m->hdr.hop_limits,
+			sizeof(spec->hdr.hop_limits));
+		set_key_field(key->f.ip_src, mask->f.ip_src,
+			spec->hdr.src_addr, m->hdr.src_addr,
+			sizeof(spec->hdr.src_addr));
+		set_key_field(key->f.ip_dst, mask->f.ip_dst,
+			spec->hdr.dst_addr, m->hdr.dst_addr,
+			sizeof(spec->hdr.dst_addr));
+		break;
+	}
+	case RTE_FLOW_ITEM_TYPE_UDP: {
+		const struct rte_flow_item_udp *spec = item->spec;
+		const struct rte_flow_item_udp *m = item->mask != NULL ?
+			item->mask : &rte_flow_item_udp_mask;
+
+		set_key_field(&key->f.l4_src, &mask->f.l4_src,
+			&spec->hdr.src_port, &m->hdr.src_port,
+			sizeof(spec->hdr.src_port));
+		set_key_field(&key->f.l4_dst, &mask->f.l4_dst,
+			&spec->hdr.dst_port, &m->hdr.dst_port,
+			sizeof(spec->hdr.dst_port));
+		break;
+	}
+	case RTE_FLOW_ITEM_TYPE_TCP: {
+		const struct rte_flow_item_tcp *spec = item->spec;
+		const struct rte_flow_item_tcp *m = item->mask != NULL ?
+			item->mask : &rte_flow_item_tcp_mask;
+
+		set_key_field(&key->f.l4_src, &mask->f.l4_src,
+			&spec->hdr.src_port, &m->hdr.src_port,
+			sizeof(spec->hdr.src_port));
+		set_key_field(&key->f.l4_dst, &mask->f.l4_dst,
+			&spec->hdr.dst_port, &m->hdr.dst_port,
+			sizeof(spec->hdr.dst_port));
+		set_key_field(&key->f.tcp_flags, &mask->f.tcp_flags,
+			&spec->hdr.tcp_flags, &m->hdr.tcp_flags,
+			sizeof(spec->hdr.tcp_flags));
+		break;
+	}
+	case RTE_FLOW_ITEM_TYPE_VXLAN: {
+		const struct rte_flow_item_vxlan *spec = item->spec;
+		const struct rte_flow_item_vxlan *m = item->mask != NULL ?
+			item->mask : &rte_flow_item_vxlan_mask;
+
+		set_key_field(&key->f.vxlan_flags, &mask->f.vxlan_flags,
+			&spec->flags, &m->flags, sizeof(spec->flags));
+		set_key_field(key->f.vxlan_vni, mask->f.vxlan_vni,
+			spec->vni, m->vni, sizeof(spec->vni));
+		break;
+	}
+	case RTE_FLOW_ITEM_TYPE_GTP: {
+		const struct rte_flow_item_gtp *spec = item->spec;
+		const struct rte_flow_item_gtp *m = item->mask != NULL ?
+			item->mask : &rte_flow_item_gtp_mask;
+
+		set_key_field(&key->f.gtp_msg_type, &mask->f.gtp_msg_type,
+			&spec->msg_type, &m->msg_type, sizeof(spec->msg_type));
+		set_key_field(&key->f.gtp_teid, &mask->f.gtp_teid,
+			&spec->teid, &m->teid, sizeof(spec->teid));
+		break;
+	}
+	default:
+		break;
+	}
+}
+
+/* Set key and mask of a rule from pattern items. */
+static int
+compile_pattern(const struct rte_flow_item *pattern,
+		struct sw_flow_rule *rule, const char **err_msg)
+{
+	const struct rte_flow_item *item;
+	uint32_t layer;
+
+	for (item = pattern; item->type != RTE_FLOW_ITEM_TYPE_END; item++) {
+		if (item->type == RTE_FLOW_ITEM_TYPE_VOID)
+			continue;
+
+		if (rule->mask.f.layers & SW_FLOW_LAYER_TUNNEL) {
+			*err_msg = "Inner headers of tunnel are not supported";
+			return -1;
+		}
+
+		layer = get_item_layer(item->type);
+		if (layer == 0) {
+			*err_msg = "Pattern item is not supported";
+			return -1;
+		}
+
+		if (rule->mask.f.layers & get_exclusive_layers(layer)) {
+			*err_msg = "Pattern items are conflicted";
+			return -1;
+		}
+
+		if (item->last != NULL) {
+			*err_msg = "Range of pattern item is not supported";
+			return -1;
+		}
+
+		compile_item(item, rule);
+		rule->key.f.layers |= layer;
+		rule->mask.f.layers |= layer;
+	}
+
+	return 0;
+}
+
+/* Set destination and mark of a rule from actions. */
+static int
+compile_actions(const struct rte_flow_action *actions,
+		struct sw_flow_rule *rule, const char **err_msg)
+{
+	const struct rte_flow_action *action;
+	const struct rte_flow_action_queue *queue;
+	const struct rte_flow_action_rss *rss = NULL;
+	const struct rte_flow_action_port_id *port_id;
+	const struct rte_flow_action_mark *mark;
+	enum sw_flow_fate fate;
+	uint32_t i;
+
+	for (action = actions; action->type != RTE_FLOW_ACTION_TYPE_END;
+			action++) {
+		switch (action->type) {
+		case RTE_FLOW_ACTION_TYPE_VOID:
+		case RTE_FLOW_ACTION_TYPE_COUNT:
+			/* Packets are always counted in software. */
+			continue;
+		case RTE_FLOW_ACTION_TYPE_MARK:
+			mark = action->conf;
+			rule->has_mark = 1;
+			rule->mark_id = mark->id;
+			continue;
+		case RTE_FLOW_ACTION_TYPE_QUEUE:
+			queue = action->conf;
+			if (queue->index >= RTE_MAX_QUEUES_PER_PORT) {
+				*err_msg = "Queue index is out of range";
+				return -1;
+			}
+			fate = SW_FLOW_FATE_QUEUE;
+			rule->dest_id = queue->index;
+			break;
+		case RTE_FLOW_ACTION_TYPE_RSS:
+			rss = action->conf;
+			if (rss->queue_num == 0) {
+				*err_msg = "No queue is given for RSS";
+				return -1;
+			}
+			for (i = 0; i < rss->queue_num; i++) {
+				if (rss->queue[i] < RTE_MAX_QUEUES_PER_PORT)
+					continue;
+				*err_msg = "Queue index is out of range";
+				return -1;
+			}
+			fate = SW_FLOW_FATE_RSS;
+			break;
+		case RTE_FLOW_ACTION_TYPE_PORT_ID:
+			port_id = action->conf;
+			if (port_id->id >= RTE_MAX_ETHPORTS ||
+				!rte_eth_dev_is_valid_port(port_id->id)) {
+				*err_msg = "Destination port is invalid";
+				return -1;
+			}
+			fate = SW_FLOW_FATE_PORT;
+			rule->dest_id = port_id->id;
+			break;
+		case RTE_FLOW_ACTION_TYPE_DROP:
+			fate = SW_FLOW_FATE_DROP;
+			break;
+		default:
+			*err_msg = "Action is not supported";
+			return -1;
+		}
+
+		if (rule->fate != SW_FLOW_FATE_PASSTHRU) {
+			*err_msg = "Only one fate action is supported";
+			return -1;
+		}
+		rule->fate = fate;
+
+		if (fate == SW_FLOW_FATE_RSS) {
+			rule->rss_queues = malloc(sizeof(uint16_t) *
+				rss->queue_num);
+			if (rule->rss_queues == NULL) {
+				*err_msg = "Memory allocation failure";
+				return -1;
+			}
+			memcpy(rule->rss_queues, rss->queue,
+				sizeof(uint16_t) * rss->queue_num);
+			rule->nof_rss_queues = rss->queue_num;
+		}
+	}
+
+	return 0;
+}
+
+/* Compile a rule. Members allocated in it are released with free_rule(). */
+static int
+compile_rule(int port_id, const struct rte_flow_attr *attr,
+		const struct rte_flow_item *pattern,
+		const struct rte_flow_action *actions,
+		struct sw_flow_rule *rule, const char **err_msg)
+{
+	if (port_id < 0 || port_id >= RTE_MAX_ETHPORTS) {
+		*err_msg = "Port ID is out of range";
+		return -1;
+	}
+
+	/* Packets are steered by forwarder of spp_primary. */
+	if (get_forwarding_flg() != 1) {
+		*err_msg = "Forwarder is not running";
+		return -1;
+	}
+
+	if (!attr->ingress || attr->egress || attr->transfer) {
+		*err_msg = "Only ingress rule is supported";
+		return -1;
+	}
+
+	if (attr->group != 0) {
+		*err_msg = "Only group 0 is supported";
+		return -1;
+	}
+
+	rule->priority = attr->priority;
+
+	if (compile_pattern(pattern, rule, err_msg) != 0)
+		return -1;
+
+	return compile_actions(actions, rule, err_msg);
+}
+
+static void
+free_rule(struct sw_flow_rule *rule)
+{
+	free(rule->rss_queues);
+	free(rule);
+}
+
+static void
+free_counts(struct sw_flow_counts *counts)
+{
+	unsigned int lcore_id;
+
+	if (counts == NULL)
+		return;
+
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++)
+		free(counts->lcores[lcore_id]);
+	free(counts);
+}
+
+/* Allocate zeroed counters for forwarder lcores of spp_primary. */
+static struct sw_flow_counts *
+alloc_counts(uint32_t nof_entries)
+{
+	struct sw_flow_counts *counts;
+	unsigned int lcore_id;
+	size_t size;
+
+	counts = calloc(1, sizeof(*counts));
+	if (counts == NULL)
+		return NULL;
+	counts->nof_entries = nof_entries;
+
+	/* Counters of lcores should not share a cache line. */
+	size = RTE_ALIGN_CEIL(sizeof(struct sw_flow_count) * nof_entries,
+		RTE_CACHE_LINE_SIZE);
+	RTE_LCORE_FOREACH_SLAVE(lcore_id) {
+		counts->lcores[lcore_id] = aligned_alloc(RTE_CACHE_LINE_SIZE,
+			size);
+		if (counts->lcores[lcore_id] == NULL) {
+			free_counts(counts);
+			return NULL;
+		}
+		memset(counts->lcores[lcore_id], 0, size);
+	}
+
+	return counts;
+}
+
+/*
+ * Move counters of replaced counts to base counters of the port. It must
+ * be called after forwarder stops referring `old_counts`.
+ */
+static void
+retire_counts(struct sw_flow_port *port, struct sw_flow_counts *old_counts)
+{
+	unsigned int lcore_id;
+	uint32_t i;
+
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+		if (old_counts->lcores[lcore_id] == NULL)
+			continue;
+		for (i = 0; i < old_counts->nof_entries; i++) {
+			port->base_counts[i].hits +=
+				old_counts->lcores[lcore_id][i].hits;
+			port->base_counts[i].bytes +=
+				old_counts->lcores[lcore_id][i].bytes;
+		}
+	}
+	free_counts(old_counts);
+}
+
+/* Clear counters of a rule ID which is not referred from forwarder. */
+static void
+clear_counts(struct sw_flow_port *port, uint32_t rule_id)
+{
+	unsigned int lcore_id;
+
+	memset(&port->base_counts[rule_id], 0, sizeof(struct sw_flow_count));
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+		if (port->counts->lcores[lcore_id] == NULL)
+			continue;
+		memset(&port->counts->lcores[lcore_id][rule_id], 0,
+			sizeof(struct sw_flow_count));
+	}
+}
+
+/*
+ * Build a hash of rules of a group except `exclude`. The best rule of the
+ * same key is registered, and `priority` is the highest one of rules.
+ */
+static int
+build_group_hash(int port_id, const struct sw_flow_group_rules *grp,
+		const struct sw_flow_rule *exclude,
+		struct rte_hash **hash, uint32_t *priority)
+{
+	struct rte_hash_parameters params = {
+		.key_len = sizeof(union sw_flow_key),
+		.hash_func = rte_hash_crc,
+		.hash_func_init_val = 0,
+		.socket_id = rte_socket_id(),
+	};
+	char name[RTE_HASH_NAMESIZE];
+	struct sw_flow_rule *rule;
+	void *data;
+
+	snprintf(name, sizeof(name), "swfl_%d_%u", port_id,
+		sw_flow_hash_gen++);
+	params.name = name;
+	params.entries = RTE_MAX(rte_align32pow2(grp->nof_rules * 2),
+		SW_FLOW_HASH_MIN_ENTRIES);
+	*hash = rte_hash_create(&params);
+	if (*hash == NULL)
+		goto err;
+
+	*priority = UINT32_MAX;
+
+	/* Rules are in installed order, so the earlier one is kept. */
+	for (rule = grp->rules; rule != NULL; rule = rule->next) {
+		if (rule == exclude)
+			continue;
+
+		if (rule->priority < *priority)
+			*priority = rule->priority;
+
+		if (rte_hash_lookup_data(*hash, &rule->key, &data) >= 0 &&
+				!is_prior_rule(rule, data))
+			continue;
+
+		if (rte_hash_add_key_data(*hash, &rule->key, rule) < 0)
+			goto err;
+	}
+
+	return 0;
+
+err:
+	RTE_LOG(ERR, SPP_FLOW,
+		"Failed to build software flow hash of port %d.(%s:%d)\n",
+		port_id, __func__, __LINE__);
+	rte_hash_free(*hash);
+	*hash = NULL;
+	return -1;
+}
+
+static int
+compare_group_priority(const void *a, const void *b)
+{
+	const struct sw_flow_group *ga = a;
+	const struct sw_flow_group *gb = b;
+
+	if (ga->priority == gb->priority)
+		return 0;
+	return ga->priority < gb->priority ? -1 : 1;
+}
+
+/*
+ * Allocate a table for given number of groups. It is allocated before
+ * updating groups so that updating is never failed after that.
+ */
+static struct sw_flow_table *
+alloc_table(uint32_t nof_groups)
+{
+	return calloc(1, sizeof(struct sw_flow_table) +
+		sizeof(struct sw_flow_group) * nof_groups);
+}
+
+/* Fill a table with groups of a port sorted in priority. */
+static void
+fill_table(struct sw_flow_table *table, const struct sw_flow_port *port)
+{
+	const struct sw_flow_group_rules *grp;
+
+	table->counts = port->counts;
+	table->nof_groups = 0;
+	for (grp = port->groups; grp != NULL; grp = grp->next)
+		table->groups[table->nof_groups++] = grp->group;
+
+	qsort(table->groups, table->nof_groups, sizeof(struct sw_flow_group),
+		compare_group_priority);
+}
+
+/* Extract fields of the first segment of a packet to the key. */
+static inline void
+extract_key(struct rte_mbuf *pkt, union sw_flow_key *key)
+{
+	const uint8_t *data = rte_pktmbuf_mtod(pkt, const uint8_t *);
+	uint32_t len = rte_pktmbuf_data_len(pkt);
+	uint32_t off = sizeof(struct rte_ether_hdr);
+	const struct rte_ether_hdr *eth;
+	const struct rte_vlan_hdr *vlan;
+	const struct rte_ipv4_hdr *ipv4;
+	const struct rte_ipv6_hdr *ipv6;
+	const struct rte_tcp_hdr *tcp;
+	const struct rte_udp_hdr *udp;
+	rte_be16_t type;
+	uint32_t ihl;
+	uint8_t proto;
+
+	memset(key, 0, sizeof(*key));
+
+	if (len < off)
+		return;
+
+	eth = (const struct rte_ether_hdr *)data;
+	rte_ether_addr_copy(&eth->d_addr, &key->f.eth_dst);
+	rte_ether_addr_copy(&eth->s_addr, &key->f.eth_src);
+	key->f.eth_type = eth->ether_type;
+	key->f.layers = SW_FLOW_LAYER_ETH;
+	type = eth->ether_type;
+
+	if (type == RTE_BE16(RTE_ETHER_TYPE_VLAN)) {
+		if (len < off + sizeof(*vlan))
+			return;
+		vlan = (const struct rte_vlan_hdr *)(data + off);
+		key->f.vlan_tci = vlan->vlan_tci;
+		key->f.vlan_inner_type = vlan->eth_proto;
+		key->f.layers |= SW_FLOW_LAYER_VLAN;
+		type = vlan->eth_proto;
+		off += sizeof(*vlan);
+	}
+
+	if (type == RTE_BE16(RTE_ETHER_TYPE_IPV4)) {
+		if (len < off + sizeof(*ipv4))
+			return;
+		ipv4 = (const struct rte_ipv4_hdr *)(data + off);
+		ihl = (ipv4->version_ihl & 0x0f) * RTE_IPV4_IHL_MULTIPLIER;
+		if (ihl < sizeof(*ipv4) || len < off + ihl)
+			return;
+		key->f.ip_tos = ipv4->type_of_service;
+		key->f.ip_ttl = ipv4->time_to_live;
+		key->f.ip_proto = ipv4->next_proto_id;
+		memcpy(key->f.ip_src, &ipv4->src_addr, sizeof(ipv4->src_addr));
+		memcpy(key->f.ip_dst, &ipv4->dst_addr, sizeof(ipv4->dst_addr));
+		key->f.layers |= SW_FLOW_LAYER_IPV4;
+
+		/* L4 header is only in the first fragment. */
+		if (ipv4->fragment_offset &
+				RTE_BE16(RTE_IPV4_HDR_OFFSET_MASK))
+			return;
+		proto = ipv4->next_proto_id;
+		off += ihl;
+	} else if (type == RTE_BE16(RTE_ETHER_TYPE_IPV6)) {
+		/* Extension headers are not parsed. */
+		if (len < off + sizeof(*ipv6))
+			return;
+		ipv6 = (const struct rte_ipv6_hdr *)(data + off);
+		key->f.ip_ttl = ipv6->hop_limits;
+		key->f.ip_proto = ipv6->proto;
+		memcpy(key->f.ip_src, ipv6->src_addr, sizeof(ipv6->src_addr));
+		memcpy(key->f.ip_dst, ipv6->dst_addr, sizeof(ipv6->dst_addr));
+		key->f.layers |= SW_FLOW_LAYER_IPV6;
+		proto = ipv6->proto;
+		off += sizeof(*ipv6);
+	} else {
+		return;
+	}
+
+	if (proto == IPPROTO_TCP) {
+		if (len < off + sizeof(*tcp))
+			return;
+		tcp = (const struct rte_tcp_hdr *)(data + off);
+		key->f.l4_src = tcp->src_port;
+		key->f.l4_dst = tcp->dst_port;
+		key->f.tcp_flags = tcp->tcp_flags;
+		key->f.layers |= SW_FLOW_LAYER_TCP;
+		return;
+	}
+
+	if (proto != IPPROTO_UDP || len < off + sizeof(*udp))
+		return;
+	udp = (const struct rte_udp_hdr *)(data + off);
+	key->f.l4_src = udp->src_port;
+	key->f.l4_dst = udp->dst_port;
+	key->f.layers |= SW_FLOW_LAYER_UDP;
+	off += sizeof(*udp);
+
+	if (len < off + SW_FLOW_TUNNEL_HDR_LEN)
+		return;
+
+	if (udp->dst_port == RTE_BE16(SW_FLOW_VXLAN_PORT)) {
+		key->f.vxlan_flags = data[off];
+		memcpy(key->f.vxlan_vni, data + off + 4,
+			sizeof(key->f.vxlan_vni));
+		key->f.layers |= SW_FLOW_LAYER_VXLAN;
+	} else if (udp->dst_port == RTE_BE16(SW_FLOW_GTPU_PORT)) {
+		key->f.gtp_msg_type = data[off + 1];
+		memcpy(&key->f.gtp_teid, data + off + 4,
+			sizeof(key->f.gtp_teid));
+		key->f.layers |= SW_FLOW_LAYER_GTP;
+	}
+}
+
+/*
+ * Steering function of forwarder. Groups are looked up in priority order
+ * with masked keys of the burst, and looking up is stopped for a packet if
+ * it is matched with a rule prior to the rest of groups.
+ */
+static void
+sw_flow_steer(uint16_t port_id, uint16_t queue_id __rte_unused,
+		struct rte_mbuf **pkts, uint16_t nb_pkts,
+		struct fwd_steer_dest *dests)
+{
+	struct sw_flow_table *table = sw_flow_ports[port_id].table;
+	union sw_flow_key keys[MAX_PKT_BURST];
+	union sw_flow_key masked_keys[MAX_PKT_BURST];
+	const void *key_ptrs[MAX_PKT_BURST];
+	void *data[MAX_PKT_BURST];
+	struct sw_flow_rule *matched[MAX_PKT_BURST];
+	uint16_t pkt_idx[MAX_PKT_BURST];
+	struct sw_flow_group *group;
+	struct sw_flow_rule *rule;
+	struct sw_flow_count *counts;
+	uint64_t hit_mask;
+	uint32_t hash;
+	uint32_t i, g, w, n, k;
+
+	if (unlikely(table == NULL || nb_pkts > MAX_PKT_BURST)) {
+		for (i = 0; i < nb_pkts; i++)
+			dests[i].type = FWD_STEER_PATCH;
+		return;
+	}
+
+	/* Counters of lcore not expected as forwarder are not allocated. */
+	counts = table->counts->lcores[rte_lcore_id()];
+
+	for (i = 0; i < nb_pkts; i++)
+		rte_prefetch0(rte_pktmbuf_mtod(pkts[i], void *));
+
+	for (i = 0; i < nb_pkts; i++) {
+		extract_key(pkts[i], &keys[i]);
+		matched[i] = NULL;
+	}
+
+	for (g = 0; g < table->nof_groups; g++) {
+		group = &table->groups[g];
+
+		n = 0;
+		for (i = 0; i < nb_pkts; i++) {
+			if (matched[i] != NULL &&
+					matched[i]->priority <= group->priority)
+				continue;
+			for (w = 0; w < SW_FLOW_KEY_WORDS; w++)
+				masked_keys[i].words[w] = keys[i].words[w] &
+					group->mask.words[w];
+			key_ptrs[n] = &masked_keys[i];
+			pkt_idx[n] = i;
+			n++;
+		}
+
+		/* Other groups are not prior to matched rules. */
+		if (n == 0)
+			break;
+
+		if (rte_hash_lookup_bulk_data(group->hash, key_ptrs, n,
+					&hit_mask, data) <= 0)
+			continue;
+
+		while (hit_mask != 0) {
+			k = __builtin_ctzll(hit_mask);
+			hit_mask &= hit_mask - 1;
+			rule = data[k];
+			i = pkt_idx[k];
+			if (matched[i] == NULL ||
+					is_prior_rule(rule, matched[i]))
+				matched[i] = rule;
+		}
+	}
+
+	for (i = 0; i < nb_pkts; i++) {
+		rule = matched[i];
+		if (rule == NULL) {
+			dests[i].type = FWD_STEER_PATCH;
+			continue;
+		}
+
+		if (likely(counts != NULL)) {
+			counts[rule->rule_id].hits++;
+			counts[rule->rule_id].bytes +=
+				rte_pktmbuf_pkt_len(pkts[i]);
+		}
+
+		switch (rule->fate) {
+		case SW_FLOW_FATE_QUEUE:
+			dests[i].type = FWD_STEER_QUEUE;
+			dests[i].id = rule->dest_id;
+			break;
+		case SW_FLOW_FATE_RSS:
+			/* Use hash from the device if it is available. */
+			if (pkts[i]->ol_flags & PKT_RX_RSS_HASH)
+				hash = pkts[i]->hash.rss;
+			else
+				hash = rte_hash_crc(&keys[i], sizeof(keys[i]),
+					0);
+			dests[i].type = FWD_STEER_QUEUE;
+			dests[i].id = rule->rss_queues[
+				hash % rule->nof_rss_queues];
+			break;
+		case SW_FLOW_FATE_PORT:
+			dests[i].type = FWD_STEER_PORT;
+			dests[i].id = rule->dest_id;
+			break;
+		case SW_FLOW_FATE_DROP:
+			dests[i].type = FWD_STEER_DROP;
+			break;
+		default:
+			dests[i].type = FWD_STEER_PATCH;
+			break;
+		}
+
+		if (rule->has_mark) {
+			pkts[i]->hash.fdir.hi = rule->mark_id;
+			pkts[i]->ol_flags |= PKT_RX_FDIR | PKT_RX_FDIR_ID;
+		}
+	}
+}
+
+/* Prepare TX of the port which is a destination of port_id action. */
+static void
+prepare_dest_port(uint16_t port_id)
+{
+	struct port *entry = &ports_fwd_array[port_id][0];
+
+	if (entry->in_port_id == PORT_RESET) {
+		entry->in_port_id = port_id;
+		entry->in_queue_id = 0;
+	}
+	set_burst_funcs(entry, port_id);
+}
+
+/*
+ * Set or clear steering function for RX queues of a port. Forwarder polls
+ * only queues patched in spp_primary, so that queues polled by secondary
+ * processes are not steered.
+ */
+static void
+set_steer_func(uint16_t port_id,
+		void (*func)(uint16_t, uint16_t, struct rte_mbuf **,
+			uint16_t, struct fwd_steer_dest *))
+{
+	uint16_t max_queue = get_port_max_queues(port_id);
+	uint16_t queue_id;
+
+	for (queue_id = 0; queue_id < max_queue; queue_id++) {
+		if (!is_valid_port_rxq(port_id, queue_id))
+			continue;
+		ports_fwd_array[port_id][queue_id].steer_func = func;
+	}
+}
+
+/*
+ * Replace the table of a port with given one filled with groups of the
+ * port, or NULL if no group remains. The previous table is released after
+ * forwarder stops referring it.
+ */
+static void
+publish_table(int port_id, struct sw_flow_table *table)
+{
+	struct sw_flow_port *port = &sw_flow_ports[port_id];
+	struct sw_flow_table *old_table;
+
+	if (table != NULL && port->nof_groups == 0) {
+		free(table);
+		table = NULL;
+	} else if (table != NULL) {
+		fill_table(table, port);
+	}
+
+	old_table = port->table;
+	rte_smp_wmb();
+	port->table = table;
+
+	set_steer_func(port_id, table != NULL ? sw_flow_steer : NULL);
+	publish_fwd_array();
+
+	free(old_table);
+}
+
+/* Find a group of the same mask as the rule, or return NULL. */
+static struct sw_flow_group_rules *
+find_group(struct sw_flow_port *port, const struct sw_flow_rule *rule,
+		struct sw_flow_group_rules ***prev)
+{
+	struct sw_flow_group_rules **p;
+
+	for (p = &port->groups; *p != NULL; p = &(*p)->next) {
+		if (memcmp(&(*p)->group.mask, &rule->mask,
+				sizeof(rule->mask)) == 0)
+			break;
+	}
+
+	if (prev != NULL)
+		*prev = p;
+	return *p;
+}
+
+/*
+ * Prepare counters which can be indexed with `rule_id`. New counters and
+ * base counters are returned if current ones are not enough, and they
+ * replace current ones when the rule is installed.
+ */
+static int
+prepare_counts(struct sw_flow_port *port, uint32_t rule_id,
+		struct sw_flow_counts **new_counts,
+		struct sw_flow_count **new_base)
+{
+	uint32_t nof_entries;
+
+	*new_counts = NULL;
+	*new_base = NULL;
+	if (port->counts != NULL && rule_id < port->counts->nof_entries)
+		return 0;
+	if (rule_id > SW_FLOW_MAX_RULE_ID)
+		return -1;
+
+	nof_entries = RTE_MAX(rte_align32pow2(rule_id + 1),
+		SW_FLOW_COUNTS_MIN_ENTRIES);
+	*new_counts = alloc_counts(nof_entries);
+	*new_base = calloc(nof_entries, sizeof(struct sw_flow_count));
+	if (*new_counts == NULL || *new_base == NULL) {
+		free_counts(*new_counts);
+		free(*new_base);
+		return -1;
+	}
+
+	if (port->counts != NULL)
+		memcpy(*new_base, port->base_counts,
+			sizeof(struct sw_flow_count) *
+			port->counts->nof_entries);
+	return 0;
+}
+
+int
+sw_flow_validate(int port_id, const struct rte_flow_attr *attr,
+	const struct rte_flow_item *pattern,
+	const struct rte_flow_action *actions,
+	const char **err_msg)
+{
+	struct sw_flow_rule rule;
+	int ret;
+
+	memset(&rule, 0, sizeof(rule));
+	ret = compile_rule(port_id, attr, pattern, actions, &rule, err_msg);
+	free(rule.rss_queues);
+
+	return ret;
+}
+
+struct sw_flow_rule *
+sw_flow_create(int port_id, uint32_t rule_id,
+	const struct rte_flow_attr *attr,
+	const struct rte_flow_item *pattern,
+	const struct rte_flow_action *actions,
+	const char **err_msg)
+{
+	struct sw_flow_port *port;
+	struct sw_flow_rule *rule, **tail;
+	struct sw_flow_group_rules *grp;
+	struct sw_flow_counts *new_counts, *old_counts = NULL;
+	struct sw_flow_count *new_base;
+	struct sw_flow_table *table;
+	struct rte_hash *hash, *old_hash;
+	uint32_t priority;
+	int is_new_group = 0;
+
+	rule = calloc(1, sizeof(*rule));
+	if (rule == NULL) {
+		*err_msg = "Memory allocation failure";
+		return NULL;
+	}
+
+	if (compile_rule(port_id, attr, pattern, actions, rule,
+				err_msg) != 0) {
+		free_rule(rule);
+		return NULL;
+	}
+	rule->rule_id = rule_id;
+	rule->seq = sw_flow_seq++;
+
+	port = &sw_flow_ports[port_id];
+	if (prepare_counts(port, rule_id, &new_counts, &new_base) != 0) {
+		free_rule(rule);
+		*err_msg = "Memory allocation failure";
+		return NULL;
+	}
+
+	grp = find_group(port, rule, NULL);
+	if (grp == NULL) {
+		grp = calloc(1, sizeof(*grp));
+		if (grp == NULL)
+			goto err_group;
+		grp->group.mask = rule->mask;
+		is_new_group = 1;
+	}
+
+	/* Only the group of the rule is rebuilt. */
+	for (tail = &grp->rules; *tail != NULL; tail = &(*tail)->next)
+		;
+	*tail = rule;
+	grp->nof_rules++;
+
+	table = alloc_table(port->nof_groups + is_new_group);
+	if (table == NULL)
+		goto err_table;
+	if (build_group_hash(port_id, grp, NULL, &hash, &priority) != 0)
+		goto err_hash;
+
+	/* Nothing is failed from here. */
+	if (is_new_group) {
+		grp->next = port->groups;
+		port->groups = grp;
+		port->nof_groups++;
+	}
+	old_hash = grp->group.hash;
+	grp->group.hash = hash;
+	grp->group.priority = priority;
+
+	if (new_counts != NULL) {
+		old_counts = port->counts;
+		port->counts = new_counts;
+		free(port->base_counts);
+		port->base_counts = new_base;
+	}
+	clear_counts(port, rule_id);
+
+	if (rule->fate == SW_FLOW_FATE_PORT)
+		prepare_dest_port(rule->dest_id);
+
+	publish_table(port_id, table);
+
+	rte_hash_free(old_hash);
+	if (old_counts != NULL)
+		retire_counts(port, old_counts);
+
+	return rule;
+
+err_hash:
+	free(table);
+err_table:
+	*tail = NULL;
+	grp->nof_rules--;
+	if (is_new_group)
+		free(grp);
+err_group:
+	free_counts(new_counts);
+	free(new_base);
+	free_rule(rule);
+	*err_msg = "Failed to update software flow table";
+	return NULL;
+}
+
+int
+sw_flow_destroy(int port_id, struct sw_flow_rule *rule)
+{
+	struct sw_flow_port *port;
+	struct sw_flow_group_rules *grp, **grp_prev;
+	struct sw_flow_rule **prev;
+	struct sw_flow_table *table;
+	struct rte_hash *hash = NULL, *old_hash;
+	uint32_t priority = 0;
+
+	if (port_id < 0 || port_id >= RTE_MAX_ETHPORTS)
+		return -1;
+
+	port = &sw_flow_ports[port_id];
+	grp = find_group(port, rule, &grp_prev);
+	if (grp == NULL)
+		return -1;
+
+	for (prev = &grp->rules; *prev != NULL; prev = &(*prev)->next) {
+		if (*prev == rule)
+			break;
+	}
+	if (*prev == NULL)
+		return -1;
+
+	/* Only the group of the rule is rebuilt, or removed if empty. */
+	if (grp->nof_rules > 1 && build_group_hash(port_id, grp, rule,
+				&hash, &priority) != 0)
+		return -1;
+
+	table = alloc_table(port->nof_groups);
+	if (table == NULL) {
+		rte_hash_free(hash);
+		return -1;
+	}
+
+	*prev = rule->next;
+	grp->nof_rules--;
+	old_hash = grp->group.hash;
+	if (grp->nof_rules == 0) {
+		*grp_prev = grp->next;
+		port->nof_groups--;
+	} else {
+		grp->group.hash = hash;
+		grp->group.priority = priority;
+	}
+
+	publish_table(port_id, table);
+
+	rte_hash_free(old_hash);
+	if (grp->nof_rules == 0)
+		free(grp);
+	free_rule(rule);
+	return 0;
+}
+
+void
+sw_flow_flush(int port_id)
+{
+	struct sw_flow_port *port;
+	struct sw_flow_group_rules *grp, *next_grp;
+	struct sw_flow_rule *rule, *next;
+
+	if (port_id < 0 || port_id >= RTE_MAX_ETHPORTS)
+		return;
+
+	port = &sw_flow_ports[port_id];
+	if (port->groups == NULL)
+		return;
+
+	grp = port->groups;
+	port->groups = NULL;
+	port->nof_groups = 0;
+
+	publish_table(port_id, NULL);
+
+	for (; grp != NULL; grp = next_grp) {
+		next_grp = grp->next;
+		for (rule = grp->rules; rule != NULL; rule = next) {
+			next = rule->next;
+			free_rule(rule);
+		}
+		rte_hash_free(grp->group.hash);
+		free(grp);
+	}
+}
+
+void
+sw_flow_query_count(int port_id, const struct sw_flow_rule *rule,
+	struct rte_flow_query_count *count)
+{
+	struct sw_flow_port *port = &sw_flow_ports[port_id];
+	unsigned int lcore_id;
+	uint32_t id = rule->rule_id;
+
+	memset(count, 0, sizeof(*count));
+	count->hits_set = 1;
+	count->bytes_set = 1;
+	count->hits = port->base_counts[id].hits;
+	count->bytes = port->base_counts[id].bytes;
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+		if (port->counts->lcores[lcore_id] == NULL)
+			continue;
+		count->hits += port->counts->lcores[lcore_id][id].hits;
+		count->bytes += port->counts->lcores[lcore_id][id].bytes;
+	}
+}
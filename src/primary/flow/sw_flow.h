@@ -0,0 +1,86 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2020 Nippon Telegraph and Telephone Corporation
+ */
+
+#ifndef _PRIMARY_FLOW_SW_FLOW_H_
+#define _PRIMARY_FLOW_SW_FLOW_H_
+
+/**
+ * @file
+ * Software flow engine for flow rules which are rejected by the device.
+ *
+ * Rules are compiled into a table of groups of the same mask, and each of
+ * groups is an exact match hash of masked fields. Packets received on the
+ * port are matched in a burst by forwarder and steered to the destination
+ * of the rule. Supported actions are queue, rss, port_id, drop, mark and
+ * count. Only ingress rules of group 0 are supported.
+ *
+ * Only the group of created or destroyed rule is rebuilt. Hit counters are
+ * kept for each of forwarder lcores in arrays indexed with rule ID.
+ */
+
+#include <rte_flow.h>
+
+/* Software flow rule. Its members are private in sw_flow.c. */
+struct sw_flow_rule;
+
+/**
+ * Check if given rule can be installed in software flow engine.
+ *
+ * @param[in] port_id Port ID.
+ * @param[in] attr Attributes of the rule.
+ * @param[in] pattern Pattern items of the rule.
+ * @param[in] actions Actions of the rule.
+ * @param[out] err_msg Reason of failure.
+ * @return 0 if supported, or -1 if not.
+ */
+int sw_flow_validate(int port_id, const struct rte_flow_attr *attr,
+	const struct rte_flow_item *pattern,
+	const struct rte_flow_action *actions,
+	const char **err_msg);
+
+/**
+ * Install a rule in software flow engine of the port. It is used by
+ * forwarder after this function returns.
+ *
+ * @param[in] port_id Port ID.
+ * @param[in] rule_id Rule ID of the rule, used as index of counters.
+ * @param[in] attr Attributes of the rule.
+ * @param[in] pattern Pattern items of the rule.
+ * @param[in] actions Actions of the rule.
+ * @param[out] err_msg Reason of failure.
+ * @return Installed rule, or NULL if failed.
+ */
+struct sw_flow_rule *sw_flow_create(int port_id, uint32_t rule_id,
+	const struct rte_flow_attr *attr,
+	const struct rte_flow_item *pattern,
+	const struct rte_flow_action *actions,
+	const char **err_msg);
+
+/**
+ * Uninstall and free a rule. It returns after forwarder stops referring it.
+ *
+ * @param[in] port_id Port ID.
+ * @param[in] rule Rule returned from sw_flow_create().
+ * @return 0 if succeeded, or -1 if failed.
+ */
+int sw_flow_destroy(int port_id, struct sw_flow_rule *rule);
+
+/**
+ * Uninstall and free all of rules of the port.
+ *
+ * @param[in] port_id Port ID.
+ */
+void sw_flow_flush(int port_id);
+
+/**
+ * Get hit counters of a rule. Packets are always counted in software.
+ *
+ * @param[in] port_id Port ID.
+ * @param[in] rule Rule returned from sw_flow_create().
+ * @param[out] count Hit counters.
+ */
+void sw_flow_query_count(int port_id, const struct sw_flow_rule *rule,
+	struct rte_flow_query_count *count);
+
+#endif
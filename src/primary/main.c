@@ -18,6 +18,7 @@
 #include "primary.h"
 #include "primary/flow/flow.h"
 
+#include "shared/lcore_usage.h"
 #include "shared/port_manager.h"
 #include "shared/secondary/add_port.h"
 #include "shared/secondary/utils.h"
@@ -27,11 +28,14 @@
  * must be equal to MSG_SIZE 32768 defined in `shared/common.h`.
  */
 #define PRI_BUF_SIZE_LCORE 128
-#define PRI_BUF_SIZE_PHY 30720
-#define PRI_BUF_SIZE_PIPE 512
+#define PRI_BUF_SIZE_PHY 30208
+#define PRI_BUF_SIZE_PIPE 1024  /* about 16 pipes of 64 bytes at most */
 #define PRI_BUF_SIZE_RING \
 	(MSG_SIZE - PRI_BUF_SIZE_LCORE - PRI_BUF_SIZE_PHY - PRI_BUF_SIZE_PIPE)
 
+/* Forwarder of primary is optional and not included in the total above. */
+#define PRI_BUF_SIZE_FWD 2048
+
 #define SPP_PATH_LEN 1024  /* seems enough for path of spp procs */
 #define NOF_TOKENS 48  /* seems enough to contain tokens */
 /* should be contain extra two tokens for `python` and path of launcher */
@@ -52,7 +56,8 @@
 struct port_id_map {
 	int port_id;
 	enum port_type type;
-	int rx_ring_id, tx_ring_id;  /* for pipe */
+	int rx_ring_id, tx_ring_id;  /* for pipe, ID of the first ring. */
+	int nof_rx_rings, nof_tx_rings;  /* for pipe, one ring per queue. */
 };
 
 struct port_id_map port_id_list[RTE_MAX_ETHPORTS];
@@ -174,15 +179,20 @@ static void
 forward_loop(void)
 {
 	unsigned int lcore_id = rte_lcore_id();
+	struct lcore_usage_poll poll;
 
 	RTE_LOG(INFO, PRIMARY, "entering main loop on lcore %u\n", lcore_id);
 
+	lcore_usage_poll_begin(&poll);
 	while (1) {
 		if (unlikely(cmd == STOP)) {
 			sleep(1);
+			/* Time of sleeping is not included in usage. */
+			lcore_usage_poll_begin(&poll);
 			continue;
 		} else if (cmd == FORWARD) {
 			forward();
+			lcore_usage_poll_end(&lcore_usages[lcore_id], &poll);
 		}
 	}
 }
@@ -634,9 +644,11 @@ forwarder_status_json(char *str)
 	char buf_running[64];
 	char buf_ports[256];
 	char buf_patches[256];
+	char buf_usage[PRI_BUF_SIZE_FWD - 640];
 	memset(buf_running, '\0', sizeof(buf_running));
 	memset(buf_ports, '\0', sizeof(buf_ports));
 	memset(buf_patches, '\0', sizeof(buf_patches));
+	memset(buf_usage, '\0', sizeof(buf_usage));
 
 	sprintf(buf_running + strlen(buf_running), "\"status\":");
 	if (cmd == FORWARD)
@@ -646,9 +658,12 @@ forwarder_status_json(char *str)
 
 	append_port_info_json(buf_ports);
 	append_patch_info_json(buf_patches);
+	if (append_lcore_usage_json(buf_usage, sizeof(buf_usage),
+				lcore_id_used) < 0)
+		RTE_LOG(WARNING, PRIMARY, "No space for usage of lcores.\n");
 
-	sprintf(str, "\"forwarder\":{%s,%s,%s}", buf_running, buf_ports,
-			buf_patches);
+	sprintf(str, "\"forwarder\":{%s,%s,%s,%s}", buf_running, buf_ports,
+			buf_patches, buf_usage);
 	return 0;
 }
 
@@ -763,17 +778,20 @@ static int
 pipes_json(char *str)
 {
 	uint16_t dev_id;
-	char pipe_buf[30];  /* it is enough if port_id < 1000 */
+	char pipe_buf[64];  /* it is enough if port_id < 1000 */
 	int find = 0;
 
 	strcpy(str, "\"pipes\":[");
 	for (dev_id = 0; dev_id < RTE_MAX_ETHPORTS; dev_id++) {
 		if (port_id_list[dev_id].type != PIPE)
 			continue;
-		sprintf(pipe_buf, "{\"id\":%d,\"rx\":%d,\"tx\":%d}",
+		sprintf(pipe_buf, "{\"id\":%d,\"rx\":%d,\"tx\":%d,"
+				"\"nof_rx\":%d,\"nof_tx\":%d}",
 				port_id_list[dev_id].port_id,
 				port_id_list[dev_id].rx_ring_id,
-				port_id_list[dev_id].tx_ring_id);
+				port_id_list[dev_id].tx_ring_id,
+				port_id_list[dev_id].nof_rx_rings,
+				port_id_list[dev_id].nof_tx_rings);
 		if (strlen(str) + strlen(pipe_buf) > PRI_BUF_SIZE_PIPE - 3) {
 			RTE_LOG(ERR, PRIMARY, "Cannot send all of pipes\n");
 			break;
@@ -843,7 +861,7 @@ get_status_json(char *str)
 			buf_pipes);
 
 	if (get_forwarding_flg() == 1) {
-		char tmp_buf[512];
+		char tmp_buf[PRI_BUF_SIZE_FWD];
 		memset(tmp_buf, '\0', sizeof(tmp_buf));
 		forwarder_status_json(tmp_buf);
 
@@ -860,6 +878,41 @@ get_status_json(char *str)
 	return 0;
 }
 
+/**
+ * Parse rings of pipe given as `ring:0`, or range of rings for multi-queue
+ * such as `ring:0-3`. Return the first ring ID and the number of rings.
+ */
+static int
+parse_pipe_rings(const char *str, int *ring_id, int *nof_rings)
+{
+	const char *ring_str = "ring:";
+	const char *num_start;
+	char *endp;
+	int last_id;
+
+	if (strncmp(str, ring_str, strlen(ring_str)) != 0)
+		return -1;
+
+	num_start = str + strlen(ring_str);
+	*ring_id = strtol(num_start, &endp, 10);
+	if (endp == num_start)
+		return -1;
+
+	if (*endp == '-') {
+		num_start = endp + 1;
+		last_id = strtol(num_start, &endp, 10);
+		if (endp == num_start)
+			return -1;
+	} else
+		last_id = *ring_id;
+
+	if (*endp != '\0' || *ring_id < 0 || last_id < *ring_id)
+		return -1;
+
+	*nof_rings = last_id - *ring_id + 1;
+	return 0;
+}
+
 /**
  * Add a port to spp_primary. Port is given as a resource UID which is a
  * combination of port type and ID like as 'ring:0'.
@@ -885,7 +938,11 @@ add_port(char *p_type, int p_id, char **token_list)
 		port_id_list[cnt].type = VHOST;
 
 	} else if (!strcmp(p_type, "ring")) {
-		res = add_ring_pmd(p_id);
+		/* Sync mode such as `mpsc` is given optionally. */
+		if (token_list[0] != NULL)
+			res = add_ring_pmd_with_mode(p_id, token_list[0]);
+		else
+			res = add_ring_pmd(p_id);
 		port_id_list[cnt].port_id = p_id;
 		port_id_list[cnt].type = RING;
 
@@ -904,17 +961,22 @@ add_port(char *p_type, int p_id, char **token_list)
 		port_id_list[cnt].port_id = p_id;
 		port_id_list[cnt].type = NULLPMD;
 	} else if (!strcmp(p_type, "pipe")) {
-		char *dummy_type;
-		uint16_t dummy_queue;
+		if (token_list[0] == NULL || token_list[1] == NULL)
+			return -1;
+		if (parse_pipe_rings(token_list[0],
+				&port_id_list[cnt].rx_ring_id,
+				&port_id_list[cnt].nof_rx_rings) < 0 ||
+				parse_pipe_rings(token_list[1],
+				&port_id_list[cnt].tx_ring_id,
+				&port_id_list[cnt].nof_tx_rings) < 0) {
+			RTE_LOG(ERR, PRIMARY, "Invalid rings for pipe.\n");
+			return -1;
+		}
 		res = add_pipe_pmd(p_id, token_list[0], token_list[1]);
 		if (res < 0)
 			return -1;
 		port_id_list[cnt].port_id = p_id;
 		port_id_list[cnt].type = PIPE;
-		parse_resource_uid(token_list[0], &dummy_type,
-				&port_id_list[cnt].rx_ring_id, &dummy_queue);
-		parse_resource_uid(token_list[1], &dummy_type,
-				&port_id_list[cnt].tx_ring_id, &dummy_queue);
 	}
 
 	if (res < 0)
@@ -923,8 +985,11 @@ add_port(char *p_type, int p_id, char **token_list)
 	port_id = (uint16_t) res;
 	port_map[port_id].id = p_id;
 	port_map[port_id].port_type = port_id_list[cnt].type;
-	if (port_map[port_id].port_type == RING)
+	if (port_map[port_id].port_type == RING) {
 		port_map[port_id].stats = &ports->client_stats[p_id];
+		port_map[port_id].ring = rte_ring_lookup(
+				get_rx_queue_name(p_id));
+	}
 	/* NOTE: port_map[].stats points to &port_map[].default_stats
 	 * other than RING. There is no support to show/clear this stats
 	 * at the moment.
@@ -964,55 +1029,79 @@ find_ethdev_id(int p_id, enum port_type ptype)
 static int
 del_port(char *p_type, int p_id)
 {
-	uint16_t dev_id = 0;
+	enum port_type type;
+	uint16_t dev_id = PORT_RESET;
 
-	if (!strcmp(p_type, "vhost")) {
-		dev_id = find_ethdev_id(p_id, VHOST);
-		if (dev_id == PORT_RESET)
-			return -1;
-		dev_detach_by_port_id(dev_id);
+	/* pipe is a port only of primary, not in portmap. */
+	if (!strcmp(p_type, "pipe"))
+		type = PIPE;
+	else
+		type = get_port_type(p_type);
+
+	switch (type) {
+	case VHOST:
+	case RING:
+	case PCAP:
+	case MEMIF:
+	case NULLPMD:
+	case PIPE:
+		dev_id = find_ethdev_id(p_id, type);
+		break;
+	default:
+		break;
+	}
+	if (dev_id == PORT_RESET)
+		return -1;
 
-	} else if (!strcmp(p_type, "ring")) {
-		dev_id = find_ethdev_id(p_id, RING);
-		if (dev_id == PORT_RESET)
-			return -1;
+	/* Forwarder should leave the port before it is destroyed. */
+	forward_array_remove(dev_id, 0);
+	publish_fwd_array();
+
+	if (type == RING) {
 		rte_eth_dev_stop(dev_id);
 		rte_eth_dev_close(dev_id);
-
-	} else if (!strcmp(p_type, "pcap")) {
-		dev_id = find_ethdev_id(p_id, PCAP);
-		if (dev_id == PORT_RESET)
-			return -1;
-		dev_detach_by_port_id(dev_id);
-
-	} else if (!strcmp(p_type, "memif")) {
-		dev_id = find_ethdev_id(p_id, MEMIF);
-		if (dev_id == PORT_RESET)
-			return -1;
-		dev_detach_by_port_id(dev_id);
-
-	} else if (!strcmp(p_type, "nullpmd")) {
-		dev_id = find_ethdev_id(p_id, NULLPMD);
-		if (dev_id == PORT_RESET)
-			return -1;
-		dev_detach_by_port_id(dev_id);
-
-	} else if (!strcmp(p_type, "pipe")) {
-		dev_id = find_ethdev_id(p_id, PIPE);
-		if (dev_id == PORT_RESET)
-			return -1;
+	} else
 		dev_detach_by_port_id(dev_id);
-	}
 
 	port_id_list[dev_id].port_id = PORT_RESET;
 	port_id_list[dev_id].type = UNDEF;
 
-	forward_array_remove(dev_id, 0);
 	port_map_init_one(dev_id);
 
 	return 0;
 }
 
+/**
+ * Execute `patch` commands given as a batch such as
+ * `batch patch phy:0 ring:0;patch ring:0 phy:1` and publish them at once.
+ * Response is written to given str.
+ */
+static int
+exec_batch(char *str)
+{
+	char err_msg[128] = { 0 };
+	int nof_cmds;
+
+	nof_cmds = exec_patch_batch(str + strlen(BATCH_CMD_PREFIX),
+			err_msg, sizeof(err_msg));
+
+	memset(str, '\0', MSG_SIZE);
+	if (nof_cmds < 0) {
+		RTE_LOG(ERR, PRIMARY, "Failed to exec batch, %s.\n", err_msg);
+		sprintf(str, "{%s:%s,%s:%s,%s:\"%s\"}",
+				"\"result\"", "\"failed\"",
+				"\"command\"", "\"batch\"",
+				"\"error\"", err_msg);
+		return -1;
+	}
+
+	sprintf(str, "{%s:%s,%s:%s,%s:%d}",
+			"\"result\"", "\"succeeded\"",
+			"\"command\"", "\"batch\"",
+			"\"nof_cmds\"", nof_cmds);
+	return 0;
+}
+
 static int
 parse_command(char *str)
 {
@@ -1034,6 +1123,13 @@ parse_command(char *str)
 	memset(sec_name, '\0', 16);
 	memset(tmp_response, '\0', MSG_SIZE);
 
+	/* Commands in batch are separated with `;` and not tokenized here. */
+	if (!strncmp(str, BATCH_CMD_PREFIX, strlen(BATCH_CMD_PREFIX))) {
+		RTE_LOG(DEBUG, PRIMARY, "batch\n");
+		exec_batch(str);
+		return 0;
+	}
+
 	/* tokenize the user commands from controller */
 	token_list[max_token] = strtok(str, " ");
 	while (token_list[max_token] != NULL) {
@@ -1111,6 +1207,7 @@ parse_command(char *str)
 			sprintf(result, "%s", "\"failed\"");
 		} else
 			sprintf(result, "%s", "\"succeeded\"");
+		publish_fwd_array();
 
 		sprintf(port_uid, "\"%s:%d\"", p_type, p_id);
 		memset(str, '\0', MSG_SIZE);
@@ -1151,6 +1248,7 @@ parse_command(char *str)
 		if (strncmp(token_list[1], "reset", 5) == 0) {
 			/* reset forward array*/
 			forward_array_reset();
+			publish_fwd_array();
 		} else {
 			uint16_t in_port;
 			uint16_t out_port;
@@ -1200,6 +1298,7 @@ parse_command(char *str)
 
 			if (add_patch(in_port, in_queue_id, out_port,
 				out_queue_id) == 0) {
+				publish_fwd_array();
 				RTE_LOG(INFO, PRIMARY,
 					"Patched '%s:%d' and '%s:%d'\n",
 					in_p_type, in_p_id,
@@ -1406,6 +1505,7 @@ main(int argc, char *argv[])
 					port_type, port_id);
 
 		}
+		publish_fwd_array();
 
 		/* do forwarding */
 		rte_eal_mp_remote_launch(main_loop, NULL, SKIP_MASTER);
@@ -3,18 +3,210 @@
  */
 
 #include <stdint.h>
+#include <rte_pause.h>
 #include "shared/common.h"
 #include "shared/basic_forwarder.h"
+#include "shared/latency.h"
+#include "shared/lcore_usage.h"
 #include "shared/port_manager.h"
+#include "shared/trace.h"
 
+/* Number of published forwarding tables, referred one and spare one. */
+#define NOF_FWD_ARRAYS 2
+
+/*
+ * Forwarding tables copied from ports_fwd_array. One of them is referred from
+ * forward(), and another one is used for publishing next.
+ */
+static struct port fwd_arrays[NOF_FWD_ARRAYS][RTE_MAX_ETHPORTS]
+		[RTE_MAX_QUEUES_PER_PORT];
+static int fwd_array_idx;
+static struct port (*volatile cur_fwd_array)[RTE_MAX_QUEUES_PER_PORT] =
+		fwd_arrays[0];
+
+/*
+ * Sequence number of each lcore incremented at entering and leaving
+ * forward(). It is odd while the lcore is in forward().
+ */
+struct fwd_lcore_seq {
+	volatile uint32_t seq;
+} __rte_cache_aligned;
+
+static struct fwd_lcore_seq fwd_lcore_seqs[RTE_MAX_LCORE];
+
+/* Publish ports_fwd_array to forward() with a single pointer swap. */
 void
-forward(void)
+publish_fwd_array(void)
 {
-	uint16_t nb_rx;
+	int next_idx = (fwd_array_idx + 1) % NOF_FWD_ARRAYS;
+	unsigned int lcore_id;
+	uint32_t seq;
+
+	memcpy(fwd_arrays[next_idx], ports_fwd_array, sizeof(ports_fwd_array));
+	rte_smp_wmb();
+	cur_fwd_array = fwd_arrays[next_idx];
+	fwd_array_idx = next_idx;
+	rte_smp_mb();
+	trace_swap(TRACE_SWAP_FWD_ARRAY, 0, next_idx);
+
+	/* Wait for lcores in forward() for previous one to leave. */
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+		seq = fwd_lcore_seqs[lcore_id].seq;
+		if ((seq & 1) == 0)
+			continue;
+		while (fwd_lcore_seqs[lcore_id].seq == seq)
+			rte_pause();
+	}
+}
+
+/* Discard changes of ports_fwd_array by restoring the published one. */
+void
+discard_fwd_array(void)
+{
+	memcpy(ports_fwd_array, fwd_arrays[fwd_array_idx],
+			sizeof(ports_fwd_array));
+}
+
+/*
+ * Receive packets from the ring of RING port without ring PMD. Nothing is
+ * received if the port is deleted, as the ring is cleared.
+ */
+uint16_t
+ring_rx_burst(uint16_t port_id, uint16_t queue_id __attribute__ ((unused)),
+		struct rte_mbuf **rx_pkts, uint16_t nb_pkts)
+{
+	struct rte_ring *ring = port_map[port_id].ring;
+
+	if (unlikely(ring == NULL))
+		return 0;
+	return (uint16_t)rte_ring_dequeue_burst(ring, (void **)rx_pkts,
+			nb_pkts, NULL);
+}
+
+/*
+ * Send packets to the ring of RING port without ring PMD. Nothing is sent,
+ * and packets are freed by the caller, if the port is deleted.
+ */
+uint16_t
+ring_tx_burst(uint16_t port_id, uint16_t queue_id __attribute__ ((unused)),
+		struct rte_mbuf **tx_pkts, uint16_t nb_pkts)
+{
+	struct rte_ring *ring = port_map[port_id].ring;
+
+	if (unlikely(ring == NULL))
+		return 0;
+	return (uint16_t)rte_ring_enqueue_burst(ring, (void **)tx_pkts,
+			nb_pkts, NULL);
+}
+
+/* Send packets to given port and free unsent ones. */
+static inline void
+send_pkts(struct port (*fwd_array)[RTE_MAX_QUEUES_PER_PORT],
+		uint16_t out_port, uint16_t out_queue,
+		struct rte_mbuf **pkts, uint16_t nb_pkts)
+{
+	uint64_t stamps[MAX_PKT_BURST];
 	uint16_t nb_tx;
+	uint16_t buf;
+
+	latency_load_stamps(pkts, nb_pkts, stamps);
+	nb_tx = fwd_array[out_port][out_queue].tx_func(
+		out_port, out_queue, pkts, nb_pkts);
+	latency_record_stamps(out_port, stamps, nb_tx);
+
+	port_map[out_port].stats->tx += nb_tx;
+	trace_burst_tx(out_port, out_queue, nb_pkts, nb_tx);
+
+	if (unlikely(nb_tx < nb_pkts)) {
+		port_map[out_port].stats->tx_drop += (nb_pkts - nb_tx);
+		trace_drop(out_port, TRACE_DROP_TX_FULL, nb_pkts - nb_tx);
+		for (buf = nb_tx; buf < nb_pkts; buf++)
+			rte_pktmbuf_free(pkts[buf]);
+	}
+}
+
+/*
+ * Forward packets to destinations decided by `steer_func` of the receiving
+ * port. Packets for the same destination are sent in a burst keeping its
+ * order. Packets for a destination not patched are dropped.
+ */
+static inline void
+forward_steered_pkts(struct port (*fwd_array)[RTE_MAX_QUEUES_PER_PORT],
+		uint16_t in_port, uint16_t in_queue,
+		struct rte_mbuf **bufs, uint16_t nb_rx)
+{
+	struct fwd_steer_dest dests[MAX_PKT_BURST];
+	uint16_t out_ports[MAX_PKT_BURST];
+	uint16_t out_queues[MAX_PKT_BURST];
+	struct rte_mbuf *tx_bufs[MAX_PKT_BURST];
+	struct port *in = &fwd_array[in_port][in_queue];
+	struct port *patch;
+	uint16_t nb_tx, nb_drop = 0;
+	uint16_t i, j;
+
+	in->steer_func(in_port, in_queue, bufs, nb_rx, dests);
+
+	/* Resolve destination port and queue of each packet. */
+	for (i = 0; i < nb_rx; i++) {
+		switch (dests[i].type) {
+		case FWD_STEER_PATCH:
+			out_ports[i] = in->out_port_id;
+			out_queues[i] = in->out_queue_id;
+			break;
+		case FWD_STEER_QUEUE:
+			patch = &fwd_array[in_port][dests[i].id];
+			out_ports[i] = patch->out_port_id;
+			out_queues[i] = patch->out_queue_id;
+			break;
+		case FWD_STEER_PORT:
+			if (fwd_array[dests[i].id][0].in_port_id == PORT_RESET)
+				out_ports[i] = PORT_RESET;
+			else
+				out_ports[i] = dests[i].id;
+			out_queues[i] = 0;
+			break;
+		default:
+			out_ports[i] = PORT_RESET;
+			break;
+		}
+
+		if (out_ports[i] == PORT_RESET) {
+			rte_pktmbuf_free(bufs[i]);
+			bufs[i] = NULL;
+			nb_drop++;
+		}
+	}
+	port_map[in_port].stats->rx_drop += nb_drop;
+	if (unlikely(nb_drop != 0))
+		trace_drop(in_port, TRACE_DROP_NO_DEST, nb_drop);
+
+	/* Gather packets of the same destination and send them at once. */
+	for (i = 0; i < nb_rx; i++) {
+		if (bufs[i] == NULL)
+			continue;
+
+		nb_tx = 0;
+		for (j = i; j < nb_rx; j++) {
+			if (bufs[j] == NULL || out_ports[j] != out_ports[i] ||
+					out_queues[j] != out_queues[i])
+				continue;
+			tx_bufs[nb_tx++] = bufs[j];
+			if (j != i)
+				bufs[j] = NULL;
+		}
+
+		send_pkts(fwd_array, out_ports[i], out_queues[i], tx_bufs,
+				nb_tx);
+	}
+}
+
+/* Forward packets between ports patched in given forwarding table. */
+static inline void
+forward_ports(struct port (*fwd_array)[RTE_MAX_QUEUES_PER_PORT])
+{
+	uint16_t nb_rx;
 	int in_port;
 	int out_port;
-	uint16_t buf;
 	int i, j;
 	uint16_t max_queue, in_queue, out_queue;
 
@@ -28,40 +220,53 @@ forward(void)
 
 			struct rte_mbuf *bufs[MAX_PKT_BURST];
 
-			if (ports_fwd_array[i][j].in_port_id == PORT_RESET)
+			if (fwd_array[i][j].in_port_id == PORT_RESET)
 				continue;
 
-			if (ports_fwd_array[i][j].out_port_id == PORT_RESET)
+			/* Queues not patched might be polled by others. */
+			if (fwd_array[i][j].out_port_id == PORT_RESET)
 				continue;
 
 			/* if status active, i count is in port*/
 			in_port = i;
 			in_queue = j;
-			out_port = ports_fwd_array[i][j].out_port_id;
-			out_queue = ports_fwd_array[i][j].out_queue_id;
+			out_port = fwd_array[i][j].out_port_id;
+			out_queue = fwd_array[i][j].out_queue_id;
 
 			/* Get burst of RX packets, from first port of pair. */
 			/*first port rx, second port tx*/
-			nb_rx = ports_fwd_array[in_port][in_queue].rx_func(
+			nb_rx = fwd_array[in_port][in_queue].rx_func(
 				in_port, in_queue, bufs, MAX_PKT_BURST);
 			if (unlikely(nb_rx == 0))
 				continue;
 
 			port_map[in_port].stats->rx += nb_rx;
+			lcore_usage_add_rx(nb_rx);
+			trace_burst_rx(in_port, in_queue, nb_rx);
+			latency_stamp_burst(bufs, nb_rx);
 
-			/* Send burst of TX packets, to second port of pair. */
-			nb_tx = ports_fwd_array[out_port][out_queue].tx_func(
-				out_port, out_queue, bufs, nb_rx);
-
-			port_map[out_port].stats->tx += nb_tx;
-
-			/* Free any unsent packets. */
-			if (unlikely(nb_tx < nb_rx)) {
-				port_map[out_port].stats->tx_drop += (nb_rx -
-					nb_tx);
-				for (buf = nb_tx; buf < nb_rx; buf++)
-					rte_pktmbuf_free(bufs[buf]);
+			/* Steer packets if the port has steering rules. */
+			if (fwd_array[in_port][in_queue].steer_func != NULL) {
+				forward_steered_pkts(fwd_array, in_port,
+					in_queue, bufs, nb_rx);
+				continue;
 			}
+
+			/* Send burst of TX packets, to second port of pair. */
+			send_pkts(fwd_array, out_port, out_queue, bufs, nb_rx);
 		}
 	}
 }
+
+void
+forward(void)
+{
+	struct fwd_lcore_seq *lcore_seq = &fwd_lcore_seqs[rte_lcore_id()];
+
+	/* Refer to the table published at the time while seq is odd. */
+	lcore_seq->seq++;
+	rte_smp_mb();
+	forward_ports(cur_fwd_array);
+	rte_smp_mb();
+	lcore_seq->seq++;
+}
@@ -10,6 +10,34 @@
 struct port_map port_map[RTE_MAX_ETHPORTS];
 struct port ports_fwd_array[RTE_MAX_ETHPORTS][RTE_MAX_QUEUES_PER_PORT];
 
+/**
+ * Receive packets from the ring of RING port directly. It is compatible with
+ * rte_eth_rx_burst() to be used as `rx_func` of `struct port`.
+ */
+uint16_t ring_rx_burst(uint16_t port_id, uint16_t queue_id,
+		struct rte_mbuf **rx_pkts, uint16_t nb_pkts);
+
+/**
+ * Send packets to the ring of RING port directly. It is compatible with
+ * rte_eth_tx_burst() to be used as `tx_func` of `struct port`.
+ */
+uint16_t ring_tx_burst(uint16_t port_id, uint16_t queue_id,
+		struct rte_mbuf **tx_pkts, uint16_t nb_pkts);
+
+/**
+ * Publish ports_fwd_array to be referred from forward() by swapping pointer
+ * of the forwarding table. Changes of ports_fwd_array are not used for
+ * forwarding until published. It returns after all of forwarders referring
+ * the previous table leave from forward().
+ */
+void publish_fwd_array(void);
+
+/**
+ * Discard changes of ports_fwd_array which are not published yet, by
+ * restoring the published forwarding table.
+ */
+void discard_fwd_array(void);
+
 void forward(void);
 
 #endif
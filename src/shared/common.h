@@ -9,6 +9,7 @@
 #include <signal.h>
 #include <unistd.h>
 #include <rte_ethdev_driver.h>
+#include <rte_ring.h>
 
 /*
  * TODO(tx_h-yamashita): Remove this definition because it was used from
@@ -120,6 +121,22 @@ struct port_map {
 	struct stats default_stats;
 	/* num of queues per port */
 	struct port_queue *queue_info;
+	/* Ring of RING port to be accessed directly without ring PMD. */
+	struct rte_ring *ring;
+};
+
+/* Kind of destination of a packet decided by `steer_func` of a port. */
+enum fwd_steer_type {
+	FWD_STEER_PATCH,  /* Follow the patch of the receiving port and queue */
+	FWD_STEER_QUEUE,  /* Follow the patch of another queue of the port */
+	FWD_STEER_PORT,   /* Send to the first queue of another port */
+	FWD_STEER_DROP,   /* Free the packet */
+};
+
+/* Destination of a steered packet, `id` is a queue or port ID. */
+struct fwd_steer_dest {
+	uint16_t type;
+	uint16_t id;
 };
 
 struct port {
@@ -129,6 +146,12 @@ struct port {
 	uint16_t out_queue_id;
 	uint16_t (*rx_func)(uint16_t, uint16_t, struct rte_mbuf **, uint16_t);
 	uint16_t (*tx_func)(uint16_t, uint16_t, struct rte_mbuf **, uint16_t);
+	/*
+	 * Decide destination of each of received packets if it is not NULL,
+	 * instead of forwarding all of them to the patched port.
+	 */
+	void (*steer_func)(uint16_t, uint16_t, struct rte_mbuf **, uint16_t,
+			struct fwd_steer_dest *);
 };
 
 /* define common names for structures shared between server and client */
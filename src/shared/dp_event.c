@@ -0,0 +1,42 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2020 Nippon Telegraph and Telephone Corporation
+ */
+
+#include <inttypes.h>
+#include <rte_log.h>
+#include "shared/dp_event.h"
+
+#define RTE_LOGTYPE_DP_EVENT RTE_LOGTYPE_USER1
+
+/* Name and level of log of each of reasons. */
+static const struct {
+	const char *name;
+	uint32_t level;
+} dp_event_descs[DP_EVENT_NOF_REASONS] = {
+	[DP_EVENT_TX_FULL] = { "tx_full", RTE_LOG_INFO },
+	[DP_EVENT_NO_MBUF] = { "no_mbuf", RTE_LOG_INFO },
+	[DP_EVENT_RING_FULL] = { "ring_full", RTE_LOG_ERR },
+	[DP_EVENT_VLAN] = { "vlan", RTE_LOG_ERR },
+};
+
+struct dp_event_stats dp_event_stats[RTE_MAX_LCORE];
+
+const char *
+dp_event_name(enum dp_event_reason reason)
+{
+	return dp_event_descs[reason].name;
+}
+
+void
+dp_event_log(unsigned int lcore_id, enum dp_event_reason reason,
+		uint32_t nb_pkts)
+{
+	struct dp_event_stats *stats = &dp_event_stats[lcore_id];
+
+	rte_log(dp_event_descs[reason].level, RTE_LOGTYPE_DP_EVENT,
+			"DP_EVENT: Dropped %u packets for %s on lcore %u "
+			"(total=%" PRIu64 ", suppressed_logs=%" PRIu64 ").\n",
+			nb_pkts, dp_event_descs[reason].name, lcore_id,
+			stats->pkts[reason], stats->suppressed[reason]);
+	stats->suppressed[reason] = 0;
+}
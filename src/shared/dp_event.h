@@ -0,0 +1,106 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2020 Nippon Telegraph and Telephone Corporation
+ */
+
+#ifndef __SHARED_DP_EVENT_H__
+#define __SHARED_DP_EVENT_H__
+
+/**
+ * @file
+ * Counters and rate limited logs of errors on data path
+ *
+ * Errors such as drops can occur on every burst under overload, and
+ * logging each of them makes it worse. Packets of errors are counted for
+ * each of lcores and reasons instead, and a log is emitted only if a
+ * token of the bucket of the lcore and reason is left. Logs suppressed are
+ * counted and reported in the next log.
+ */
+
+#include <stdint.h>
+#include <rte_branch_prediction.h>
+#include <rte_cycles.h>
+#include <rte_lcore.h>
+
+/* Num of logs allowed in a second for each of lcores and reasons. */
+#define DP_EVENT_LOG_RATE 1
+
+/* Num of logs allowed in a burst. */
+#define DP_EVENT_LOG_BURST 5
+
+enum dp_event_reason {
+	DP_EVENT_TX_FULL,    /* Packets not sent because TX queue is full. */
+	DP_EVENT_NO_MBUF,    /* Failed to alloc mbuf for a copy. */
+	DP_EVENT_RING_FULL,  /* Packets not enqueued because ring is full. */
+	DP_EVENT_VLAN,       /* Failed to add or delete VLAN tag. */
+	DP_EVENT_NOF_REASONS,
+};
+
+/* Counters of an lcore, updated only by the lcore. */
+struct dp_event_stats {
+	uint64_t pkts[DP_EVENT_NOF_REASONS];  /* Num of packets of errors. */
+	uint64_t tokens[DP_EVENT_NOF_REASONS];  /* Tokens in TSC cycles. */
+	uint64_t last_tsc[DP_EVENT_NOF_REASONS];  /* Last refill of tokens. */
+	uint64_t suppressed[DP_EVENT_NOF_REASONS];  /* Logs not emitted. */
+} __rte_cache_aligned;
+
+extern struct dp_event_stats dp_event_stats[RTE_MAX_LCORE];
+
+/**
+ * Get name of reason used in logs and status, such as `tx_full`.
+ *
+ * @param reason Reason of error.
+ * @return Name of reason.
+ */
+const char *dp_event_name(enum dp_event_reason reason);
+
+/* Emit log of an error. Not inlined to keep hot paths small. */
+void dp_event_log(unsigned int lcore_id, enum dp_event_reason reason,
+		uint32_t nb_pkts);
+
+/* Take a token to emit a log, or return 0 if the bucket is empty. */
+static inline int
+dp_event_take_token(struct dp_event_stats *stats,
+		enum dp_event_reason reason)
+{
+	uint64_t now = rte_rdtsc();
+	uint64_t cost = rte_get_tsc_hz() / DP_EVENT_LOG_RATE;
+	uint64_t tokens = stats->tokens[reason] +
+			(now - stats->last_tsc[reason]);
+
+	if (tokens > cost * DP_EVENT_LOG_BURST)
+		tokens = cost * DP_EVENT_LOG_BURST;
+	stats->last_tsc[reason] = now;
+
+	if (tokens < cost) {
+		stats->tokens[reason] = tokens;
+		return 0;
+	}
+	stats->tokens[reason] = tokens - cost;
+	return 1;
+}
+
+/**
+ * Count packets of an error on this lcore, and emit a log if it is not
+ * rate limited.
+ *
+ * @param reason Reason of error.
+ * @param nb_pkts Num of packets.
+ */
+static inline void
+dp_event_add(enum dp_event_reason reason, uint32_t nb_pkts)
+{
+	unsigned int lcore_id = rte_lcore_id();
+	struct dp_event_stats *stats;
+
+	if (unlikely(lcore_id >= RTE_MAX_LCORE))
+		return;
+
+	stats = &dp_event_stats[lcore_id];
+	stats->pkts[reason] += nb_pkts;
+	if (dp_event_take_token(stats, reason))
+		dp_event_log(lcore_id, reason, nb_pkts);
+	else
+		stats->suppressed[reason]++;
+}
+
+#endif
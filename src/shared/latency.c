@@ -0,0 +1,165 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2020 Nippon Telegraph and Telephone Corporation
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <rte_errno.h>
+#include <rte_log.h>
+#include <rte_malloc.h>
+#include "shared/latency.h"
+
+#define RTE_LOGTYPE_LATENCY RTE_LOGTYPE_USER1
+
+int latency_ts_offset = -1;
+uint64_t latency_flag;
+unsigned int latency_sample_rate;
+struct latency_hist *latency_hists[RTE_MAX_LCORE];
+
+RTE_DEFINE_PER_LCORE(unsigned int, latency_sample_cnt);
+
+int
+latency_parse_sample_rate(const char *str, unsigned int *rate)
+{
+	unsigned long val;
+	char *endptr;
+
+	errno = 0;
+	val = strtoul(str, &endptr, 10);
+	if (errno != 0 || *str == '\0' || *endptr != '\0' || val == 0 ||
+			val > UINT32_MAX)
+		return -1;
+
+	*rate = val;
+	return 0;
+}
+
+int
+latency_init(unsigned int sample_rate)
+{
+	static const struct rte_mbuf_dynfield ts_params = {
+		.name = LATENCY_DYNFIELD_NAME,
+		.size = sizeof(uint64_t),
+		.align = __alignof__(uint64_t),
+	};
+	static const struct rte_mbuf_dynflag flag_params = {
+		.name = LATENCY_DYNFLAG_NAME,
+	};
+	unsigned int lcore_id;
+	int offset, bit;
+
+	/**
+	 * Histograms are allocated for all of lcores given to EAL because
+	 * role of an lcore can be changed to service lcore after that.
+	 */
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+		if (rte_lcore_has_role(lcore_id, ROLE_OFF))
+			continue;
+
+		latency_hists[lcore_id] = rte_zmalloc_socket("latency_hists",
+				sizeof(struct latency_hist) * RTE_MAX_ETHPORTS,
+				RTE_CACHE_LINE_SIZE,
+				rte_lcore_to_socket_id(lcore_id));
+		if (latency_hists[lcore_id] == NULL) {
+			RTE_LOG(ERR, LATENCY,
+					"Failed to alloc histograms of lcore %u.\n",
+					lcore_id);
+			return -1;
+		}
+	}
+
+	offset = rte_mbuf_dynfield_register(&ts_params);
+	if (offset < 0) {
+		RTE_LOG(ERR, LATENCY, "Failed to register %s (%s).\n",
+				LATENCY_DYNFIELD_NAME, rte_strerror(rte_errno));
+		return -1;
+	}
+
+	bit = rte_mbuf_dynflag_register(&flag_params);
+	if (bit < 0) {
+		RTE_LOG(ERR, LATENCY, "Failed to register %s (%s).\n",
+				LATENCY_DYNFLAG_NAME, rte_strerror(rte_errno));
+		return -1;
+	}
+
+	latency_ts_offset = offset;
+	latency_sample_rate = sample_rate;
+	rte_smp_wmb();
+	latency_flag = 1ULL << bit;
+
+	RTE_LOG(INFO, LATENCY, "Latency enabled (sample_rate=%u).\n",
+			sample_rate);
+	return 0;
+}
+
+void
+latency_sum_hist(uint16_t port_id, struct latency_hist *sum)
+{
+	const struct latency_hist *hist;
+	unsigned int lcore_id, idx;
+
+	memset(sum, 0, sizeof(*sum));
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+		if (latency_hists[lcore_id] == NULL)
+			continue;
+
+		hist = &latency_hists[lcore_id][port_id];
+		if (hist->count == 0)
+			continue;
+
+		sum->count += hist->count;
+		sum->sum += hist->sum;
+		if (hist->max > sum->max)
+			sum->max = hist->max;
+		for (idx = 0; idx < LATENCY_NOF_BUCKETS; idx++)
+			sum->buckets[idx] += hist->buckets[idx];
+	}
+}
+
+uint64_t
+latency_cycles_to_ns(uint64_t cycles)
+{
+	uint64_t hz = rte_get_tsc_hz();
+
+	if (unlikely(hz == 0))
+		return 0;
+
+	/* Divide first for large cycles to avoid overflow. */
+	return (cycles / hz) * NS_PER_S + (cycles % hz) * NS_PER_S / hz;
+}
+
+uint64_t
+latency_bucket_cycles(unsigned int idx)
+{
+	unsigned int range, sub;
+
+	if (idx < LATENCY_NOF_SUBS)
+		return idx;
+
+	range = idx >> LATENCY_SUB_BITS;
+	sub = idx & (LATENCY_NOF_SUBS - 1);
+	return (uint64_t)(LATENCY_NOF_SUBS + sub) << (range - 1);
+}
+
+uint64_t
+latency_percentile_ns(const struct latency_hist *hist, unsigned int permille)
+{
+	uint64_t target, cnt = 0;
+	unsigned int idx;
+
+	if (hist->count == 0)
+		return 0;
+
+	/* Rank of the packet of the percentile, starting from 1. */
+	target = (hist->count * permille + 999) / 1000;
+	if (target == 0)
+		target = 1;
+
+	for (idx = 0; idx < LATENCY_NOF_BUCKETS; idx++) {
+		cnt += hist->buckets[idx];
+		if (cnt >= target)
+			return latency_cycles_to_ns(latency_bucket_cycles(idx));
+	}
+	return latency_cycles_to_ns(hist->max);
+}
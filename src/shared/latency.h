@@ -0,0 +1,236 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2020 Nippon Telegraph and Telephone Corporation
+ */
+
+#ifndef __SHARED_LATENCY_H__
+#define __SHARED_LATENCY_H__
+
+/**
+ * @file
+ * Latency of packets between SPP processes
+ *
+ * The first RX point of SPP stamps TSC to packets in a mbuf dynamic field,
+ * and each of TX points records the delta to a log-linear histogram of the
+ * port. Several lcores can send to queues of the same port, so each of
+ * lcores has its own histograms which are summed up for status. Packets
+ * are marked with a dynamic flag at the first RX point, and only packets
+ * not marked are stamped at following RX points. Unsampled packets are
+ * marked with a stamp of zero which is not recorded.
+ *
+ * It is enabled with `--latency RATE` for each of processes, and all of
+ * processes in a chain should be launched with it to record from the first
+ * RX point.
+ */
+
+#include <stdint.h>
+#include <rte_branch_prediction.h>
+#include <rte_cycles.h>
+#include <rte_lcore.h>
+#include <rte_mbuf.h>
+#include <rte_mbuf_dyn.h>
+
+#define LATENCY_DYNFIELD_NAME "spp_dynfield_latency_tsc"
+#define LATENCY_DYNFLAG_NAME "spp_dynflag_latency"
+
+/* Num of buckets in each of power of two ranges of cycles. */
+#define LATENCY_SUB_BITS 3
+#define LATENCY_NOF_SUBS (1 << LATENCY_SUB_BITS)
+
+/* Cycles recorded up to 2^36, or counted in the last bucket. */
+#define LATENCY_NOF_RANGES 36
+#define LATENCY_NOF_BUCKETS \
+	((LATENCY_NOF_RANGES - LATENCY_SUB_BITS + 1) * LATENCY_NOF_SUBS)
+
+/*
+ * Histogram of latency of packets sent to a port from an lcore. Counters
+ * are not atomic because it is updated only from the lcore.
+ */
+struct latency_hist {
+	uint64_t count;
+	uint64_t sum;  /* Sum of cycles for average. */
+	uint64_t max;  /* Max of cycles. */
+	uint64_t buckets[LATENCY_NOF_BUCKETS];
+} __rte_cache_aligned;
+
+extern int latency_ts_offset;
+extern uint64_t latency_flag;
+extern unsigned int latency_sample_rate;
+/* Histograms of ports for each of lcores, or NULL for lcore not used. */
+extern struct latency_hist *latency_hists[RTE_MAX_LCORE];
+
+RTE_DECLARE_PER_LCORE(unsigned int, latency_sample_cnt);
+
+/**
+ * Parse sample rate given as `--latency RATE`. One of RATE packets is
+ * stamped, and all of packets are stamped if it is 1.
+ *
+ * @param str Sample rate.
+ * @param[out] rate Sample rate parsed.
+ * @return 0 if succeeded, or -1.
+ */
+int latency_parse_sample_rate(const char *str, unsigned int *rate);
+
+/**
+ * Register the dynamic field and flag, and enable stamping and recording
+ * latency. The same offset of the field is given for all of processes.
+ *
+ * @param sample_rate One of `sample_rate` packets is stamped.
+ * @return 0 if succeeded, or -1.
+ */
+int latency_init(unsigned int sample_rate);
+
+/* Return 1 if latency is recorded, or 0. */
+static inline int
+latency_is_enabled(void)
+{
+	return latency_flag != 0;
+}
+
+/* Get index of bucket of given cycles. */
+static inline unsigned int
+latency_bucket_idx(uint64_t cycles)
+{
+	unsigned int msb;
+
+	if (cycles < LATENCY_NOF_SUBS)
+		return cycles;
+	if (unlikely(cycles >> LATENCY_NOF_RANGES))
+		return LATENCY_NOF_BUCKETS - 1;
+
+	msb = 63 - __builtin_clzll(cycles);
+	return ((msb - LATENCY_SUB_BITS + 1) << LATENCY_SUB_BITS) |
+		((cycles >> (msb - LATENCY_SUB_BITS)) &
+		 (LATENCY_NOF_SUBS - 1));
+}
+
+/**
+ * Stamp TSC to packets received at the first RX point of SPP. Packets
+ * already marked by previous one are not changed.
+ */
+static inline void
+latency_stamp_burst(struct rte_mbuf **pkts, uint16_t nb_pkts)
+{
+	unsigned int *cnt;
+	uint64_t now;
+	uint16_t buf;
+
+	if (likely(latency_sample_rate == 0))
+		return;
+
+	cnt = &RTE_PER_LCORE(latency_sample_cnt);
+	now = rte_rdtsc();
+	for (buf = 0; buf < nb_pkts; buf++) {
+		if (pkts[buf]->ol_flags & latency_flag)
+			continue;
+
+		pkts[buf]->ol_flags |= latency_flag;
+		if (++(*cnt) >= latency_sample_rate) {
+			*cnt = 0;
+			*RTE_MBUF_DYNFIELD(pkts[buf], latency_ts_offset,
+					uint64_t *) = now;
+		} else {
+			*RTE_MBUF_DYNFIELD(pkts[buf], latency_ts_offset,
+					uint64_t *) = 0;
+		}
+	}
+}
+
+/**
+ * Copy the stamp of `org` to `copy` of which flags are copied, such as
+ * a mirrored packet.
+ */
+static inline void
+latency_copy_stamp(struct rte_mbuf *copy, struct rte_mbuf *org)
+{
+	if (likely(!(org->ol_flags & latency_flag)))
+		return;
+
+	*RTE_MBUF_DYNFIELD(copy, latency_ts_offset, uint64_t *) =
+		*RTE_MBUF_DYNFIELD(org, latency_ts_offset, uint64_t *);
+}
+
+/**
+ * Load stamps of packets to `stamps` before sending, because packets sent
+ * might be released by the PMD. Zero is loaded for packets not sampled.
+ * It does nothing if latency is not recorded.
+ */
+static inline void
+latency_load_stamps(struct rte_mbuf **pkts, uint16_t nb_pkts,
+		uint64_t *stamps)
+{
+	uint16_t buf;
+
+	if (likely(latency_flag == 0))
+		return;
+
+	for (buf = 0; buf < nb_pkts; buf++) {
+		if (pkts[buf]->ol_flags & latency_flag)
+			stamps[buf] = *RTE_MBUF_DYNFIELD(pkts[buf],
+					latency_ts_offset, uint64_t *);
+		else
+			stamps[buf] = 0;
+	}
+}
+
+/**
+ * Record latency of packets sent to the histogram of the port from stamps
+ * loaded with latency_load_stamps(). Only the first `nb_sent` ones should
+ * be given, not to count packets rejected by the PMD.
+ */
+static inline void
+latency_record_stamps(uint16_t port_id, const uint64_t *stamps,
+		uint16_t nb_sent)
+{
+	unsigned int lcore_id = rte_lcore_id();
+	struct latency_hist *hist;
+	uint64_t now, cycles;
+	uint16_t buf;
+
+	if (likely(latency_flag == 0))
+		return;
+	if (unlikely(lcore_id >= RTE_MAX_LCORE ||
+			latency_hists[lcore_id] == NULL))
+		return;
+
+	hist = &latency_hists[lcore_id][port_id];
+	now = rte_rdtsc();
+	for (buf = 0; buf < nb_sent; buf++) {
+		if (stamps[buf] == 0)
+			continue;
+
+		cycles = likely(now > stamps[buf]) ? now - stamps[buf] : 0;
+		hist->buckets[latency_bucket_idx(cycles)]++;
+		hist->count++;
+		hist->sum += cycles;
+		if (cycles > hist->max)
+			hist->max = cycles;
+	}
+}
+
+/**
+ * Sum up histograms of a port of all of lcores. Counters can be updated
+ * while summing up, and the result might be a bit inconsistent.
+ *
+ * @param port_id Port ID.
+ * @param[out] sum Histogram summed up.
+ */
+void latency_sum_hist(uint16_t port_id, struct latency_hist *sum);
+
+/* Convert cycles of TSC to nanoseconds. */
+uint64_t latency_cycles_to_ns(uint64_t cycles);
+
+/* Get the lower bound of cycles of a bucket. */
+uint64_t latency_bucket_cycles(unsigned int idx);
+
+/**
+ * Get latency of given percentile of a histogram from the lower bound of
+ * the bucket including it.
+ *
+ * @param hist Histogram.
+ * @param permille Percentile in per mille, such as 999 for p99.9.
+ * @return Latency in nanoseconds.
+ */
+uint64_t latency_percentile_ns(const struct latency_hist *hist,
+		unsigned int permille);
+
+#endif
@@ -0,0 +1,78 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2020 Nippon Telegraph and Telephone Corporation
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include "shared/lcore_usage.h"
+
+struct lcore_usage lcore_usages[RTE_MAX_LCORE];
+struct lcore_usage comp_usages[RTE_MAX_LCORE];
+
+RTE_DEFINE_PER_LCORE(uint64_t, lcore_usage_rx_pkts);
+
+size_t
+lcore_usage_json_len(const uint8_t lcore_id_used[RTE_MAX_LCORE])
+{
+	size_t len = LCORE_USAGE_JSON_HDR_LEN;
+	unsigned int lcore_id;
+
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+		if (lcore_id_used[lcore_id] == 1)
+			len += LCORE_USAGE_JSON_LEN;
+	}
+	return len;
+}
+
+int
+append_lcore_usage_json(char *str, size_t len,
+		const uint8_t lcore_id_used[RTE_MAX_LCORE])
+{
+	const struct lcore_usage *usage;
+	unsigned int has_lcore = 0;
+	unsigned int lcore_id;
+	size_t pos = strlen(str);
+	size_t start = pos;
+	int ret;
+
+	/* Keep space for closing bracket and null character. */
+	if (pos + 2 >= len)
+		return -1;
+	len -= 1;
+
+	ret = snprintf(str + pos, len - pos, "\"lcore_usage\":[");
+	if (ret < 0 || (size_t)ret >= len - pos)
+		goto err;
+	pos += ret;
+
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+		if (lcore_id_used[lcore_id] != 1 ||
+				lcore_id == rte_get_master_lcore())
+			continue;
+
+		usage = &lcore_usages[lcore_id];
+		if (usage->busy_cycles + usage->idle_cycles == 0)
+			continue;
+
+		ret = snprintf(str + pos, len - pos, "%s{\"lcore\":%u,"
+				"\"busy_cycles\":%" PRIu64 ","
+				"\"idle_cycles\":%" PRIu64 ",\"usage\":%u}",
+				has_lcore ? "," : "", lcore_id,
+				usage->busy_cycles, usage->idle_cycles,
+				lcore_usage_percent(usage));
+		if (ret < 0 || (size_t)ret >= len - pos) {
+			/* Close the array without lcores not appended. */
+			strcpy(str + pos, "]");
+			return -1;
+		}
+		pos += ret;
+		has_lcore = 1;
+	}
+	strcpy(str + pos, "]");
+	return 0;
+
+err:
+	str[start] = '\0';
+	return -1;
+}
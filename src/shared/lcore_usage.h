@@ -0,0 +1,119 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2020 Nippon Telegraph and Telephone Corporation
+ */
+
+#ifndef __SHARED_LCORE_USAGE_H__
+#define __SHARED_LCORE_USAGE_H__
+
+/**
+ * @file
+ * Usage of lcores in busy polling
+ *
+ * Lcores of SPP poll ports all the time, so the usage of CPU is always
+ * 100% for OS. TSC cycles of polls are counted separately for polls in
+ * which packets are received, as busy, and others, as idle. Packets are
+ * counted at RX points for each of lcores to decide it.
+ */
+
+#include <stdint.h>
+#include <rte_cycles.h>
+#include <rte_lcore.h>
+
+/* Cycles of polls with and without packets, updated only by its lcore. */
+struct lcore_usage {
+	uint64_t busy_cycles;
+	uint64_t idle_cycles;
+} __rte_cache_aligned;
+
+/* A poll started to be measured. */
+struct lcore_usage_poll {
+	uint64_t tsc;
+	uint64_t rx_pkts;
+};
+
+/* Usage of each of lcores. */
+extern struct lcore_usage lcore_usages[RTE_MAX_LCORE];
+
+/* Usage of each of components of spp_vf and spp_mirror indexed by ID. */
+extern struct lcore_usage comp_usages[RTE_MAX_LCORE];
+
+RTE_DECLARE_PER_LCORE(uint64_t, lcore_usage_rx_pkts);
+
+/* Count packets received on this lcore at RX points. */
+static inline void
+lcore_usage_add_rx(uint16_t nb_rx)
+{
+	RTE_PER_LCORE(lcore_usage_rx_pkts) += nb_rx;
+}
+
+/* Start to measure a poll. */
+static inline void
+lcore_usage_poll_begin(struct lcore_usage_poll *poll)
+{
+	poll->tsc = rte_rdtsc();
+	poll->rx_pkts = RTE_PER_LCORE(lcore_usage_rx_pkts);
+}
+
+/**
+ * Add cycles of the poll as busy if packets are received in it, or idle.
+ * Next poll is started from the end of this one.
+ */
+static inline void
+lcore_usage_poll_end(struct lcore_usage *usage,
+		struct lcore_usage_poll *poll)
+{
+	uint64_t now = rte_rdtsc();
+	uint64_t rx_pkts = RTE_PER_LCORE(lcore_usage_rx_pkts);
+
+	if (rx_pkts != poll->rx_pkts)
+		usage->busy_cycles += now - poll->tsc;
+	else
+		usage->idle_cycles += now - poll->tsc;
+
+	poll->tsc = now;
+	poll->rx_pkts = rx_pkts;
+}
+
+/* Get ratio of busy cycles in percent. */
+static inline unsigned int
+lcore_usage_percent(const struct lcore_usage *usage)
+{
+	uint64_t total = usage->busy_cycles + usage->idle_cycles;
+
+	if (total == 0)
+		return 0;
+	return usage->busy_cycles * 100 / total;
+}
+
+/* Max length of `"lcore_usage":[]` in JSON without lcores. */
+#define LCORE_USAGE_JSON_HDR_LEN 16
+
+/* Max length of usage of an lcore in JSON with a separator. */
+#define LCORE_USAGE_JSON_LEN 112
+
+/**
+ * Get max length of usage of lcores appended by append_lcore_usage_json(),
+ * used for reserving space of it before appending others.
+ *
+ * @param lcore_id_used Flags of lcores used.
+ * @return Max length of usage of lcores in JSON.
+ */
+size_t lcore_usage_json_len(const uint8_t lcore_id_used[RTE_MAX_LCORE]);
+
+/**
+ * Append usage of lcores used, except master, to JSON of status. Lcores
+ * not polling are skipped. Here is an example.
+ *
+ *     "lcore_usage": [
+ *       {"lcore":2,"busy_cycles":1200,"idle_cycles":4800,"usage":20}
+ *     ]
+ *
+ * @param str JSON string appended to.
+ * @param len Size of buffer of `str`.
+ * @param lcore_id_used Flags of lcores used.
+ * @return 0 if succeeded, or -1 if lcores are skipped for no space.
+ */
+int append_lcore_usage_json(char *str, size_t len,
+		const uint8_t lcore_id_used[RTE_MAX_LCORE]);
+
+#endif
@@ -3,6 +3,10 @@
  */
 
 #include "shared/port_manager.h"
+#include "shared/secondary/utils.h"
+
+/* The number of tokens of `patch` command in a batch. */
+#define NOF_PATCH_TOKENS 3
 
 struct porttype_map portmap[] = {
 	{ .port_name = "phy",   .port_type = PHY, },
@@ -22,6 +26,7 @@ forward_array_init_one(unsigned int i, unsigned int j)
 	ports_fwd_array[i][j].in_queue_id = 0;
 	ports_fwd_array[i][j].out_port_id = PORT_RESET;
 	ports_fwd_array[i][j].out_queue_id = 0;
+	ports_fwd_array[i][j].steer_func = NULL;
 }
 
 /* initialize forward array with default value */
@@ -35,6 +40,9 @@ forward_array_init(void)
 		for (j = 0; j < RTE_MAX_QUEUES_PER_PORT; j++)
 			forward_array_init_one(i, j);
 	}
+
+	/* Forwarding table referred from forward() should be valid. */
+	publish_fwd_array();
 }
 
 void
@@ -67,6 +75,7 @@ port_map_init_one(unsigned int i)
 	port_map[i].port_type = UNDEF;
 	port_map[i].stats = &port_map[i].default_stats;
 	port_map[i].queue_info = NULL;
+	port_map[i].ring = NULL;
 }
 
 void
@@ -78,6 +87,24 @@ port_map_init(void)
 		port_map_init_one(i);
 }
 
+/*
+ * Set burst functions of given port. RING port is accessed with rte_ring APIs
+ * directly to skip the ethdev layer and counters of ring PMD, which are not
+ * referred from SPP.
+ */
+void
+set_burst_funcs(struct port *port, uint16_t port_id)
+{
+	if (port_map[port_id].port_type == RING &&
+			port_map[port_id].ring != NULL) {
+		port->rx_func = &ring_rx_burst;
+		port->tx_func = &ring_tx_burst;
+	} else {
+		port->rx_func = &rte_eth_rx_burst;
+		port->tx_func = &rte_eth_tx_burst;
+	}
+}
+
 /* Return -1 as an error if given patch is invalid */
 int
 add_patch(uint16_t in_port, uint16_t in_queue,
@@ -94,16 +121,14 @@ add_patch(uint16_t in_port, uint16_t in_queue,
 	/* Populate in port data */
 	ports_fwd_array[in_port][in_queue].in_port_id = in_port;
 	ports_fwd_array[in_port][in_queue].in_queue_id = in_queue;
-	ports_fwd_array[in_port][in_queue].rx_func = &rte_eth_rx_burst;
-	ports_fwd_array[in_port][in_queue].tx_func = &rte_eth_tx_burst;
+	set_burst_funcs(&ports_fwd_array[in_port][in_queue], in_port);
 	ports_fwd_array[in_port][in_queue].out_port_id = out_port;
 	ports_fwd_array[in_port][in_queue].out_queue_id = out_queue;
 
 	/* Populate out port data */
 	ports_fwd_array[out_port][out_queue].in_port_id = out_port;
 	ports_fwd_array[out_port][out_queue].in_queue_id = out_queue;
-	ports_fwd_array[out_port][out_queue].rx_func = &rte_eth_rx_burst;
-	ports_fwd_array[out_port][out_queue].tx_func = &rte_eth_tx_burst;
+	set_burst_funcs(&ports_fwd_array[out_port][out_queue], out_port);
 
 	RTE_LOG(DEBUG, SHARED, "STATUS: in port %d in queue %d"
 		" in_port_id %d in_queue_id %d\n",
@@ -124,6 +149,108 @@ add_patch(uint16_t in_port, uint16_t in_queue,
 	return 0;
 }
 
+/* Patch ports of given resource UIDs. Return 0 if succeeded. */
+static int
+add_patch_res_uid(char *in_res_uid, char *out_res_uid)
+{
+	char *in_p_type, *out_p_type;
+	int in_p_id, out_p_id;
+	uint16_t in_queue_id, out_queue_id;
+	uint16_t in_port, out_port;
+
+	if (parse_resource_uid(in_res_uid, &in_p_type, &in_p_id,
+				&in_queue_id) < 0 ||
+			parse_resource_uid(out_res_uid, &out_p_type,
+				&out_p_id, &out_queue_id) < 0)
+		return -1;
+
+	in_port = find_port_id(in_p_id, get_port_type(in_p_type));
+	out_port = find_port_id(out_p_id, get_port_type(out_p_type));
+	if (in_port == PORT_RESET || out_port == PORT_RESET) {
+		RTE_LOG(ERR, SHARED, "Patch not found, '%s:%d' or '%s:%d'\n",
+				in_p_type, in_p_id, out_p_type, out_p_id);
+		return -1;
+	}
+
+	if (add_patch(in_port, in_queue_id, out_port, out_queue_id) != 0)
+		return -1;
+
+	return 0;
+}
+
+/* Execute `patch` commands in given str and publish it at once. */
+int
+exec_patch_batch(char *str, char *err_msg, size_t err_msg_len)
+{
+	char *cmd_str, *cmd_saveptr = NULL;
+	char *token_list[NOF_PATCH_TOKENS + 1];
+	char *token_saveptr;
+	int nof_cmds = 0;
+	int max_token;
+	int ret;
+
+	cmd_str = strtok_r(str, ";", &cmd_saveptr);
+	while (cmd_str != NULL) {
+		if (nof_cmds >= MAX_BATCH_CMDS) {
+			snprintf(err_msg, err_msg_len,
+					"Too many commands, max is %d",
+					MAX_BATCH_CMDS);
+			discard_fwd_array();
+			return -1;
+		}
+
+		max_token = 0;
+		token_saveptr = NULL;
+		token_list[max_token] = strtok_r(cmd_str, " ",
+				&token_saveptr);
+		while (token_list[max_token] != NULL &&
+				max_token < NOF_PATCH_TOKENS) {
+			max_token++;
+			token_list[max_token] = strtok_r(NULL, " ",
+					&token_saveptr);
+		}
+
+		/* Skip empty command such as spaces after the last `;`. */
+		if (max_token == 0) {
+			cmd_str = strtok_r(NULL, ";", &cmd_saveptr);
+			continue;
+		}
+
+		if (token_list[max_token] != NULL ||
+				strcmp(token_list[0], "patch") != 0)
+			ret = -1;  /* Invalid command. */
+		else if (max_token == 2 &&
+				strcmp(token_list[1], "reset") == 0) {
+			forward_array_reset();
+			ret = 0;
+		} else if (max_token == NOF_PATCH_TOKENS)
+			ret = add_patch_res_uid(token_list[1], token_list[2]);
+		else
+			ret = -1;
+
+		if (ret < 0) {
+			snprintf(err_msg, err_msg_len,
+					"Failed to execute command %d",
+					nof_cmds);
+			RTE_LOG(ERR, SHARED, "%s in batch.\n", err_msg);
+			discard_fwd_array();
+			return -1;
+		}
+
+		nof_cmds++;
+		cmd_str = strtok_r(NULL, ";", &cmd_saveptr);
+	}
+
+	if (nof_cmds == 0) {
+		snprintf(err_msg, err_msg_len, "No commands in batch");
+		return -1;
+	}
+
+	publish_fwd_array();
+	RTE_LOG(INFO, SHARED, "Published %d commands in batch.\n", nof_cmds);
+	return nof_cmds;
+}
+
 /*
  * Return actual port ID which is assigned by system internally, or PORT_RESET
  * if port is not found.
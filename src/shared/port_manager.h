@@ -27,9 +27,34 @@ void port_map_init(void);
 
 enum port_type get_port_type(char *portname);
 
+/**
+ * Set `rx_func` and `tx_func` of given entry of ports_fwd_array for the type
+ * of port_id.
+ */
+void set_burst_funcs(struct port *port, uint16_t port_id);
+
 int add_patch(uint16_t in_port, uint16_t in_queue,
 	uint16_t out_port, uint16_t out_queue);
 
+/* Prefix of batch command followed by commands separated with `;`. */
+#define BATCH_CMD_PREFIX "batch "
+
+/* Max number of commands in a batch. */
+#define MAX_BATCH_CMDS 1024
+
+/**
+ * Execute `patch` commands separated with `;` in given str, such as
+ * `patch phy:0 ring:0;patch ring:0 phy:1`, and publish the result with
+ * publish_fwd_array() at once. `patch reset` is also accepted. All of the
+ * changes are discarded if one of the commands is failed.
+ *
+ * @param[in] str Commands. It is modified while parsing.
+ * @param[out] err_msg Error message if failed.
+ * @param[in] err_msg_len Size of err_msg.
+ * @return The number of executed commands, or -1 if failed.
+ */
+int exec_patch_batch(char *str, char *err_msg, size_t err_msg_len);
+
 uint16_t find_port_id(int id, enum port_type type);
 
 int is_valid_port(uint16_t port_id, uint16_t queue_id);
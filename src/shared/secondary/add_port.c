@@ -12,6 +12,21 @@
 #include "shared/secondary/add_port.h"
 #include "shared/secondary/utils.h"
 
+/* Sync mode of producer and consumer of ring. */
+struct ring_sync_mode {
+	const char *name;
+	uint32_t single_prod;  /* 1 for single producer. */
+	uint32_t single_cons;  /* 1 for single consumer. */
+};
+
+static const struct ring_sync_mode ring_sync_modes[] = {
+	{ "spsc", 1, 1 },
+	{ "mpsc", 0, 1 },
+	{ "spmc", 1, 0 },
+	{ "mpmc", 0, 0 },
+	{ NULL, 0, 0 },  /* termination */
+};
+
 char *
 get_vhost_backend_name(unsigned int id)
 {
@@ -154,6 +169,91 @@ add_ring_pmd(int ring_id)
 	return res;
 }
 
+/*
+ * Return 1 if the ring is used by any of processes, or 0. Ring PMD of the
+ * ring is started by the process using it, and data of ethdevs is shared
+ * among processes.
+ */
+static int
+is_ring_used(const struct rte_ring *ring)
+{
+	char dev_name[RTE_ETH_NAME_MAX_LEN];
+	uint16_t port_id;
+
+	if (!rte_ring_empty(ring))
+		return 1;
+
+	snprintf(dev_name, RTE_ETH_NAME_MAX_LEN - 1, "net_ring_%s", ring->name);
+	if (rte_eth_dev_get_port_by_name(dev_name, &port_id) != 0)
+		return 0;
+	return rte_eth_devices[port_id].data->dev_started != 0;
+}
+
+/*
+ * Set sync mode of the ring. Flags are also updated because it is referred
+ * from the ring PMDs for counting packets.
+ */
+static void
+set_ring_sync_mode(struct rte_ring *ring, uint32_t single_prod,
+		uint32_t single_cons)
+{
+	ring->prod.single = single_prod;
+	ring->cons.single = single_cons;
+	ring->flags &= ~(RING_F_SP_ENQ | RING_F_SC_DEQ);
+	if (single_prod)
+		ring->flags |= RING_F_SP_ENQ;
+	if (single_cons)
+		ring->flags |= RING_F_SC_DEQ;
+}
+
+int
+add_ring_pmd_with_mode(int ring_id, const char *mode)
+{
+	struct rte_ring *ring;
+	const struct ring_sync_mode *sync = NULL;
+	uint32_t old_prod, old_cons;
+	int i, res;
+
+	for (i = 0; ring_sync_modes[i].name != NULL; i++) {
+		if (!strcmp(mode, ring_sync_modes[i].name)) {
+			sync = &ring_sync_modes[i];
+			break;
+		}
+	}
+	if (sync == NULL) {
+		RTE_LOG(ERR, SHARED, "Invalid ring sync mode '%s'.\n", mode);
+		return -1;
+	}
+
+	ring = rte_ring_lookup(get_rx_queue_name(ring_id));
+	if (ring == NULL) {
+		RTE_LOG(ERR, SHARED, "Failed to get ring %s.\n",
+				get_rx_queue_name(ring_id));
+		return -1;
+	}
+
+	/* Changing it while others enqueue or dequeue corrupts the ring. */
+	if (is_ring_used(ring)) {
+		RTE_LOG(ERR, SHARED, "Ring '%s' is in use, cannot change "
+				"sync mode.\n", ring->name);
+		return -1;
+	}
+
+	old_prod = ring->prod.single;
+	old_cons = ring->cons.single;
+	set_ring_sync_mode(ring, sync->single_prod, sync->single_cons);
+
+	res = add_ring_pmd(ring_id);
+	if (res < 0) {
+		set_ring_sync_mode(ring, old_prod, old_cons);
+		return res;
+	}
+
+	RTE_LOG(INFO, SHARED, "Set sync mode of ring '%s' to %s.\n",
+			ring->name, sync->name);
+	return res;
+}
+
 int
 add_vhost_pmd(int index)
 {
@@ -65,6 +65,22 @@ get_vhost_iface_name(unsigned int id);
 int
 add_ring_pmd(int ring_id);
 
+/**
+ * Create a ring PMD with given ring_id after changing sync mode of producer
+ * and consumer of the ring. Rings are created as single producer and single
+ * consumer by spp_primary. It fails if the ring is used by any of processes,
+ * and the mode is restored if the ring PMD cannot be created.
+ *
+ * @param ring_id
+ *   ID of ring.
+ * @param mode
+ *   Sync mode, one of `spsc`, `mpsc`, `spmc` or `mpmc`.
+ * @return
+ *   Port ID of ring PMD, or -1 if failed.
+ */
+int
+add_ring_pmd_with_mode(int ring_id, const char *mode);
+
 /**
  * Create a vhost PMD with given ring_id.
  *
@@ -7,11 +7,26 @@
 
 #define RTE_LOGTYPE_WK_JSON_HELPER RTE_LOGTYPE_USER1
 
-/* Add a comma to given JSON string, or nothing if the end of the msg. */
+/**
+ * Get a comma added before a value, or nothing if it is the first one in
+ * the msg, a block or an array. Opening brackets are followed by a space
+ * which is never at the end of values.
+ */
+static inline const char *
+json_comma(const char *output)
+{
+	size_t len = spp_strbuf_len(output);
+
+	return JSON_APPEND_COMMA(len != 0 && output[len - 1] != ' ');
+}
+
+/* Add a comma to given JSON string, or nothing if it is not needed. */
 int
 append_json_comma(char **output)
 {
-	*output = spp_strbuf_append(*output, ", ", strlen(", "));
+	const char *comma = json_comma(*output);
+
+	*output = spp_strbuf_append(*output, comma, strlen(comma));
 	if (unlikely(*output == NULL)) {
 		RTE_LOG(ERR, WK_JSON_HELPER, "Failed to add comma.\n");
 		return SPPWK_RET_NG;
@@ -24,10 +39,8 @@ append_json_comma(char **output)
 int
 append_json_uint_value(char **output, const char *name, unsigned int value)
 {
-	int len = strlen(*output);
-
-	*output = spp_strbuf_append(*output, "",
-			strlen(name) + JSON_APPEND_LEN*2);
+	*output = spp_strbuf_appendf(*output, JSON_APPEND_VALUE("%u"),
+			json_comma(*output), name, value);
 	if (unlikely(*output == NULL)) {
 		RTE_LOG(ERR, WK_JSON_HELPER,
 				"JSON's numeric format failed to add. "
@@ -35,8 +48,23 @@ append_json_uint_value(char **output, const char *name, unsigned int value)
 		return SPPWK_RET_NG;
 	}
 
-	sprintf(&(*output)[len], JSON_APPEND_VALUE("%u"),
-			JSON_APPEND_COMMA(len), name, value);
+	return SPPWK_RET_OK;
+}
+
+/* Add a uint64 value to given JSON string. */
+int
+append_json_uint64_value(char **output, const char *name, uint64_t value)
+{
+	*output = spp_strbuf_appendf(*output, JSON_APPEND_VALUE("%"PRIu64),
+			json_comma(*output), name, value);
+	if (unlikely(*output == NULL)) {
+		RTE_LOG(ERR, WK_JSON_HELPER,
+				"JSON's numeric format failed to add. "
+				"(name = %s, uint64 = %"PRIu64")\n",
+				name, value);
+		return SPPWK_RET_NG;
+	}
+
 	return SPPWK_RET_OK;
 }
 
@@ -44,10 +72,8 @@ append_json_uint_value(char **output, const char *name, unsigned int value)
 int
 append_json_int_value(char **output, const char *name, int value)
 {
-	int len = strlen(*output);
-	/* extend the buffer */
-	*output = spp_strbuf_append(*output, "",
-			strlen(name) + JSON_APPEND_LEN*2);
+	*output = spp_strbuf_appendf(*output, JSON_APPEND_VALUE("%d"),
+			json_comma(*output), name, value);
 	if (unlikely(*output == NULL)) {
 		RTE_LOG(ERR, WK_JSON_HELPER,
 				"JSON's numeric format failed to add. "
@@ -55,8 +81,6 @@ append_json_int_value(char **output, const char *name, int value)
 		return SPPWK_RET_NG;
 	}
 
-	sprintf(&(*output)[len], JSON_APPEND_VALUE("%d"),
-			JSON_APPEND_COMMA(len), name, value);
 	return SPPWK_RET_OK;
 }
 
@@ -64,10 +88,8 @@ append_json_int_value(char **output, const char *name, int value)
 int
 append_json_str_value(char **output, const char *name, const char *val)
 {
-	int len = strlen(*output);
-	/* extend the buffer */
-	*output = spp_strbuf_append(*output, "",
-			strlen(name) + strlen(val) + JSON_APPEND_LEN);
+	*output = spp_strbuf_appendf(*output, JSON_APPEND_VALUE("\"%s\""),
+			json_comma(*output), name, val);
 	if (unlikely(*output == NULL)) {
 		RTE_LOG(ERR, WK_JSON_HELPER,
 				"JSON's string format failed to add. "
@@ -75,8 +97,6 @@ append_json_str_value(char **output, const char *name, const char *val)
 		return SPPWK_RET_NG;
 	}
 
-	sprintf(&(*output)[len], JSON_APPEND_VALUE("\"%s\""),
-			JSON_APPEND_COMMA(len), name, val);
 	return SPPWK_RET_OK;
 }
 
@@ -88,10 +108,8 @@ append_json_str_value(char **output, const char *name, const char *val)
 int
 append_json_array_brackets(char **output, const char *name, const char *val)
 {
-	int len = strlen(*output);
-	/* extend the buffer */
-	*output = spp_strbuf_append(*output, "",
-			strlen(name) + strlen(val) + JSON_APPEND_LEN);
+	*output = spp_strbuf_appendf(*output, JSON_APPEND_ARRAY,
+			json_comma(*output), name, val);
 	if (unlikely(*output == NULL)) {
 		RTE_LOG(ERR, WK_JSON_HELPER,
 				"JSON's square bracket failed to add. "
@@ -99,8 +117,6 @@ append_json_array_brackets(char **output, const char *name, const char *val)
 		return SPPWK_RET_NG;
 	}
 
-	sprintf(&(*output)[len], JSON_APPEND_ARRAY,
-			JSON_APPEND_COMMA(len), name, val);
 	return SPPWK_RET_OK;
 }
 
@@ -115,10 +131,13 @@ append_json_array_brackets(char **output, const char *name, const char *val)
 int
 append_json_block_brackets(char **output, const char *name, const char *val)
 {
-	int len = strlen(*output);
-	/* extend the buffer */
-	*output = spp_strbuf_append(*output, "",
-			strlen(name) + strlen(val) + JSON_APPEND_LEN);
+	if (name[0] == '\0')
+		*output = spp_strbuf_appendf(*output,
+				JSON_APPEND_BLOCK_NONAME,
+				json_comma(*output), name, val);
+	else
+		*output = spp_strbuf_appendf(*output, JSON_APPEND_BLOCK,
+				json_comma(*output), name, val);
 	if (unlikely(*output == NULL)) {
 		RTE_LOG(ERR, WK_JSON_HELPER,
 				"JSON's curly bracket failed to add. "
@@ -126,11 +145,67 @@ append_json_block_brackets(char **output, const char *name, const char *val)
 		return SPPWK_RET_NG;
 	}
 
+	return SPPWK_RET_OK;
+}
+
+/* Open a block or an array with its key, or without key if it is `""`. */
+static int
+append_json_begin(char **output, const char *name, char bracket)
+{
 	if (name[0] == '\0')
-		sprintf(&(*output)[len], JSON_APPEND_BLOCK_NONAME,
-				JSON_APPEND_COMMA(len), name, val);
+		*output = spp_strbuf_appendf(*output, "%s%c ",
+				json_comma(*output), bracket);
 	else
-		sprintf(&(*output)[len], JSON_APPEND_BLOCK,
-				JSON_APPEND_COMMA(len), name, val);
+		*output = spp_strbuf_appendf(*output, "%s\"%s\": %c ",
+				json_comma(*output), name, bracket);
+	if (unlikely(*output == NULL)) {
+		RTE_LOG(ERR, WK_JSON_HELPER,
+				"Failed to open '%c'. (name = %s)\n",
+				bracket, name);
+		return SPPWK_RET_NG;
+	}
+
+	return SPPWK_RET_OK;
+}
+
+/* Close a block or an array. */
+static int
+append_json_end(char **output, char bracket)
+{
+	*output = spp_strbuf_appendf(*output, " %c", bracket);
+	if (unlikely(*output == NULL)) {
+		RTE_LOG(ERR, WK_JSON_HELPER, "Failed to close '%c'.\n",
+				bracket);
+		return SPPWK_RET_NG;
+	}
+
 	return SPPWK_RET_OK;
 }
+
+/* Open a block such as `"key": { `, or `{ ` if key is `""`. */
+int
+append_json_begin_block(char **output, const char *name)
+{
+	return append_json_begin(output, name, '{');
+}
+
+/* Close a block opened with append_json_begin_block(). */
+int
+append_json_end_block(char **output)
+{
+	return append_json_end(output, '}');
+}
+
+/* Open an array such as `"key": [ `, or `[ ` if key is `""`. */
+int
+append_json_begin_array(char **output, const char *name)
+{
+	return append_json_begin(output, name, '[');
+}
+
+/* Close an array opened with append_json_begin_array(). */
+int
+append_json_end_array(char **output)
+{
+	return append_json_end(output, ']');
+}
@@ -6,6 +6,7 @@
 #define _SPPWK_JSON_HELPER_H_
 
 #include <string.h>
+#include <inttypes.h>
 #include <rte_branch_prediction.h>
 #include <rte_log.h>
 #include "return_codes.h"
@@ -28,7 +29,8 @@
 #define JSON_APPEND_BLOCK         "%s\"%s\": { %s }"
 
 /**
- * Add a comma to given JSON string, or nothing if the end of the statement.
+ * Add a comma to given JSON string, or nothing if it is the first value in
+ * the msg, a block or an array.
  *
  * @param[in,out] output Placeholder of JSON msg.
  */
@@ -45,6 +47,17 @@ int append_json_comma(char **output);
  */
 int append_json_uint_value(char **output, const char *name, unsigned int val);
 
+/**
+ * Add a uint64 value, such as counter of packets, to given JSON string.
+ *
+ * @param[in,out] output Placeholder of JSON msg.
+ * @param[in] name Name as a key.
+ * @param[in] val Uint64 value of the key.
+ * @retval SPPWK_RET_OK if succeeded.
+ * @retval SPPWK_RET_NG if failed.
+ */
+int append_json_uint64_value(char **output, const char *name, uint64_t val);
+
 /**
  * Add an int value to given JSON string.
  *
@@ -98,4 +111,58 @@ int append_json_array_brackets(char **output, const char *name,
 int append_json_block_brackets(char **output, const char *name,
 		const char *val);
 
+/**
+ * Functions for writing JSON msg in streaming. Values appended between
+ * beginning and end of a block or an array are put inside of it directly,
+ * without making a temporary string of the values for surrounding them
+ * with brackets. It is useful for a large msg such as `status` with many
+ * entries of classifier table.
+ *
+ *   append_json_begin_array(&output, "ports");
+ *   append_json_begin_block(&output, "");
+ *   append_json_str_value(&output, "port", "phy:0");
+ *   append_json_end_block(&output);
+ *   append_json_end_array(&output);
+ *
+ * Above makes `"ports": [ { "port": "phy:0" } ]`.
+ */
+
+/**
+ * Open a block with key such as `"key": { `, or `{ ` if key is `""`.
+ *
+ * @param[in,out] output Placeholder of JSON msg.
+ * @param[in] name Name as a key, or `""`.
+ * @retval SPPWK_RET_OK if succeeded.
+ * @retval SPPWK_RET_NG if failed.
+ */
+int append_json_begin_block(char **output, const char *name);
+
+/**
+ * Close a block opened with append_json_begin_block().
+ *
+ * @param[in,out] output Placeholder of JSON msg.
+ * @retval SPPWK_RET_OK if succeeded.
+ * @retval SPPWK_RET_NG if failed.
+ */
+int append_json_end_block(char **output);
+
+/**
+ * Open an array with key such as `"key": [ `, or `[ ` if key is `""`.
+ *
+ * @param[in,out] output Placeholder of JSON msg.
+ * @param[in] name Name as a key, or `""`.
+ * @retval SPPWK_RET_OK if succeeded.
+ * @retval SPPWK_RET_NG if failed.
+ */
+int append_json_begin_array(char **output, const char *name);
+
+/**
+ * Close an array opened with append_json_begin_array().
+ *
+ * @param[in,out] output Placeholder of JSON msg.
+ * @retval SPPWK_RET_OK if succeeded.
+ * @retval SPPWK_RET_NG if failed.
+ */
+int append_json_end_array(char **output);
+
 #endif
@@ -3,6 +3,7 @@
  */
 
 #include <unistd.h>
+#include <ctype.h>
 #include <string.h>
 
 #include <rte_ether.h>
@@ -80,6 +81,22 @@ sppwk_cmd_type_str(enum sppwk_cmd_type ctype)
 	}
 }
 
+/* Get string of scheduling policy of merger. */
+const char*
+sppwk_mrg_policy_str(enum sppwk_mrg_policy mrg_policy)
+{
+	switch (mrg_policy) {
+	case SPPWK_MRG_POLICY_RR:
+		return "rr";
+	case SPPWK_MRG_POLICY_WFQ:
+		return "wfq";
+	case SPPWK_MRG_POLICY_PRIO:
+		return "prio";
+	default:
+		return "unknown";
+	}
+}
+
 /**
  * List of classifier type. The order of items should be same as the order of
  * enum `sppwk_cls_type` defined in cmd_utils.h.
@@ -89,6 +106,20 @@ const char *CLS_TYPE_LIST[] = {
 	"none",
 	"mac",
 	"vlan",
+	"ipv4",
+	"ipv6",
+	"weight",
+	"",  /* termination */
+};
+
+/**
+ * List of scheduling policy of merger. The order of items should be same as
+ * the order of enum `sppwk_mrg_policy` in data_types.h.
+ */
+const char *MRG_POLICY_LIST[] = {
+	"rr",
+	"wfq",
+	"prio",
 	"",  /* termination */
 };
 
@@ -124,17 +155,48 @@ is_used_with_addr(
 {
 	struct sppwk_port_info *wk_port = get_sppwk_port(
 			iface_type, iface_no, queue_no);
+	if (wk_port == NULL)
+		return 0;
 
 	return ((mac_addr == wk_port->cls_attrs.mac_addr) &&
 		(vid == wk_port->cls_attrs.vlantag.vid));
 }
 
+/* Return 1 as true if port is used with given 5-tuple. */
+static int
+is_used_with_5tuple(const struct sppwk_cls_5tuple *tuple,
+		enum port_type iface_type, int iface_no, int queue_no)
+{
+	struct sppwk_port_info *wk_port = get_sppwk_port(
+			iface_type, iface_no, queue_no);
+	if (wk_port == NULL)
+		return 0;
+
+	return (memcmp(tuple, &wk_port->cls_attrs.tuple,
+			sizeof(struct sppwk_cls_5tuple)) == 0);
+}
+
+/* Return 1 as true if port is used with given weight of distributor. */
+static int
+is_used_with_weight(int weight,
+		enum port_type iface_type, int iface_no, int queue_no)
+{
+	struct sppwk_port_info *wk_port = get_sppwk_port(
+			iface_type, iface_no, queue_no);
+	if (wk_port == NULL)
+		return 0;
+
+	return (weight == wk_port->cls_attrs.weight);
+}
+
 /* Return 1 as true if given port is already used. */
 static int
 is_added_port(enum port_type iface_type, int iface_no, int queue_no)
 {
 	struct sppwk_port_info *port = get_sppwk_port(iface_type, iface_no,
 			queue_no);
+	if (port == NULL)
+		return 0;
 	return port->iface_type != UNDEF;
 }
 
@@ -267,7 +329,9 @@ static inline int
 set_detailed_parse_error(struct sppwk_parse_err_msg *wk_err_msg,
 		const char *err_msg, const char *err_details)
 {
-	strcpy(wk_err_msg->details, err_details);
+	/* Given value might be longer than details, such as 5-tuple rule. */
+	snprintf(wk_err_msg->details, sizeof(wk_err_msg->details), "%s",
+			err_details);
 	return set_parse_error(wk_err_msg, SPPWK_PARSE_INVALID_VALUE, err_msg);
 }
 
@@ -479,6 +543,79 @@ parse_comp_type(void *output, const char *arg_val,
 	return SPPWK_RET_OK;
 }
 
+/**
+ * Parse scheduling policy of merger of `arg_val` in `component` command.
+ * It is optional, and only for `merge` type.
+ */
+static int
+parse_comp_mrg_policy(struct sppwk_cmd_comp *component, const char *arg_val)
+{
+	int idx;
+
+	if (unlikely(component->wk_type != SPPWK_TYPE_MRG)) {
+		RTE_LOG(ERR, WK_CMD_PARSER,
+				"Policy is only for starting merge.\n");
+		return SPPWK_RET_NG;
+	}
+
+	idx = get_list_idx(arg_val, MRG_POLICY_LIST);
+	if (unlikely(idx < SPPWK_RET_OK)) {
+		RTE_LOG(ERR, WK_CMD_PARSER,
+				"Unknown merge policy '%s'.\n", arg_val);
+		return SPPWK_RET_NG;
+	}
+
+	component->mrg_policy = idx;
+	return SPPWK_RET_OK;
+}
+
+/**
+ * Parse burst size of `arg_val` in `component` command. It is optional,
+ * and only for `forward` and `merge` types.
+ */
+static int
+parse_comp_burst_size(struct sppwk_cmd_comp *component, const char *arg_val)
+{
+	int ret;
+
+	if (unlikely(component->wk_type != SPPWK_TYPE_FWD) &&
+			unlikely(component->wk_type != SPPWK_TYPE_MRG)) {
+		RTE_LOG(ERR, WK_CMD_PARSER,
+				"Burst size is only for forward or merge.\n");
+		return SPPWK_RET_NG;
+	}
+
+	ret = get_int_in_range(&component->burst_size, arg_val, 1,
+			SPPWK_BURST_MAX);
+	if (unlikely(ret < SPPWK_RET_OK)) {
+		RTE_LOG(ERR, WK_CMD_PARSER,
+				"Invalid burst size '%s'.\n", arg_val);
+		return SPPWK_RET_NG;
+	}
+	return SPPWK_RET_OK;
+}
+
+/**
+ * Parse optional params of `arg_val` for starting component, which are
+ * merge policy or burst size of any order. Number is taken as burst size.
+ */
+static int
+parse_comp_option(void *output, const char *arg_val,
+		int allow_override __attribute__ ((unused)))
+{
+	struct sppwk_cmd_comp *component = output;
+
+	if (unlikely(component->wk_action != SPPWK_ACT_START)) {
+		RTE_LOG(ERR, WK_CMD_PARSER,
+				"Option is only for starting component.\n");
+		return SPPWK_RET_NG;
+	}
+
+	if (isdigit(arg_val[0]))
+		return parse_comp_burst_size(component, arg_val);
+	return parse_comp_mrg_policy(component, arg_val);
+}
+
 /* Parse given action for port of `arg_val` in `port` command. */
 static int
 parse_port_action(void *output, const char *arg_val,
@@ -737,6 +874,37 @@ parse_mac_addr(void *output, const char *arg_val,
 	return SPPWK_RET_OK;
 }
 
+/**
+ * Parse MAC address or 5-tuple rule, which is decided from type parsed
+ * before, for classifier_table command.
+ */
+static int
+parse_cls_value(void *cls_cmd_attr, const char *arg_val,
+		int allow_override)
+{
+	struct sppwk_cls_cmd_attrs *cls_attrs = cls_cmd_attr;
+
+	switch (cls_attrs->cls_type) {
+	case SPPWK_CLS_TYPE_IPV4:
+		return sppwk_convert_cls_5tuple(&cls_attrs->tuple, 4,
+				arg_val);
+	case SPPWK_CLS_TYPE_IPV6:
+		return sppwk_convert_cls_5tuple(&cls_attrs->tuple, 6,
+				arg_val);
+	case SPPWK_CLS_TYPE_WEIGHT:
+		if (unlikely(get_int_in_range(&cls_attrs->weight, arg_val, 1,
+				SPPWK_DIST_WEIGHT_MAX) < SPPWK_RET_OK)) {
+			RTE_LOG(ERR, WK_CMD_PARSER,
+					"Invalid weight `%s`.\n", arg_val);
+			return SPPWK_RET_NG;
+		}
+		return SPPWK_RET_OK;
+	default:
+		return parse_mac_addr(cls_attrs->mac, arg_val,
+				allow_override);
+	}
+}
+
 /**
  * Parse given action for getting index of actions for `classifier_table`
  * command.
@@ -807,6 +975,7 @@ parse_cls_port(void *cls_cmd_attr, const char *arg_val,
 	int ret = SPPWK_RET_OK;
 	struct sppwk_cls_cmd_attrs *cls_attrs = cls_cmd_attr;
 	struct sppwk_port_idx tmp_port;
+	struct sppwk_cls_5tuple no_tuple;
 	int64_t mac_addr = 0;
 
 	ret = parse_port_uid(&tmp_port, arg_val);
@@ -820,11 +989,52 @@ parse_cls_port(void *cls_cmd_attr, const char *arg_val,
 		return SPPWK_RET_NG;
 	}
 
-	if (cls_attrs->cls_type == SPPWK_CLS_TYPE_MAC)
+	if (cls_attrs->cls_type != SPPWK_CLS_TYPE_VLAN)
 		cls_attrs->vid = ETH_VLAN_ID_MAX;
 
-	if (unlikely(cls_attrs->wk_action == SPPWK_ACT_ADD)) {
+	/* 5-tuple is not parsed if given with VLAN ID. */
+	if ((cls_attrs->cls_type == SPPWK_CLS_TYPE_IPV4 ||
+			cls_attrs->cls_type == SPPWK_CLS_TYPE_IPV6) &&
+			cls_attrs->tuple.ip_ver == 0) {
+		RTE_LOG(ERR, WK_CMD_PARSER, "No 5-tuple rule for port. "
+				"(classifier_table command) val=%s\n",
+				arg_val);
+		return SPPWK_RET_NG;
+	}
+
+	/**
+	 * Weight is independent from MAC address and 5-tuple. It is added
+	 * only if not set, and deleted only if it is the same as given.
+	 */
+	if (cls_attrs->cls_type == SPPWK_CLS_TYPE_WEIGHT) {
+		if (cls_attrs->weight == 0 || !is_used_with_weight(
+				(cls_attrs->wk_action == SPPWK_ACT_ADD) ?
+				0 : cls_attrs->weight,
+				tmp_port.iface_type, tmp_port.iface_no,
+				tmp_port.queue_no)) {
+			RTE_LOG(ERR, WK_CMD_PARSER, "Port in used. "
+					"(classifier_table command) val=%s\n",
+					arg_val);
+			return SPPWK_RET_NG;
+		}
+	} else if (unlikely(cls_attrs->wk_action == SPPWK_ACT_ADD)) {
+		/* Port is used for either of MAC address or 5-tuple. */
+		memset(&no_tuple, 0x00, sizeof(no_tuple));
 		if (!is_used_with_addr(ETH_VLAN_ID_MAX, 0,
+				tmp_port.iface_type, tmp_port.iface_no,
+				tmp_port.queue_no) ||
+				!is_used_with_5tuple(&no_tuple,
+				tmp_port.iface_type, tmp_port.iface_no,
+				tmp_port.queue_no)) {
+			RTE_LOG(ERR, WK_CMD_PARSER, "Port in used. "
+					"(classifier_table command) val=%s\n",
+					arg_val);
+			return SPPWK_RET_NG;
+		}
+	} else if (unlikely(cls_attrs->wk_action == SPPWK_ACT_DEL) &&
+			(cls_attrs->cls_type == SPPWK_CLS_TYPE_IPV4 ||
+			cls_attrs->cls_type == SPPWK_CLS_TYPE_IPV6)) {
+		if (!is_used_with_5tuple(&cls_attrs->tuple,
 				tmp_port.iface_type, tmp_port.iface_no,
 				tmp_port.queue_no)) {
 			RTE_LOG(ERR, WK_CMD_PARSER, "Port in used. "
@@ -870,7 +1080,7 @@ struct sppwk_cmd_ops {
 /* TODO(yasufum) It must be separated into each of commands. */
 static struct sppwk_cmd_ops
 cmd_ops_list[][SPPWK_MAX_PARAMS] = {
-	{  /* classifier_table(mac) */
+	{  /* classifier_table(mac, ipv4, ipv6 or weight) */
 		{
 			.name = "action",
 			.offset = offsetof(struct sppwk_cmd_attrs,
@@ -884,10 +1094,10 @@ cmd_ops_list[][SPPWK_MAX_PARAMS] = {
 			.func = parse_cls_type
 		},
 		{
-			.name = "mac address",
+			.name = "mac address or rule",
 			.offset = offsetof(struct sppwk_cmd_attrs,
-					spec.cls_table.mac),
-			.func = parse_mac_addr
+					spec.cls_table),
+			.func = parse_cls_value
 		},
 		{
 			.name = "port",
@@ -955,6 +1165,16 @@ cmd_ops_list[][SPPWK_MAX_PARAMS] = {
 			.offset = offsetof(struct sppwk_cmd_attrs, spec.comp),
 			.func = parse_comp_type
 		},
+		{
+			.name = "component option",
+			.offset = offsetof(struct sppwk_cmd_attrs, spec.comp),
+			.func = parse_comp_option
+		},
+		{
+			.name = "component option",
+			.offset = offsetof(struct sppwk_cmd_attrs, spec.comp),
+			.func = parse_comp_option
+		},
 		SPPWK_CMD_NO_PARAMS,
 	},
 	{  /* port */
@@ -1118,7 +1338,7 @@ static struct cmd_parse_attrs cmd_attr_list[] = {
 	{ "_get_client_id", 1, 1, NULL },
 	{ "status", 1, 1, NULL },
 	{ "exit", 1, 1, NULL },
-	{ "component", 3, 5, parse_cmd_comp },
+	{ "component", 3, 7, parse_cmd_comp },
 	{ "port", 5, 8, parse_cmd_port },
 	{ "", 0, 0, NULL }  /* termination */
 };
@@ -77,12 +77,16 @@ enum sppwk_cmd_type {
 
 const char *sppwk_cmd_type_str(enum sppwk_cmd_type ctype);
 
+const char *sppwk_mrg_policy_str(enum sppwk_mrg_policy mrg_policy);
+
 /* `classifier_table` command specific parameters. */
 struct sppwk_cls_cmd_attrs {
 	enum sppwk_action wk_action;  /**< add or del */
-	enum sppwk_cls_type cls_type;  /**< currently only for MAC. */
+	enum sppwk_cls_type cls_type;  /**< MAC, VLAN, IPv4, IPv6 or weight. */
 	int vid;  /**< VLAN ID  */
 	char mac[SPPWK_VAL_BUFSZ];  /**< MAC address  */
+	struct sppwk_cls_5tuple tuple;  /**< 5-tuple of IPv4 or IPv6 */
+	int weight;  /**< Weight of TX port of distributor */
 	struct sppwk_port_idx port;/**< Destination port type and number */
 };
 
@@ -97,6 +101,8 @@ struct sppwk_cmd_comp {
 	char name[SPPWK_NAME_BUFSZ];  /**< component name */
 	unsigned int core;  /**< logical core number */
 	enum sppwk_worker_type wk_type;  /**< worker thread type */
+	enum sppwk_mrg_policy mrg_policy;  /**< scheduling policy of merger */
+	int burst_size;  /**< num of packets in a burst, or 0 as default */
 };
 
 /* `port` command parameters. */
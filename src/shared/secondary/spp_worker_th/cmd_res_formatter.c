@@ -6,6 +6,9 @@
 #include "port_capability.h"
 #include "cmd_utils.h"
 #include "shared/secondary/json_helper.h"
+#include "shared/latency.h"
+#include "shared/lcore_usage.h"
+#include "shared/dp_event.h"
 
 #ifdef SPP_VF_MODULE
 #include "vf_deps.h"
@@ -54,26 +57,16 @@ append_error_details_value(const char *name, char **output, void *tmp)
 {
 	int ret = SPPWK_RET_NG;
 	const struct cmd_result *result = tmp;
-	char *tmp_buff;
 	/* string is empty, except for errors */
 	if (result->err_msg[0] == '\0')
 		return SPPWK_RET_OK;
 
-	tmp_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
-	if (unlikely(tmp_buff == NULL)) {
-		RTE_LOG(ERR, WK_CMD_RES_FMT,
-				"Fail to alloc buf for `%s`.\n", name);
-		return SPPWK_RET_NG;
-	}
-
-	ret = append_json_str_value(&tmp_buff, "message", result->err_msg);
-	if (unlikely(ret < 0)) {
-		spp_strbuf_free(tmp_buff);
-		return SPPWK_RET_NG;
-	}
-
-	ret = append_json_block_brackets(output, name, tmp_buff);
-	spp_strbuf_free(tmp_buff);
+	ret = append_json_begin_block(output, name);
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_str_value(output, "message",
+				result->err_msg);
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_end_block(output);
 	return ret;
 }
 
@@ -83,7 +76,7 @@ is_port_flushed(enum port_type iface_type, int iface_no, int queue_no)
 {
 	struct sppwk_port_info *port = get_sppwk_port(iface_type, iface_no,
 			queue_no);
-	return port->ethdev_port_id >= 0;
+	return port != NULL && port->ethdev_port_id >= 0;
 }
 
 /* Append index number as comma separated format such as `0, 1, ...`. */
@@ -92,7 +85,6 @@ append_interface_array(char **output, const enum port_type type)
 {
 	int port_cnt, str_cnt = 0;
 	uint16_t queue_cnt;
-	char tmp_str[CMD_TAG_APPEND_SIZE];
 
 	for (port_cnt = 0; port_cnt < RTE_MAX_ETHPORTS; port_cnt++) {
 		int max_queue_port = get_port_max_queues(type, port_cnt);
@@ -104,18 +96,17 @@ append_interface_array(char **output, const enum port_type type)
 			if (!is_port_flushed(type, port_cnt, queue_cnt))
 				continue;
 
-			if (max_queue_port <= 1) {
-				sprintf(tmp_str, "%s\"%d\"",
+			if (max_queue_port <= 1)
+				*output = spp_strbuf_appendf(*output,
+						"%s\"%d\"",
 						JSON_APPEND_COMMA(str_cnt),
 						port_cnt);
-			} else {
-				sprintf(tmp_str, "%s\"%d nq %d\"",
+			else
+				*output = spp_strbuf_appendf(*output,
+						"%s\"%d nq %d\"",
 						JSON_APPEND_COMMA(str_cnt),
 						port_cnt, queue_cnt);
-			}
 
-			*output = spp_strbuf_append(*output,
-					tmp_str, strlen(tmp_str));
 			if (unlikely(*output == NULL)) {
 				RTE_LOG(ERR, WK_CMD_RES_FMT,
 					/**
@@ -168,20 +159,17 @@ append_vlan_block(const char *name, char **output,
 	int ret = SPPWK_RET_NG;
 	int i = 0;
 	struct sppwk_port_attrs *port_attrs = NULL;
-	char *tmp_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
-	if (unlikely(tmp_buff == NULL)) {
-		RTE_LOG(ERR, WK_CMD_RES_FMT,
-				"Failed to allocate buffer (name = %s).\n",
-				name);
+
+	ret = append_json_begin_block(output, name);
+	if (unlikely(ret < SPPWK_RET_OK))
 		return SPPWK_RET_NG;
-	}
 
 	sppwk_get_port_attrs(&port_attrs, port_id, dir);
 	for (i = 0; i < PORT_CAPABL_MAX; i++) {
 		switch (port_attrs[i].ops) {
 		case SPPWK_PORT_OPS_ADD_VLAN:
 		case SPPWK_PORT_OPS_DEL_VLAN:
-			ret = append_vlan_value(&tmp_buff, port_attrs[i].ops,
+			ret = append_vlan_value(output, port_attrs[i].ops,
 					port_attrs[i].capability.vlantag.vid,
 					port_attrs[i].capability.vlantag.pcp);
 			if (unlikely(ret < SPPWK_RET_OK))
@@ -200,15 +188,13 @@ append_vlan_block(const char *name, char **output,
 		}
 	}
 	if (i == PORT_CAPABL_MAX) {
-		ret = append_vlan_value(&tmp_buff, SPPWK_PORT_OPS_NONE,
+		ret = append_vlan_value(output, SPPWK_PORT_OPS_NONE,
 				0, 0);
 		if (unlikely(ret < SPPWK_RET_OK))
 			return SPPWK_RET_NG;
 	}
 
-	ret = append_json_block_brackets(output, name, tmp_buff);
-	spp_strbuf_free(tmp_buff);
-	return ret;
+	return append_json_end_block(output);
 }
 
 /**
@@ -223,11 +209,17 @@ get_ethdev_port_id(enum port_type iface_type, int iface_no, int queue_no)
 	sppwk_get_mng_data(&iface_info, NULL, NULL, NULL, NULL, NULL);
 	switch (iface_type) {
 	case PHY:
+		if (unlikely(queue_no >= iface_info->nof_phy_queues[iface_no]))
+			return SPPWK_RET_NG;
 		return iface_info->phy[iface_no][queue_no].ethdev_port_id;
 	case RING:
-		return iface_info->ring[iface_no].ethdev_port_id;
+		if (unlikely(iface_info->ring[iface_no] == NULL))
+			return SPPWK_RET_NG;
+		return iface_info->ring[iface_no]->ethdev_port_id;
 	case VHOST:
-		return iface_info->vhost[iface_no].ethdev_port_id;
+		if (unlikely(iface_info->vhost[iface_no] == NULL))
+			return SPPWK_RET_NG;
+		return iface_info->vhost[iface_no]->ethdev_port_id;
 	default:
 		return SPPWK_RET_NG;
 	}
@@ -240,21 +232,18 @@ append_port_block(char **output, const struct sppwk_port_idx *port,
 {
 	int ret = SPPWK_RET_NG;
 	char port_str[CMD_TAG_APPEND_SIZE];
-	char *tmp_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
-	if (unlikely(tmp_buff == NULL)) {
-		RTE_LOG(ERR, WK_CMD_RES_FMT,
-				/* TODO(yasufum) refactor no meaning err msg */
-				"allocate error. (name = port_block)\n");
+
+	ret = append_json_begin_block(output, "");
+	if (unlikely(ret < SPPWK_RET_OK))
 		return SPPWK_RET_NG;
-	}
 
 	sppwk_port_uid(port_str, port->iface_type, port->iface_no,
 			port->queue_no);
-	ret = append_json_str_value(&tmp_buff, "port", port_str);
+	ret = append_json_str_value(output, "port", port_str);
 	if (unlikely(ret < SPPWK_RET_OK))
 		return SPPWK_RET_NG;
 
-	ret = append_vlan_block("vlan", &tmp_buff,
+	ret = append_vlan_block("vlan", output,
 			get_ethdev_port_id(
 				port->iface_type, port->iface_no,
 				port->queue_no),
@@ -262,9 +251,7 @@ append_port_block(char **output, const struct sppwk_port_idx *port,
 	if (unlikely(ret < SPPWK_RET_OK))
 		return SPPWK_RET_NG;
 
-	ret = append_json_block_brackets(output, "", tmp_buff);
-	spp_strbuf_free(tmp_buff);
-	return ret;
+	return append_json_end_block(output);
 }
 
 /* append a list of port numbers for JSON format */
@@ -275,24 +262,18 @@ append_port_array(const char *name, char **output, const int num,
 {
 	int ret = SPPWK_RET_NG;
 	int i = 0;
-	char *tmp_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
-	if (unlikely(tmp_buff == NULL)) {
-		RTE_LOG(ERR, WK_CMD_RES_FMT,
-				/* TODO(yasufum) refactor no meaning err msg */
-				"allocate error. (name = %s)\n",
-				name);
+
+	ret = append_json_begin_array(output, name);
+	if (unlikely(ret < SPPWK_RET_OK))
 		return SPPWK_RET_NG;
-	}
 
 	for (i = 0; i < num; i++) {
-		ret = append_port_block(&tmp_buff, &ports[i], dir);
+		ret = append_port_block(output, &ports[i], dir);
 		if (unlikely(ret < SPPWK_RET_OK))
 			return SPPWK_RET_NG;
 	}
 
-	ret = append_json_array_brackets(output, name, tmp_buff);
-	spp_strbuf_free(tmp_buff);
-	return ret;
+	return append_json_end_array(output);
 }
 
 /**
@@ -309,54 +290,46 @@ append_core_element_value(struct sppwk_lcore_params *params,
 {
 	int ret = SPPWK_RET_NG;
 	int unuse_flg = 0;
-	char *buff, *tmp_buff;
-	buff = params->output;
-	tmp_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
-	if (unlikely(tmp_buff == NULL)) {
-		/* TODO(yasufum) refactor no meaning err msg */
-		RTE_LOG(ERR, WK_CMD_RES_FMT,
-				"allocate error. (name = %s)\n",
-				name);
-		return ret;
-	}
+	char **output = &params->output;
 
 	/* there is unnecessary data when "unuse" by type */
 	unuse_flg = strcmp(type, SPPWK_TYPE_NONE_STR);
 
+	ret = append_json_begin_block(output, "");
+	if (unlikely(ret < SPPWK_RET_OK))
+		return ret;
+
 	/**
 	 * TODO(yasufum) change ambiguous "core" to more specific one such as
 	 * "worker-lcores" or "slave-lcores".
 	 */
-	ret = append_json_uint_value(&tmp_buff, "core", lcore_id);
+	ret = append_json_uint_value(output, "core", lcore_id);
 	if (unlikely(ret < SPPWK_RET_OK))
 		return ret;
 
 	if (unuse_flg) {
-		ret = append_json_str_value(&tmp_buff, "name", name);
+		ret = append_json_str_value(output, "name", name);
 		if (unlikely(ret < 0))
 			return ret;
 	}
 
-	ret = append_json_str_value(&tmp_buff, "type", type);
+	ret = append_json_str_value(output, "type", type);
 	if (unlikely(ret < SPPWK_RET_OK))
 		return ret;
 
 	if (unuse_flg) {
-		ret = append_port_array("rx_port", &tmp_buff,
+		ret = append_port_array("rx_port", output,
 				num_rx, rx_ports, SPPWK_PORT_DIR_RX);
 		if (unlikely(ret < 0))
 			return ret;
 
-		ret = append_port_array("tx_port", &tmp_buff,
+		ret = append_port_array("tx_port", output,
 				num_tx, tx_ports, SPPWK_PORT_DIR_TX);
 		if (unlikely(ret < SPPWK_RET_OK))
 			return ret;
 	}
 
-	ret = append_json_block_brackets(&buff, "", tmp_buff);
-	spp_strbuf_free(tmp_buff);
-	params->output = buff;
-	return ret;
+	return append_json_end_block(output);
 }
 
 /* append string of command response list for JSON format */
@@ -376,7 +349,7 @@ append_response_list_value(char **output,
 	}
 
 	for (i = 0; responses[i].tag_name[0] != '\0'; i++) {
-		tmp_buff[0] = '\0';
+		spp_strbuf_clear(tmp_buff);
 		ret = responses[i].func(responses[i].tag_name, &tmp_buff, tmp);
 		if (unlikely(ret < SPPWK_RET_OK)) {
 			spp_strbuf_free(tmp_buff);
@@ -386,23 +359,21 @@ append_response_list_value(char **output,
 			return SPPWK_RET_NG;
 		}
 
-		if (tmp_buff[0] == '\0')
+		if (spp_strbuf_len(tmp_buff) == 0)
 			continue;
 
-		if ((*output)[0] != '\0') {
-			ret = append_json_comma(output);
-			if (unlikely(ret < SPPWK_RET_OK)) {
-				spp_strbuf_free(tmp_buff);
-				RTE_LOG(ERR, WK_CMD_RES_FMT,
-						"Failed to add commas. "
-						"(tag = %s)\n",
-						responses[i].tag_name);
-				return SPPWK_RET_NG;
-			}
+		ret = append_json_comma(output);
+		if (unlikely(ret < SPPWK_RET_OK)) {
+			spp_strbuf_free(tmp_buff);
+			RTE_LOG(ERR, WK_CMD_RES_FMT,
+					"Failed to add commas. "
+					"(tag = %s)\n",
+					responses[i].tag_name);
+			return SPPWK_RET_NG;
 		}
 
 		*output = spp_strbuf_append(*output, tmp_buff,
-				strlen(tmp_buff));
+				spp_strbuf_len(tmp_buff));
 		if (unlikely(*output == NULL)) {
 			spp_strbuf_free(tmp_buff);
 			RTE_LOG(ERR, WK_CMD_RES_FMT,
@@ -427,53 +398,26 @@ append_command_results_value(const char *name, char **output,
 {
 	int ret = SPPWK_RET_NG;
 	int i;
-	char *tmp_buff1, *tmp_buff2;
 
-	/* Setup result statement step by step with two buffers. */
-	tmp_buff1 = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
-	if (unlikely(tmp_buff1 == NULL)) {
-		RTE_LOG(ERR, WK_CMD_RES_FMT,
-				"Faield to alloc 1st buf for `%s`.\n", name);
-		return SPPWK_RET_NG;
+	ret = append_json_begin_array(output, name);
+	for (i = 0; ret == SPPWK_RET_OK && i < num; i++) {
+		/* Setup block such as `{ "result": "success" }`. */
+		ret = append_json_begin_block(output, "");
+		if (ret == SPPWK_RET_OK)
+			ret = append_response_list_value(output,
+					response_result_list, &results[i]);
+		if (ret == SPPWK_RET_OK)
+			ret = append_json_end_block(output);
 	}
-	tmp_buff2 = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
-	if (unlikely(tmp_buff2 == NULL)) {
-		spp_strbuf_free(tmp_buff1);
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_end_array(output);
+
+	if (unlikely(ret < SPPWK_RET_OK)) {
 		RTE_LOG(ERR, WK_CMD_RES_FMT,
-				"Faield to alloc 2nd buf for `%s`.\n", name);
+				"Failed to add `%s`.\n", name);
 		return SPPWK_RET_NG;
 	}
-
-	for (i = 0; i < num; i++) {
-		tmp_buff1[0] = '\0';
-
-		/* Setup key-val pair such as `"result": "success"` */
-		ret = append_response_list_value(&tmp_buff1,
-				response_result_list, &results[i]);
-		if (unlikely(ret < 0)) {
-			spp_strbuf_free(tmp_buff1);
-			spp_strbuf_free(tmp_buff2);
-			return SPPWK_RET_NG;
-		}
-
-		/* Surround key-val pair such as `{ "result": "success" }`. */
-		ret = append_json_block_brackets(&tmp_buff2, "", tmp_buff1);
-		if (unlikely(ret < 0)) {
-			spp_strbuf_free(tmp_buff1);
-			spp_strbuf_free(tmp_buff2);
-			return SPPWK_RET_NG;
-		}
-	}
-
-	/**
-	 * Setup result statement such as
-	 * `"results": [ { "result": "success" } ]`.
-	 */
-	ret = append_json_array_brackets(output, name, tmp_buff2);
-
-	spp_strbuf_free(tmp_buff1);
-	spp_strbuf_free(tmp_buff2);
-	return ret;
+	return SPPWK_RET_OK;
 }
 
 /**
@@ -495,16 +439,8 @@ int
 append_info_value(const char *name, char **output)
 {
 	int ret = SPPWK_RET_NG;
-	char *tmp_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
 	struct cmd_res_formatter_ops ops_list[NOF_STAT_OPS];
 
-	if (unlikely(tmp_buff == NULL)) {
-		RTE_LOG(ERR, WK_CMD_RES_FMT,
-				"Failed to get empty buf for append `%s`.\n",
-				name);
-		return SPPWK_RET_NG;
-	}
-
 	memset(ops_list, 0x00,
 			sizeof(struct cmd_res_formatter_ops) * NOF_STAT_OPS);
 
@@ -516,15 +452,11 @@ append_info_value(const char *name, char **output)
 	}
 
 	/* Setup JSON msg in value of `info` key. */
-	ret = append_response_list_value(&tmp_buff, ops_list, NULL);
-	if (unlikely(ret < SPPWK_RET_OK)) {
-		spp_strbuf_free(tmp_buff);
-		return SPPWK_RET_NG;
-	}
-
-	/* Setup response of JSON msg. */
-	ret = append_json_block_brackets(output, name, tmp_buff);
-	spp_strbuf_free(tmp_buff);
+	ret = append_json_begin_block(output, name);
+	if (ret == SPPWK_RET_OK)
+		ret = append_response_list_value(output, ops_list, NULL);
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_end_block(output);
 	return ret;
 }
 
@@ -548,32 +480,23 @@ add_interface(const char *name, char **output,
 		void *tmp __attribute__ ((unused)))
 {
 	int ret = SPPWK_RET_NG;
-	char *tmp_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
-	if (unlikely(tmp_buff == NULL)) {
-		RTE_LOG(ERR, WK_CMD_RES_FMT,
-				/* TODO(yasufum) refactor no meaning err msg */
-				"allocate error. (name = %s)\n",
-				name);
+
+	if (unlikely(append_json_begin_array(output, name) < SPPWK_RET_OK))
 		return SPPWK_RET_NG;
-	}
 
 	if (strcmp(name, SPPWK_PHY_STR) == 0)
-		ret = append_interface_array(&tmp_buff, PHY);
+		ret = append_interface_array(output, PHY);
 
 	else if (strcmp(name, SPPWK_VHOST_STR) == 0)
-		ret = append_interface_array(&tmp_buff, VHOST);
+		ret = append_interface_array(output, VHOST);
 
 	else if (strcmp(name, SPPWK_RING_STR) == 0)
-		ret = append_interface_array(&tmp_buff, RING);
+		ret = append_interface_array(output, RING);
 
-	if (unlikely(ret < SPPWK_RET_OK)) {
-		spp_strbuf_free(tmp_buff);
+	if (unlikely(ret < SPPWK_RET_OK))
 		return SPPWK_RET_NG;
-	}
 
-	ret = append_json_array_brackets(output, name, tmp_buff);
-	spp_strbuf_free(tmp_buff);
-	return ret;
+	return append_json_end_array(output);
 }
 
 /* Add entry of master lcore to a response in JSON. */
@@ -585,3 +508,232 @@ add_master_lcore(const char *name, char **output,
 	ret = append_json_int_value(output, name, rte_get_master_lcore());
 	return ret;
 }
+
+/* Append buckets of a latency histogram not empty in JSON. */
+static int
+append_latency_hist_array(char **output, const struct latency_hist *hist)
+{
+	unsigned int idx;
+	int str_cnt = 0;
+
+	for (idx = 0; idx < LATENCY_NOF_BUCKETS; idx++) {
+		if (hist->buckets[idx] == 0)
+			continue;
+
+		*output = spp_strbuf_appendf(*output,
+				"%s{ \"ns\": %" PRIu64 ", \"count\": %"
+				PRIu64 " }", JSON_APPEND_COMMA(str_cnt),
+				latency_cycles_to_ns(
+					latency_bucket_cycles(idx)),
+				hist->buckets[idx]);
+		if (unlikely(*output == NULL)) {
+			RTE_LOG(ERR, WK_CMD_RES_FMT,
+					"Failed to add latency histogram.\n");
+			return SPPWK_RET_NG;
+		}
+		str_cnt++;
+	}
+	return SPPWK_RET_OK;
+}
+
+/* Append latency of packets sent to a port in JSON. */
+static int
+append_latency_value(char **output, const char *port_str,
+		const struct latency_hist *hist)
+{
+	int ret;
+
+	ret = append_json_begin_block(output, "");
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_str_value(output, "port", port_str);
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_uint64_value(output, "count", hist->count);
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_uint64_value(output, "avg_ns",
+				latency_cycles_to_ns(hist->sum / hist->count));
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_uint64_value(output, "p50_ns",
+				latency_percentile_ns(hist, 500));
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_uint64_value(output, "p99_ns",
+				latency_percentile_ns(hist, 990));
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_uint64_value(output, "p999_ns",
+				latency_percentile_ns(hist, 999));
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_uint64_value(output, "max_ns",
+				latency_cycles_to_ns(hist->max));
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_begin_array(output, "hist");
+	if (ret == SPPWK_RET_OK)
+		ret = append_latency_hist_array(output, hist);
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_end_array(output);
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_end_block(output);
+	return ret;
+}
+
+/**
+ * Add entry of latency of packets sent to each of ports in JSON. Ports
+ * without packets recorded are not included.
+ */
+int
+add_latency(const char *name, char **output,
+		void *tmp __attribute__ ((unused)))
+{
+	static const enum port_type iface_types[] = { PHY, VHOST, RING };
+	static const char * const iface_type_strs[] = {
+		SPPWK_PHY_STR, SPPWK_VHOST_STR, SPPWK_RING_STR };
+	static struct latency_hist hist;
+	char port_str[CMD_TAG_APPEND_SIZE];
+	int ret = SPPWK_RET_OK;
+	int port_id;
+	unsigned int type_cnt;
+	int iface_no;
+
+	ret = append_json_begin_array(output, name);
+	for (type_cnt = 0; ret == SPPWK_RET_OK &&
+			type_cnt < RTE_DIM(iface_types); type_cnt++) {
+		for (iface_no = 0; ret == SPPWK_RET_OK &&
+				iface_no < RTE_MAX_ETHPORTS; iface_no++) {
+			/* Latency is recorded for each of ethdev ports. */
+			port_id = get_ethdev_port_id(iface_types[type_cnt],
+					iface_no, 0);
+			if (port_id < 0)
+				continue;
+
+			latency_sum_hist(port_id, &hist);
+			if (hist.count == 0)
+				continue;
+
+			snprintf(port_str, sizeof(port_str), "%s:%d",
+					iface_type_strs[type_cnt], iface_no);
+			ret = append_latency_value(output, port_str, &hist);
+		}
+	}
+
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_end_array(output);
+	return ret;
+}
+
+/* Append cycles and usage counted for an lcore or a component in JSON. */
+static int
+append_lcore_usage_value(char **output, const struct lcore_usage *usage)
+{
+	int ret;
+
+	ret = append_json_uint64_value(output, "busy_cycles",
+			usage->busy_cycles);
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_uint64_value(output, "idle_cycles",
+				usage->idle_cycles);
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_uint_value(output, "usage",
+				lcore_usage_percent(usage));
+	return ret;
+}
+
+/* Append usage of components running on an lcore in JSON. */
+static int
+append_comp_usage_array(char **output, const struct core_info *core)
+{
+	int ret = SPPWK_RET_OK;
+	int cnt;
+	struct sppwk_comp_info *comp_info_base = NULL;
+
+	sppwk_get_mng_data(NULL, &comp_info_base, NULL, NULL, NULL, NULL);
+	for (cnt = 0; ret == SPPWK_RET_OK && cnt < core->num; cnt++) {
+		ret = append_json_begin_block(output, "");
+		if (ret == SPPWK_RET_OK)
+			ret = append_json_str_value(output, "name",
+					comp_info_base[core->id[cnt]].name);
+		if (ret == SPPWK_RET_OK)
+			ret = append_lcore_usage_value(output,
+					&comp_usages[core->id[cnt]]);
+		if (ret == SPPWK_RET_OK)
+			ret = append_json_end_block(output);
+	}
+	return ret;
+}
+
+/**
+ * Add entry of usage of slave and service lcores, and components on each of
+ * them, in JSON. Cycles of polls receiving packets are counted as busy.
+ */
+int
+add_lcore_usage(const char *name, char **output,
+		void *tmp __attribute__ ((unused)))
+{
+	int ret;
+	unsigned int lcore_id;
+
+	ret = append_json_begin_array(output, name);
+	SPPWK_LCORE_FOREACH_WORKER(lcore_id) {
+		if (unlikely(ret != SPPWK_RET_OK))
+			break;
+		if (sppwk_get_lcore_status(lcore_id) == SPPWK_LCORE_UNUSED)
+			continue;
+
+		ret = append_json_begin_block(output, "");
+		if (ret == SPPWK_RET_OK)
+			ret = append_json_uint_value(output, "lcore",
+					lcore_id);
+		if (ret == SPPWK_RET_OK)
+			ret = append_lcore_usage_value(output,
+					&lcore_usages[lcore_id]);
+		if (ret == SPPWK_RET_OK)
+			ret = append_json_begin_array(output, "components");
+		if (ret == SPPWK_RET_OK)
+			ret = append_comp_usage_array(output,
+					get_core_info(lcore_id));
+		if (ret == SPPWK_RET_OK)
+			ret = append_json_end_array(output);
+		if (ret == SPPWK_RET_OK)
+			ret = append_json_end_block(output);
+	}
+
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_end_array(output);
+	return ret;
+}
+
+/**
+ * Add entry of packets of errors on data path, such as drops, for each of
+ * slave and service lcores in JSON. Here is an example.
+ *
+ *     "drops": [{"lcore":2,"tx_full":32,"no_mbuf":0,"ring_full":0}]
+ */
+int
+add_drops(const char *name, char **output,
+		void *tmp __attribute__ ((unused)))
+{
+	int ret;
+	unsigned int lcore_id;
+	int reason;
+
+	ret = append_json_begin_array(output, name);
+	SPPWK_LCORE_FOREACH_WORKER(lcore_id) {
+		if (unlikely(ret != SPPWK_RET_OK))
+			break;
+		if (sppwk_get_lcore_status(lcore_id) == SPPWK_LCORE_UNUSED)
+			continue;
+
+		ret = append_json_begin_block(output, "");
+		if (ret == SPPWK_RET_OK)
+			ret = append_json_uint_value(output, "lcore",
+					lcore_id);
+		for (reason = 0; ret == SPPWK_RET_OK &&
+				reason < DP_EVENT_NOF_REASONS; reason++)
+			ret = append_json_uint64_value(output,
+					dp_event_name(reason),
+					dp_event_stats[lcore_id].pkts[reason]);
+		if (ret == SPPWK_RET_OK)
+			ret = append_json_end_block(output);
+	}
+
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_end_array(output);
+	return ret;
+}
@@ -74,4 +74,13 @@ int add_interface(const char *name, char **output,
 
 int add_master_lcore(const char *name, char **output,
 		void *tmp __attribute__ ((unused)));
+
+int add_latency(const char *name, char **output,
+		void *tmp __attribute__ ((unused)));
+
+int add_lcore_usage(const char *name, char **output,
+		void *tmp __attribute__ ((unused)));
+
+int add_drops(const char *name, char **output,
+		void *tmp __attribute__ ((unused)));
 #endif
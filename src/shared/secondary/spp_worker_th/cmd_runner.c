@@ -6,14 +6,18 @@
 #include <string.h>
 
 #include <rte_log.h>
+#include <rte_cycles.h>
 #include <rte_branch_prediction.h>
 
 #include "cmd_runner.h"
 #include "cmd_res_formatter.h"
 #include "conn_spp_ctl.h"
 #include "cmd_parser.h"
+#include "comp_service.h"
+#include "port_capability.h"
 #include "shared/secondary/string_buffer.h"
 #include "shared/secondary/json_helper.h"
+#include "shared/trace.h"
 
 #ifdef SPP_VF_MODULE
 #include "vf_deps.h"
@@ -38,7 +42,7 @@ enum cmd_res_code {
 int
 flush_cmd(void)
 {
-	int ret;
+	int ret, ret_svc;
 	int *p_change_comp;
 	struct sppwk_comp_info *p_comp_info;
 	struct cancel_backup_info *backup_info;
@@ -47,19 +51,48 @@ flush_cmd(void)
 			&backup_info);
 
 	ret = update_port_info();
-	if (ret < SPPWK_RET_OK)
+	if (ret < SPPWK_RET_OK) {
+		/**
+		 * Nothing is published yet, so roll back updates in the
+		 * backup not to be restored again by a later cancel_cmd().
+		 */
+		cancel_mng_info(backup_info);
 		return ret;
+	}
 
-	/* TODO(yasufum) confirm why no returned value. */
-	update_lcore_info();
-
+	/**
+	 * Publish update sides of components, port attributes and lcores.
+	 * Components are published before lcores so that a newly assigned
+	 * component is never run with its old data.
+	 */
 	/* TODO(yasufum) confirm why no checking for returned value. */
 	ret = update_comp_info(p_comp_info, p_change_comp);
+	sppwk_swap_two_sides(SPPWK_SWAP_REF, 0, 0);
+	update_lcore_info();
+	ret_svc = sppwk_update_comp_services();
+
+	/* Wait just once for all of updates before reusing retired sides. */
+	sppwk_wait_grace_period();
+	sync_lcore_info();
+	sppwk_sync_comp_services();
+	sync_comp_info();
 
 	backup_mng_info(backup_info);
+	if (unlikely(ret_svc != SPPWK_RET_OK))
+		return ret_svc;
 	return ret;
 }
 
+/* Cancel temporarily stored command. */
+void
+cancel_cmd(void)
+{
+	struct cancel_backup_info *backup_info;
+
+	sppwk_get_mng_data(NULL, NULL, NULL, NULL, NULL, &backup_info);
+	cancel_mng_info(backup_info);
+}
+
 /* Get error message of parsing from given wk_err_msg object. */
 static const char *
 get_parse_err_msg(
@@ -157,40 +190,26 @@ send_decode_error_response(int *sock,
 		struct cmd_result *cmd_results)
 {
 	int ret = SPPWK_RET_NG;
-	char *msg, *tmp_buff;
-	tmp_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
-	if (unlikely(tmp_buff == NULL)) {
-		/* TODO(yasufum) refactor no meaning err msg */
-		RTE_LOG(ERR, WK_CMD_RUNNER, "allocate error. "
-				"(name = decode_error_response)\n");
-		return;
-	}
-
-	/* create & append result array */
-	ret = append_command_results_value("results", &tmp_buff,
-			request->nof_cmds, cmd_results);
-	if (unlikely(ret < SPPWK_RET_OK)) {
-		spp_strbuf_free(tmp_buff);
-		RTE_LOG(ERR, WK_CMD_RUNNER,
-				"Failed to make command result response.\n");
-		return;
-	}
-
+	char *msg;
 	msg = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
 	if (unlikely(msg == NULL)) {
-		spp_strbuf_free(tmp_buff);
 		/* TODO(yasufum) refactor no meaning err msg */
 		RTE_LOG(ERR, WK_CMD_RUNNER, "allocate error. "
 				"(name = decode_error_response)\n");
 		return;
 	}
-	ret = append_json_block_brackets(&msg, "", tmp_buff);
-	spp_strbuf_free(tmp_buff);
+
+	/* create & append result array */
+	ret = append_json_begin_block(&msg, "");
+	if (ret == SPPWK_RET_OK)
+		ret = append_command_results_value("results", &msg,
+				request->nof_cmds, cmd_results);
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_end_block(&msg);
 	if (unlikely(ret < SPPWK_RET_OK)) {
 		spp_strbuf_free(msg);
 		RTE_LOG(ERR, WK_CMD_RUNNER,
-				/* TODO(yasufum) refactor no meaning err msg */
-				"allocate error. (name = result_response)\n");
+				"Failed to make command result response.\n");
 		return;
 	}
 
@@ -199,7 +218,7 @@ send_decode_error_response(int *sock,
 			"response_str=\n%s\n", msg);
 
 	/* send response to requester */
-	ret = send_ctl_msg(sock, msg, strlen(msg));
+	ret = send_ctl_msg(sock, msg, spp_strbuf_len(msg));
 	if (unlikely(ret != SPPWK_RET_OK)) {
 		RTE_LOG(ERR, WK_CMD_RUNNER,
 				"Failed to send decode error response.\n");
@@ -209,16 +228,19 @@ send_decode_error_response(int *sock,
 	spp_strbuf_free(msg);
 }
 
-/* Send the result of command to spp-ctl. */
+/**
+ * Send the result of command to spp-ctl. The response is written to a
+ * buffer in streaming without temporary buffers for each of parts.
+ */
 static void
 send_result_spp_ctl(int *sock,
 		const struct sppwk_cmd_req *request,
 		struct cmd_result *cmd_results)
 {
 	int ret = SPPWK_RET_NG;
-	char *msg, *tmp_buff;
-	tmp_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
-	if (unlikely(tmp_buff == NULL)) {
+	char *msg;
+	msg = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
+	if (unlikely(msg == NULL)) {
 		RTE_LOG(ERR, WK_CMD_RUNNER,
 				/* TODO(yasufum) refactor no meaning err msg */
 				"allocate error. (name = result_response)\n");
@@ -226,10 +248,12 @@ send_result_spp_ctl(int *sock,
 	}
 
 	/* create & append result array */
-	ret = append_command_results_value("results", &tmp_buff,
-			request->nof_cmds, cmd_results);
+	ret = append_json_begin_block(&msg, "");
+	if (ret == SPPWK_RET_OK)
+		ret = append_command_results_value("results", &msg,
+				request->nof_cmds, cmd_results);
 	if (unlikely(ret < SPPWK_RET_OK)) {
-		spp_strbuf_free(tmp_buff);
+		spp_strbuf_free(msg);
 		RTE_LOG(ERR, WK_CMD_RUNNER,
 				"Failed to make command result response.\n");
 		return;
@@ -237,38 +261,30 @@ send_result_spp_ctl(int *sock,
 
 	/* append client id information value */
 	if (request->is_requested_client_id) {
-		ret = add_client_id("client_id", &tmp_buff, NULL);
+		ret = add_client_id("client_id", &msg, NULL);
+		if (ret == SPPWK_RET_OK)
+			ret = append_process_type_value("process_type",
+					&msg, NULL);
 		if (unlikely(ret < SPPWK_RET_OK)) {
-			spp_strbuf_free(tmp_buff);
+			spp_strbuf_free(msg);
 			RTE_LOG(ERR, WK_CMD_RUNNER, "Failed to make "
 					"client id response.\n");
 			return;
 		}
-		ret = append_process_type_value("process_type",
-							&tmp_buff, NULL);
 	}
 
 	/* append info value */
 	if (request->is_requested_status) {
-		ret = append_info_value("info", &tmp_buff);
+		ret = append_info_value("info", &msg);
 		if (unlikely(ret < SPPWK_RET_OK)) {
-			spp_strbuf_free(tmp_buff);
+			spp_strbuf_free(msg);
 			RTE_LOG(ERR, WK_CMD_RUNNER,
 					"Failed to make status response.\n");
 			return;
 		}
 	}
 
-	msg = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
-	if (unlikely(msg == NULL)) {
-		spp_strbuf_free(tmp_buff);
-		RTE_LOG(ERR, WK_CMD_RUNNER,
-				/* TODO(yasufum) refactor no meaning err msg */
-				"allocate error. (name = result_response)\n");
-		return;
-	}
-	ret = append_json_block_brackets(&msg, "", tmp_buff);
-	spp_strbuf_free(tmp_buff);
+	ret = append_json_end_block(&msg);
 	if (unlikely(ret < SPPWK_RET_OK)) {
 		spp_strbuf_free(msg);
 		RTE_LOG(ERR, WK_CMD_RUNNER,
@@ -282,7 +298,7 @@ send_result_spp_ctl(int *sock,
 			"response_str=\n%s\n", msg);
 
 	/* send response to requester */
-	ret = send_ctl_msg(sock, msg, strlen(msg));
+	ret = send_ctl_msg(sock, msg, spp_strbuf_len(msg));
 	if (unlikely(ret != SPPWK_RET_OK)) {
 		RTE_LOG(ERR, WK_CMD_RUNNER,
 			"Failed to send command result response.\n");
@@ -298,6 +314,7 @@ exec_cmds(int *sock, const char *req_str, size_t req_str_len)
 {
 	int ret = SPPWK_RET_NG;
 	int i;
+	uint64_t start;
 
 	struct sppwk_cmd_req cmd_req;
 	struct sppwk_parse_err_msg wk_err_msg;
@@ -326,7 +343,10 @@ exec_cmds(int *sock, const char *req_str, size_t req_str_len)
 
 	/* execute commands */
 	for (i = 0; i < cmd_req.nof_cmds; ++i) {
+		start = rte_rdtsc();
 		ret = exec_one_cmd(cmd_req.commands + i);
+		trace_cmd(cmd_req.commands[i].type, ret != SPPWK_RET_OK,
+				rte_rdtsc() - start);
 		if (unlikely(ret != SPPWK_RET_OK)) {
 			set_cmd_result(&cmd_results[i], CMD_FAILED,
 					"error occur");
@@ -409,7 +429,7 @@ sppwk_run_cmd(void)
 int
 del_comp_info(int lcore_id, int nof_comps, int *comp_ary)
 {
-	int idx = 0;  /* The index of comp_ary to be deleted. */
+	int idx = -1;  /* The index of comp_ary to be deleted. */
 	int cnt;
 
 	/* Find the index. */
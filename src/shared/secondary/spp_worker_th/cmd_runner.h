@@ -19,6 +19,12 @@
  */
 int flush_cmd(void);
 
+/**
+ * Cancel temporarily stored command which is failed before flushing, and
+ * management data is restored as it was flushed last.
+ */
+void cancel_cmd(void);
+
 /**
  * Setup connection for accepting commands from spp-ctl.
  *
@@ -2,13 +2,17 @@
  * Copyright(c) 2018-2019 Nippon Telegraph and Telephone Corporation
  */
 
+#include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include <arpa/inet.h>
 
 #include <rte_eth_ring.h>
 #include <rte_eth_vhost.h>
 #include <rte_cycles.h>
 #include <rte_log.h>
+#include <rte_malloc.h>
+#include <rte_rcu_qsbr.h>
 #include <rte_branch_prediction.h>
 
 #include "cmd_utils.h"
@@ -25,6 +29,7 @@
 
 #include "shared/secondary/add_port.h"
 #include "shared/secondary/utils.h"
+#include "shared/trace.h"
 
 
 /* TODO(yasufum) change log label after filename is revised. */
@@ -44,6 +49,13 @@ struct mng_data_info {
 /* Logical core ID for main process */
 static struct mng_data_info g_mng_data;
 
+/**
+ * QSBR variable for worker lcores. Master lcore waits for a grace period
+ * on it to confirm that retired sides of two sides data are no longer
+ * referred while flushing.
+ */
+static struct rte_rcu_qsbr *g_wk_qsv;
+
 /* Hexdump `addr` for logging, used for core_info or component info. */
 void
 log_hexdumped(const char *obj_name, const void *obj_addr, const size_t size)
@@ -143,6 +155,10 @@ stop_process(int signal)
 		return;
 	}
 
+	/* Nothing to stop before management data is allocated. */
+	if (unlikely(g_mng_data.p_core_info == NULL))
+		return;
+
 	master_lcore = rte_get_master_lcore();
 	(g_mng_data.p_core_info + master_lcore)->status =
 		SPPWK_LCORE_REQ_STOP;
@@ -151,7 +167,7 @@ stop_process(int signal)
 
 /**
  * Return sppwk_port_info of given type and num of interface. It returns NULL
- * if given type is invalid.
+ * if given type is invalid, or port info is not allocated yet.
  */
 struct sppwk_port_info *
 get_sppwk_port(enum port_type iface_type, int iface_no, int queue_no)
@@ -160,14 +176,76 @@ get_sppwk_port(enum port_type iface_type, int iface_no, int queue_no)
 
 	switch (iface_type) {
 	case PHY:
+		/* Queues are allocated only for existing phy ports. */
+		if (unlikely(queue_no < 0) || unlikely(queue_no >=
+				iface_info->nof_phy_queues[iface_no]))
+			return NULL;
 		return &iface_info->phy[iface_no][queue_no];
 	case VHOST:
-		return &iface_info->vhost[iface_no];
+		return iface_info->vhost[iface_no];
+	case RING:
+		return iface_info->ring[iface_no];
+	default:
+		return NULL;
+	}
+}
+
+/* Allocate port info of vhost or ring on the local socket. */
+static struct sppwk_port_info *
+alloc_single_port(enum port_type iface_type, int iface_no)
+{
+	struct sppwk_port_info *port;
+
+	port = rte_zmalloc_socket("sppwk_port", sizeof(*port),
+			RTE_CACHE_LINE_SIZE, rte_socket_id());
+	if (unlikely(port == NULL)) {
+		RTE_LOG(ERR, WK_CMD_UTILS, "Failed to alloc port %d:%d.\n",
+				iface_type, iface_no);
+		return NULL;
+	}
+
+	port->iface_type = UNDEF;
+	port->iface_no = iface_no;
+	port->queue_no = DEFAULT_QUEUE_ID;
+	port->ethdev_port_id = -1;
+	port->cls_attrs.vlantag.vid = ETH_VLAN_ID_MAX;
+	return port;
+}
+
+/* Get port info to be updated, or allocate it for vhost or ring. */
+struct sppwk_port_info *
+sppwk_prepare_port(enum port_type iface_type, int iface_no, int queue_no)
+{
+	struct iface_info *iface_info = g_mng_data.p_iface_info;
+	struct sppwk_port_info **slot;
+	struct sppwk_port_info *port;
+
+	switch (iface_type) {
+	case VHOST:
+		slot = &iface_info->vhost[iface_no];
+		break;
 	case RING:
-		return &iface_info->ring[iface_no];
+		slot = &iface_info->ring[iface_no];
+		break;
 	default:
+		return get_sppwk_port(iface_type, iface_no, queue_no);
+	}
+	if (*slot != NULL)
+		return *slot;
+
+	port = alloc_single_port(iface_type, iface_no);
+	if (unlikely(port == NULL))
+		return NULL;
+
+	/* Freed if canceled, or kept until the process is terminated. */
+	if (unlikely(backup_mng_obj(slot, sizeof(*slot)) != SPPWK_RET_OK) ||
+			unlikely(backup_mng_replaced(port, NULL) !=
+			SPPWK_RET_OK)) {
+		rte_free(port);
 		return NULL;
 	}
+	*slot = port;
+	return port;
 }
 
 /* Dump of core information */
@@ -177,7 +255,7 @@ log_core_info(const struct core_mng_info *core_info)
 	char str[STR_LEN_NAME];
 	const struct core_mng_info *info = NULL;
 	unsigned int lcore_id = 0;
-	RTE_LCORE_FOREACH_SLAVE(lcore_id) {
+	SPPWK_LCORE_FOREACH_WORKER(lcore_id) {
 		info = &core_info[lcore_id];
 		RTE_LOG(DEBUG, WK_CMD_UTILS,
 				"core[%d] status=%d, ref=%d, upd=%d\n",
@@ -231,8 +309,7 @@ log_interface_info(const struct iface_info *iface_info)
 	int cnt = 0;
 	int queue_cnt;
 	for (cnt = 0; cnt < RTE_MAX_ETHPORTS; cnt++) {
-		int max_queue_port = get_port_max_queues(PHY, cnt);
-		for (queue_cnt = 0; queue_cnt < max_queue_port;
+		for (queue_cnt = 0; queue_cnt < iface_info->nof_phy_queues[cnt];
 				queue_cnt++) {
 			port = &iface_info->phy[cnt][queue_cnt];
 			if (port->iface_type == UNDEF)
@@ -249,8 +326,8 @@ log_interface_info(const struct iface_info *iface_info)
 		}
 	}
 	for (cnt = 0; cnt < RTE_MAX_ETHPORTS; cnt++) {
-		port = &iface_info->vhost[cnt];
-		if (port->iface_type == UNDEF)
+		port = iface_info->vhost[cnt];
+		if (port == NULL || port->iface_type == UNDEF)
 			continue;
 
 		RTE_LOG(DEBUG, WK_CMD_UTILS,
@@ -263,8 +340,8 @@ log_interface_info(const struct iface_info *iface_info)
 				port->cls_attrs.mac_addr_str);
 	}
 	for (cnt = 0; cnt < RTE_MAX_ETHPORTS; cnt++) {
-		port = &iface_info->ring[cnt];
-		if (port->iface_type == UNDEF)
+		port = iface_info->ring[cnt];
+		if (port == NULL || port->iface_type == UNDEF)
 			continue;
 
 		RTE_LOG(DEBUG, WK_CMD_UTILS,
@@ -293,44 +370,112 @@ log_all_mng_info(
 	log_interface_info(interface);
 }
 
-/* Copy management information */
-void
-copy_mng_info(
-		struct core_mng_info *dst_core,
-		struct sppwk_comp_info *dst_component,
-		struct iface_info *dst_interface,
-		const struct core_mng_info *src_core,
-		const struct sppwk_comp_info *src_component,
-		const struct iface_info *src_interface,
-		enum copy_mng_flg flg)
-{
-	int upd_index = 0;
-	unsigned int lcore_id = 0;
+/* Initial num of entries of backup, and it is doubled if it is not enough. */
+#define MNG_BACKUP_INIT_ENTS 16
 
-	switch (flg) {
-	case COPY_MNG_FLG_UPDCOPY:
-		RTE_LCORE_FOREACH_SLAVE(lcore_id) {
-			upd_index = src_core[lcore_id].upd_index;
-			memcpy(&dst_core[lcore_id].core[upd_index],
-					&src_core[lcore_id].core[upd_index],
-					sizeof(struct core_info));
+/* Save an object of management data before updating it. */
+int
+backup_mng_obj(void *addr, size_t size)
+{
+	struct cancel_backup_info *backup = g_mng_data.p_backup_info;
+	struct mng_backup_ent *ents;
+	int max_ents, i;
+	void *data;
+
+	if (unlikely(addr == NULL))
+		return SPPWK_RET_NG;
+
+	/* Only the first copy after the last flush is kept. */
+	for (i = 0; i < backup->nof_ents; i++) {
+		if (backup->ents[i].addr == addr &&
+				backup->ents[i].size == size)
+			return SPPWK_RET_OK;
+	}
+
+	if (backup->nof_ents == backup->max_ents) {
+		max_ents = backup->max_ents == 0 ?
+				MNG_BACKUP_INIT_ENTS : backup->max_ents * 2;
+		ents = realloc(backup->ents, sizeof(*ents) * max_ents);
+		if (unlikely(ents == NULL)) {
+			RTE_LOG(ERR, WK_CMD_UTILS,
+					"Failed to extend backup entries.\n");
+			return SPPWK_RET_NG;
 		}
-		break;
-	default:
-		/*
-		 * Even if the flag is set to None,
-		 * copying of core is necessary,
-		 * so we will treat all copies as default.
-		 */
-		memcpy(dst_core, src_core,
-				sizeof(struct core_mng_info)*RTE_MAX_LCORE);
-		break;
+		backup->ents = ents;
+		backup->max_ents = max_ents;
 	}
 
-	memcpy(dst_component, src_component,
-			sizeof(struct sppwk_comp_info)*RTE_MAX_LCORE);
-	memcpy(dst_interface, src_interface,
-			sizeof(struct iface_info));
+	data = malloc(size);
+	if (unlikely(data == NULL)) {
+		RTE_LOG(ERR, WK_CMD_UTILS, "Failed to alloc backup of %p.\n",
+				addr);
+		return SPPWK_RET_NG;
+	}
+	memcpy(data, addr, size);
+
+	backup->ents[backup->nof_ents].addr = addr;
+	backup->ents[backup->nof_ents].size = size;
+	backup->ents[backup->nof_ents].data = data;
+	backup->nof_ents++;
+	return SPPWK_RET_OK;
+}
+
+/* Log an object of management data replaced with another one. */
+int
+backup_mng_replaced(void *new_obj, void *old_obj)
+{
+	struct cancel_backup_info *backup = g_mng_data.p_backup_info;
+	struct mng_replaced_ent *ents;
+	int max_ents;
+
+	if (backup->nof_replaced == backup->max_replaced) {
+		max_ents = backup->max_replaced == 0 ?
+				MNG_BACKUP_INIT_ENTS :
+				backup->max_replaced * 2;
+		ents = realloc(backup->replaced, sizeof(*ents) * max_ents);
+		if (unlikely(ents == NULL)) {
+			RTE_LOG(ERR, WK_CMD_UTILS,
+					"Failed to extend replaced entries.\n");
+			return SPPWK_RET_NG;
+		}
+		backup->replaced = ents;
+		backup->max_replaced = max_ents;
+	}
+
+	backup->replaced[backup->nof_replaced].new_obj = new_obj;
+	backup->replaced[backup->nof_replaced].old_obj = old_obj;
+	backup->nof_replaced++;
+	return SPPWK_RET_OK;
+}
+
+/* Free saved objects, and entries are kept to be reused. */
+static void
+clear_backup_ents(struct cancel_backup_info *backup)
+{
+	int i;
+
+	for (i = 0; i < backup->nof_ents; i++)
+		free(backup->ents[i].data);
+	backup->nof_ents = 0;
+}
+
+/**
+ * Free old objects replaced if `is_flushed`, or new ones if canceled. It
+ * is called after objects are restored for cancel, because a new object
+ * might be restored as it was before freed.
+ */
+static void
+clear_replaced_ents(struct cancel_backup_info *backup, int is_flushed)
+{
+	int i;
+
+	for (i = 0; i < backup->nof_replaced; i++) {
+		if (is_flushed)
+			rte_free(backup->replaced[i].old_obj);
+		else
+			rte_free(backup->replaced[i].new_obj);
+	}
+	backup->nof_replaced = 0;
 }
 
 /* Backup the management information */
@@ -340,12 +485,27 @@ backup_mng_info(struct cancel_backup_info *backup)
 	log_all_mng_info(g_mng_data.p_core_info,
 			g_mng_data.p_component_info,
 			g_mng_data.p_iface_info);
-	copy_mng_info(backup->core, backup->component, &backup->interface,
-			g_mng_data.p_core_info,
-			g_mng_data.p_component_info,
-			g_mng_data.p_iface_info,
-			COPY_MNG_FLG_ALLCOPY);
-	log_all_mng_info(backup->core, backup->component, &backup->interface);
+	clear_backup_ents(backup);
+	clear_replaced_ents(backup, 1);
+	memset(g_mng_data.p_change_core, 0x00,
+				sizeof(int)*RTE_MAX_LCORE);
+	memset(g_mng_data.p_change_component, 0x00,
+				sizeof(int)*RTE_MAX_LCORE);
+}
+
+/* Cancel updates of the management information since the last backup */
+void
+cancel_mng_info(struct cancel_backup_info *backup)
+{
+	int i;
+
+	RTE_LOG(DEBUG, WK_CMD_UTILS, "Restore %d objects from backup.\n",
+			backup->nof_ents);
+	for (i = backup->nof_ents - 1; i >= 0; i--)
+		memcpy(backup->ents[i].addr, backup->ents[i].data,
+				backup->ents[i].size);
+	clear_backup_ents(backup);
+	clear_replaced_ents(backup, 0);
 	memset(g_mng_data.p_change_core, 0x00,
 				sizeof(int)*RTE_MAX_LCORE);
 	memset(g_mng_data.p_change_component, 0x00,
@@ -355,43 +515,14 @@ backup_mng_info(struct cancel_backup_info *backup)
 /**
  * Initialize g_iface_info
  *
- * Clear g_iface_info and set initial value.
+ * Clear g_iface_info. Queues of phy ports and existing rings are allocated
+ * in init_host_port_info(), and others are allocated when they are added.
  */
 static void
 init_iface_info(void)
 {
-	int port_cnt;  /* increment ether ports */
-	int queue_cnt;  /* increment ether queue per ports */
 	struct iface_info *p_iface_info = g_mng_data.p_iface_info;
 	memset(p_iface_info, 0x00, sizeof(struct iface_info));
-	for (port_cnt = 0; port_cnt < RTE_MAX_ETHPORTS; port_cnt++) {
-		for (queue_cnt = 0; queue_cnt < RTE_MAX_QUEUES_PER_PORT;
-				queue_cnt++) {
-			p_iface_info->phy[port_cnt][queue_cnt].iface_type =
-					UNDEF;
-			p_iface_info->phy[port_cnt][queue_cnt].iface_no =
-					port_cnt;
-			p_iface_info->phy[port_cnt][queue_cnt].queue_no =
-					queue_cnt;
-			p_iface_info->phy[port_cnt][queue_cnt]
-					.ethdev_port_id = -1;
-			p_iface_info->phy[port_cnt][queue_cnt]
-					.cls_attrs.vlantag.vid =
-					ETH_VLAN_ID_MAX;
-		}
-		p_iface_info->vhost[port_cnt].iface_type = UNDEF;
-		p_iface_info->vhost[port_cnt].iface_no = port_cnt;
-		p_iface_info->vhost[port_cnt].queue_no = DEFAULT_QUEUE_ID;
-		p_iface_info->vhost[port_cnt].ethdev_port_id = -1;
-		p_iface_info->vhost[port_cnt].cls_attrs.vlantag.vid =
-			ETH_VLAN_ID_MAX;
-		p_iface_info->ring[port_cnt].iface_type = UNDEF;
-		p_iface_info->ring[port_cnt].iface_no = port_cnt;
-		p_iface_info->ring[port_cnt].queue_no = DEFAULT_QUEUE_ID;
-		p_iface_info->ring[port_cnt].ethdev_port_id = -1;
-		p_iface_info->ring[port_cnt].cls_attrs.vlantag.vid =
-			ETH_VLAN_ID_MAX;
-	}
 }
 
 /* Initialize g_component_info */
@@ -423,15 +554,55 @@ init_core_info(void)
 	memset(g_mng_data.p_change_core, 0x00, sizeof(int)*RTE_MAX_LCORE);
 }
 
+/**
+ * Allocate port info of queues of phy port `iface_no` on the socket of
+ * `ethdev_port_id`, as many as the num of queues of the port.
+ */
+static int
+init_phy_queues(struct iface_info *iface_info, int iface_no,
+		uint16_t ethdev_port_id)
+{
+	struct sppwk_port_info *queues;
+	int nof_queues, queue_id;
+
+	nof_queues = get_port_max_queues(PHY, iface_no);
+	if (nof_queues < 1)
+		nof_queues = 1;
+
+	queues = rte_zmalloc_socket("sppwk_phy_queues",
+			sizeof(struct sppwk_port_info) * nof_queues,
+			RTE_CACHE_LINE_SIZE,
+			rte_eth_dev_socket_id(ethdev_port_id));
+	if (unlikely(queues == NULL)) {
+		RTE_LOG(ERR, WK_CMD_UTILS,
+				"Failed to alloc queues of phy:%d.\n",
+				iface_no);
+		return SPPWK_RET_NG;
+	}
+
+	for (queue_id = 0; queue_id < nof_queues; queue_id++) {
+		queues[queue_id].iface_type = PHY;
+		queues[queue_id].iface_no = iface_no;
+		queues[queue_id].queue_no = queue_id;
+		queues[queue_id].ethdev_port_id = iface_no;
+		queues[queue_id].cls_attrs.vlantag.vid = ETH_VLAN_ID_MAX;
+	}
+
+	iface_info->phy[iface_no] = queues;
+	iface_info->nof_phy_queues[iface_no] = nof_queues;
+	return SPPWK_RET_OK;
+}
+
 /* Initialize mng data of ports on host */
 static int
 init_host_port_info(void)
 {
 	int port_type, port_id;
-	int i, ret, queue_id;
+	int i, ret;
 	int nof_phys = 0;
 	char dev_name[RTE_DEV_NAME_MAX_LEN] = { 0 };
 	struct iface_info *p_iface_info = g_mng_data.p_iface_info;
+	struct sppwk_port_info *port;
 
 	for (i = 0; i < RTE_MAX_ETHPORTS; i++) {
 		if (!rte_eth_dev_is_valid_port(i))
@@ -450,13 +621,9 @@ init_host_port_info(void)
 
 		switch (port_type) {
 		case PHY:
-			for (queue_id = 0; queue_id < RTE_MAX_QUEUES_PER_PORT;
-					queue_id++) {
-				p_iface_info->phy[port_id][queue_id]
-						.iface_type = port_type;
-				p_iface_info->phy[port_id][queue_id]
-						.ethdev_port_id = port_id;
-			}
+			ret = init_phy_queues(p_iface_info, port_id, i);
+			if (unlikely(ret != SPPWK_RET_OK))
+				return SPPWK_RET_NG;
 			break;
 		case VHOST:
 			/* NOTE: a vhost can be used by one process.
@@ -467,8 +634,12 @@ init_host_port_info(void)
 			 */
 			break;
 		case RING:
-			p_iface_info->ring[port_id].iface_type = port_type;
-			p_iface_info->ring[port_id].ethdev_port_id = port_id;
+			port = alloc_single_port(RING, port_id);
+			if (unlikely(port == NULL))
+				return SPPWK_RET_NG;
+			port->iface_type = port_type;
+			port->ethdev_port_id = port_id;
+			p_iface_info->ring[port_id] = port;
 			break;
 		case PIPE:
 			break;
@@ -483,6 +654,31 @@ init_host_port_info(void)
 	return SPPWK_RET_OK;
 }
 
+/* Setup QSBR variable shared with worker lcores. */
+static int
+init_wk_qsbr(void)
+{
+	size_t sz;
+
+	if (g_wk_qsv != NULL)
+		return SPPWK_RET_OK;
+
+	sz = rte_rcu_qsbr_get_memsize(RTE_MAX_LCORE);
+	g_wk_qsv = rte_zmalloc(NULL, sz, RTE_CACHE_LINE_SIZE);
+	if (unlikely(g_wk_qsv == NULL)) {
+		RTE_LOG(ERR, WK_CMD_UTILS, "Failed to alloc QSBR variable.\n");
+		return SPPWK_RET_NG;
+	}
+
+	if (unlikely(rte_rcu_qsbr_init(g_wk_qsv, RTE_MAX_LCORE) != 0)) {
+		RTE_LOG(ERR, WK_CMD_UTILS, "Failed to init QSBR variable.\n");
+		rte_free(g_wk_qsv);
+		g_wk_qsv = NULL;
+		return SPPWK_RET_NG;
+	}
+	return SPPWK_RET_OK;
+}
+
 /* Setup management info for spp_vf */
 int
 init_mng_data(void)
@@ -492,7 +688,11 @@ init_mng_data(void)
 	init_core_info();
 	init_component_info();
 
-	int ret = init_host_port_info();
+	int ret = init_wk_qsbr();
+	if (unlikely(ret != SPPWK_RET_OK))
+		return SPPWK_RET_NG;
+
+	ret = init_host_port_info();
 	if (unlikely(ret != SPPWK_RET_OK))
 		return SPPWK_RET_NG;
 	return SPPWK_RET_OK;
@@ -500,7 +700,7 @@ init_mng_data(void)
 
 /* Remove sock file if spp is not running */
 void
-del_vhost_sockfile(struct sppwk_port_info *vhost)
+del_vhost_sockfile(struct sppwk_port_info **vhost)
 {
 	int cnt;
 
@@ -509,7 +709,8 @@ del_vhost_sockfile(struct sppwk_port_info *vhost)
 		return;
 
 	for (cnt = 0; cnt < RTE_MAX_ETHPORTS; cnt++) {
-		if (likely(vhost[cnt].iface_type == UNDEF)) {
+		if (likely(vhost[cnt] == NULL) ||
+				likely(vhost[cnt]->iface_type == UNDEF)) {
 			/* Skip removing if it is not using vhost */
 			continue;
 		}
@@ -534,15 +735,64 @@ get_core_info(unsigned int lcore_id)
 	return &(info->core[info->ref_index]);
 }
 
-/* Check lcore info of given ID is updated */
-int
-sppwk_is_lcore_updated(unsigned int lcore_id)
+/* Get next slave lcore or service lcore after `i`. */
+unsigned int
+sppwk_get_next_lcore(unsigned int i)
 {
-	struct core_mng_info *info = (g_mng_data.p_core_info + lcore_id);
-	if (info->ref_index == info->upd_index)
-		return 1;
-	else
-		return 0;
+	while (++i < RTE_MAX_LCORE) {
+		if (rte_eal_lcore_role(i) == ROLE_SERVICE)
+			break;
+		if (rte_lcore_is_enabled(i) && i != rte_get_master_lcore())
+			break;
+	}
+	return i;
+}
+
+/* Register worker lcore to QSBR variable before entering main loop. */
+void
+sppwk_qsbr_register(unsigned int lcore_id)
+{
+	rte_rcu_qsbr_thread_register(g_wk_qsv, lcore_id);
+}
+
+/* Unregister worker lcore from QSBR variable after leaving main loop. */
+void
+sppwk_qsbr_unregister(unsigned int lcore_id)
+{
+	rte_rcu_qsbr_thread_offline(g_wk_qsv, lcore_id);
+	rte_rcu_qsbr_thread_unregister(g_wk_qsv, lcore_id);
+}
+
+/* Start reporting quiescent states of worker lcore. */
+void
+sppwk_qsbr_online(unsigned int lcore_id)
+{
+	rte_rcu_qsbr_thread_online(g_wk_qsv, lcore_id);
+}
+
+/* Stop reporting quiescent states of worker lcore while it is not running. */
+void
+sppwk_qsbr_offline(unsigned int lcore_id)
+{
+	rte_rcu_qsbr_thread_offline(g_wk_qsv, lcore_id);
+}
+
+/* Report worker lcore refers no data of components. */
+void
+sppwk_qsbr_quiescent(unsigned int lcore_id)
+{
+	rte_rcu_qsbr_quiescent(g_wk_qsv, lcore_id);
+}
+
+/**
+ * Wait for a grace period, until all of online worker lcores pass through
+ * a quiescent state. Offline lcores, such as idling or stopped, are not
+ * waited.
+ */
+void
+sppwk_wait_grace_period(void)
+{
+	rte_rcu_qsbr_synchronize(g_wk_qsv, RTE_QSBR_THRID_INVALID);
 }
 
 /* Check if component is using port. */
@@ -700,6 +950,80 @@ delete_port_info(struct sppwk_port_info *p_info, int nof_ports,
 	return SPPWK_RET_OK;
 }
 
+/* Initial num of entries of ports of a component, doubled if not enough. */
+#define COMP_PORTS_INIT_ENTS 4
+
+/* Prepare array of RX or TX ports of component to be updated. */
+struct sppwk_port_info **
+sppwk_prepare_comp_ports(struct sppwk_comp_info *comp,
+		enum sppwk_port_dir dir, int nof_ports)
+{
+	struct sppwk_port_info ***ports;
+	struct sppwk_port_info **new_ports;
+	int *max_ports;
+	int max;
+
+	if (dir == SPPWK_PORT_DIR_RX) {
+		ports = &comp->rx_ports;
+		max_ports = &comp->max_rx;
+	} else {
+		ports = &comp->tx_ports;
+		max_ports = &comp->max_tx;
+	}
+
+	if (nof_ports <= *max_ports) {
+		if (unlikely(backup_mng_obj(*ports,
+				sizeof(**ports) * *max_ports) !=
+				SPPWK_RET_OK))
+			return NULL;
+		return *ports;
+	}
+
+	/* Old one is kept until flushed, to be restored if canceled. */
+	max = (*max_ports == 0) ? COMP_PORTS_INIT_ENTS : *max_ports * 2;
+	while (max < nof_ports)
+		max *= 2;
+	new_ports = rte_zmalloc_socket("sppwk_comp_ports",
+			sizeof(*new_ports) * max, 0, rte_socket_id());
+	if (unlikely(new_ports == NULL)) {
+		RTE_LOG(ERR, WK_CMD_UTILS,
+				"Failed to alloc ports of component %d.\n",
+				comp->comp_id);
+		return NULL;
+	}
+	if (unlikely(backup_mng_replaced(new_ports, *ports) !=
+			SPPWK_RET_OK)) {
+		rte_free(new_ports);
+		return NULL;
+	}
+
+	if (*max_ports != 0)
+		memcpy(new_ports, *ports, sizeof(*new_ports) * *max_ports);
+	*ports = new_ports;
+	*max_ports = max;
+	return new_ports;
+}
+
+/* Release arrays of ports of a component stopped. */
+int
+sppwk_release_comp_ports(struct sppwk_comp_info *comp)
+{
+	if (comp->rx_ports != NULL &&
+			unlikely(backup_mng_replaced(NULL, comp->rx_ports) !=
+			SPPWK_RET_OK))
+		return SPPWK_RET_NG;
+	comp->rx_ports = NULL;
+	comp->max_rx = 0;
+
+	if (comp->tx_ports != NULL &&
+			unlikely(backup_mng_replaced(NULL, comp->tx_ports) !=
+			SPPWK_RET_OK))
+		return SPPWK_RET_NG;
+	comp->tx_ports = NULL;
+	comp->max_tx = 0;
+	return SPPWK_RET_OK;
+}
+
 /* Activate temporarily stored port info while flushing. */
 int
 update_port_info(void)
@@ -711,8 +1035,9 @@ update_port_info(void)
 
 	/* Initialize added vhost. */
 	for (cnt = 0; cnt < RTE_MAX_ETHPORTS; cnt++) {
-		port = &p_iface_info->vhost[cnt];
-		if ((port->iface_type != UNDEF) && (port->ethdev_port_id < 0)) {
+		port = p_iface_info->vhost[cnt];
+		if (port != NULL && (port->iface_type != UNDEF) &&
+				(port->ethdev_port_id < 0)) {
 			ret = add_vhost_pmd(port->iface_no);
 			if (ret < 0)
 				return SPPWK_RET_NG;
@@ -722,8 +1047,9 @@ update_port_info(void)
 
 	/* Initialize added ring. */
 	for (cnt = 0; cnt < RTE_MAX_ETHPORTS; cnt++) {
-		port = &p_iface_info->ring[cnt];
-		if ((port->iface_type != UNDEF) && (port->ethdev_port_id < 0)) {
+		port = p_iface_info->ring[cnt];
+		if (port != NULL && (port->iface_type != UNDEF) &&
+				(port->ethdev_port_id < 0)) {
 			ret = add_ring_pmd(port->iface_no);
 			if (ret < 0)
 				return SPPWK_RET_NG;
@@ -733,30 +1059,47 @@ update_port_info(void)
 	return SPPWK_RET_OK;
 }
 
-/* Activate temporarily stored lcore info while flushing. */
+/**
+ * Activate temporarily stored lcore info while flushing. Update side is
+ * published as reference side by swapping the indices, and retired side
+ * should not be updated until sync_lcore_info() is called after a grace
+ * period.
+ */
 void
 update_lcore_info(void)
 {
 	int cnt = 0;
+	int ref_index;
 	struct core_mng_info *info = NULL;
 	struct core_mng_info *p_core_info = g_mng_data.p_core_info;
 	int *p_change_core = g_mng_data.p_change_core;
 
-	/* Changed core has changed index. */
+	/* Make update side visible before publishing it. */
+	rte_smp_wmb();
+
 	for (cnt = 0; cnt < RTE_MAX_LCORE; cnt++) {
 		if (*(p_change_core + cnt) != 0) {
 			info = (p_core_info + cnt);
-			info->upd_index = info->ref_index;
+			ref_index = info->ref_index;
+			info->ref_index = info->upd_index;
+			info->upd_index = ref_index;
+			trace_swap(TRACE_SWAP_LCORE, cnt, info->ref_index);
 		}
 	}
+}
+
+/* Copy published lcore info to retired side after a grace period. */
+void
+sync_lcore_info(void)
+{
+	int cnt = 0;
+	struct core_mng_info *info = NULL;
+	struct core_mng_info *p_core_info = g_mng_data.p_core_info;
+	int *p_change_core = g_mng_data.p_change_core;
 
-	/* Waiting for changed core change. */
 	for (cnt = 0; cnt < RTE_MAX_LCORE; cnt++) {
 		if (*(p_change_core + cnt) != 0) {
 			info = (p_core_info + cnt);
-			while (likely(info->ref_index == info->upd_index))
-				rte_delay_us_block(SPPWK_UPDATE_INTERVAL);
-
 			memcpy(&info->core[info->upd_index],
 					&info->core[info->ref_index],
 					sizeof(struct core_info));
@@ -845,6 +1188,314 @@ sppwk_convert_mac_str_to_int64(const char *macaddr)
 	return ret_mac;
 }
 
+/* Term for wildcard of each of fields of 5-tuple rule. */
+#define CLS_5TUPLE_ANY "any"
+
+/* Num of fields of 5-tuple rule. */
+#define NOF_CLS_5TUPLE_FIELDS 5
+
+/* L4 protocols can be specified with its name in 5-tuple rule. */
+static const struct {
+	const char *name;
+	uint8_t proto;
+} CLS_5TUPLE_PROTO_LIST[] = {
+	{ "icmp", IPPROTO_ICMP },
+	{ "tcp", IPPROTO_TCP },
+	{ "udp", IPPROTO_UDP },
+	{ "sctp", IPPROTO_SCTP },
+	{ "", 0 },  /* termination */
+};
+
+/* Parse L4 protocol of 5-tuple rule, name or number. */
+static int
+parse_cls_5tuple_proto(uint8_t *proto, const char *str)
+{
+	int i;
+	long val;
+	char *endptr = NULL;
+
+	if (strcmp(str, CLS_5TUPLE_ANY) == 0) {
+		*proto = 0;
+		return SPPWK_RET_OK;
+	}
+
+	for (i = 0; CLS_5TUPLE_PROTO_LIST[i].name[0] != '\0'; i++) {
+		if (strcmp(str, CLS_5TUPLE_PROTO_LIST[i].name) == 0) {
+			*proto = CLS_5TUPLE_PROTO_LIST[i].proto;
+			return SPPWK_RET_OK;
+		}
+	}
+
+	val = strtol(str, &endptr, 0);
+	if (unlikely(str == endptr) || unlikely(*endptr != '\0') ||
+			unlikely(val <= 0) || unlikely(val > UINT8_MAX))
+		return SPPWK_RET_NG;
+
+	*proto = (uint8_t)val;
+	return SPPWK_RET_OK;
+}
+
+/* Parse address with optional prefix length and mask it. */
+static int
+parse_cls_5tuple_addr(uint8_t *addr, uint8_t *depth, int ip_ver,
+		const char *str)
+{
+	int i;
+	long val;
+	int max_depth = (ip_ver == 4) ? 32 : 128;
+	char tmp_addr[INET6_ADDRSTRLEN];
+	char *len_str;
+	char *endptr = NULL;
+
+	memset(addr, 0x00, 16);
+	if (strcmp(str, CLS_5TUPLE_ANY) == 0) {
+		*depth = 0;
+		return SPPWK_RET_OK;
+	}
+
+	val = max_depth;
+	len_str = strchr(str, '/');
+	if (len_str != NULL) {
+		val = strtol(len_str + 1, &endptr, 10);
+		if (unlikely(len_str + 1 == endptr) ||
+				unlikely(*endptr != '\0') ||
+				unlikely(val < 0) || unlikely(val > max_depth))
+			return SPPWK_RET_NG;
+		if (unlikely((size_t)(len_str - str) >= sizeof(tmp_addr)))
+			return SPPWK_RET_NG;
+		memcpy(tmp_addr, str, len_str - str);
+		tmp_addr[len_str - str] = '\0';
+	} else {
+		if (unlikely(strlen(str) >= sizeof(tmp_addr)))
+			return SPPWK_RET_NG;
+		strcpy(tmp_addr, str);
+	}
+
+	if (inet_pton((ip_ver == 4) ? AF_INET : AF_INET6, tmp_addr,
+			addr) != 1)
+		return SPPWK_RET_NG;
+
+	/* Clear host bits so that the same rules are compared as equal. */
+	for (i = 0; i < max_depth / 8; i++) {
+		if (val >= (i + 1) * 8)
+			continue;
+		if (val <= i * 8)
+			addr[i] = 0;
+		else
+			addr[i] &= (uint8_t)(0xff << ((i + 1) * 8 - val));
+	}
+
+	*depth = (uint8_t)val;
+	return SPPWK_RET_OK;
+}
+
+/* Parse L4 port or range of ports such as `80` or `1024-65535`. */
+static int
+parse_cls_5tuple_port(uint16_t *port_min, uint16_t *port_max,
+		const char *str)
+{
+	long min, max;
+	char *endptr = NULL;
+
+	if (strcmp(str, CLS_5TUPLE_ANY) == 0) {
+		*port_min = 0;
+		*port_max = UINT16_MAX;
+		return SPPWK_RET_OK;
+	}
+
+	min = strtol(str, &endptr, 10);
+	if (unlikely(str == endptr))
+		return SPPWK_RET_NG;
+	max = min;
+	if (*endptr == '-') {
+		str = endptr + 1;
+		max = strtol(str, &endptr, 10);
+		if (unlikely(str == endptr))
+			return SPPWK_RET_NG;
+	}
+	if (unlikely(*endptr != '\0') || unlikely(min < 0) ||
+			unlikely(max > UINT16_MAX) || unlikely(min > max))
+		return SPPWK_RET_NG;
+
+	*port_min = (uint16_t)min;
+	*port_max = (uint16_t)max;
+	return SPPWK_RET_OK;
+}
+
+/* Convert 5-tuple rule such as `tcp,10.0.0.0/8,any,any,80` to struct. */
+int
+sppwk_convert_cls_5tuple(struct sppwk_cls_5tuple *tuple, int ip_ver,
+		const char *rule_str)
+{
+	int ret;
+	int cnt = 0;
+	char tmp_rule[SPPWK_CLS_5TUPLE_STR_SZ];
+	char *fields[NOF_CLS_5TUPLE_FIELDS];
+	char *str = tmp_rule;
+	char *saveptr = NULL;
+	char *tok;
+
+	RTE_LOG(DEBUG, WK_CMD_UTILS, "Try to convert 5-tuple `%s`.\n",
+			rule_str);
+
+	/* Clear paddings also for comparing with memcmp(). */
+	memset(tuple, 0x00, sizeof(*tuple));
+	tuple->ip_ver = ip_ver;
+	if (unlikely(ip_ver != 4 && ip_ver != 6))
+		return SPPWK_RET_NG;
+
+	if (strcmp(rule_str, SPPWK_TERM_DEFAULT) == 0) {
+		tuple->is_default = 1;
+		return SPPWK_RET_OK;
+	}
+
+	if (unlikely(strlen(rule_str) >= sizeof(tmp_rule)))
+		return SPPWK_RET_NG;
+	strcpy(tmp_rule, rule_str);
+
+	while ((tok = strtok_r(str, ",", &saveptr)) != NULL) {
+		if (unlikely(cnt >= NOF_CLS_5TUPLE_FIELDS))
+			return SPPWK_RET_NG;
+		fields[cnt++] = tok;
+		str = NULL;
+	}
+	if (unlikely(cnt != NOF_CLS_5TUPLE_FIELDS))
+		return SPPWK_RET_NG;
+
+	ret = parse_cls_5tuple_proto(&tuple->proto, fields[0]);
+	if (ret == SPPWK_RET_OK)
+		ret = parse_cls_5tuple_addr(tuple->src_addr,
+				&tuple->src_depth, ip_ver, fields[1]);
+	if (ret == SPPWK_RET_OK)
+		ret = parse_cls_5tuple_addr(tuple->dst_addr,
+				&tuple->dst_depth, ip_ver, fields[2]);
+	if (ret == SPPWK_RET_OK)
+		ret = parse_cls_5tuple_port(&tuple->sport_min,
+				&tuple->sport_max, fields[3]);
+	if (ret == SPPWK_RET_OK)
+		ret = parse_cls_5tuple_port(&tuple->dport_min,
+				&tuple->dport_max, fields[4]);
+	if (unlikely(ret != SPPWK_RET_OK)) {
+		RTE_LOG(ERR, WK_CMD_UTILS, "Invalid 5-tuple `%s`.\n",
+				rule_str);
+		return SPPWK_RET_NG;
+	}
+
+	return SPPWK_RET_OK;
+}
+
+/* Format address of 5-tuple with prefix length, or `any`. */
+static int
+format_cls_5tuple_addr(char *buf, size_t len, int ip_ver,
+		const uint8_t *addr, uint8_t depth)
+{
+	char addr_str[INET6_ADDRSTRLEN];
+
+	if (depth == 0)
+		return snprintf(buf, len, "%s", CLS_5TUPLE_ANY);
+
+	inet_ntop((ip_ver == 4) ? AF_INET : AF_INET6, addr, addr_str,
+			sizeof(addr_str));
+	return snprintf(buf, len, "%s/%u", addr_str, depth);
+}
+
+/* Format range of L4 ports of 5-tuple, or `any`. */
+static int
+format_cls_5tuple_port(char *buf, size_t len, uint16_t port_min,
+		uint16_t port_max)
+{
+	if (port_min == 0 && port_max == UINT16_MAX)
+		return snprintf(buf, len, "%s", CLS_5TUPLE_ANY);
+	if (port_min == port_max)
+		return snprintf(buf, len, "%u", port_min);
+	return snprintf(buf, len, "%u-%u", port_min, port_max);
+}
+
+/* Convert 5-tuple to string such as `tcp,10.0.0.0/8,any,any,80`. */
+void
+sppwk_format_cls_5tuple(char *rule_str, const struct sppwk_cls_5tuple *tuple)
+{
+	int i;
+	size_t len = SPPWK_CLS_5TUPLE_STR_SZ;
+	char *buf = rule_str;
+	int n;
+
+	if (tuple->is_default) {
+		snprintf(rule_str, len, "%s", SPPWK_TERM_DEFAULT);
+		return;
+	}
+
+	n = snprintf(buf, len, "%u", tuple->proto);
+	if (tuple->proto == 0)
+		n = snprintf(buf, len, "%s", CLS_5TUPLE_ANY);
+	for (i = 0; CLS_5TUPLE_PROTO_LIST[i].name[0] != '\0'; i++) {
+		if (tuple->proto == CLS_5TUPLE_PROTO_LIST[i].proto) {
+			n = snprintf(buf, len, "%s",
+					CLS_5TUPLE_PROTO_LIST[i].name);
+			break;
+		}
+	}
+	buf += n;
+	len -= n;
+
+	n = snprintf(buf, len, ",");
+	n += format_cls_5tuple_addr(buf + n, len - n, tuple->ip_ver,
+			tuple->src_addr, tuple->src_depth);
+	buf += n;
+	len -= n;
+
+	n = snprintf(buf, len, ",");
+	n += format_cls_5tuple_addr(buf + n, len - n, tuple->ip_ver,
+			tuple->dst_addr, tuple->dst_depth);
+	buf += n;
+	len -= n;
+
+	n = snprintf(buf, len, ",");
+	n += format_cls_5tuple_port(buf + n, len - n, tuple->sport_min,
+			tuple->sport_max);
+	buf += n;
+	len -= n;
+
+	n = snprintf(buf, len, ",");
+	format_cls_5tuple_port(buf + n, len - n, tuple->dport_min,
+			tuple->dport_max);
+}
+
+/* Allocate tables of components and lcores on the local socket. */
+int
+sppwk_alloc_mng_tables(struct sppwk_comp_info **component_p,
+		struct core_mng_info **core_mng_p,
+		int **change_core_p, int **change_component_p)
+{
+	int socket_id = rte_socket_id();
+
+	*component_p = rte_zmalloc_socket("sppwk_comp_info",
+			sizeof(struct sppwk_comp_info) * RTE_MAX_LCORE,
+			RTE_CACHE_LINE_SIZE, socket_id);
+	*core_mng_p = rte_zmalloc_socket("sppwk_core_info",
+			sizeof(struct core_mng_info) * RTE_MAX_LCORE,
+			RTE_CACHE_LINE_SIZE, socket_id);
+	*change_core_p = rte_zmalloc_socket("sppwk_change_core",
+			sizeof(int) * RTE_MAX_LCORE, 0, socket_id);
+	*change_component_p = rte_zmalloc_socket("sppwk_change_comp",
+			sizeof(int) * RTE_MAX_LCORE, 0, socket_id);
+	if (likely(*component_p != NULL) && likely(*core_mng_p != NULL) &&
+			likely(*change_core_p != NULL) &&
+			likely(*change_component_p != NULL))
+		return SPPWK_RET_OK;
+
+	RTE_LOG(ERR, WK_CMD_UTILS, "Failed to alloc management data.\n");
+	rte_free(*component_p);
+	rte_free(*core_mng_p);
+	rte_free(*change_core_p);
+	rte_free(*change_component_p);
+	*component_p = NULL;
+	*core_mng_p = NULL;
+	*change_core_p = NULL;
+	*change_component_p = NULL;
+	return SPPWK_RET_NG;
+}
+
 /* Set management data of global var for given non-NULL args. */
 int sppwk_set_mng_data(
 		struct iface_info *iface_p,
@@ -21,15 +21,14 @@
  */
 /** Identifier string for each component (status command) */
 #define SPPWK_TYPE_CLS_STR "classifier"
+#define SPPWK_TYPE_CLS_5TUPLE_STR "classifier_5tuple"
+#define SPPWK_TYPE_DIST_STR "distributor"
 #define SPPWK_TYPE_MRG_STR "merge"
 #define SPPWK_TYPE_FWD_STR "forward"
 #define SPPWK_TYPE_MIR_STR "mirror"
 #define SPPWK_TYPE_PCAP_STR "pcap"
 #define SPPWK_TYPE_NONE_STR "unuse"
 
-/** Waiting time for checking update (not used for spp_pcap). */
-#define SPPWK_UPDATE_INTERVAL 10  /* micro sec */
-
 /**
  * Used for index of arrary of management data which has two sides. It is not
  * used for spp_pcap.
@@ -57,6 +56,8 @@
  */
 /* Name string for each component */
 #define CORE_TYPE_CLASSIFIER_MAC_STR "classifier"
+#define CORE_TYPE_CLASSIFIER_5TUPLE_STR "classifier_5tuple"
+#define CORE_TYPE_DISTRIBUTOR_STR "distributor"
 #define CORE_TYPE_MERGE_STR	     "merge"
 #define CORE_TYPE_FORWARD_STR	     "forward"
 #define CORE_TYPE_MIRROR_STR	     "mirror"
@@ -65,16 +66,26 @@
 enum sppwk_cls_type {
 	SPPWK_CLS_TYPE_NONE,
 	SPPWK_CLS_TYPE_MAC,
-	SPPWK_CLS_TYPE_VLAN
+	SPPWK_CLS_TYPE_VLAN,
+	SPPWK_CLS_TYPE_IPV4,
+	SPPWK_CLS_TYPE_IPV6,
+	SPPWK_CLS_TYPE_WEIGHT
 };
 
-/* Flag of processing type to copy management information */
-/* TODO(yasufum) add comments for each of members. */
-enum copy_mng_flg {
-	COPY_MNG_FLG_NONE,
-	COPY_MNG_FLG_UPDCOPY,
-	COPY_MNG_FLG_ALLCOPY,
-};
+/** Max weight of a TX port of distributor. It is used only for spp_vf. */
+#define SPPWK_DIST_WEIGHT_MAX 255
+
+/**
+ * Max num of packets in a burst of forwarder and merger, which is given as
+ * option of `component start`. It is used only for spp_vf.
+ */
+#define SPPWK_BURST_MAX 256
+
+/**
+ * Size of string of 5-tuple rule of classifier such as
+ * `tcp,192.168.0.0/16,any,any,80-89`. It is used only for spp_vf.
+ */
+#define SPPWK_CLS_5TUPLE_STR_SZ 128
 
 /* Manage component running in core as global variable. */
 struct core_info {
@@ -93,11 +104,32 @@ struct core_mng_info {
 	struct core_info core[TWO_SIDES];  /* info of each core */
 };
 
-/* Manage data used for backup. */
+/* Copy of an object of management data taken before it is updated. */
+struct mng_backup_ent {
+	void *addr;  /* Address of the object in management data. */
+	size_t size;  /* Size of the object. */
+	void *data;  /* Copy of the object allocated dynamically. */
+};
+
+/* Object of management data replaced with another allocated one. */
+struct mng_replaced_ent {
+	void *new_obj;  /* Freed if updates are canceled, or NULL. */
+	void *old_obj;  /* Freed if updates are flushed, or NULL. */
+};
+
+/**
+ * Manage data used for backup. It is an undo log of objects updated since
+ * the last flush, and only objects updated are copied instead of the whole
+ * of management data. Objects replaced are also logged to free either of
+ * old or new ones.
+ */
 struct cancel_backup_info {
-	struct core_mng_info core[RTE_MAX_LCORE];
-	struct sppwk_comp_info component[RTE_MAX_LCORE];
-	struct iface_info interface;
+	int nof_ents;  /* Num of entries in use. */
+	int max_ents;  /* Num of entries allocated. */
+	struct mng_backup_ent *ents;
+	int nof_replaced;  /* Num of replaced entries in use. */
+	int max_replaced;  /* Num of replaced entries allocated. */
+	struct mng_replaced_ent *replaced;
 };
 
 /**
@@ -173,6 +205,19 @@ void stop_process(int signal);
 struct sppwk_port_info *
 get_sppwk_port(enum port_type iface_type, int iface_no, int queue_no);
 
+/**
+ * Return sppwk_port_info of given type and num of interface to be updated.
+ * Port info of vhost or ring is allocated on the local socket if it is not
+ * added before, and freed if updates are canceled.
+ *
+ * @param iface_type Type of interface.
+ * @param iface_no Num of interface.
+ * @param queue_no Num of queue, used only for phy.
+ * @return Port info, or NULL if invalid or failed to allocate.
+ */
+struct sppwk_port_info *
+sppwk_prepare_port(enum port_type iface_type, int iface_no, int queue_no);
+
 /* Output log message for core information */
 void log_core_info(const struct core_mng_info *core_info);
 
@@ -182,36 +227,139 @@ void log_component_info(const struct sppwk_comp_info *component_info);
 /* Output log message for interface information */
 void log_interface_info(const struct iface_info *iface_info);
 
-/* Copy management information */
-void copy_mng_info(
-		struct core_mng_info *dst_core,
-		struct sppwk_comp_info *dst_component,
-		struct iface_info *dst_interface,
-		const struct core_mng_info *src_core,
-		const struct sppwk_comp_info *src_component,
-		const struct iface_info *src_interface,
-		enum copy_mng_flg flg);
-
-/* Backup the management information */
+/**
+ * Save an object of management data to backup before updating it. It is
+ * copied only for the first time after the last flush, and does nothing
+ * for following calls.
+ *
+ * @param addr Address of the object.
+ * @param size Size of the object.
+ * @retval SPPWK_RET_OK If succeeded.
+ * @retval SPPWK_RET_NG If failed.
+ */
+int backup_mng_obj(void *addr, size_t size);
+
+/**
+ * Log an object of management data allocated with rte_malloc replaced with
+ * another one. Old one is freed when updates are flushed, or new one is
+ * freed when canceled instead. Pointer to it should be backed up before.
+ *
+ * @param new_obj Object replacing, or NULL if it is just released.
+ * @param old_obj Object replaced, or NULL if it is newly allocated.
+ * @retval SPPWK_RET_OK If succeeded.
+ * @retval SPPWK_RET_NG If failed.
+ */
+int backup_mng_replaced(void *new_obj, void *old_obj);
+
+/**
+ * Prepare array of RX or TX ports of a component to be updated for
+ * `nof_ports` ports. Array is backed up, or replaced with larger one
+ * allocated on the local socket if it is not enough. The component should
+ * be backed up before.
+ *
+ * @param comp Component.
+ * @param dir Direction of ports, RX or TX.
+ * @param nof_ports Num of ports after updated, more than zero.
+ * @return Array of ports, or NULL if failed.
+ */
+struct sppwk_port_info **sppwk_prepare_comp_ports(
+		struct sppwk_comp_info *comp, enum sppwk_port_dir dir,
+		int nof_ports);
+
+/**
+ * Release arrays of ports of a component stopped. It should be called
+ * before clearing the component backed up.
+ *
+ * @param comp Component.
+ * @retval SPPWK_RET_OK If succeeded.
+ * @retval SPPWK_RET_NG If failed.
+ */
+int sppwk_release_comp_ports(struct sppwk_comp_info *comp);
+
+/**
+ * Backup the management information. It discards saved objects, and then
+ * current management information is the base of the next backup.
+ *
+ * @param backup Backup to be reset.
+ */
 void backup_mng_info(struct cancel_backup_info *backup);
 
+/**
+ * Cancel updates of management information since the last backup by
+ * restoring saved objects in reverse order.
+ *
+ * @param backup Backup to be restored.
+ */
+void cancel_mng_info(struct cancel_backup_info *backup);
+
 /* Setup management info for spp_vf */
 int init_mng_data(void);
 
 /* Remove sock file if spp is not running */
-void del_vhost_sockfile(struct sppwk_port_info *vhost);
+void del_vhost_sockfile(struct sppwk_port_info **vhost);
 
 /* Get core information which is in use */
 struct core_info *get_core_info(unsigned int lcore_id);
 
 /**
- * Check lcore info of given ID is updated.
+ * Get next lcore which can run components, a slave lcore or a service
+ * lcore, after `i`.
+ *
+ * @param i Lcore ID to start after, or -1 to get the first one.
+ * @return Lcore ID, or RTE_MAX_LCORE if no more lcores.
+ */
+unsigned int sppwk_get_next_lcore(unsigned int i);
+
+/* Iterate over slave lcores and service lcores running components. */
+#define SPPWK_LCORE_FOREACH_WORKER(i)			\
+	for (i = sppwk_get_next_lcore(-1);		\
+	     i < RTE_MAX_LCORE;				\
+	     i = sppwk_get_next_lcore(i))
+
+/**
+ * Register worker lcore to QSBR variable. It should be called before the
+ * lcore enters its main loop.
+ *
+ * @param lcore_id Lcore ID.
+ */
+void sppwk_qsbr_register(unsigned int lcore_id);
+
+/**
+ * Unregister worker lcore from QSBR variable after leaving main loop.
+ *
+ * @param lcore_id Lcore ID.
+ */
+void sppwk_qsbr_unregister(unsigned int lcore_id);
+
+/**
+ * Start reporting quiescent states of worker lcore. It is called when the
+ * lcore starts running components.
+ *
+ * @param lcore_id Lcore ID.
+ */
+void sppwk_qsbr_online(unsigned int lcore_id);
+
+/**
+ * Stop reporting quiescent states of worker lcore. Master lcore does not
+ * wait for offline lcores while flushing.
  *
  * @param lcore_id Lcore ID.
- * @retval 1 If it is updated.
- * @retval 0 If it is not updated.
  */
-int sppwk_is_lcore_updated(unsigned int lcore_id);
+void sppwk_qsbr_offline(unsigned int lcore_id);
+
+/**
+ * Report that worker lcore refers no data of components. It is called
+ * once for each iteration of main loop of the lcore.
+ *
+ * @param lcore_id Lcore ID.
+ */
+void sppwk_qsbr_quiescent(unsigned int lcore_id);
+
+/**
+ * Wait until all of online worker lcores pass through a quiescent state.
+ * After that, retired sides of two sides data can be updated safely.
+ */
+void sppwk_wait_grace_period(void);
 
 /**
  * Check if component is using port.
@@ -301,6 +449,9 @@ int update_port_info(void);
 /* Activate temporarily stored lcore info while flushing. */
 void update_lcore_info(void);
 
+/* Copy published lcore info to retired side after a grace period. */
+void sync_lcore_info(void);
+
 /**
  * Return port uid such as `phy:0nq0`, `ring:1` or so.
  *
@@ -323,6 +474,46 @@ sppwk_port_uid(char *port_uid, enum port_type iface_type, int iface_no,
  */
 int64_t sppwk_convert_mac_str_to_int64(const char *macaddr);
 
+/**
+ * Change string of 5-tuple rule to struct. The rule is a comma separated
+ * list of `PROTO,SRC_ADDR[/LEN],DST_ADDR[/LEN],SPORT[-MAX],DPORT[-MAX]`
+ * and each of fields can be `any`, or `default` for whole of the rule.
+ *
+ * @param[out] tuple Converted 5-tuple.
+ * @param[in] ip_ver IP version of addresses, 4 or 6.
+ * @param[in] rule_str String of the rule to be converted.
+ * @retval SPPWK_RET_OK if succeeded.
+ * @retval SPPWK_RET_NG if invalid.
+ */
+int sppwk_convert_cls_5tuple(struct sppwk_cls_5tuple *tuple, int ip_ver,
+		const char *rule_str);
+
+/**
+ * Change 5-tuple to string of the rule, the reverse of
+ * sppwk_convert_cls_5tuple().
+ *
+ * @param[out] rule_str Buffer of SPPWK_CLS_5TUPLE_STR_SZ bytes.
+ * @param[in] tuple 5-tuple to be converted.
+ */
+void sppwk_format_cls_5tuple(char *rule_str,
+		const struct sppwk_cls_5tuple *tuple);
+
+/**
+ * Allocate tables of components and lcores, and flags of changes of them
+ * on the local socket. They are indexed by ID of component or lcore, so
+ * have RTE_MAX_LCORE entries.
+ *
+ * @param[out] component_p Table of components.
+ * @param[out] core_mng_p Table of lcores.
+ * @param[out] change_core_p Flags of changes of lcores.
+ * @param[out] change_component_p Flags of changes of components.
+ * @retval SPPWK_RET_OK If succeeded.
+ * @retval SPPWK_RET_NG If failed.
+ */
+int sppwk_alloc_mng_tables(struct sppwk_comp_info **component_p,
+		struct core_mng_info **core_mng_p,
+		int **change_core_p, int **change_component_p);
+
 /**
  * Set mange data address.
  *
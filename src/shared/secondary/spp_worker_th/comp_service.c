@@ -0,0 +1,461 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2020 Nippon Telegraph and Telephone Corporation
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+
+#include <rte_branch_prediction.h>
+#include <rte_cycles.h>
+#include <rte_lcore.h>
+#include <rte_log.h>
+#include <rte_service.h>
+#include <rte_service_component.h>
+#include <rte_spinlock.h>
+
+#include "comp_service.h"
+#include "cmd_runner.h"
+#include "cmd_utils.h"
+#include "shared/lcore_usage.h"
+#include "shared/secondary/return_codes.h"
+
+#define RTE_LOGTYPE_WK_COMP_SVC RTE_LOGTYPE_USER1
+
+/**
+ * Min difference of busy cycles between the busiest and least busy service
+ * lcores to move a component, in percent of the interval of balancer.
+ */
+#define BALANCE_MARGIN_PCT 10
+
+/* Service of a component. */
+struct comp_service {
+	uint32_t id;  /* Service ID. */
+	int is_registered;
+	int lcore_id;  /* Lcore mapped, or -1. */
+	int retired;  /* Unregistered after a grace period if stopped. */
+	/**
+	 * Lcore running the component. It is run only on this lcore while it
+	 * is mapped to both of lcores in moving, and never run on two lcores
+	 * at once because of the lock.
+	 */
+	volatile int owner;
+	rte_spinlock_t lock;
+};
+
+static sppwk_comp_proc g_comp_proc;
+
+static uint32_t g_nof_svc_lcores;
+static uint32_t g_svc_lcores[RTE_MAX_LCORE];
+
+/* Service reporting quiescent states and usage of service lcores. */
+static uint32_t g_lcore_svc_id;
+static struct lcore_usage_poll g_lcore_polls[RTE_MAX_LCORE];
+
+/* Services indexed by component ID. */
+static struct comp_service g_comp_svcs[RTE_MAX_LCORE];
+
+/* Services of other than components, mapped to service lcores in turn. */
+static uint32_t g_nof_ext_svcs;
+static uint32_t g_ext_svc_ids[RTE_SERVICE_NUM_MAX];
+
+static uint64_t g_balance_cycles;  /* Interval of balancer in TSC cycles. */
+static uint64_t g_last_balance;  /* TSC of last time of balancer. */
+static uint64_t g_last_busy[RTE_MAX_LCORE];  /* Busy cycles of components. */
+
+/**
+ * Run once in each loop over services on a service lcore, as the end of a
+ * poll of slave lcores. No component is run on the lcore while it is run,
+ * so it is a quiescent state.
+ */
+static int32_t
+run_lcore_service(void *arg __attribute__ ((unused)))
+{
+	unsigned int lcore_id = rte_lcore_id();
+
+	sppwk_qsbr_quiescent(lcore_id);
+	lcore_usage_poll_end(&lcore_usages[lcore_id],
+			&g_lcore_polls[lcore_id]);
+	return 0;
+}
+
+static int32_t
+run_comp_service(void *arg)
+{
+	int ret;
+	int comp_id = (int)(uintptr_t)arg;
+	struct comp_service *svc = &g_comp_svcs[comp_id];
+	struct lcore_usage_poll poll;
+
+	if (svc->owner != (int)rte_lcore_id())
+		return 0;
+	if (!rte_spinlock_trylock(&svc->lock))
+		return 0;
+
+	/* Check again because it might be moved before locked. */
+	ret = SPPWK_RET_OK;
+	if (likely(svc->owner == (int)rte_lcore_id())) {
+		lcore_usage_poll_begin(&poll);
+		ret = (*g_comp_proc)(comp_id);
+		lcore_usage_poll_end(&comp_usages[comp_id], &poll);
+	}
+
+	rte_spinlock_unlock(&svc->lock);
+	return ret;
+}
+
+int
+sppwk_init_comp_services(sppwk_comp_proc proc, unsigned int balance_interval)
+{
+	int32_t ret;
+	uint32_t i, lcore_id;
+	struct rte_service_spec spec;
+
+	g_comp_proc = proc;
+
+	ret = rte_service_lcore_list(g_svc_lcores, RTE_MAX_LCORE);
+	if (ret < 0) {
+		RTE_LOG(ERR, WK_COMP_SVC, "Failed to get service lcores.\n");
+		return SPPWK_RET_NG;
+	}
+	g_nof_svc_lcores = ret;
+	if (g_nof_svc_lcores == 0)
+		return SPPWK_RET_OK;
+
+	memset(&spec, 0, sizeof(spec));
+	snprintf(spec.name, sizeof(spec.name), "spp_lcore");
+	spec.callback = run_lcore_service;
+	spec.capabilities = RTE_SERVICE_CAP_MT_SAFE;
+	spec.socket_id = SOCKET_ID_ANY;
+	if (rte_service_component_register(&spec, &g_lcore_svc_id) != 0) {
+		RTE_LOG(ERR, WK_COMP_SVC, "Failed to register service.\n");
+		return SPPWK_RET_NG;
+	}
+	rte_service_component_runstate_set(g_lcore_svc_id, 1);
+	rte_service_runstate_set(g_lcore_svc_id, 1);
+
+	for (i = 0; i < g_nof_svc_lcores; i++) {
+		lcore_id = g_svc_lcores[i];
+
+		/* It is reported by the service once the lcore is started. */
+		sppwk_qsbr_register(lcore_id);
+		sppwk_qsbr_online(lcore_id);
+		g_lcore_polls[lcore_id].tsc = rte_rdtsc();
+
+		if (rte_service_map_lcore_set(g_lcore_svc_id, lcore_id,
+				1) != 0) {
+			RTE_LOG(ERR, WK_COMP_SVC,
+					"Failed to map service to lcore %u.\n",
+					lcore_id);
+			return SPPWK_RET_NG;
+		}
+
+		ret = rte_service_lcore_start(lcore_id);
+		if (ret != 0 && ret != -EALREADY) {
+			RTE_LOG(ERR, WK_COMP_SVC,
+					"Failed to start service lcore %u.\n",
+					lcore_id);
+			return SPPWK_RET_NG;
+		}
+		set_core_status(lcore_id, SPPWK_LCORE_RUNNING);
+	}
+
+	g_balance_cycles = balance_interval * rte_get_tsc_hz();
+	g_last_balance = rte_rdtsc();
+
+	RTE_LOG(INFO, WK_COMP_SVC, "Started %u service lcores.\n",
+			g_nof_svc_lcores);
+	return SPPWK_RET_OK;
+}
+
+void
+sppwk_fini_comp_services(void)
+{
+	uint32_t i, lcore_id;
+	int comp_id;
+
+	if (g_nof_svc_lcores == 0)
+		return;
+
+	/* Stop all of services, or service lcores cannot be stopped. */
+	for (comp_id = 0; comp_id < RTE_MAX_LCORE; comp_id++) {
+		if (g_comp_svcs[comp_id].is_registered)
+			rte_service_runstate_set(g_comp_svcs[comp_id].id, 0);
+	}
+	rte_service_runstate_set(g_lcore_svc_id, 0);
+	for (i = 0; i < g_nof_ext_svcs; i++)
+		rte_service_runstate_set(g_ext_svc_ids[i], 0);
+
+	for (i = 0; i < g_nof_svc_lcores; i++) {
+		lcore_id = g_svc_lcores[i];
+		rte_service_lcore_stop(lcore_id);
+		rte_eal_wait_lcore(lcore_id);
+		sppwk_qsbr_unregister(lcore_id);
+		set_core_status(lcore_id, SPPWK_LCORE_STOPPED);
+	}
+
+	for (comp_id = 0; comp_id < RTE_MAX_LCORE; comp_id++) {
+		if (g_comp_svcs[comp_id].is_registered)
+			rte_service_component_unregister(
+					g_comp_svcs[comp_id].id);
+	}
+	rte_service_component_unregister(g_lcore_svc_id);
+	g_nof_svc_lcores = 0;
+	g_nof_ext_svcs = 0;
+}
+
+int
+sppwk_is_service_lcore(unsigned int lcore_id)
+{
+	return rte_eal_lcore_role(lcore_id) == ROLE_SERVICE;
+}
+
+int
+sppwk_comp_service_available(void)
+{
+	/* Services of stopped components are unregistered in flush. */
+	return rte_service_get_count() < RTE_SERVICE_NUM_MAX;
+}
+
+/* Register service of a component which is not mapped yet. */
+static int
+register_comp_service(int comp_id, unsigned int lcore_id)
+{
+	struct comp_service *svc = &g_comp_svcs[comp_id];
+	struct rte_service_spec spec;
+
+	memset(&spec, 0, sizeof(spec));
+	snprintf(spec.name, sizeof(spec.name), "spp_comp%d", comp_id);
+	spec.callback = run_comp_service;
+	spec.callback_userdata = (void *)(uintptr_t)comp_id;
+	/* Run on two lcores in moving, but serialized by itself. */
+	spec.capabilities = RTE_SERVICE_CAP_MT_SAFE;
+	spec.socket_id = rte_lcore_to_socket_id(lcore_id);
+	if (rte_service_component_register(&spec, &svc->id) != 0) {
+		RTE_LOG(ERR, WK_COMP_SVC,
+				"Failed to register service of comp %d.\n",
+				comp_id);
+		return SPPWK_RET_NG;
+	}
+	rte_service_component_runstate_set(svc->id, 1);
+
+	svc->is_registered = 1;
+	svc->lcore_id = -1;
+	svc->retired = 0;
+	svc->owner = -1;
+	rte_spinlock_init(&svc->lock);
+	return SPPWK_RET_OK;
+}
+
+/* Map services to service lcores as published lcore info. */
+int
+sppwk_update_comp_services(void)
+{
+	uint32_t i;
+	int cnt, comp_id, lcore_id;
+	int new_lcores[RTE_MAX_LCORE];
+	struct core_info *core;
+	struct comp_service *svc;
+
+	if (g_nof_svc_lcores == 0)
+		return SPPWK_RET_OK;
+
+	memset(new_lcores, -1, sizeof(new_lcores));
+	for (i = 0; i < g_nof_svc_lcores; i++) {
+		core = get_core_info(g_svc_lcores[i]);
+		for (cnt = 0; cnt < core->num; cnt++)
+			new_lcores[core->id[cnt]] = g_svc_lcores[i];
+	}
+
+	for (comp_id = 0; comp_id < RTE_MAX_LCORE; comp_id++) {
+		svc = &g_comp_svcs[comp_id];
+		lcore_id = new_lcores[comp_id];
+		if (!svc->is_registered) {
+			if (lcore_id < 0)
+				continue;
+			if (register_comp_service(comp_id, lcore_id) !=
+					SPPWK_RET_OK)
+				return SPPWK_RET_NG;
+		}
+		if (lcore_id == svc->lcore_id)
+			continue;
+
+		/* Stopped, and unregistered after a grace period. */
+		if (lcore_id < 0) {
+			rte_service_runstate_set(svc->id, 0);
+			svc->owner = -1;
+			svc->retired = 1;
+			continue;
+		}
+
+		/**
+		 * Map to new lcore before unmapping from old one, so that the
+		 * component keeps running while it is moved.
+		 */
+		if (rte_service_map_lcore_set(svc->id, lcore_id, 1) != 0) {
+			RTE_LOG(ERR, WK_COMP_SVC,
+					"Failed to map comp %d to lcore %d.\n",
+					comp_id, lcore_id);
+			return SPPWK_RET_NG;
+		}
+		rte_service_runstate_set(svc->id, 1);
+		svc->owner = lcore_id;
+		if (svc->lcore_id >= 0)
+			rte_service_map_lcore_set(svc->id, svc->lcore_id, 0);
+		svc->lcore_id = lcore_id;
+	}
+
+	return SPPWK_RET_OK;
+}
+
+/**
+ * Unregister services of stopped components after a grace period, which are
+ * no longer run because their runstates were cleared before it.
+ */
+void
+sppwk_sync_comp_services(void)
+{
+	int comp_id;
+	struct comp_service *svc;
+
+	for (comp_id = 0; comp_id < RTE_MAX_LCORE; comp_id++) {
+		svc = &g_comp_svcs[comp_id];
+		if (!svc->is_registered || !svc->retired)
+			continue;
+
+		rte_service_component_unregister(svc->id);
+		memset(svc, 0, sizeof(*svc));
+	}
+}
+
+/* Move a component to another service lcore and flush it. */
+static int
+move_comp(int comp_id, unsigned int from, unsigned int to)
+{
+	struct sppwk_comp_info *comp_info_base = NULL;
+	struct core_mng_info *core_info = NULL;
+	int *change_core = NULL;
+	struct core_info *src, *dst;
+
+	sppwk_get_mng_data(NULL, &comp_info_base, &core_info, &change_core,
+			NULL, NULL);
+
+	src = &core_info[from].core[core_info[from].upd_index];
+	dst = &core_info[to].core[core_info[to].upd_index];
+	/* Objects backed up or modified so far are restored if failed. */
+	if (unlikely(backup_mng_obj(&comp_info_base[comp_id],
+			sizeof(struct sppwk_comp_info)) != SPPWK_RET_OK) ||
+			unlikely(backup_mng_obj(src,
+			sizeof(struct core_info)) != SPPWK_RET_OK) ||
+			unlikely(backup_mng_obj(dst,
+			sizeof(struct core_info)) != SPPWK_RET_OK)) {
+		cancel_cmd();
+		return SPPWK_RET_NG;
+	}
+
+	if (del_comp_info(comp_id, src->num, src->id) != SPPWK_RET_OK) {
+		cancel_cmd();
+		return SPPWK_RET_NG;
+	}
+	src->num--;
+	dst->id[dst->num++] = comp_id;
+	comp_info_base[comp_id].lcore_id = to;
+	change_core[from] = 1;
+	change_core[to] = 1;
+
+	RTE_LOG(INFO, WK_COMP_SVC,
+			"Move component '%s' from lcore %u to %u.\n",
+			comp_info_base[comp_id].name, from, to);
+	return flush_cmd();
+}
+
+int
+sppwk_balance_comp_services(void)
+{
+	uint32_t i;
+	int cnt, comp_id, best_id = -1;
+	unsigned int lcore_id, max_lcore = 0, min_lcore = 0;
+	uint64_t busy, diff, best_busy = 0;
+	uint64_t now = rte_rdtsc();
+	uint64_t comp_busy[RTE_MAX_LCORE];
+	uint64_t lcore_busy[RTE_MAX_LCORE];
+	struct core_info *core;
+
+	if (g_balance_cycles == 0 || now - g_last_balance < g_balance_cycles)
+		return SPPWK_RET_OK;
+	g_last_balance = now;
+
+	/* Busy cycles of components and lcores in the last interval. */
+	for (i = 0; i < g_nof_svc_lcores; i++) {
+		lcore_id = g_svc_lcores[i];
+		core = get_core_info(lcore_id);
+		lcore_busy[lcore_id] = 0;
+		for (cnt = 0; cnt < core->num; cnt++) {
+			comp_id = core->id[cnt];
+			busy = comp_usages[comp_id].busy_cycles;
+			/* Usage is cleared if the ID is reused. */
+			comp_busy[comp_id] = busy >= g_last_busy[comp_id] ?
+					busy - g_last_busy[comp_id] : busy;
+			g_last_busy[comp_id] = busy;
+			lcore_busy[lcore_id] += comp_busy[comp_id];
+		}
+
+		if (i == 0 || lcore_busy[lcore_id] > lcore_busy[max_lcore])
+			max_lcore = lcore_id;
+		if (i == 0 || lcore_busy[lcore_id] < lcore_busy[min_lcore])
+			min_lcore = lcore_id;
+	}
+
+	if (g_nof_svc_lcores < 2)
+		return SPPWK_RET_OK;
+	diff = lcore_busy[max_lcore] - lcore_busy[min_lcore];
+	if (diff * 100 < g_balance_cycles * BALANCE_MARGIN_PCT)
+		return SPPWK_RET_OK;
+
+	/**
+	 * Move the busiest component which makes the max of busy cycles of
+	 * the two lcores less than before.
+	 */
+	core = get_core_info(max_lcore);
+	for (cnt = 0; cnt < core->num; cnt++) {
+		comp_id = core->id[cnt];
+		if (comp_busy[comp_id] < diff &&
+				comp_busy[comp_id] > best_busy) {
+			best_id = comp_id;
+			best_busy = comp_busy[comp_id];
+		}
+	}
+	if (best_id < 0)
+		return SPPWK_RET_OK;
+
+	return move_comp(best_id, max_lcore, min_lcore);
+}
+
+int
+sppwk_map_ext_service(uint32_t service_id)
+{
+	uint32_t lcore_id;
+
+	if (g_nof_svc_lcores == 0) {
+		RTE_LOG(ERR, WK_COMP_SVC,
+				"No service lcore for service %u.\n",
+				service_id);
+		return SPPWK_RET_NG;
+	}
+	if (unlikely(g_nof_ext_svcs >= RTE_SERVICE_NUM_MAX))
+		return SPPWK_RET_NG;
+
+	lcore_id = g_svc_lcores[g_nof_ext_svcs % g_nof_svc_lcores];
+	if (rte_service_map_lcore_set(service_id, lcore_id, 1) != 0) {
+		RTE_LOG(ERR, WK_COMP_SVC,
+				"Failed to map service %u to lcore %u.\n",
+				service_id, lcore_id);
+		return SPPWK_RET_NG;
+	}
+	rte_service_runstate_set(service_id, 1);
+	g_ext_svc_ids[g_nof_ext_svcs++] = service_id;
+
+	RTE_LOG(INFO, WK_COMP_SVC, "Service %u is mapped to lcore %u.\n",
+			service_id, lcore_id);
+	return SPPWK_RET_OK;
+}
@@ -0,0 +1,104 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2020 Nippon Telegraph and Telephone Corporation
+ */
+
+#ifndef _SPPWK_COMP_SERVICE_H_
+#define _SPPWK_COMP_SERVICE_H_
+
+#include <stdint.h>
+
+/**
+ * @file comp_service.h
+ *
+ * Components running as services on service lcores.
+ *
+ * Components assigned to service lcores given with EAL option `-s` or `-S`
+ * are registered as services of `rte_service` and mapped to the lcores,
+ * instead of running in the loop of slave lcores. Several components can
+ * share a service lcore, and a component can be moved to another service
+ * lcore while running without losing packets, because it is mapped to new
+ * lcore before unmapped from old one and the service framework does not
+ * run it on both of lcores at once.
+ *
+ * Components can be moved among service lcores by a load balancer based on
+ * busy cycles of components, if it is enabled with `--balance-interval`.
+ */
+
+/**
+ * Function of a component, such as classify_packets(), run in a service.
+ *
+ * @param comp_id Component ID.
+ * @retval SPPWK_RET_OK If succeeded.
+ * @retval SPPWK_RET_NG If failed.
+ */
+typedef int (*sppwk_comp_proc)(int comp_id);
+
+/**
+ * Start service lcores, on which a service for reporting quiescent states
+ * and usage of the lcore is running. It does nothing if no service lcore
+ * is given.
+ *
+ * @param proc Function of components.
+ * @param balance_interval Interval of load balancer in seconds, or 0 for
+ *   disabling it.
+ * @retval SPPWK_RET_OK If succeeded.
+ * @retval SPPWK_RET_NG If failed.
+ */
+int sppwk_init_comp_services(sppwk_comp_proc proc,
+		unsigned int balance_interval);
+
+/* Stop service lcores and unregister services of components. */
+void sppwk_fini_comp_services(void);
+
+/* Return 1 if `lcore_id` is a service lcore, or 0. */
+int sppwk_is_service_lcore(unsigned int lcore_id);
+
+/**
+ * Return 1 if a service can be registered for a new component, or 0 if
+ * RTE_SERVICE_NUM_MAX services are registered. It should be checked
+ * before starting a component on a service lcore, because failure of
+ * registering it while flushing cannot be cancelled.
+ */
+int sppwk_comp_service_available(void);
+
+/**
+ * Map services of components to service lcores as lcore info published
+ * while flushing. Services of new components are registered, and ones of
+ * stopped components are stopped.
+ *
+ * @retval SPPWK_RET_OK If succeeded.
+ * @retval SPPWK_RET_NG If failed.
+ */
+int sppwk_update_comp_services(void);
+
+/**
+ * Unregister services of components stopped in
+ * sppwk_update_comp_services(). It should be called after a grace period,
+ * for no service lcore to be running them.
+ */
+void sppwk_sync_comp_services(void);
+
+/**
+ * Move a component from the busiest service lcore to the least busy one
+ * if it makes them more balanced. It is called from the loop of master
+ * and does nothing until the interval has passed since last time.
+ *
+ * @retval SPPWK_RET_OK If succeeded or nothing to do.
+ * @retval SPPWK_RET_NG If failed.
+ */
+int sppwk_balance_comp_services(void);
+
+/**
+ * Map a service of other than components, such as the scheduler of an
+ * event device, to a service lcore and start it. Service lcores are taken
+ * in turn for each of services. It should be called after service lcores
+ * are started with sppwk_init_comp_services(), and the service is stopped
+ * in sppwk_fini_comp_services().
+ *
+ * @param service_id ID of the service.
+ * @retval SPPWK_RET_OK If succeeded.
+ * @retval SPPWK_RET_NG If failed or no service lcore is given.
+ */
+int sppwk_map_ext_service(uint32_t service_id);
+
+#endif  /* _SPPWK_COMP_SERVICE_H_ */
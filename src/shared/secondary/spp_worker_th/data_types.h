@@ -81,6 +81,37 @@ enum sppwk_worker_type {
 	SPPWK_TYPE_MRG,  /**< Merger */
 	SPPWK_TYPE_FWD,  /**< Forwarder */
 	SPPWK_TYPE_MIR,  /**< Mirror */
+	SPPWK_TYPE_CLS_5TUPLE,  /**< Classifier_5tuple */
+	SPPWK_TYPE_DIST,  /**< Distributor */
+};
+
+/**
+ * Scheduling policy of RX ports of merger. Weight of each of RX ports is
+ * referred as its quota, share or priority.
+ */
+enum sppwk_mrg_policy {
+	SPPWK_MRG_POLICY_RR,  /**< Round robin with quota of each port */
+	SPPWK_MRG_POLICY_WFQ,  /**< Weighted fair in bytes */
+	SPPWK_MRG_POLICY_PRIO,  /**< Strict priority */
+};
+
+/**
+ * 5-tuple of IPv4 or IPv6 for classifying. Addresses are in network byte
+ * order and masked with its prefix length. Port ranges are in host byte
+ * order. Wildcard is zero depth, zero proto or full range of ports.
+ */
+struct sppwk_cls_5tuple {
+	int ip_ver;  /**< 4 or 6, or 0 if not used */
+	int is_default;  /**< Default destination of the IP version */
+	uint8_t proto;  /**< L4 protocol number, or 0 for any */
+	uint8_t src_depth;  /**< Prefix length of source address */
+	uint8_t dst_depth;  /**< Prefix length of destination address */
+	uint8_t src_addr[16];  /**< Source address */
+	uint8_t dst_addr[16];  /**< Destination address */
+	uint16_t sport_min;  /**< Min of source port */
+	uint16_t sport_max;  /**< Max of source port */
+	uint16_t dport_min;  /**< Min of destination port */
+	uint16_t dport_max;  /**< Max of destination port */
 };
 
 /* Attributes for classifying. */
@@ -88,6 +119,8 @@ struct sppwk_cls_attrs {
 	uint64_t mac_addr;  /**< Mac address (binary) */
 	char mac_addr_str[STR_LEN_SHORT];  /**< Mac address (text) */
 	struct sppwk_vlan_tag vlantag;   /**< VLAN tag information */
+	struct sppwk_cls_5tuple tuple;  /**< 5-tuple of classifier_5tuple */
+	int weight;  /**< Weight of distributor, or 0 for default */
 };
 
 /**
@@ -118,10 +151,16 @@ struct sppwk_comp_info {
 	int comp_id;  /**< Component ID */
 	int nof_rx;  /**< The number of rx ports */
 	int nof_tx;  /**< The number of tx ports */
-	/**< rx ports */
-	struct sppwk_port_info *rx_ports[RTE_MAX_QUEUES_PER_PORT];
-	/**< tx ports */
-	struct sppwk_port_info *tx_ports[RTE_MAX_QUEUES_PER_PORT];
+	enum sppwk_mrg_policy mrg_policy;  /**< Scheduling policy of merger */
+	int burst_size;  /**< Num of packets in a burst, or 0 as default */
+	/*
+	 * Arrays of ports are allocated when a port is added, and extended
+	 * if it is not enough for the num of ports.
+	 */
+	int max_rx;  /**< Num of entries of rx_ports */
+	int max_tx;  /**< Num of entries of tx_ports */
+	struct sppwk_port_info **rx_ports;  /**< rx ports */
+	struct sppwk_port_info **tx_ports;  /**< tx ports */
 };
 
 /* Manage number of interfaces  and port information as global variable. */
@@ -132,9 +171,18 @@ struct sppwk_comp_info {
  * or not.
  */
 struct iface_info {
-	struct sppwk_port_info phy[RTE_MAX_ETHPORTS][RTE_MAX_QUEUES_PER_PORT];
-	struct sppwk_port_info vhost[RTE_MAX_ETHPORTS];
-	struct sppwk_port_info ring[RTE_MAX_ETHPORTS];
+	/**
+	 * Port info of queues of phy ports allocated for each of existing
+	 * ports on its socket, or NULL if the port does not exist.
+	 */
+	struct sppwk_port_info *phy[RTE_MAX_ETHPORTS];
+	int nof_phy_queues[RTE_MAX_ETHPORTS];  /**< Num of queues in phy */
+	/**
+	 * Port info of vhost and ring allocated when it is added on the
+	 * local socket, or NULL if it is not used.
+	 */
+	struct sppwk_port_info *vhost[RTE_MAX_ETHPORTS];
+	struct sppwk_port_info *ring[RTE_MAX_ETHPORTS];
 };
 
 struct sppwk_lcore_params;
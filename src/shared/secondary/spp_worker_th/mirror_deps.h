@@ -12,7 +12,7 @@
 #define SPPWK_PROC_TYPE "mirror"
 
 /* Num of entries of ops_list in mir_cmd_runner.c. */
-#define NOF_STAT_OPS 7
+#define NOF_STAT_OPS 10
 
 int exec_one_cmd(const struct sppwk_cmd_attrs *cmd);
 
@@ -38,6 +38,12 @@ int update_mirror(struct sppwk_comp_info *wk_comp_info);
  */
 int update_comp_info(struct sppwk_comp_info *p_comp_info, int *p_change_comp);
 
+/**
+ * Release data of components stopped since the last flush. It is called
+ * while flushing after the grace period, so that no lcore refers them.
+ */
+void sync_comp_info(void);
+
 enum sppwk_worker_type get_comp_type_from_str(const char *type_str);
 
 int get_status_ops(struct cmd_res_formatter_ops *ops_list);
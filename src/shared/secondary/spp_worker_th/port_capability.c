@@ -7,9 +7,16 @@
 #include <rte_udp.h>
 #include <rte_tcp.h>
 #include <rte_net_crc.h>
+#ifdef RTE_MACHINE_CPUFLAG_SSE4_1
+#include <rte_vect.h>
+#endif
 
 #include "port_capability.h"
 #include "shared/secondary/return_codes.h"
+#include "shared/dp_event.h"
+#include "shared/latency.h"
+#include "shared/lcore_usage.h"
+#include "shared/trace.h"
 
 
 /**
@@ -29,6 +36,7 @@ struct port_capabl_mng_info {
 	/* TODO(yasufum) consider to not use two flags for (0,1) and (1,0). */
 	volatile int ref_index; /* Flag to indicate using reference side. */
 	volatile int upd_index; /* Flag to indicate using update side. */
+	int is_pending;  /* Update side is not published yet. */
 
 	/* A set of attrs including sppwk_port_capability. */
 	/* TODO(yasufum) confirm why using PORT_CAPABL_MAX. */
@@ -43,12 +51,29 @@ struct port_mng_info {
 	struct port_capabl_mng_info tx;  /* Mng data of capability for Tx. */
 };
 
+/* List of ports of which update side is waiting to be published. */
+struct port_capabl_pending_list {
+	int nof_rx;  /* Num of entries of rx_list. */
+	int nof_tx;  /* Num of entries of tx_list. */
+	int rx_list[RTE_MAX_ETHPORTS];
+	int tx_list[RTE_MAX_ETHPORTS];
+};
+
 /* Information for VLAN tag management. */
 struct port_mng_info g_port_mng_info[RTE_MAX_ETHPORTS];
 
+/* Ports updated while flushing, published at once by sppwk_swap_two_sides. */
+static struct port_capabl_pending_list g_pending_ports;
+
 /* TPID of VLAN. */
 static uint16_t g_vlan_tpid;
 
+/* Num of packets of which VLAN tag is rewritten at a time. */
+#define VLAN_BATCH 4
+
+/* Bytes of header loaded at a time for rewriting VLAN tag. */
+#define VLAN_HDR_LOAD_LEN 16
+
 /* Initialize g_port_mng_info, and set ref side to 0 and update side to 1. */
 void
 sppwk_port_capability_init(void)
@@ -56,6 +81,7 @@ sppwk_port_capability_init(void)
 	int cnt = 0;
 	g_vlan_tpid = rte_cpu_to_be_16(RTE_ETHER_TYPE_VLAN);
 	memset(g_port_mng_info, 0x00, sizeof(g_port_mng_info));
+	memset(&g_pending_ports, 0x00, sizeof(g_pending_ports));
 	for (cnt = 0; cnt < RTE_MAX_ETHPORTS; cnt++) {
 		g_port_mng_info[cnt].rx.ref_index = 0;
 		g_port_mng_info[cnt].rx.upd_index = 1;
@@ -96,7 +122,7 @@ set_fcs_packet(struct rte_mbuf *pkt)
 			pkt->data_len, RTE_NET_CRC32_ETH);
 }
 
-/* Add VLAN tag to a packet. It is called from add_vlan_tag_all(). */
+/* Add VLAN tag to a packet. It is called from vlan_ops_burst(). */
 static inline int
 add_vlan_tag_one(
 		struct rte_mbuf *pkt,
@@ -116,11 +142,8 @@ add_vlan_tag_one(
 		/* For packets without VLAN tag, add VLAN tag. */
 		new_ether = (struct rte_ether_hdr *)rte_pktmbuf_prepend(pkt,
 				sizeof(struct rte_vlan_hdr));
-		if (unlikely(new_ether == NULL)) {
-			RTE_LOG(ERR, PORT, "Failed to "
-					"get additional header area.\n");
+		if (unlikely(new_ether == NULL))
 			return SPPWK_RET_NG;
-		}
 
 		rte_memcpy(new_ether, old_ether, sizeof(struct rte_ether_hdr));
 		vlan = (struct rte_vlan_hdr *)&new_ether[1];
@@ -133,27 +156,7 @@ add_vlan_tag_one(
 	return SPPWK_RET_OK;
 }
 
-/* Add VLAN tag to all packets. */
-static inline int
-add_vlan_tag_all(
-		struct rte_mbuf **pkts, int nb_pkts,
-		const union sppwk_port_capability *capability)
-{
-	int ret = SPPWK_RET_OK;
-	int cnt = 0;
-	for (cnt = 0; cnt < nb_pkts; cnt++) {
-		ret = add_vlan_tag_one(pkts[cnt], capability);
-		if (unlikely(ret < 0)) {
-			RTE_LOG(ERR, PORT,
-					"Failed to add VLAN tag."
-					"(pkts %d/%d)\n", cnt, nb_pkts);
-			break;
-		}
-	}
-	return cnt;
-}
-
-/* Delete VLAN tag from a packet. It is called from del_vlan_tag_all(). */
+/* Delete VLAN tag from a packet. It is called from vlan_ops_burst(). */
 static inline int
 del_vlan_tag_one(
 		struct rte_mbuf *pkt,
@@ -168,11 +171,8 @@ del_vlan_tag_one(
 		/* For packets without VLAN tag, delete VLAN tag. */
 		new_ether = (struct rte_ether_hdr *)rte_pktmbuf_adj(pkt,
 				sizeof(struct rte_vlan_hdr));
-		if (unlikely(new_ether == NULL)) {
-			RTE_LOG(ERR, PORT, "Failed to "
-					"delete unnecessary header area.\n");
+		if (unlikely(new_ether == NULL))
 			return SPPWK_RET_NG;
-		}
 
 		old = (uint32_t *)old_ether;
 		new = (uint32_t *)new_ether;
@@ -185,51 +185,45 @@ del_vlan_tag_one(
 	return SPPWK_RET_OK;
 }
 
-/* Delete VLAN tag from all packets. */
-static inline int
-del_vlan_tag_all(
-		struct rte_mbuf **pkts, int nb_pkts,
-		const union sppwk_port_capability *capability)
+/* Swap ref side and update side of given port capability mng info. */
+static inline void
+swap_port_capabl_sides(struct port_capabl_mng_info *mng)
 {
-	int ret = SPPWK_RET_OK;
-	int cnt = 0;
-	for (cnt = 0; cnt < nb_pkts; cnt++) {
-		ret = del_vlan_tag_one(pkts[cnt], capability);
-		if (unlikely(ret < 0)) {
-			RTE_LOG(ERR, PORT,
-					"Failed to del VLAN tag."
-					"(pkts %d/%d)\n", cnt, nb_pkts);
-			break;
-		}
-	}
-	return cnt;
+	int ref_index = mng->ref_index;
+
+	mng->ref_index = mng->upd_index;
+	mng->upd_index = ref_index;
+	mng->is_pending = 0;
 }
 
-/* Swap ref side and update side. */
-/* TODO(yasufum) add desc for this function. */
+/**
+ * Swap ref side and update side. SPPWK_SWAP_UPD adds given port to pending
+ * list, and SPPWK_SWAP_REF publishes all of pending ports and clears the
+ * list. Both of them are called from master lcore while flushing, and
+ * retired sides must not be updated until a grace period is passed.
+ */
 void
 sppwk_swap_two_sides(
 		enum sppwk_swap_type swap_type,
 		int port_id, enum sppwk_port_dir dir)
 {
 	int cnt;
-	static int num_rx;
-	static int num_tx;
-	static int rx_list[RTE_MAX_ETHPORTS];
-	static int tx_list[RTE_MAX_ETHPORTS];
+	struct port_capabl_pending_list *pend = &g_pending_ports;
 	struct port_capabl_mng_info *mng = NULL;
 
 	if (swap_type == SPPWK_SWAP_UPD) {
 		switch (dir) {
 		case SPPWK_PORT_DIR_RX:
 			mng = &g_port_mng_info[port_id].rx;
-			mng->upd_index = mng->ref_index;
-			rx_list[num_rx++] = port_id;
+			if (mng->is_pending == 0)
+				pend->rx_list[pend->nof_rx++] = port_id;
+			mng->is_pending = 1;
 			break;
 		case SPPWK_PORT_DIR_TX:
 			mng = &g_port_mng_info[port_id].tx;
-			mng->upd_index = mng->ref_index;
-			tx_list[num_tx++] = port_id;
+			if (mng->is_pending == 0)
+				pend->tx_list[pend->nof_tx++] = port_id;
+			mng->is_pending = 1;
 			break;
 		default:
 			/* Not used. */
@@ -238,17 +232,17 @@ sppwk_swap_two_sides(
 		return;
 	}
 
-	for (cnt = 0; cnt < num_rx; cnt++) {
-		mng = &g_port_mng_info[rx_list[cnt]].rx;
-		mng->ref_index = (mng->upd_index+1) % TWO_SIDES;
-		rx_list[cnt] = 0;
-	}
+	/* Make update sides visible before publishing them. */
+	rte_smp_wmb();
 
-	for (cnt = 0; cnt < num_tx; cnt++) {
-		mng = &g_port_mng_info[tx_list[cnt]].tx;
-		mng->ref_index = (mng->upd_index+1) % TWO_SIDES;
-		tx_list[cnt] = 0;
-	}
+	for (cnt = 0; cnt < pend->nof_rx; cnt++)
+		swap_port_capabl_sides(&g_port_mng_info[pend->rx_list[cnt]].rx);
+
+	for (cnt = 0; cnt < pend->nof_tx; cnt++)
+		swap_port_capabl_sides(&g_port_mng_info[pend->tx_list[cnt]].tx);
+
+	pend->nof_rx = 0;
+	pend->nof_tx = 0;
 }
 
 /* Update port attributes of given direction. */
@@ -326,26 +320,254 @@ sppwk_update_port_dir(const struct sppwk_comp_info *comp)
 }
 
 /**
- * Define list of VLAN opeartion functions. It is only used in
- * vlan_operation().
+ * Move a packet failed in VLAN operation to the tail of the burst, keeping
+ * order of others. It is rare, so cost of moving is ignorable.
  */
-typedef int (*vlan_f)(
-		struct rte_mbuf **pkts, int nb_pkts,
-		const union sppwk_port_capability *capability);
-
-vlan_f vlan_ops[] = {
-	NULL,              /* None */
-	add_vlan_tag_all,  /* Add VLAN tag */
-	del_vlan_tag_all,  /* Del VLAN tag */
-	NULL               /* Termination */
-};
+static inline void
+move_pkt_to_tail(struct rte_mbuf **pkts, int idx, int nb_pkts)
+{
+	struct rte_mbuf *failed = pkts[idx];
+
+	memmove(&pkts[idx], &pkts[idx + 1],
+			sizeof(struct rte_mbuf *) * (nb_pkts - idx - 1));
+	pkts[nb_pkts - 1] = failed;
+}
+
+/**
+ * Prefetch headers of packets up to `SPPWK_PREFETCH_OFFSET` ahead of the
+ * batch from `idx`. `next_pf` is the index of packet prefetched next.
+ */
+static inline void
+prefetch_vlan_batch(struct rte_mbuf **pkts, int idx, int nb_pkts,
+		int *next_pf)
+{
+	int last = RTE_MIN(idx + VLAN_BATCH + SPPWK_PREFETCH_OFFSET, nb_pkts);
+
+	for (; *next_pf < last; (*next_pf)++)
+		rte_prefetch0(rte_pktmbuf_mtod(pkts[*next_pf], void *));
+}
+
+/* Return 1 if VLAN tag can be added to the packet without copying. */
+static inline int
+is_vlan_pushable(const struct rte_mbuf *pkt)
+{
+	return rte_pktmbuf_headroom(pkt) >= sizeof(struct rte_vlan_hdr) &&
+		rte_pktmbuf_data_len(pkt) >= VLAN_HDR_LOAD_LEN &&
+		rte_pktmbuf_mtod(pkt, struct rte_ether_hdr *)->ether_type !=
+		g_vlan_tpid;
+}
+
+/* Return 1 if VLAN tag can be deleted from the packet without copying. */
+static inline int
+is_vlan_poppable(const struct rte_mbuf *pkt)
+{
+	return rte_pktmbuf_data_len(pkt) >=
+		sizeof(struct rte_vlan_hdr) + VLAN_HDR_LOAD_LEN &&
+		rte_pktmbuf_mtod(pkt, struct rte_ether_hdr *)->ether_type ==
+		g_vlan_tpid;
+}
+
+#ifdef RTE_MACHINE_CPUFLAG_SSE4_1
+/**
+ * Add VLAN tag to VLAN_BATCH packets. The first 16 bytes of each header
+ * are loaded, of which the last 4 bytes are replaced with TPID and TCI, and
+ * stored 4 bytes before. Original ether type is remained just after them.
+ */
+static inline void
+push_vlan_tag_batch(struct rte_mbuf **pkts, uint32_t tag)
+{
+	int i;
+	char *hdr[VLAN_BATCH];
+	__m128i val[VLAN_BATCH];
+
+	for (i = 0; i < VLAN_BATCH; i++) {
+		hdr[i] = rte_pktmbuf_mtod(pkts[i], char *);
+		val[i] = _mm_loadu_si128((const __m128i *)hdr[i]);
+	}
+	for (i = 0; i < VLAN_BATCH; i++)
+		val[i] = _mm_insert_epi32(val[i], tag, 3);
+	for (i = 0; i < VLAN_BATCH; i++) {
+		hdr[i] = rte_pktmbuf_prepend(pkts[i],
+				sizeof(struct rte_vlan_hdr));
+		_mm_storeu_si128((__m128i *)hdr[i], val[i]);
+		set_fcs_packet(pkts[i]);
+	}
+}
+
+/**
+ * Delete VLAN tag from VLAN_BATCH packets. MAC addresses of the first 12
+ * bytes are blended with 4 bytes following the tag, and stored 4 bytes
+ * after, so that ether type of inner is just after MAC addresses.
+ */
+static inline void
+pop_vlan_tag_batch(struct rte_mbuf **pkts)
+{
+	int i;
+	char *hdr[VLAN_BATCH];
+	__m128i val[VLAN_BATCH];
+
+	for (i = 0; i < VLAN_BATCH; i++) {
+		hdr[i] = rte_pktmbuf_mtod(pkts[i], char *);
+		val[i] = _mm_blend_epi16(
+				_mm_loadu_si128((const __m128i *)hdr[i]),
+				_mm_loadu_si128((const __m128i *)(hdr[i] +
+						sizeof(struct rte_vlan_hdr))),
+				0xc0);
+	}
+	for (i = 0; i < VLAN_BATCH; i++) {
+		hdr[i] = rte_pktmbuf_adj(pkts[i], sizeof(struct rte_vlan_hdr));
+		_mm_storeu_si128((__m128i *)hdr[i], val[i]);
+		set_fcs_packet(pkts[i]);
+	}
+}
+#else
+/* Add VLAN tag to VLAN_BATCH packets with scalar copy of MAC addresses. */
+static inline void
+push_vlan_tag_batch(struct rte_mbuf **pkts, uint32_t tag)
+{
+	int i;
+	char *hdr;
+
+	for (i = 0; i < VLAN_BATCH; i++) {
+		hdr = rte_pktmbuf_prepend(pkts[i], sizeof(struct rte_vlan_hdr));
+		memmove(hdr, hdr + sizeof(struct rte_vlan_hdr),
+				2 * RTE_ETHER_ADDR_LEN);
+		memcpy(hdr + 2 * RTE_ETHER_ADDR_LEN, &tag, sizeof(tag));
+		set_fcs_packet(pkts[i]);
+	}
+}
+
+/* Delete VLAN tag from VLAN_BATCH packets with scalar copy. */
+static inline void
+pop_vlan_tag_batch(struct rte_mbuf **pkts)
+{
+	int i;
+	char *hdr;
+
+	for (i = 0; i < VLAN_BATCH; i++) {
+		hdr = rte_pktmbuf_mtod(pkts[i], char *);
+		memmove(hdr + sizeof(struct rte_vlan_hdr), hdr,
+				2 * RTE_ETHER_ADDR_LEN);
+		rte_pktmbuf_adj(pkts[i], sizeof(struct rte_vlan_hdr));
+		set_fcs_packet(pkts[i]);
+	}
+}
+#endif /* RTE_MACHINE_CPUFLAG_SSE4_1 */
+
+/**
+ * Add VLAN tag to all packets. Packets are processed in batches if all of
+ * them are untagged and have enough headroom, or one by one. Return the
+ * number of succeeded packets, and failed ones are moved after them.
+ */
+static inline int
+add_vlan_tag_burst(struct rte_mbuf **pkts, int nb_pkts,
+		const union sppwk_port_capability *capability)
+{
+	int i = 0;
+	int next_pf = 0;
+	int nb_ok = nb_pkts;
+	/* TPID and TCI in the order of the header on little endian. */
+	uint32_t tag = (uint32_t)g_vlan_tpid |
+		((uint32_t)(uint16_t)capability->vlantag.tci << 16);
+
+	while (i < nb_ok) {
+		prefetch_vlan_batch(pkts, i, nb_ok, &next_pf);
+		if (i + VLAN_BATCH <= nb_ok &&
+				is_vlan_pushable(pkts[i]) &&
+				is_vlan_pushable(pkts[i + 1]) &&
+				is_vlan_pushable(pkts[i + 2]) &&
+				is_vlan_pushable(pkts[i + 3])) {
+			push_vlan_tag_batch(&pkts[i], tag);
+			i += VLAN_BATCH;
+		} else if (likely(add_vlan_tag_one(pkts[i], capability) ==
+				SPPWK_RET_OK)) {
+			i++;
+		} else {
+			move_pkt_to_tail(pkts, i, nb_ok);
+			nb_ok--;
+		}
+	}
+	return nb_ok;
+}
+
+/**
+ * Delete VLAN tag from all packets as add_vlan_tag_burst(). Packets
+ * without VLAN tag are not changed.
+ */
+static inline int
+del_vlan_tag_burst(struct rte_mbuf **pkts, int nb_pkts,
+		const union sppwk_port_capability *capability)
+{
+	int i = 0;
+	int next_pf = 0;
+	int nb_ok = nb_pkts;
+
+	while (i < nb_ok) {
+		prefetch_vlan_batch(pkts, i, nb_ok, &next_pf);
+		if (i + VLAN_BATCH <= nb_ok &&
+				is_vlan_poppable(pkts[i]) &&
+				is_vlan_poppable(pkts[i + 1]) &&
+				is_vlan_poppable(pkts[i + 2]) &&
+				is_vlan_poppable(pkts[i + 3])) {
+			pop_vlan_tag_batch(&pkts[i]);
+			i += VLAN_BATCH;
+		} else if (likely(del_vlan_tag_one(pkts[i], capability) ==
+				SPPWK_RET_OK)) {
+			i++;
+		} else {
+			move_pkt_to_tail(pkts, i, nb_ok);
+			nb_ok--;
+		}
+	}
+	return nb_ok;
+}
+
+/**
+ * Do all of operations of the port for each packet in a pass over the
+ * burst, in case of several operations are assigned.
+ */
+static inline int
+vlan_ops_chain_burst(struct rte_mbuf **pkts, int nb_pkts,
+		const struct sppwk_port_attrs *port_attrs, int nof_ops)
+{
+	int i = 0;
+	int op;
+	int ret = SPPWK_RET_OK;
+	int nb_ok = nb_pkts;
+
+	sppwk_prefetch_burst_hdrs(pkts, nb_ok);
+	while (i < nb_ok) {
+		sppwk_prefetch_next_hdr(pkts, i, nb_ok);
+		for (op = 0; op < nof_ops; op++) {
+			if (port_attrs[op].ops == SPPWK_PORT_OPS_ADD_VLAN)
+				ret = add_vlan_tag_one(pkts[i],
+						&port_attrs[op].capability);
+			else
+				ret = del_vlan_tag_one(pkts[i],
+						&port_attrs[op].capability);
+			if (unlikely(ret < 0))
+				break;
+		}
+
+		if (likely(ret == SPPWK_RET_OK)) {
+			i++;
+		} else {
+			move_pkt_to_tail(pkts, i, nb_ok);
+			nb_ok--;
+		}
+	}
+	return nb_ok;
+}
 
-/* Add or delete VLAN tag. */
+/**
+ * Add or delete VLAN tag. Return the number of succeeded packets, and
+ * failed ones are moved after them in `pkts`.
+ */
 static inline int
 vlan_operation(uint16_t port_id, struct rte_mbuf **pkts, const uint16_t nb_pkts,
 		enum sppwk_port_dir dir)
 {
-	int cnt, buf;
+	int nof_ops = 0;
 	int ok_pkts = nb_pkts;
 	struct sppwk_port_attrs *port_attrs = NULL;
 
@@ -353,20 +575,26 @@ vlan_operation(uint16_t port_id, struct rte_mbuf **pkts, const uint16_t nb_pkts,
 	if (unlikely(port_attrs[0].ops == SPPWK_PORT_OPS_NONE))
 		return nb_pkts;
 
-	for (cnt = 0; cnt < PORT_CAPABL_MAX; cnt++) {
-		/* Do nothing if the port is assigned no VLAN feature. */
-		if (port_attrs[cnt].ops == SPPWK_PORT_OPS_NONE)
-			break;
-
-		/* Add or delete VLAN tag with operation function. */
-		ok_pkts = vlan_ops[port_attrs[cnt].ops](
-				pkts, ok_pkts, &port_attrs->capability);
-	}
-
-	/* Discard remained packets to release mbuf. */
+	/* Operations are packed from the head and end with none. */
+	while (nof_ops < PORT_CAPABL_MAX &&
+			port_attrs[nof_ops].ops != SPPWK_PORT_OPS_NONE)
+		nof_ops++;
+
+	if (nof_ops > 1)
+		ok_pkts = vlan_ops_chain_burst(pkts, nb_pkts, port_attrs,
+				nof_ops);
+	else if (port_attrs[0].ops == SPPWK_PORT_OPS_ADD_VLAN)
+		ok_pkts = add_vlan_tag_burst(pkts, nb_pkts,
+				&port_attrs[0].capability);
+	else
+		ok_pkts = del_vlan_tag_burst(pkts, nb_pkts,
+				&port_attrs[0].capability);
+
+	trace_vlan_op(port_id, dir, nb_pkts, port_attrs[0].ops);
+	/* Failures are counted and logged with rate limited. */
 	if (unlikely(ok_pkts < nb_pkts)) {
-		for (buf = ok_pkts; buf < nb_pkts; buf++)
-			rte_pktmbuf_free(pkts[buf]);
+		dp_event_add(DP_EVENT_VLAN, nb_pkts - ok_pkts);
+		trace_drop(port_id, TRACE_DROP_VLAN, nb_pkts - ok_pkts);
 	}
 
 	return ok_pkts;
@@ -378,22 +606,36 @@ sppwk_eth_vlan_rx_burst(uint16_t port_id,
 		uint16_t queue_id,
 		struct rte_mbuf **rx_pkts, const uint16_t nb_pkts)
 {
-	uint16_t nb_rx;
+	int buf;
+	uint16_t nb_rx, nb_ok;
+
 	nb_rx = rte_eth_rx_burst(port_id, queue_id, rx_pkts, nb_pkts);
 	if (unlikely(nb_rx == 0))
 		return SPPWK_RET_OK;
+	lcore_usage_add_rx(nb_rx);
+	trace_burst_rx(port_id, queue_id, nb_rx);
+	latency_stamp_burst(rx_pkts, nb_rx);
 
-	/* Add or delete VLAN tag. */
-	return vlan_operation(port_id, rx_pkts, nb_rx, SPPWK_PORT_DIR_RX);
+	/* Add or delete VLAN tag, and discard failed packets. */
+	nb_ok = vlan_operation(port_id, rx_pkts, nb_rx, SPPWK_PORT_DIR_RX);
+	for (buf = nb_ok; buf < nb_rx; buf++)
+		rte_pktmbuf_free(rx_pkts[buf]);
+
+	return nb_ok;
 }
 
-/* Wrapper function for rte_eth_tx_burst() with VLAN feature. */
+/**
+ * Wrapper function for rte_eth_tx_burst() with VLAN feature. Packets
+ * failed in VLAN operation are remained after ones not sent, to be
+ * released by caller.
+ */
 uint16_t
 sppwk_eth_vlan_tx_burst(uint16_t port_id,
 		uint16_t queue_id,
 		struct rte_mbuf **tx_pkts, uint16_t nb_pkts)
 {
-	uint16_t nb_tx;
+	uint64_t stamps[SPPWK_BURST_MAX];
+	uint16_t nb_tx, nb_sent;
 
 	/* Add or delete VLAN tag. */
 	nb_tx = vlan_operation(port_id, tx_pkts, nb_pkts, SPPWK_PORT_DIR_TX);
@@ -401,6 +643,12 @@ sppwk_eth_vlan_tx_burst(uint16_t port_id,
 	if (unlikely(nb_tx == 0))
 		return SPPWK_RET_OK;
 
-	return rte_eth_tx_burst(port_id, queue_id, tx_pkts, nb_tx);
+	latency_load_stamps(tx_pkts, RTE_MIN(nb_tx, SPPWK_BURST_MAX), stamps);
+	nb_sent = rte_eth_tx_burst(port_id, queue_id, tx_pkts, nb_tx);
+	latency_record_stamps(port_id, stamps,
+			RTE_MIN(nb_sent, SPPWK_BURST_MAX));
+	trace_burst_tx(port_id, queue_id, nb_tx, nb_sent);
+	if (unlikely(nb_sent < nb_tx))
+		trace_drop(port_id, TRACE_DROP_TX_FULL, nb_tx - nb_sent);
+	return nb_sent;
 }
-
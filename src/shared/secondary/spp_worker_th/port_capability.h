@@ -12,15 +12,27 @@
  * Provide about the ability per port.
  */
 
+#include <rte_mbuf.h>
+#include <rte_prefetch.h>
+
 #include "cmd_utils.h"
 
+/**
+ * Num of packets of which headers are prefetched ahead of processing. It is
+ * large enough to cover latency of memory, and small enough not to evict
+ * headers prefetched but not processed yet.
+ */
+#ifndef SPPWK_PREFETCH_OFFSET
+#define SPPWK_PREFETCH_OFFSET 8
+#endif
+
 /** Calculate TCI of VLAN tag. */
 #define SPP_VLANTAG_CALC_TCI(id, pcp) (((pcp & 0x07) << 13) | (id & 0x0fff))
 
 /** Type for swaping sides . */
 enum sppwk_swap_type {
-	SPPWK_SWAP_REF,  /** Swap to reference area. */
-	SPPWK_SWAP_UPD,  /** Swap to update area. */
+	SPPWK_SWAP_REF,  /** Publish all of pending update areas. */
+	SPPWK_SWAP_UPD,  /** Add update area of given port to pending. */
 };
 
 /**
@@ -41,11 +53,12 @@ void sppwk_get_port_attrs(
 		int port_id, enum sppwk_port_dir dir);
 
 /**
- * Swap ref side and update side.
+ * Swap ref side and update side. Ports given with SPPWK_SWAP_UPD are kept
+ * as pending, and published at once with SPPWK_SWAP_REF while flushing.
  *
+ * @param swap_type Type for changing index.
  * @param port_id Etherdev ID.
- * @param rxtx RX/TX ID of port_id.
- * @param type Type for changing index.
+ * @param dir RX/TX ID of port_id.
  */
 void sppwk_swap_two_sides(
 		enum sppwk_swap_type swap_type,
@@ -59,7 +72,39 @@ void sppwk_swap_two_sides(
 void sppwk_update_port_dir(const struct sppwk_comp_info *comp);
 
 /**
- * Wrapper function for rte_eth_rx_burst() with VLAN feature.
+ * Prefetch headers of first packets of a burst before processing it.
+ *
+ * @param[in] pkts Packets of a burst.
+ * @param nb_pkts Number of packets.
+ */
+static inline void
+sppwk_prefetch_burst_hdrs(struct rte_mbuf **pkts, int nb_pkts)
+{
+	int cnt;
+
+	for (cnt = 0; cnt < nb_pkts && cnt < SPPWK_PREFETCH_OFFSET; cnt++)
+		rte_prefetch0(rte_pktmbuf_mtod(pkts[cnt], void *));
+}
+
+/**
+ * Prefetch header of a packet `SPPWK_PREFETCH_OFFSET` ahead of given one
+ * while processing packets of a burst in order.
+ *
+ * @param[in] pkts Packets of a burst.
+ * @param cnt Index of the packet processed now.
+ * @param nb_pkts Number of packets.
+ */
+static inline void
+sppwk_prefetch_next_hdr(struct rte_mbuf **pkts, int cnt, int nb_pkts)
+{
+	if (cnt + SPPWK_PREFETCH_OFFSET < nb_pkts)
+		rte_prefetch0(rte_pktmbuf_mtod(
+				pkts[cnt + SPPWK_PREFETCH_OFFSET], void *));
+}
+
+/**
+ * Wrapper function for rte_eth_rx_burst() with VLAN feature. Packets
+ * failed in VLAN operation are released and not returned.
  *
  * @param[in] port_id Etherdev ID.
  * @param[in] queue_id RX queue ID.
@@ -71,7 +116,9 @@ uint16_t sppwk_eth_vlan_rx_burst(uint16_t port_id, uint16_t queue_id,
 		struct rte_mbuf **rx_pkts, const uint16_t nb_pkts);
 
 /**
- * Wrapper function for rte_eth_tx_burst() with VLAN feature.
+ * Wrapper function for rte_eth_tx_burst() with VLAN feature. Packets not
+ * sent, including ones failed in VLAN operation, are remained from the
+ * returned index of `tx_pkts` to be released by caller.
  *
  * @param port_id Etherdev ID.
  * @param[in] queue_id TX queue ID.
@@ -18,7 +18,7 @@
 #define NOF_VLAN 4096
 
 /* Num of entries of ops_list in vf_cmd_runner.c. */
-#define NOF_STAT_OPS 8
+#define NOF_STAT_OPS 11
 
 /* Classifier for MAC addresses. */
 struct mac_classifier {
@@ -107,6 +107,12 @@ void init_classifier_info(int component_id);
  */
 int update_comp_info(struct sppwk_comp_info *p_comp_info, int *p_change_comp);
 
+/**
+ * Release data of components stopped since the last flush. It is called
+ * while flushing after the grace period, so that no lcore refers them.
+ */
+void sync_comp_info(void);
+
 enum sppwk_worker_type get_comp_type_from_str(const char *type_str);
 
 int get_status_ops(struct cmd_res_formatter_ops *ops_list);
@@ -3,6 +3,8 @@
  */
 
 #include <stdlib.h>
+#include <stdio.h>
+#include <stdarg.h>
 #include <string.h>
 
 #include <rte_log.h>
@@ -12,48 +14,65 @@
 
 #define RTE_LOGTYPE_SPP_STRING_BUFF RTE_LOGTYPE_USER1
 
+/**
+ * Header placed in front of string buffer. Length is kept to append without
+ * scanning the whole of string.
+ */
+struct strbuf_hdr {
+	size_t capacity;  /* Size of buffer including null char. */
+	size_t len;  /* Length of string. */
+};
+
+/* get header of message buffer */
+static inline struct strbuf_hdr *
+strbuf_get_hdr(const char *strbuf)
+{
+	return (struct strbuf_hdr *)(strbuf - sizeof(struct strbuf_hdr));
+}
+
 /* get message buffer capacity */
 static inline size_t
 strbuf_get_capacity(const char *strbuf)
 {
-	return *((const size_t *)(strbuf - sizeof(size_t)));
+	return strbuf_get_hdr(strbuf)->capacity;
 }
 
-/* re-allocate message buffer */
+/* re-allocate message buffer, and its string is kept as it is. */
 static inline char*
 strbuf_reallocate(char *strbuf, size_t required_len)
 {
 	size_t new_cap = strbuf_get_capacity(strbuf) * 2;
-	char *new_strbuf = NULL;
+	struct strbuf_hdr *new_hdr = NULL;
 
 	while (unlikely(new_cap <= required_len))
 		new_cap *= 2;
 
-	new_strbuf = spp_strbuf_allocate(new_cap);
-	if (unlikely(new_strbuf == NULL))
+	new_hdr = realloc(strbuf_get_hdr(strbuf),
+			sizeof(struct strbuf_hdr) + new_cap);
+	if (unlikely(new_hdr == NULL))
 		return NULL;
 
-	strcpy(new_strbuf, strbuf);
-	spp_strbuf_free(strbuf);
-
-	return new_strbuf;
+	new_hdr->capacity = new_cap;
+	return (char *)(new_hdr + 1);
 }
 
 /* allocate message buffer */
 char*
 spp_strbuf_allocate(size_t capacity)
 {
-	char *buf = (char *)malloc(capacity + sizeof(size_t));
-	if (unlikely(buf == NULL))
+	struct strbuf_hdr *hdr = malloc(sizeof(struct strbuf_hdr) +
+			capacity);
+	if (unlikely(hdr == NULL))
 		return NULL;
 
-	memset(buf, 0x00, capacity + sizeof(size_t));
-	*((size_t *)buf) = capacity;
+	hdr->capacity = capacity;
+	hdr->len = 0;
+	*((char *)(hdr + 1)) = '\0';
 	RTE_LOG(DEBUG, SPP_STRING_BUFF,
 			";alloc  ; addr=%p; size=%lu; str= ; len=0;\n",
-			buf + sizeof(size_t), capacity);
+			hdr + 1, capacity);
 
-	return buf + sizeof(size_t);
+	return (char *)(hdr + 1);
 }
 
 /* free message buffer */
@@ -62,23 +81,36 @@ spp_strbuf_free(char *strbuf)
 {
 	if (likely(strbuf != NULL)) {
 		RTE_LOG(DEBUG, SPP_STRING_BUFF,
-				";free   ; addr=%p; size=%lu; "
-				"str=%s; len=%lu;\n",
+				";free   ; addr=%p; size=%lu; len=%lu;\n",
 				strbuf, strbuf_get_capacity(strbuf),
-				strbuf, strlen(strbuf));
-		free(strbuf - sizeof(size_t));
+				spp_strbuf_len(strbuf));
+		free(strbuf_get_hdr(strbuf));
 	}
 }
 
+/* get length of string */
+size_t
+spp_strbuf_len(const char *strbuf)
+{
+	return strbuf_get_hdr(strbuf)->len;
+}
+
+/* clear string */
+void
+spp_strbuf_clear(char *strbuf)
+{
+	strbuf_get_hdr(strbuf)->len = 0;
+	*strbuf = '\0';
+}
+
 /* append message to buffer */
 char*
 spp_strbuf_append(char *strbuf, const char *append, size_t append_len)
 {
-	size_t cap = strbuf_get_capacity(strbuf);
-	size_t len = strlen(strbuf);
+	size_t len = spp_strbuf_len(strbuf);
 	char *new_strbuf = strbuf;
 
-	if (unlikely(len + append_len >= cap)) {
+	if (unlikely(len + append_len >= strbuf_get_capacity(strbuf))) {
 		new_strbuf = strbuf_reallocate(strbuf, len + append_len);
 		if (unlikely(new_strbuf == NULL))
 			return NULL;
@@ -86,11 +118,45 @@ spp_strbuf_append(char *strbuf, const char *append, size_t append_len)
 
 	memcpy(new_strbuf + len, append, append_len);
 	*(new_strbuf + len + append_len) = '\0';
+	strbuf_get_hdr(new_strbuf)->len = len + append_len;
 	RTE_LOG(DEBUG, SPP_STRING_BUFF,
-			";append ; addr=%p; size=%lu; str=%s; len=%lu;\n",
+			";append ; addr=%p; size=%lu; len=%lu;\n",
 			new_strbuf, strbuf_get_capacity(new_strbuf),
-			new_strbuf, strlen(new_strbuf));
+			len + append_len);
+
+	return new_strbuf;
+}
+
+/* append formatted message to buffer */
+char*
+spp_strbuf_appendf(char *strbuf, const char *format, ...)
+{
+	size_t len = spp_strbuf_len(strbuf);
+	char *new_strbuf = strbuf;
+	va_list ap;
+	int n;
+
+	va_start(ap, format);
+	n = vsnprintf(strbuf + len, strbuf_get_capacity(strbuf) - len,
+			format, ap);
+	va_end(ap);
+	if (unlikely(n < 0))
+		return NULL;
+
+	/* Format again if it is truncated. */
+	if (unlikely(len + n >= strbuf_get_capacity(strbuf))) {
+		new_strbuf = strbuf_reallocate(strbuf, len + n);
+		if (unlikely(new_strbuf == NULL))
+			return NULL;
+
+		va_start(ap, format);
+		vsnprintf(new_strbuf + len,
+				strbuf_get_capacity(new_strbuf) - len,
+				format, ap);
+		va_end(ap);
+	}
 
+	strbuf_get_hdr(new_strbuf)->len = len + n;
 	return new_strbuf;
 }
 
@@ -98,9 +164,10 @@ spp_strbuf_append(char *strbuf, const char *append, size_t append_len)
 char*
 spp_strbuf_remove_front(char *strbuf, size_t remove_len)
 {
-	size_t len = strlen(strbuf);
+	size_t len = spp_strbuf_len(strbuf);
 	size_t new_len = len - remove_len;
 
+	strbuf_get_hdr(strbuf)->len = new_len;
 	if (likely(new_len == 0)) {
 		*strbuf = '\0';
 		return strbuf;
@@ -12,7 +12,8 @@
  * SPP String buffer management
  *
  * Management features of string buffer which is used for communicating
- * between spp_vf and controller.
+ * between spp_vf and controller. Length of string is kept in the buffer,
+ * so string must be updated only via functions of this file.
  */
 
 /**
@@ -52,6 +53,43 @@ void spp_strbuf_free(char *strbuf);
  */
 char *spp_strbuf_append(char *strbuf, const char *append, size_t append_len);
 
+/**
+ * append formatted string to buffer, as same as sprintf().
+ *
+ * @param strbuf
+ *  destination string buffer.
+ *  spp_strbuf_allocate/spp_strbuf_append return value.
+ * @param format
+ *  format string of printf.
+ *
+ * @return if "strbuf" has enough space to append, returns "strbuf"
+ *         else returns a new pointer to the allocated memory.
+ */
+char *spp_strbuf_appendf(char *strbuf, const char *format, ...)
+	__attribute__ ((format(printf, 2, 3)));
+
+/**
+ * get length of string in buffer without scanning it.
+ *
+ * @param strbuf
+ *  target string buffer.
+ *  spp_strbuf_allocate/spp_strbuf_append return value.
+ *
+ * @return
+ *  length of string.
+ */
+size_t spp_strbuf_len(const char *strbuf);
+
+/**
+ * clear string in buffer. It must be used instead of writing null char
+ * to the buffer directly to keep its length.
+ *
+ * @param strbuf
+ *  target string buffer.
+ *  spp_strbuf_allocate/spp_strbuf_append return value.
+ */
+void spp_strbuf_clear(char *strbuf);
+
 /**
  * remove string from front.
  *
@@ -0,0 +1,416 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2020 Nippon Telegraph and Telephone Corporation
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <signal.h>
+#include <time.h>
+#include <unistd.h>
+#include <inttypes.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <sys/stat.h>
+#include <rte_byteorder.h>
+#include <rte_eal.h>
+#include <rte_log.h>
+#include <rte_malloc.h>
+#include <rte_service.h>
+#include "shared/trace.h"
+
+#define RTE_LOGTYPE_TRACE RTE_LOGTYPE_USER1
+
+#define TRACE_DEF_DIR "/tmp"
+#define TRACE_PATH_LEN 256
+#define TRACE_NAME_LEN 32
+
+/* Magic number of packet header of CTF. */
+#define TRACE_CTF_MAGIC 0xC1FC1FC1
+
+/* Size of event header, id and timestamp, and the max of an event. */
+#define TRACE_EV_HDR_LEN (sizeof(uint16_t) + sizeof(uint64_t))
+#define TRACE_EV_MAX_LEN (TRACE_EV_HDR_LEN + \
+		sizeof(uint16_t) * (TRACE_NOF_ARGS - 1) + sizeof(uint32_t))
+
+/*
+ * Name and TSDL fields of args of events. Args of NULL are not saved, and
+ * the last one is 32bit.
+ */
+struct trace_event_desc {
+	const char *name;
+	const char *args[TRACE_NOF_ARGS];
+	const char *opt;  /* Event name for `--trace`. */
+};
+
+static const struct trace_event_desc trace_events[TRACE_NOF_EVENTS] = {
+	[TRACE_BURST_RX] = { "spp.burst.rx",
+		{ "uint16_t port_id", "uint16_t queue_id",
+		  "uint16_t nb_pkts", NULL }, "rx" },
+	[TRACE_BURST_TX] = { "spp.burst.tx",
+		{ "uint16_t port_id", "uint16_t queue_id",
+		  "uint16_t nb_pkts", "uint32_t nb_tx" }, "tx" },
+	[TRACE_CLS] = { "spp.cls.decision",
+		{ "uint16_t rx_port_id", "uint16_t vid",
+		  "uint16_t tx_port_id", NULL }, "cls" },
+	[TRACE_DROP] = { "spp.drop",
+		{ "uint16_t port_id", "enum drop_reason reason",
+		  "uint16_t nb_pkts", NULL }, "drop" },
+	[TRACE_VLAN_OP] = { "spp.vlan.op",
+		{ "uint16_t port_id", "enum port_dir dir",
+		  "uint16_t nb_pkts", "enum vlan_op op" }, "vlan" },
+	[TRACE_SWAP] = { "spp.swap",
+		{ "enum swap_target target", "uint16_t id",
+		  "uint16_t ref_index", NULL }, "swap" },
+	[TRACE_CMD] = { "spp.cmd",
+		{ "uint16_t type", "uint16_t result", NULL,
+		  "uint32_t cycles" }, "cmd" },
+};
+
+/* Types of CTF for fields of events. */
+static const char trace_ctf_types[] =
+	"typealias integer { size = 16; align = 8; signed = false; } "
+	":= uint16_t;\n"
+	"typealias integer { size = 32; align = 8; signed = false; } "
+	":= uint32_t;\n"
+	"typealias integer { size = 64; align = 8; signed = false; } "
+	":= uint64_t;\n\n"
+	"enum drop_reason : uint16_t {\n"
+	"\tTX_FULL = 0, NO_DEST = 1, VLAN = 2, NO_MBUF = 3,\n"
+	"};\n\n"
+	"enum port_dir : uint16_t { NONE = 0, RX = 1, TX = 2, BOTH = 3, };\n\n"
+	"enum vlan_op : uint32_t { NONE = 0, ADD = 1, DEL = 2, };\n\n"
+	"enum swap_target : uint16_t {\n"
+	"\tLCORE = 0, FWD_ARRAY = 1, CLS = 2,\n"
+	"};\n\n";
+
+volatile uint32_t trace_mask;
+struct trace_buf trace_bufs[RTE_MAX_LCORE];
+
+/* Mask given as `--trace`, restored when it is toggled. */
+static uint32_t trace_conf_mask;
+static char trace_dir[TRACE_PATH_LEN];
+static char trace_procname[TRACE_NAME_LEN];
+
+/* Epoch of TSC in real time for clock of CTF. */
+static uint64_t trace_tsc_offset_ns;
+
+/*
+ * Saving is requested from handler of SIGUSR1 by posting the semaphore,
+ * and done in a control thread because file I/O is not allowed in it.
+ */
+static sem_t trace_save_sem;
+static pthread_t trace_save_thread;
+static pthread_mutex_t trace_save_lock = PTHREAD_MUTEX_INITIALIZER;
+static volatile int trace_saving;
+
+int
+trace_parse_events(const char *str, uint32_t *mask)
+{
+	char buf[TRACE_PATH_LEN];
+	char *tok, *saveptr = NULL;
+	uint32_t ev_mask = 0;
+	int ev;
+
+	if (strlen(str) >= sizeof(buf))
+		return -1;
+	strcpy(buf, str);
+
+	for (tok = strtok_r(buf, ",", &saveptr); tok != NULL;
+			tok = strtok_r(NULL, ",", &saveptr)) {
+		if (strcmp(tok, "all") == 0) {
+			ev_mask |= (1U << TRACE_NOF_EVENTS) - 1;
+			continue;
+		}
+
+		for (ev = 0; ev < TRACE_NOF_EVENTS; ev++) {
+			if (strcmp(tok, trace_events[ev].opt) == 0)
+				break;
+		}
+		if (ev == TRACE_NOF_EVENTS)
+			return -1;
+		ev_mask |= 1U << ev;
+	}
+
+	if (ev_mask == 0)
+		return -1;
+
+	*mask = ev_mask;
+	return 0;
+}
+
+/* Toggle tracing with SIGUSR1, and request saving if it is stopped. */
+static void
+trace_toggle(int sig __attribute__ ((unused)))
+{
+	/* Not restarted until rings are saved. */
+	if (trace_saving)
+		return;
+
+	if (trace_mask == 0) {
+		trace_mask = trace_conf_mask;
+		return;
+	}
+	trace_mask = 0;
+	sem_post(&trace_save_sem);
+}
+
+/* Save rings each time requested from trace_toggle(). */
+static void *
+trace_save_loop(void *arg __attribute__ ((unused)))
+{
+	for (;;) {
+		if (sem_wait(&trace_save_sem) != 0)
+			continue;
+		trace_save();
+	}
+	return NULL;
+}
+
+/* Get offset of TSC from the Epoch in nanoseconds. */
+static uint64_t
+get_tsc_offset_ns(void)
+{
+	struct timespec now;
+	uint64_t tsc = rte_rdtsc();
+	uint64_t hz = rte_get_tsc_hz();
+	uint64_t now_ns;
+
+	clock_gettime(CLOCK_REALTIME, &now);
+	now_ns = (uint64_t)now.tv_sec * NS_PER_S + now.tv_nsec;
+	return now_ns - ((tsc / hz) * NS_PER_S + (tsc % hz) * NS_PER_S / hz);
+}
+
+/* Allocate a ring of records of the lcore on its socket. */
+static int
+alloc_trace_buf(unsigned int lcore_id)
+{
+	struct trace_rec *recs;
+
+	recs = rte_zmalloc_socket("spp_trace",
+			sizeof(struct trace_rec) * TRACE_NOF_RECS,
+			RTE_CACHE_LINE_SIZE,
+			rte_lcore_to_socket_id(lcore_id));
+	if (recs == NULL) {
+		RTE_LOG(ERR, TRACE, "Failed to alloc trace of lcore %u.\n",
+				lcore_id);
+		return -1;
+	}
+	trace_bufs[lcore_id].head = 0;
+	trace_bufs[lcore_id].recs = recs;
+	return 0;
+}
+
+int
+trace_init(const char *procname, uint32_t mask, const char *dir)
+{
+	unsigned int lcore_id;
+	uint32_t svc_lcores[RTE_MAX_LCORE];
+	int i, nof_svc_lcores;
+
+	RTE_LCORE_FOREACH(lcore_id) {
+		if (alloc_trace_buf(lcore_id) != 0)
+			return -1;
+	}
+
+	/* Service lcores are not included in RTE_LCORE_FOREACH. */
+	nof_svc_lcores = rte_service_lcore_list(svc_lcores, RTE_MAX_LCORE);
+	for (i = 0; i < nof_svc_lcores; i++) {
+		if (alloc_trace_buf(svc_lcores[i]) != 0)
+			return -1;
+	}
+
+	snprintf(trace_dir, sizeof(trace_dir), "%s",
+			dir != NULL ? dir : TRACE_DEF_DIR);
+	snprintf(trace_procname, sizeof(trace_procname), "%s", procname);
+	trace_tsc_offset_ns = get_tsc_offset_ns();
+	trace_conf_mask = mask;
+
+	if (sem_init(&trace_save_sem, 0, 0) != 0) {
+		RTE_LOG(ERR, TRACE, "Failed to init semaphore of trace.\n");
+		return -1;
+	}
+	if (rte_ctrl_thread_create(&trace_save_thread, "spp-trace", NULL,
+			trace_save_loop, NULL) != 0) {
+		RTE_LOG(ERR, TRACE, "Failed to create thread of trace.\n");
+		return -1;
+	}
+	signal(SIGUSR1, trace_toggle);
+
+	rte_smp_wmb();
+	trace_mask = mask;
+
+	RTE_LOG(INFO, TRACE, "Trace enabled (mask=0x%x).\n", mask);
+	return 0;
+}
+
+/* Write metadata of CTF describing clock and events. */
+static int
+write_metadata(const char *path)
+{
+	const struct trace_event_desc *desc;
+	uint64_t hz = rte_get_tsc_hz();
+	int ev, arg;
+	FILE *fp;
+
+	fp = fopen(path, "w");
+	if (fp == NULL)
+		return -1;
+
+	fprintf(fp, "/* CTF 1.8 */\n\n%s", trace_ctf_types);
+	fprintf(fp, "trace {\n"
+			"\tmajor = 1;\n\tminor = 8;\n"
+			"\tbyte_order = %s;\n"
+			"\tpacket.header := struct {\n"
+			"\t\tuint32_t magic;\n\t\tuint32_t stream_id;\n"
+			"\t};\n};\n\n",
+			RTE_BYTE_ORDER == RTE_LITTLE_ENDIAN ? "le" : "be");
+	fprintf(fp, "env {\n\tdomain = \"spp\";\n"
+			"\tprocname = \"%s\";\n\tpid = %d;\n};\n\n",
+			trace_procname, getpid());
+	fprintf(fp, "clock {\n\tname = \"tsc\";\n"
+			"\tfreq = %" PRIu64 ";\n"
+			"\toffset_s = %" PRIu64 ";\n"
+			"\toffset = %" PRIu64 ";\n};\n\n",
+			hz, trace_tsc_offset_ns / NS_PER_S,
+			(trace_tsc_offset_ns % NS_PER_S) * hz / NS_PER_S);
+	fprintf(fp, "typealias integer { size = 64; align = 8; "
+			"signed = false; map = clock.tsc.value; } "
+			":= uint64_clock_t;\n\n");
+	fprintf(fp, "stream {\n\tid = 0;\n"
+			"\tpacket.context := struct {\n"
+			"\t\tuint32_t cpu_id;\n\t};\n"
+			"\tevent.header := struct {\n"
+			"\t\tuint16_t id;\n\t\tuint64_clock_t timestamp;\n"
+			"\t};\n};\n");
+
+	for (ev = 0; ev < TRACE_NOF_EVENTS; ev++) {
+		desc = &trace_events[ev];
+		fprintf(fp, "\nevent {\n\tid = %d;\n\tname = \"%s\";\n"
+				"\tstream_id = 0;\n\tfields := struct {\n",
+				ev, desc->name);
+		for (arg = 0; arg < TRACE_NOF_ARGS; arg++) {
+			if (desc->args[arg] != NULL)
+				fprintf(fp, "\t\t%s;\n", desc->args[arg]);
+		}
+		fprintf(fp, "\t};\n};\n");
+	}
+
+	return fclose(fp) == 0 ? 0 : -1;
+}
+
+/* Serialize a record in the layout of event declared in metadata. */
+static size_t
+pack_rec(char *dst, const struct trace_rec *rec)
+{
+	const struct trace_event_desc *desc = &trace_events[rec->event];
+	size_t len = 0;
+	int arg;
+
+	memcpy(dst + len, &rec->event, sizeof(rec->event));
+	len += sizeof(rec->event);
+	memcpy(dst + len, &rec->tsc, sizeof(rec->tsc));
+	len += sizeof(rec->tsc);
+
+	for (arg = 0; arg < TRACE_NOF_ARGS - 1; arg++) {
+		if (desc->args[arg] == NULL)
+			continue;
+		memcpy(dst + len, &rec->args16[arg], sizeof(uint16_t));
+		len += sizeof(uint16_t);
+	}
+	if (desc->args[TRACE_NOF_ARGS - 1] != NULL) {
+		memcpy(dst + len, &rec->arg32, sizeof(rec->arg32));
+		len += sizeof(rec->arg32);
+	}
+	return len;
+}
+
+/* Write records of an lcore as a stream of a packet from the oldest. */
+static int
+write_stream(const char *path, unsigned int lcore_id)
+{
+	const struct trace_buf *buf = &trace_bufs[lcore_id];
+	uint32_t hdr[3] = { TRACE_CTF_MAGIC, 0, lcore_id };
+	char ev_buf[TRACE_EV_MAX_LEN];
+	uint64_t head, idx;
+	size_t len;
+	FILE *fp;
+
+	fp = fopen(path, "w");
+	if (fp == NULL)
+		return -1;
+
+	head = buf->head;
+	rte_smp_rmb();
+	idx = head > TRACE_NOF_RECS ? head - TRACE_NOF_RECS : 0;
+
+	fwrite(hdr, sizeof(hdr), 1, fp);
+	for (; idx < head; idx++) {
+		len = pack_rec(ev_buf,
+				&buf->recs[idx & (TRACE_NOF_RECS - 1)]);
+		fwrite(ev_buf, len, 1, fp);
+	}
+
+	return fclose(fp) == 0 ? 0 : -1;
+}
+
+/* Write metadata and streams of lcores to the directory of trace. */
+static int
+save_trace_dir(void)
+{
+	char dir[TRACE_PATH_LEN * 2];
+	char path[TRACE_PATH_LEN * 2 + TRACE_NAME_LEN];
+	unsigned int lcore_id;
+
+	snprintf(dir, sizeof(dir), "%s/spp-trace-%s-%d", trace_dir,
+			trace_procname, getpid());
+	if (mkdir(dir, 0755) != 0 && errno != EEXIST) {
+		RTE_LOG(ERR, TRACE, "Failed to create %s (%s).\n", dir,
+				strerror(errno));
+		return -1;
+	}
+
+	snprintf(path, sizeof(path), "%s/metadata", dir);
+	if (write_metadata(path) != 0) {
+		RTE_LOG(ERR, TRACE, "Failed to write %s.\n", path);
+		return -1;
+	}
+
+	for (lcore_id = 0; lcore_id < RTE_MAX_LCORE; lcore_id++) {
+		if (trace_bufs[lcore_id].recs == NULL ||
+				trace_bufs[lcore_id].head == 0)
+			continue;
+
+		snprintf(path, sizeof(path), "%s/channel0_%u", dir, lcore_id);
+		if (write_stream(path, lcore_id) != 0) {
+			RTE_LOG(ERR, TRACE, "Failed to write %s.\n", path);
+			return -1;
+		}
+	}
+
+	RTE_LOG(INFO, TRACE, "Trace saved in %s.\n", dir);
+	return 0;
+}
+
+int
+trace_save(void)
+{
+	int ret;
+
+	if (trace_conf_mask == 0)
+		return 0;
+
+	/* Saved from the thread of SIGUSR1 and also on exit. */
+	pthread_mutex_lock(&trace_save_lock);
+	trace_saving = 1;
+
+	/* Stop recording while saving. */
+	trace_mask = 0;
+	rte_smp_mb();
+
+	ret = save_trace_dir();
+
+	trace_saving = 0;
+	pthread_mutex_unlock(&trace_save_lock);
+	return ret;
+}
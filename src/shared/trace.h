@@ -0,0 +1,187 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2020 Nippon Telegraph and Telephone Corporation
+ */
+
+#ifndef __SHARED_TRACE_H__
+#define __SHARED_TRACE_H__
+
+/**
+ * @file
+ * Tracepoints on data and control paths of SPP
+ *
+ * Events are recorded as fixed size binary records to a ring of each of
+ * lcores, and saved in Common Trace Format (CTF) when tracing is stopped
+ * and when the process exits, which can be read with babeltrace. A
+ * tracepoint costs only a check of the mask of events if it is disabled,
+ * and it does not format any string if enabled.
+ *
+ * It is enabled with `--trace EVENTS` for each of processes, and toggled
+ * at runtime by sending SIGUSR1 to the process. Rings are saved by a
+ * control thread each time tracing is stopped with SIGUSR1, so that it can
+ * be dumped without terminating the process. Rings are not cleared, and
+ * the saved trace is overwritten with events retained at the next time.
+ */
+
+#include <stdint.h>
+#include <rte_branch_prediction.h>
+#include <rte_cycles.h>
+#include <rte_lcore.h>
+
+/* Num of records of each of lcores, and older ones are overwritten. */
+#define TRACE_NOF_RECS (1 << 16)
+
+/* Num of args of an event, the first three are 16bit and the last 32bit. */
+#define TRACE_NOF_ARGS 4
+
+enum trace_event {
+	TRACE_BURST_RX,  /* Burst of RX packets. */
+	TRACE_BURST_TX,  /* Burst of TX packets. */
+	TRACE_CLS,       /* Decision of classifier for a packet. */
+	TRACE_DROP,      /* Packets dropped. */
+	TRACE_VLAN_OP,   /* VLAN operation for a burst. */
+	TRACE_SWAP,      /* Reference side swapped with update side. */
+	TRACE_CMD,       /* Command executed. */
+	TRACE_NOF_EVENTS,
+};
+
+enum trace_drop_reason {
+	TRACE_DROP_TX_FULL,  /* Failed to send. */
+	TRACE_DROP_NO_DEST,  /* No destination. */
+	TRACE_DROP_VLAN,     /* Failed to add or delete VLAN tag. */
+	TRACE_DROP_NO_MBUF,  /* Failed to alloc mbuf. */
+};
+
+enum trace_swap_target {
+	TRACE_SWAP_LCORE,      /* Components on lcore. */
+	TRACE_SWAP_FWD_ARRAY,  /* Forwarding table of basic forwarder. */
+	TRACE_SWAP_CLS,        /* Classifier table. */
+};
+
+/* An event, 24 bytes including padding. */
+struct trace_rec {
+	uint64_t tsc;
+	uint16_t event;
+	uint16_t args16[TRACE_NOF_ARGS - 1];
+	uint32_t arg32;
+};
+
+/* Ring of records written only by its lcore. */
+struct trace_buf {
+	uint64_t head;  /* Num of records written so far. */
+	struct trace_rec *recs;
+} __rte_cache_aligned;
+
+extern volatile uint32_t trace_mask;
+extern struct trace_buf trace_bufs[RTE_MAX_LCORE];
+
+/**
+ * Parse events given as `--trace EVENTS`, a comma separated list of `rx`,
+ * `tx`, `cls`, `drop`, `vlan`, `swap` and `cmd`, or `all`.
+ *
+ * @param str Events.
+ * @param[out] mask Mask of events parsed.
+ * @return 0 if succeeded, or -1.
+ */
+int trace_parse_events(const char *str, uint32_t *mask);
+
+/**
+ * Allocate rings of lcores and enable given events. It also registers
+ * handler of SIGUSR1 to toggle tracing, and creates a control thread to
+ * save rings when tracing is stopped by it.
+ *
+ * @param procname Name of process included in the name of trace.
+ * @param mask Mask of events.
+ * @param dir Directory in which trace is saved, or NULL for `/tmp`.
+ * @return 0 if succeeded, or -1.
+ */
+int trace_init(const char *procname, uint32_t mask, const char *dir);
+
+/**
+ * Save recorded events in CTF as `spp-trace-PROCNAME-PID` in the directory
+ * given to trace_init(). Tracing is stopped while saving and not restarted.
+ * It does nothing if tracing is not initialized.
+ *
+ * @return 0 if succeeded, or -1.
+ */
+int trace_save(void);
+
+/* Record an event if it is enabled. */
+static inline void
+trace_emit(enum trace_event event, uint16_t arg0, uint16_t arg1,
+		uint16_t arg2, uint32_t arg3)
+{
+	unsigned int lcore_id;
+	struct trace_buf *buf;
+	struct trace_rec *rec;
+
+	if (likely(!(trace_mask & (1U << event))))
+		return;
+
+	/* Threads other than lcores are not traced. */
+	lcore_id = rte_lcore_id();
+	if (unlikely(lcore_id >= RTE_MAX_LCORE))
+		return;
+
+	buf = &trace_bufs[lcore_id];
+	if (unlikely(buf->recs == NULL))
+		return;
+	rec = &buf->recs[buf->head & (TRACE_NOF_RECS - 1)];
+	rec->tsc = rte_rdtsc();
+	rec->event = event;
+	rec->args16[0] = arg0;
+	rec->args16[1] = arg1;
+	rec->args16[2] = arg2;
+	rec->arg32 = arg3;
+	buf->head++;
+}
+
+static inline void
+trace_burst_rx(uint16_t port_id, uint16_t queue_id, uint16_t nb_pkts)
+{
+	trace_emit(TRACE_BURST_RX, port_id, queue_id, nb_pkts, 0);
+}
+
+static inline void
+trace_burst_tx(uint16_t port_id, uint16_t queue_id, uint16_t nb_pkts,
+		uint16_t nb_tx)
+{
+	trace_emit(TRACE_BURST_TX, port_id, queue_id, nb_pkts, nb_tx);
+}
+
+/* VID of decisions of classifier_5tuple which does not refer VLAN. */
+#define TRACE_NO_VID 0xffff
+
+/* Packet of `vid` from `rx_port_id` is classified to `tx_port_id`. */
+static inline void
+trace_cls(uint16_t rx_port_id, uint16_t vid, uint16_t tx_port_id)
+{
+	trace_emit(TRACE_CLS, rx_port_id, vid, tx_port_id, 0);
+}
+
+static inline void
+trace_drop(uint16_t port_id, enum trace_drop_reason reason, uint16_t nb_pkts)
+{
+	trace_emit(TRACE_DROP, port_id, reason, nb_pkts, 0);
+}
+
+static inline void
+trace_vlan_op(uint16_t port_id, uint16_t dir, uint16_t nb_pkts, uint32_t op)
+{
+	trace_emit(TRACE_VLAN_OP, port_id, dir, nb_pkts, op);
+}
+
+static inline void
+trace_swap(enum trace_swap_target target, uint16_t id, uint16_t ref_index)
+{
+	trace_emit(TRACE_SWAP, target, id, ref_index, 0);
+}
+
+/* Command of `type` is executed with `result`, 0 for success, in cycles. */
+static inline void
+trace_cmd(uint16_t type, uint16_t result, uint64_t cycles)
+{
+	trace_emit(TRACE_CMD, type, result, 0,
+			cycles > UINT32_MAX ? UINT32_MAX : cycles);
+}
+
+#endif
@@ -166,9 +166,15 @@ class VfCommon(SppProc):
         return "status"
 
     @exec_command
-    def start_component(self, comp_name, core_id, comp_type):
-        return ("component start {comp_name} {core_id} {comp_type}"
-                .format(**locals()))
+    def start_component(self, comp_name, core_id, comp_type, policy=None,
+                        burst=None):
+        cmd = ("component start {comp_name} {core_id} {comp_type}"
+               .format(**locals()))
+        if policy is not None:
+            cmd += " {policy}".format(**locals())
+        if burst is not None:
+            cmd += " {burst}".format(**locals())
+        return cmd
 
     @exec_command
     def stop_component(self, comp_name):
@@ -223,6 +229,26 @@ class VfProc(VfCommon):
         return ("classifier_table del vlan {vlan_id} {mac_address} {port}"
                 .format(**locals()))
 
+    @exec_command
+    def set_classifier_table_with_rule(self, ip_type, rule, port):
+        return ("classifier_table add {ip_type} {rule} {port}"
+                .format(**locals()))
+
+    @exec_command
+    def clear_classifier_table_with_rule(self, ip_type, rule, port):
+        return ("classifier_table del {ip_type} {rule} {port}"
+                .format(**locals()))
+
+    @exec_command
+    def set_classifier_table_with_weight(self, weight, port):
+        return ("classifier_table add weight {weight} {port}"
+                .format(**locals()))
+
+    @exec_command
+    def clear_classifier_table_with_weight(self, weight, port):
+        return ("classifier_table del weight {weight} {port}"
+                .format(**locals()))
+
 
 class MirrorProc(VfCommon):
 
@@ -252,8 +278,11 @@ class NfvProc(SppProc):
         return "status"
 
     @exec_command
-    def port_add(self, port):
-        return "add {port}".format(**locals())
+    def port_add(self, port, mode=None):
+        if mode is not None:
+            return "add {port} {mode}".format(**locals())
+        else:
+            return "add {port}".format(**locals())
 
     @exec_command
     def port_del(self, port):
@@ -267,6 +296,13 @@ class NfvProc(SppProc):
     def patch_reset(self):
         return "patch reset"
 
+    @exec_command
+    def patch_batch(self, patches, reset=False):
+        cmds = ["patch reset"] if reset else []
+        for patch in patches:
+            cmds.append("patch {src} {dst}".format(**patch))
+        return "batch " + ";".join(cmds)
+
     @exec_command
     def forward(self):
         return "forward"
@@ -294,9 +330,11 @@ class PrimaryProc(SppProc):
         return "clear"
 
     @exec_command
-    def port_add(self, port, rx=None, tx=None):
+    def port_add(self, port, rx=None, tx=None, mode=None):
         if rx is not None and tx is not None:
             return "add {port} {rx} {tx}".format(**locals())
+        elif mode is not None:
+            return "add {port} {mode}".format(**locals())
         else:
             return "add {port}".format(**locals())
 
@@ -312,6 +350,13 @@ class PrimaryProc(SppProc):
     def patch_reset(self):
         return "patch reset"
 
+    @exec_command
+    def patch_batch(self, patches, reset=False):
+        cmds = ["patch reset"] if reset else []
+        for patch in patches:
+            cmds.append("patch {src} {dst}".format(**patch))
+        return "batch " + ";".join(cmds)
+
     @exec_command
     def forward(self):
         return "forward"
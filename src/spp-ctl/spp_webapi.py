@@ -15,6 +15,7 @@ import spp_proc
 
 PORT_TYPES = ["phy", "vhost", "ring", "pcap", "nullpmd", "tap", "memif",
               "pipe"]
+RING_SYNC_MODES = ["spsc", "mpsc", "spmc", "mpmc"]
 VF_PORT_TYPES = ["phy", "vhost", "ring"] # TODO(yasufum) add other ports
 # TODO(yasufum) consider PCAP_PORT_TYPES is required.
 
@@ -79,6 +80,27 @@ class BaseHandler(bottle.Bottle):
         except Exception:
             raise KeyInvalid('port', port)
 
+    def _validate_patch_batch(self, body):
+        if 'patches' not in body:
+            raise KeyRequired('patches')
+        if not isinstance(body['patches'], list):
+            raise KeyInvalid('patches', body['patches'])
+        if not isinstance(body.get('reset', False), bool):
+            raise KeyInvalid('reset', body['reset'])
+        for patch in body['patches']:
+            for key in ['src', 'dst']:
+                if key not in patch:
+                    raise KeyRequired(key)
+            self._validate_port(patch['src'])
+            self._validate_port(patch['dst'])
+
+    def _patch_batch(self, proc, body):
+        self._validate_patch_batch(body)
+        res = proc.patch_batch(body['patches'], body.get('reset', False))
+        if res.get('result') != "succeeded":
+            raise bottle.HTTPError(400, "command error: %s" %
+                                   res.get('error', "batch failed"))
+
     def log_url(self):
         LOG.info("%s %s called", bottle.request.method, bottle.request.path)
 
@@ -214,6 +236,14 @@ class V1VFCommon(object):
         vf["components"] = info["core"]
         if "classifier_table" in info:
             vf["classifier_table"] = info["classifier_table"]
+        if "merge_stats" in info:
+            vf["merge_stats"] = info["merge_stats"]
+        if "latency" in info:
+            vf["latency"] = info["latency"]
+        if "lcore_usage" in info:
+            vf["lcore_usage"] = info["lcore_usage"]
+        if "drops" in info:
+            vf["drops"] = info["drops"]
 
         return vf
 
@@ -271,8 +301,21 @@ class V1VFHandler(BaseHandler, V1VFCommon):
         return self.convert_info(proc.get_status())
 
     def vf_comp_start(self, proc, body):
-        self.validate_comp_start(body, ["forward", "merge", "classifier"])
-        proc.start_component(body['name'], body['core'], body['type'])
+        self.validate_comp_start(body, ["forward", "merge", "classifier",
+                                        "classifier_5tuple", "distributor"])
+        # Scheduling policy of RX ports is optional only for merge.
+        policy = body.get('policy')
+        if policy is not None:
+            if body['type'] != "merge" or policy not in ["rr", "wfq", "prio"]:
+                raise KeyInvalid('policy', policy)
+        # Burst size is optional only for forward and merge.
+        burst = body.get('burst')
+        if burst is not None:
+            if (body['type'] not in ["forward", "merge"] or
+                    not isinstance(burst, int) or not 1 <= burst <= 256):
+                raise KeyInvalid('burst', burst)
+        proc.start_component(body['name'], body['core'], body['type'],
+                             policy, burst)
 
     def vf_comp_stop(self, proc, name):
         proc.stop_component(name)
@@ -318,15 +361,38 @@ class V1VFHandler(BaseHandler, V1VFCommon):
             raise KeyInvalid('mac_address', mac_address)
 
     def _validate_vf_classifier(self, body):
-        for key in ['action', 'type', 'port', 'mac_address']:
+        for key in ['action', 'type', 'port']:
             if key not in body:
                 raise KeyRequired(key)
         if body['action'] not in ["add", "del"]:
             raise KeyInvalid('action', body['action'])
-        if body['type'] not in ["mac", "vlan"]:
+        if body['type'] not in ["mac", "vlan", "ipv4", "ipv6", "weight"]:
             raise KeyInvalid('type', body['type'])
         self._validate_port(body['port'])
 
+        # 5-tuple rule such as "tcp,10.0.0.0/8,any,any,80" is validated
+        # by spp_vf, but it must be one token of the command.
+        if body['type'] in ["ipv4", "ipv6"]:
+            rule = body.get('rule')
+            if rule is None:
+                raise KeyRequired('rule')
+            if not isinstance(rule, str) or rule == "" or " " in rule:
+                raise KeyInvalid('rule', rule)
+            return
+
+        # Weight of TX port of distributor.
+        if body['type'] == "weight":
+            if 'weight' not in body:
+                raise KeyRequired('weight')
+            weight = body['weight']
+            if (not isinstance(weight, int) or isinstance(weight, bool) or
+                    weight < 1 or weight > 255):
+                raise KeyInvalid('weight', weight)
+            return
+
+        if 'mac_address' not in body:
+            raise KeyRequired('mac_address')
+
         if not body['mac_address'] == 'default':
             self._validate_mac(body['mac_address'])
 
@@ -340,6 +406,23 @@ class V1VFHandler(BaseHandler, V1VFCommon):
         self._validate_vf_classifier(body)
 
         port = body['port']
+
+        if body['type'] in ["ipv4", "ipv6"]:
+            if body['action'] == "add":
+                proc.set_classifier_table_with_rule(
+                    body['type'], body['rule'], port)
+            else:
+                proc.clear_classifier_table_with_rule(
+                    body['type'], body['rule'], port)
+            return
+
+        if body['type'] == "weight":
+            if body['action'] == "add":
+                proc.set_classifier_table_with_weight(body['weight'], port)
+            else:
+                proc.clear_classifier_table_with_weight(body['weight'], port)
+            return
+
         mac_address = body['mac_address']
 
         if body['action'] == "add":
@@ -419,6 +502,8 @@ class V1NFVHandler(BaseHandler):
                    callback=self.nfv_patch_add)
         self.route('/<sec_id:int>/patches', 'DELETE',
                    callback=self.nfv_patch_del)
+        self.route('/<sec_id:int>/patches/batch', 'PUT',
+                   callback=self.nfv_patch_batch)
 
     def nfv_get(self, proc):
         return proc.get_status()
@@ -442,12 +527,17 @@ class V1NFVHandler(BaseHandler):
         if body['action'] not in ["add", "del"]:
             raise KeyInvalid('action', body['action'])
         self._validate_port(body['port'])
+        if 'mode' in body:
+            if not body['port'].startswith("ring:"):
+                raise KeyInvalid('mode', body['mode'])
+            if body['mode'] not in RING_SYNC_MODES:
+                raise KeyInvalid('mode', body['mode'])
 
     def nfv_port(self, proc, body):
         self._validate_nfv_port(body)
 
         if body['action'] == "add":
-            proc.port_add(body['port'])
+            proc.port_add(body['port'], body.get('mode'))
         else:
             proc.port_del(body['port'])
 
@@ -465,6 +555,9 @@ class V1NFVHandler(BaseHandler):
     def nfv_patch_del(self, proc):
         proc.patch_reset()
 
+    def nfv_patch_batch(self, proc, body):
+        self._patch_batch(proc, body)
+
     def nfv_exit(self, proc):
         self.ctrl.do_exit(proc.type, proc.id)
         proc.do_exit()
@@ -491,6 +584,7 @@ class V1PrimaryHandler(BaseHandler):
         self.route('/ports', 'PUT', callback=self.primary_port)
         self.route('/patches', 'PUT', callback=self.nfv_patch_add)
         self.route('/patches', 'DELETE', callback=self.nfv_patch_del)
+        self.route('/patches/batch', 'PUT', callback=self.patch_batch)
         self.route('/launch', 'PUT', callback=self.launch_sec_proc)
         self.route('/', 'DELETE', callback=self.pri_exit)
 
@@ -545,15 +639,35 @@ class V1PrimaryHandler(BaseHandler):
         if body['action'] not in ["add", "del"]:
             raise KeyInvalid('action', body['action'])
         self._validate_port(body['port'])
+        if 'mode' in body:
+            if not body['port'].startswith("ring:"):
+                raise KeyInvalid('mode', body['mode'])
+            if body['mode'] not in RING_SYNC_MODES:
+                raise KeyInvalid('mode', body['mode'])
+
+    def _validate_pipe_rings(self, rings):
+        """Validate rings of pipe such as `ring:0` or `ring:0-3`."""
+
+        if not isinstance(rings, str):
+            raise ValueError("invalid rings '%s'" % rings)
+        if_type, _, if_num = rings.partition(":")
+        if if_type != "ring":
+            raise ValueError("invalid type of rings '%s'" % rings)
+        first, sep, last = if_num.partition("-")
+        if not first.isdigit():
+            raise ValueError("invalid first ring of '%s'" % rings)
+        if sep != "":
+            if not last.isdigit() or int(last) < int(first):
+                raise ValueError("invalid last ring of '%s'" % rings)
 
     def _validate_pipe_args(self, rx_ring, tx_ring):
         try:
-            self._validate_port(rx_ring, ["ring"])
-        except Exception:
+            self._validate_pipe_rings(rx_ring)
+        except ValueError:
             raise KeyInvalid('rx', rx_ring)
         try:
-            self._validate_port(tx_ring, ["ring"])
-        except Exception:
+            self._validate_pipe_rings(tx_ring)
+        except ValueError:
             raise KeyInvalid('tx', tx_ring)
 
     def primary_port(self, body):
@@ -566,7 +680,7 @@ class V1PrimaryHandler(BaseHandler):
                                          body.get('tx', ""))
                 proc.port_add(body['port'], body['rx'], body['tx'])
             else:
-                proc.port_add(body['port'])
+                proc.port_add(body['port'], mode=body.get('mode'))
         else:
             proc.port_del(body['port'])
 
@@ -589,6 +703,9 @@ class V1PrimaryHandler(BaseHandler):
         proc = self._get_proc()
         proc.patch_reset()
 
+    def patch_batch(self, body):
+        self._patch_batch(self._get_proc(), body)
+
     def launch_sec_proc(self, body):  # the arg should be "body"
         for key in ['client_id', 'proc_name', 'eal', 'app']:
             if key not in body:
@@ -623,6 +740,10 @@ class V1PrimaryFlowHandler(V1PrimaryHandler):
                    'DELETE', callback=self.delete_flow_all_destroy)
         self.route('/<rule_id:int>/port_id/<port_id:int>',
                    'DELETE', callback=self.delete_flow_destroy)
+        self.route('/<rule_id:int>/port_id/<port_id:int>/count',
+                   'GET', callback=self.get_flow_count)
+        self.route('/port_id/<port_id:int>/stats',
+                   'GET', callback=self.get_flow_stats)
 
     def post_flow_validate(self, port_id, body):
         self._check_request_body(body)
@@ -652,6 +773,18 @@ class V1PrimaryFlowHandler(V1PrimaryHandler):
         proc = self._get_proc()
         return proc.flow(command)
 
+    def get_flow_count(self, rule_id, port_id):
+        command = "flow query phy:{0} {1} count".format(port_id, rule_id)
+
+        proc = self._get_proc()
+        return proc.flow(command)
+
+    def get_flow_stats(self, port_id):
+        command = "flow stats phy:{0}".format(port_id)
+
+        proc = self._get_proc()
+        return proc.flow(command)
+
     def _create_flow_rule_command(self, port_id, rule, sub_command):
         attr_data = {}
         data = {}
@@ -14,6 +14,7 @@
 #include <rte_log.h>
 #include <rte_cycles.h>
 #include <rte_memcpy.h>
+#include <rte_malloc.h>
 #include <rte_random.h>
 #include <rte_byteorder.h>
 #include <rte_per_lcore.h>
@@ -22,16 +23,18 @@
 #include <netinet/in.h>
 
 #include "classifier.h"
+#include "cls_pipeline.h"
+#include "classifier_5tuple.h"
+#include "distributor.h"
 #include "shared/secondary/return_codes.h"
 #include "shared/secondary/string_buffer.h"
 #include "shared/secondary/json_helper.h"
 #include "shared/secondary/spp_worker_th/cmd_res_formatter.h"
 #include "shared/secondary/spp_worker_th/vf_deps.h"
 #include "shared/secondary/spp_worker_th/port_capability.h"
+#include "shared/trace.h"
 
 
-#define RTE_LOGTYPE_VF_CLS RTE_LOGTYPE_USER1
-
 #ifdef RTE_MACHINE_CPUFLAG_SSE4_2
 #include <rte_hash_crc.h>
 #define DEFAULT_HASH_FUNC rte_hash_crc
@@ -43,9 +46,6 @@
 /* Number of classifier table entry */
 #define NOF_CLS_TABLE_ENTRIES 128
 
-/* Interval transmit burst packet if buffer is not filled. */
-#define DRAIN_TX_PACKET_INTERVAL 100  /* nano sec */
-
 /* VID of VLAN untagged */
 #define VLAN_UNTAGGED_VID 0x0fff
 
@@ -60,8 +60,11 @@ struct cls_mng_info {
 	volatile int is_used;
 };
 
-/* classifier information per lcore */
-struct cls_mng_info cls_mng_info_list[RTE_MAX_LCORE];
+/**
+ * classifier information per component, allocated on the socket of its
+ * lcore when it is updated for the first time, and kept for reusing the ID.
+ */
+struct cls_mng_info *cls_mng_info_list[RTE_MAX_LCORE];
 
 /* uninitialize classifier information. */
 static void
@@ -85,6 +88,7 @@ clean_classifier(struct cls_mng_info *mng_info)
 		clean_component_info(mng_info->comp_list + (long)i);
 
 	memset(mng_info, 0, sizeof(struct cls_mng_info));
+	mng_info->upd_index = 1;
 }
 
 /* Initialize classifier information. */
@@ -93,7 +97,9 @@ init_classifier_info(int comp_id)
 {
 	struct cls_mng_info *mng_info = NULL;
 
-	mng_info = cls_mng_info_list + comp_id;
+	mng_info = cls_mng_info_list[comp_id];
+	if (mng_info == NULL)
+		return;
 	clean_classifier(mng_info);
 }
 
@@ -413,73 +419,6 @@ init_component_info(struct cls_comp_info *cmp_info,
 	return SPPWK_RET_OK;
 }
 
-/* transmit packet to one destination. */
-static inline void
-transmit_packets(struct cls_port_info *clsd_data)
-{
-	int i;
-	uint16_t n_tx;
-
-	/* transmit packets */
-
-	n_tx = sppwk_eth_vlan_tx_burst(clsd_data->ethdev_port_id,
-			clsd_data->queue_no, clsd_data->pkts,
-			clsd_data->nof_pkts);
-
-
-	/* free cannot transmit packets */
-	if (unlikely(n_tx != clsd_data->nof_pkts)) {
-		for (i = n_tx; i < clsd_data->nof_pkts; i++)
-			rte_pktmbuf_free(clsd_data->pkts[i]);
-		RTE_LOG(DEBUG, VF_CLS,
-				"drop packets(tx). num=%hu, ethdev_port_id=%hu\n",
-				(uint16_t)(clsd_data->nof_pkts - n_tx),
-				clsd_data->ethdev_port_id);
-	}
-
-	clsd_data->nof_pkts = 0;
-}
-
-/* transmit packet to one destination. */
-static inline void
-transmit_all_packet(struct cls_comp_info *cmp_info)
-{
-	int i;
-	struct cls_port_info *clsd_data_tx = cmp_info->tx_ports_i;
-
-	for (i = 0; i < cmp_info->nof_tx_ports; i++) {
-		if (unlikely(clsd_data_tx[i].nof_pkts != 0)) {
-			RTE_LOG(INFO, VF_CLS,
-					"transmit all packets (drain). "
-					"index=%d, nof_pkts=%hu\n",
-					i, clsd_data_tx[i].nof_pkts);
-			transmit_packets(&clsd_data_tx[i]);
-		}
-	}
-}
-
-/* set mbuf pointer to tx buffer and transmit packet, if buffer is filled */
-static inline void
-push_packet(struct rte_mbuf *pkt, struct cls_port_info *clsd_data)
-{
-	clsd_data->pkts[clsd_data->nof_pkts++] = pkt;
-
-	/* transmit packet, if buffer is filled */
-	if (unlikely(clsd_data->nof_pkts == MAX_PKT_BURST)) {
-		RTE_LOG(DEBUG, VF_CLS,
-				"transmit packets (buffer is filled). "
-				"iface_type=%d, iface_no={%d,%d}, queue_no=%d, "
-				"tx_port=%hu, nof_pkts=%hu\n",
-				clsd_data->iface_type,
-				clsd_data->iface_no_global,
-				clsd_data->iface_no,
-				clsd_data->queue_no,
-				clsd_data->ethdev_port_id,
-				clsd_data->nof_pkts);
-		transmit_packets(clsd_data);
-	}
-}
-
 /* get index of general default classified */
 static inline int
 get_general_default_classified_index(struct cls_comp_info *cmp_info)
@@ -496,17 +435,19 @@ get_general_default_classified_index(struct cls_comp_info *cmp_info)
 	return mac_cls->default_cls_idx;
 }
 
-/* handle L2 multicast(include broadcast) packet */
-static inline void
-handle_l2multicast_packet(struct rte_mbuf *pkt,
-		struct cls_comp_info *cmp_info,
-		struct cls_port_info *clsd_data)
+/**
+ * Get indexes of TX ports of L2 multicast(include broadcast) packet, and
+ * return the num of them, or 0 if no entry.
+ */
+static inline int
+get_l2multicast_idxs(const struct rte_mbuf *pkt,
+		struct cls_comp_info *cmp_info, int *clsd_idxs)
 {
 	int i;
+	int n_act_clsd = 0;
 	struct mac_classifier *mac_cls;
 	uint16_t vid = get_vid(pkt);
 	int gen_def_clsd_idx = get_general_default_classified_index(cmp_info);
-	int n_act_clsd;
 
 	/* select mac address classification by vid */
 	mac_cls = cmp_info->mac_clfs[vid];
@@ -519,32 +460,50 @@ handle_l2multicast_packet(struct rte_mbuf *pkt,
 			/* untagged's default is not registered too */
 			RTE_LOG(ERR, VF_CLS,
 					"No entry.(l2 multicast packet)\n");
-			rte_pktmbuf_free(pkt);
-			return;
+			return 0;
 		}
 
-		/* transmit to untagged's default(as general default) */
-		LOG_CLS((long)gen_def_clsd_idx, pkt, cmp_info, clsd_data);
-		push_packet(pkt, clsd_data + (long)gen_def_clsd_idx);
-		return;
+		clsd_idxs[n_act_clsd++] = gen_def_clsd_idx;
+		return n_act_clsd;
 	}
 
-	/* add to mbuf's refcnt */
-	n_act_clsd = mac_cls->nof_cls_ports;
+	/* specific segment & general default */
+	for (i = 0; i < mac_cls->nof_cls_ports; i++)
+		clsd_idxs[n_act_clsd++] = mac_cls->cls_ports[i];
+
 	if (gen_def_clsd_idx >= 0 && vid != VLAN_UNTAGGED_VID)
-		++n_act_clsd;
+		clsd_idxs[n_act_clsd++] = gen_def_clsd_idx;
 
-	rte_mbuf_refcnt_update(pkt, (int16_t)(n_act_clsd - 1));
+	return n_act_clsd;
+}
 
-	/* transmit to specific segment & general default */
-	for (i = 0; i < mac_cls->nof_cls_ports; i++) {
-		LOG_CLS((long)mac_cls->cls_ports[i], pkt, cmp_info, clsd_data);
-		push_packet(pkt, clsd_data + (long)mac_cls->cls_ports[i]);
+/* handle L2 multicast(include broadcast) packet */
+static inline void
+handle_l2multicast_packet(struct rte_mbuf *pkt,
+		struct cls_comp_info *cmp_info,
+		struct cls_port_info *clsd_data)
+{
+	int i;
+	int clsd_idxs[CLS_MAX_DESTS];
+	uint16_t vid = get_vid(pkt);
+	int n_act_clsd = get_l2multicast_idxs(pkt, cmp_info, clsd_idxs);
+
+	if (unlikely(n_act_clsd == 0)) {
+		trace_drop(cmp_info->rx_port_i.ethdev_port_id,
+				TRACE_DROP_NO_DEST, 1);
+		rte_pktmbuf_free(pkt);
+		return;
 	}
 
-	if (gen_def_clsd_idx >= 0 && vid != VLAN_UNTAGGED_VID) {
-		LOG_CLS((long)gen_def_clsd_idx, pkt, cmp_info, clsd_data);
-		push_packet(pkt, clsd_data + (long)gen_def_clsd_idx);
+	/* add to mbuf's refcnt */
+	rte_mbuf_refcnt_update(pkt, (int16_t)(n_act_clsd - 1));
+
+	/* transmit to specific segment & general default */
+	for (i = 0; i < n_act_clsd; i++) {
+		LOG_CLS((long)clsd_idxs[i], pkt, cmp_info, clsd_data);
+		trace_cls(cmp_info->rx_port_i.ethdev_port_id, vid,
+				clsd_data[clsd_idxs[i]].ethdev_port_id);
+		push_packet(pkt, clsd_data + (long)clsd_idxs[i]);
 	}
 }
 
@@ -617,10 +576,15 @@ _classify_packets(struct rte_mbuf **rx_pkts, uint16_t n_rx,
 		if (likely(clsd_idx >= 0)) {
 			LOG_DBG(cmp_info->name, "as unicast packet. i=%d\n",
 					i);
+			trace_cls(cmp_info->rx_port_i.ethdev_port_id,
+					get_vid(rx_pkts[i]),
+					clsd_data[clsd_idx].ethdev_port_id);
 			push_packet(rx_pkts[i], clsd_data + clsd_idx);
 		} else if (unlikely(clsd_idx == -1)) {
 			LOG_DBG(cmp_info->name, "no destination. "
 					"drop packet. i=%d\n", i);
+			trace_drop(cmp_info->rx_port_i.ethdev_port_id,
+					TRACE_DROP_NO_DEST, 1);
 			rte_pktmbuf_free(rx_pkts[i]);
 		} else if (unlikely(clsd_idx == -2)) {
 			LOG_DBG(cmp_info->name, "as multicast packet. i=%d\n",
@@ -631,32 +595,43 @@ _classify_packets(struct rte_mbuf **rx_pkts, uint16_t n_rx,
 	}
 }
 
-/* TODO(yasufum) Revise this comment and name of func. */
-/* change update index at classifier management information */
-static inline void
-change_classifier_index(struct cls_mng_info *mng_info, int id)
+/* classifier(mac address) initialize globals. */
+int
+init_cls_mng_info(void)
 {
-	if (unlikely(mng_info->ref_index ==
-			mng_info->upd_index)) {
-		/* Change reference index of port ability. */
-		sppwk_swap_two_sides(SPPWK_SWAP_REF, 0, 0);
-
-		/* Transmit all packets for switching the using data. */
-		transmit_all_packet(mng_info->comp_list + mng_info->ref_index);
+	int i;
 
-		RTE_LOG(DEBUG, VF_CLS,
-				"Core[%u] Change update index.\n", id);
-		mng_info->ref_index =
-				(mng_info->upd_index + 1) % TWO_SIDES;
+	for (i = 0; i < RTE_MAX_LCORE; i++) {
+		if (cls_mng_info_list[i] == NULL)
+			continue;
+		memset(cls_mng_info_list[i], 0, sizeof(struct cls_mng_info));
+		cls_mng_info_list[i]->upd_index = 1;
 	}
+	return 0;
 }
 
-/* classifier(mac address) initialize globals. */
-int
-init_cls_mng_info(void)
+/* Get management info of component, or allocate it if it is not yet. */
+static struct cls_mng_info *
+get_cls_mng_info(const struct sppwk_comp_info *wk_comp_info)
 {
-	memset(cls_mng_info_list, 0, sizeof(cls_mng_info_list));
-	return 0;
+	struct cls_mng_info *mng_info =
+			cls_mng_info_list[wk_comp_info->comp_id];
+
+	if (likely(mng_info != NULL))
+		return mng_info;
+
+	mng_info = rte_zmalloc_socket("cls_mng_info",
+			sizeof(struct cls_mng_info), RTE_CACHE_LINE_SIZE,
+			rte_lcore_to_socket_id(wk_comp_info->lcore_id));
+	if (unlikely(mng_info == NULL)) {
+		RTE_LOG(ERR, VF_CLS,
+				"Cannot alloc classifier info, id=%d.\n",
+				wk_comp_info->comp_id);
+		return NULL;
+	}
+	mng_info->upd_index = 1;
+	cls_mng_info_list[wk_comp_info->comp_id] = mng_info;
+	return mng_info;
 }
 
 /* classifier(mac address) update component info. */
@@ -665,15 +640,24 @@ update_classifier(struct sppwk_comp_info *wk_comp_info)
 {
 	int ret;
 	int wk_id = wk_comp_info->comp_id;
-	struct cls_mng_info *mng_info = cls_mng_info_list + wk_id;
+	struct cls_mng_info *mng_info = get_cls_mng_info(wk_comp_info);
 	struct cls_comp_info *cls_info = NULL;
 
+	if (unlikely(mng_info == NULL))
+		return SPPWK_RET_NG;
+
 	RTE_LOG(INFO, VF_CLS,
 			"Start updating classifier, id=%u.\n", wk_id);
 
 	/* TODO(yasufum) rename `infos`. */
 	cls_info = mng_info->comp_list + mng_info->upd_index;
 
+	/**
+	 * Clean old one retired in previous flush. It is no longer referred
+	 * because a grace period has been passed in flush_cmd().
+	 */
+	clean_component_info(cls_info);
+
 	/* initialize update side classifier information */
 	ret = init_component_info(cls_info, wk_comp_info);
 	if (unlikely(ret != SPPWK_RET_OK)) {
@@ -683,17 +667,12 @@ update_classifier(struct sppwk_comp_info *wk_comp_info)
 	}
 	memcpy(cls_info->name, wk_comp_info->name, STR_LEN_NAME);
 
-	/* change index of reference side */
+	/* Publish update side as reference side. */
+	rte_smp_wmb();
 	mng_info->upd_index = mng_info->ref_index;
+	mng_info->ref_index = (mng_info->upd_index + 1) % TWO_SIDES;
 	mng_info->is_used = 1;
-
-	/* wait until no longer access the new update side */
-	while (likely(mng_info->ref_index ==
-			mng_info->upd_index))
-		rte_delay_us_block(SPPWK_UPDATE_INTERVAL);
-
-	/* Clean old one. */
-	clean_component_info(mng_info->comp_list + mng_info->upd_index);
+	trace_swap(TRACE_SWAP_CLS, wk_id, mng_info->ref_index);
 
 	RTE_LOG(INFO, VF_CLS,
 			"Done update classifier, id=%u.\n", wk_id);
@@ -705,22 +684,17 @@ update_classifier(struct sppwk_comp_info *wk_comp_info)
 int
 classify_packets(int comp_id)
 {
-	int i;
 	int n_rx;
-	struct cls_mng_info *mng_info = cls_mng_info_list + comp_id;
+	struct cls_mng_info *mng_info = cls_mng_info_list[comp_id];
 	struct cls_comp_info *cmp_info = NULL;
 	struct rte_mbuf *rx_pkts[MAX_PKT_BURST];
 
 	struct cls_port_info *clsd_data_rx = NULL;
 	struct cls_port_info *clsd_data_tx = NULL;
 
-	uint64_t cur_tsc, prev_tsc = 0;
-	const uint64_t drain_tsc = (rte_get_tsc_hz() + US_PER_S - 1) /
-			US_PER_S * DRAIN_TX_PACKET_INTERVAL;
-
-	/* change index of update classifier management information */
-	change_classifier_index(mng_info, comp_id);
-
+	/* Not updated if it is failed to alloc info. */
+	if (unlikely(mng_info == NULL))
+		return SPPWK_RET_OK;
 	cmp_info = mng_info->comp_list + mng_info->ref_index;
 	clsd_data_rx = &cmp_info->rx_port_i;
 	clsd_data_tx = cmp_info->tx_ports_i;
@@ -731,25 +705,6 @@ classify_packets(int comp_id)
 			cmp_info->mac_addr_entry == 1))
 		return SPPWK_RET_OK;
 
-	cur_tsc = rte_rdtsc();
-	if (unlikely(cur_tsc - prev_tsc > drain_tsc)) {
-		for (i = 0; i < cmp_info->nof_tx_ports; i++) {
-			if (likely(clsd_data_tx[i].nof_pkts == 0))
-				continue;
-
-			RTE_LOG(DEBUG, VF_CLS,
-					"transmit packets (drain). index=%d, "
-					"nof_pkts=%hu, interval=%lu\n",
-					i, clsd_data_tx[i].nof_pkts,
-					cur_tsc - prev_tsc);
-				transmit_packets(&clsd_data_tx[i]);
-		}
-		prev_tsc = cur_tsc;
-	}
-
-	if (clsd_data_rx->iface_type == UNDEF)
-		return SPPWK_RET_OK;
-
 	/* Retrieve packets */
 
 	n_rx = sppwk_eth_vlan_rx_burst(clsd_data_rx->ethdev_port_id,
@@ -758,11 +713,81 @@ classify_packets(int comp_id)
 	if (unlikely(n_rx == 0))
 		return SPPWK_RET_OK;
 
+	/* Classified by workers, and sent in cls_pipeline_transmit(). */
+	if (cls_pipeline_enabled()) {
+		cls_pipeline_dispatch(comp_id, rx_pkts, n_rx);
+		return SPPWK_RET_OK;
+	}
+
 	_classify_packets(rx_pkts, n_rx, cmp_info, clsd_data_tx);
 
+	/**
+	 * Transmit all of classified packets before returning, so that no
+	 * packets are left in reference side which might be retired while
+	 * flushing after the lcore reports its quiescent state.
+	 */
+	transmit_all_packet(clsd_data_tx, cmp_info->nof_tx_ports);
+
 	return SPPWK_RET_OK;
 }
 
+/* Classify a packet passed to a worker of cls_pipeline. */
+int
+select_cls_dests(int comp_id, struct rte_mbuf *pkt, int *dests)
+{
+	int i;
+	int n_act_clsd = 0;
+	long clsd_idx;
+	int clsd_idxs[CLS_MAX_DESTS];
+	struct cls_mng_info *mng_info = cls_mng_info_list[comp_id];
+	struct cls_comp_info *cmp_info = NULL;
+
+	/* Packets can be left in the pipeline after stopped. */
+	if (unlikely(!is_used_mng_info(mng_info))) {
+		rte_pktmbuf_free(pkt);
+		return 0;
+	}
+	cmp_info = mng_info->comp_list + mng_info->ref_index;
+
+	LOG_PKT(cmp_info->name, pkt);
+	clsd_idx = select_classified_index(pkt, cmp_info);
+	if (likely(clsd_idx >= 0))
+		clsd_idxs[n_act_clsd++] = clsd_idx;
+	else if (unlikely(clsd_idx == -2))
+		n_act_clsd = get_l2multicast_idxs(pkt, cmp_info, clsd_idxs);
+
+	if (unlikely(n_act_clsd == 0)) {
+		trace_drop(cmp_info->rx_port_i.ethdev_port_id,
+				TRACE_DROP_NO_DEST, 1);
+		rte_pktmbuf_free(pkt);
+		return 0;
+	}
+
+	rte_mbuf_refcnt_update(pkt, (int16_t)(n_act_clsd - 1));
+	for (i = 0; i < n_act_clsd; i++) {
+		dests[i] = clsd_idxs[i];
+		trace_cls(cmp_info->rx_port_i.ethdev_port_id, get_vid(pkt),
+				cmp_info->tx_ports_i[dests[i]].ethdev_port_id);
+	}
+	return n_act_clsd;
+}
+
+/* Get TX port of classifier for packets classified by workers. */
+const struct cls_port_info *
+get_cls_tx_port(int comp_id, int idx)
+{
+	struct cls_mng_info *mng_info = cls_mng_info_list[comp_id];
+	struct cls_comp_info *cmp_info = NULL;
+
+	if (unlikely(!is_used_mng_info(mng_info)))
+		return NULL;
+	cmp_info = mng_info->comp_list + mng_info->ref_index;
+
+	if (unlikely(idx >= cmp_info->nof_tx_ports))
+		return NULL;
+	return cmp_info->tx_ports_i + idx;
+}
+
 /* classifier iterate component information */
 int
 get_classifier_status(unsigned int lcore_id, int id,
@@ -777,7 +802,7 @@ get_classifier_status(unsigned int lcore_id, int id,
 	struct sppwk_port_idx rx_ports[RTE_MAX_QUEUES_PER_PORT];
 	struct sppwk_port_idx tx_ports[RTE_MAX_QUEUES_PER_PORT];
 
-	mng_info = cls_mng_info_list + id;
+	mng_info = cls_mng_info_list[id];
 	if (!is_used_mng_info(mng_info)) {
 		RTE_LOG(ERR, VF_CLS,
 				"Classifier is not used "
@@ -887,7 +912,7 @@ _add_classifier_table(struct classifier_table_params *params)
 	struct cls_port_info *port_info;
 
 	for (i = 0; i < RTE_MAX_LCORE; i++) {
-		mng_info = cls_mng_info_list + i;
+		mng_info = cls_mng_info_list[i];
 		if (!is_used_mng_info(mng_info))
 			continue;
 
@@ -910,30 +935,34 @@ _add_classifier_table(struct classifier_table_params *params)
 	return SPPWK_RET_OK;
 }
 
-/* Add entries of classifier table in JSON. */
+/**
+ * Add entries of classifier table in JSON. Entries are written to `output`
+ * directly in streaming because there might be thousands of them.
+ */
 int
 add_classifier_table(const char *name, char **output,
 		void *tmp __attribute__ ((unused)))
 {
 	int ret;
 	struct classifier_table_params tbl_params;
-	char *tmp_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
 
-	if (unlikely(tmp_buff == NULL)) {
-		RTE_LOG(ERR, VF_CLS, "Failed to alloc buff.\n");
+	ret = append_json_begin_array(output, name);
+	if (unlikely(ret != SPPWK_RET_OK))
 		return SPPWK_RET_NG;
-	}
 
-	tbl_params.output = tmp_buff;
+	tbl_params.output = *output;
 	tbl_params.tbl_proc = append_classifier_element_value;
 
 	ret = _add_classifier_table(&tbl_params);
-	if (unlikely(ret != SPPWK_RET_OK)) {
-		spp_strbuf_free(tbl_params.output);
+	if (ret == SPPWK_RET_OK)
+		ret = add_classifier_5tuple_table(&tbl_params);
+	if (ret == SPPWK_RET_OK)
+		ret = add_distributor_table(&tbl_params);
+
+	/* Buffer might be reallocated while appending entries. */
+	*output = tbl_params.output;
+	if (unlikely(ret != SPPWK_RET_OK) || unlikely(*output == NULL))
 		return SPPWK_RET_NG;
-	}
 
-	ret = append_json_array_brackets(output, name, tbl_params.output);
-	spp_strbuf_free(tbl_params.output);
-	return ret;
+	return append_json_end_array(output);
 }
@@ -5,7 +5,15 @@
 #ifndef __CLASSIFIER_H__
 #define __CLASSIFIER_H__
 
+#include <rte_mbuf.h>
 #include "shared/secondary/spp_worker_th/cmd_utils.h"
+#include "shared/secondary/spp_worker_th/vf_deps.h"
+#include "shared/secondary/spp_worker_th/port_capability.h"
+
+#define RTE_LOGTYPE_VF_CLS RTE_LOGTYPE_USER1
+
+/* Max num of TX ports of a packet, for specific VLAN and general default. */
+#define CLS_MAX_DESTS (RTE_MAX_QUEUES_PER_PORT + 1)
 
 /**
  * @file
@@ -39,6 +47,77 @@ struct classifier_table_params {
 	classifier_table_proc tbl_proc;
 };
 
+/*
+ * TX buffering of classified packets. They are shared among classifiers
+ * which have TX ports as `cls_port_info`.
+ */
+
+/* transmit packet to one destination. */
+static inline void
+transmit_packets(struct cls_port_info *clsd_data)
+{
+	int i;
+	uint16_t n_tx;
+
+	/* transmit packets */
+
+	n_tx = sppwk_eth_vlan_tx_burst(clsd_data->ethdev_port_id,
+			clsd_data->queue_no, clsd_data->pkts,
+			clsd_data->nof_pkts);
+
+
+	/* free cannot transmit packets */
+	if (unlikely(n_tx != clsd_data->nof_pkts)) {
+		for (i = n_tx; i < clsd_data->nof_pkts; i++)
+			rte_pktmbuf_free(clsd_data->pkts[i]);
+		RTE_LOG(DEBUG, VF_CLS,
+				"drop packets(tx). num=%hu, ethdev_port_id=%hu\n",
+				(uint16_t)(clsd_data->nof_pkts - n_tx),
+				clsd_data->ethdev_port_id);
+	}
+
+	clsd_data->nof_pkts = 0;
+}
+
+/* transmit packets remained in all of TX ports. */
+static inline void
+transmit_all_packet(struct cls_port_info *clsd_data_tx, int nof_tx_ports)
+{
+	int i;
+
+	for (i = 0; i < nof_tx_ports; i++) {
+		if (unlikely(clsd_data_tx[i].nof_pkts != 0)) {
+			RTE_LOG(DEBUG, VF_CLS,
+					"transmit all packets (drain). "
+					"index=%d, nof_pkts=%hu\n",
+					i, clsd_data_tx[i].nof_pkts);
+			transmit_packets(&clsd_data_tx[i]);
+		}
+	}
+}
+
+/* set mbuf pointer to tx buffer and transmit packet, if buffer is filled */
+static inline void
+push_packet(struct rte_mbuf *pkt, struct cls_port_info *clsd_data)
+{
+	clsd_data->pkts[clsd_data->nof_pkts++] = pkt;
+
+	/* transmit packet, if buffer is filled */
+	if (unlikely(clsd_data->nof_pkts == MAX_PKT_BURST)) {
+		RTE_LOG(DEBUG, VF_CLS,
+				"transmit packets (buffer is filled). "
+				"iface_type=%d, iface_no={%d,%d}, queue_no=%d, "
+				"tx_port=%hu, nof_pkts=%hu\n",
+				clsd_data->iface_type,
+				clsd_data->iface_no_global,
+				clsd_data->iface_no,
+				clsd_data->queue_no,
+				clsd_data->ethdev_port_id,
+				clsd_data->nof_pkts);
+		transmit_packets(clsd_data);
+	}
+}
+
 int append_classifier_element_value(
 		struct classifier_table_params *params,
 		enum sppwk_cls_type cls_type,
@@ -84,6 +163,29 @@ void init_classifier_info(int comp_id);
  */
 int classify_packets(int comp_id);
 
+/**
+ * Classify a packet passed to a worker of cls_pipeline. Refcnt of the
+ * packet is incremented for each of TX ports except the first one, or
+ * it is released if no TX port is found.
+ *
+ * @param comp_id Component ID.
+ * @param pkt Packet to be classified.
+ * @param[out] dests Indexes of TX ports of the packet, at most
+ *   CLS_MAX_DESTS.
+ * @return Num of TX ports.
+ */
+int select_cls_dests(int comp_id, struct rte_mbuf *pkt, int *dests);
+
+/**
+ * Get TX port of given index in reference side of classifier, for sending
+ * packets classified by workers of cls_pipeline.
+ *
+ * @param comp_id Component ID.
+ * @param idx Index of TX port returned from select_cls_dests().
+ * @return TX port, or NULL if classifier is stopped or has no such port.
+ */
+const struct cls_port_info *get_cls_tx_port(int comp_id, int idx);
+
 /**
  * Get classifier status.
  *
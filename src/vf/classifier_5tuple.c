@@ -0,0 +1,805 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2020 Nippon Telegraph and Telephone Corporation
+ */
+
+#include <unistd.h>
+#include <sys/types.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <netinet/in.h>
+
+#include <rte_common.h>
+#include <rte_mbuf.h>
+#include <rte_malloc.h>
+#include <rte_log.h>
+#include <rte_byteorder.h>
+#include <rte_ether.h>
+#include <rte_ip.h>
+#include <rte_acl.h>
+#include <rte_atomic.h>
+
+#include "classifier_5tuple.h"
+#include "shared/secondary/return_codes.h"
+#include "shared/secondary/spp_worker_th/vf_deps.h"
+#include "shared/trace.h"
+
+/* Index of contexts and defaults for each of IP versions. */
+enum cls5_ip_idx {
+	CLS5_IPV4,
+	CLS5_IPV6,
+	NOF_CLS5_IP,
+};
+
+/* Fields of ACL rule for IPv4. */
+enum {
+	CLS5_IPV4_PROTO,
+	CLS5_IPV4_SRC,
+	CLS5_IPV4_DST,
+	CLS5_IPV4_SPORT,
+	CLS5_IPV4_DPORT,
+	NOF_CLS5_IPV4_FIELDS,
+};
+
+/* Fields of ACL rule for IPv6, addresses are divided into four words. */
+enum {
+	CLS5_IPV6_PROTO,
+	CLS5_IPV6_SRC0,
+	CLS5_IPV6_SRC1,
+	CLS5_IPV6_SRC2,
+	CLS5_IPV6_SRC3,
+	CLS5_IPV6_DST0,
+	CLS5_IPV6_DST1,
+	CLS5_IPV6_DST2,
+	CLS5_IPV6_DST3,
+	CLS5_IPV6_SPORT,
+	CLS5_IPV6_DPORT,
+	NOF_CLS5_IPV6_FIELDS,
+};
+
+RTE_ACL_RULE_DEF(cls5_ipv4_rule, NOF_CLS5_IPV4_FIELDS);
+RTE_ACL_RULE_DEF(cls5_ipv6_rule, NOF_CLS5_IPV6_FIELDS);
+
+/**
+ * Key of IPv4 packet for lookup, in network byte order. The first field
+ * should be one byte for ACL library.
+ */
+struct cls5_ipv4_key {
+	uint8_t proto;
+	uint8_t pad[3];
+	uint32_t src_addr;
+	uint32_t dst_addr;
+	uint16_t sport;
+	uint16_t dport;
+};
+
+/* Key of IPv6 packet for lookup, in network byte order. */
+struct cls5_ipv6_key {
+	uint8_t proto;
+	uint8_t pad[3];
+	uint8_t src_addr[16];
+	uint8_t dst_addr[16];
+	uint16_t sport;
+	uint16_t dport;
+};
+
+/* Definition of a field of ACL rule placed at `offset` in the key. */
+#define CLS5_FIELD_DEF(ftype, fsize, idx, input, key, member, word) \
+	{                                                           \
+		.type = RTE_ACL_FIELD_TYPE_ ## ftype,               \
+		.size = fsize,                                      \
+		.field_index = idx,                                 \
+		.input_index = input,                               \
+		.offset = offsetof(struct key, member) +            \
+				(word) * sizeof(uint32_t),          \
+	}
+
+static struct rte_acl_field_def cls5_ipv4_defs[NOF_CLS5_IPV4_FIELDS] = {
+	CLS5_FIELD_DEF(BITMASK, sizeof(uint8_t), CLS5_IPV4_PROTO, 0,
+			cls5_ipv4_key, proto, 0),
+	CLS5_FIELD_DEF(MASK, sizeof(uint32_t), CLS5_IPV4_SRC, 1,
+			cls5_ipv4_key, src_addr, 0),
+	CLS5_FIELD_DEF(MASK, sizeof(uint32_t), CLS5_IPV4_DST, 2,
+			cls5_ipv4_key, dst_addr, 0),
+	/* Ports are in the same input of four bytes. */
+	CLS5_FIELD_DEF(RANGE, sizeof(uint16_t), CLS5_IPV4_SPORT, 3,
+			cls5_ipv4_key, sport, 0),
+	CLS5_FIELD_DEF(RANGE, sizeof(uint16_t), CLS5_IPV4_DPORT, 3,
+			cls5_ipv4_key, dport, 0),
+};
+
+static struct rte_acl_field_def cls5_ipv6_defs[NOF_CLS5_IPV6_FIELDS] = {
+	CLS5_FIELD_DEF(BITMASK, sizeof(uint8_t), CLS5_IPV6_PROTO, 0,
+			cls5_ipv6_key, proto, 0),
+	CLS5_FIELD_DEF(MASK, sizeof(uint32_t), CLS5_IPV6_SRC0, 1,
+			cls5_ipv6_key, src_addr, 0),
+	CLS5_FIELD_DEF(MASK, sizeof(uint32_t), CLS5_IPV6_SRC1, 2,
+			cls5_ipv6_key, src_addr, 1),
+	CLS5_FIELD_DEF(MASK, sizeof(uint32_t), CLS5_IPV6_SRC2, 3,
+			cls5_ipv6_key, src_addr, 2),
+	CLS5_FIELD_DEF(MASK, sizeof(uint32_t), CLS5_IPV6_SRC3, 4,
+			cls5_ipv6_key, src_addr, 3),
+	CLS5_FIELD_DEF(MASK, sizeof(uint32_t), CLS5_IPV6_DST0, 5,
+			cls5_ipv6_key, dst_addr, 0),
+	CLS5_FIELD_DEF(MASK, sizeof(uint32_t), CLS5_IPV6_DST1, 6,
+			cls5_ipv6_key, dst_addr, 1),
+	CLS5_FIELD_DEF(MASK, sizeof(uint32_t), CLS5_IPV6_DST2, 7,
+			cls5_ipv6_key, dst_addr, 2),
+	CLS5_FIELD_DEF(MASK, sizeof(uint32_t), CLS5_IPV6_DST3, 8,
+			cls5_ipv6_key, dst_addr, 3),
+	CLS5_FIELD_DEF(RANGE, sizeof(uint16_t), CLS5_IPV6_SPORT, 9,
+			cls5_ipv6_key, sport, 0),
+	CLS5_FIELD_DEF(RANGE, sizeof(uint16_t), CLS5_IPV6_DPORT, 9,
+			cls5_ipv6_key, dport, 0),
+};
+
+/* classifier_5tuple component information */
+struct cls5_comp_info {
+	char name[STR_LEN_NAME];  /* component name */
+	int rule_entry;  /* Flag of any of rules or defaults is set. */
+	struct rte_acl_ctx *acl_ctx[NOF_CLS5_IP];  /* NULL if no rules. */
+	int default_idx[NOF_CLS5_IP];  /* Index of default, or -1. */
+	int nof_tx_ports;  /* Number of TX ports info entries. */
+	/* Classifier has one RX port and several TX ports. */
+	struct cls_port_info rx_port_i;  /* RX port info classified. */
+	struct cls_port_info tx_ports_i[RTE_MAX_QUEUES_PER_PORT];
+	/* Rules of TX ports, referred for status. */
+	struct sppwk_cls_5tuple tuples[RTE_MAX_QUEUES_PER_PORT];
+};
+
+/* classifier_5tuple management information */
+struct cls5_mng_info {
+	struct cls5_comp_info comp_list[TWO_SIDES];
+	volatile int ref_index;  /* Flag for ref side */
+	volatile int upd_index;  /* Flag for update side */
+	volatile int is_used;
+};
+
+/* classifier_5tuple information per component, allocated on update. */
+static struct cls5_mng_info *cls5_mng_info_list[RTE_MAX_LCORE];
+
+/* Count used for making unique name of ACL context among processes. */
+static rte_atomic16_t g_acl_ctx_count = RTE_ATOMIC16_INIT(0xff);
+
+/* uninitialize classifier_5tuple information. */
+static void
+clean_component_info(struct cls5_comp_info *cmp_info)
+{
+	int i;
+
+	for (i = 0; i < NOF_CLS5_IP; i++) {
+		if (cmp_info->acl_ctx[i] != NULL)
+			rte_acl_free(cmp_info->acl_ctx[i]);
+	}
+	memset(cmp_info, 0, sizeof(struct cls5_comp_info));
+}
+
+/* Initialize classifier_5tuple information. */
+void
+init_classifier_5tuple_info(int comp_id)
+{
+	int i;
+	struct cls5_mng_info *mng_info = cls5_mng_info_list[comp_id];
+
+	if (mng_info == NULL)
+		return;
+
+	mng_info->is_used = 0;
+	for (i = 0; i < TWO_SIDES; i++)
+		clean_component_info(mng_info->comp_list + i);
+
+	mng_info->ref_index = 0;
+	mng_info->upd_index = 1;
+}
+
+/* Initialize globals of classifier_5tuple. */
+int
+init_cls_5tuple_mng_info(void)
+{
+	int i;
+
+	for (i = 0; i < RTE_MAX_LCORE; i++) {
+		if (cls5_mng_info_list[i] != NULL)
+			cls5_mng_info_list[i]->upd_index = 1;
+	}
+	return SPPWK_RET_OK;
+}
+
+/* Get management info of component, or allocate it if it is not yet. */
+static struct cls5_mng_info *
+get_cls5_mng_info(const struct sppwk_comp_info *wk_comp_info)
+{
+	struct cls5_mng_info *mng_info =
+			cls5_mng_info_list[wk_comp_info->comp_id];
+
+	if (likely(mng_info != NULL))
+		return mng_info;
+
+	mng_info = rte_zmalloc_socket("cls5_mng_info",
+			sizeof(struct cls5_mng_info), RTE_CACHE_LINE_SIZE,
+			rte_lcore_to_socket_id(wk_comp_info->lcore_id));
+	if (unlikely(mng_info == NULL)) {
+		RTE_LOG(ERR, VF_CLS,
+				"Cannot alloc classifier_5tuple info, id=%d.\n",
+				wk_comp_info->comp_id);
+		return NULL;
+	}
+	mng_info->upd_index = 1;
+	cls5_mng_info_list[wk_comp_info->comp_id] = mng_info;
+	return mng_info;
+}
+
+/**
+ * Priority of the rule. More specific rule has higher priority, longer
+ * prefixes at first, and then specified protocol and ports.
+ */
+static inline int32_t
+get_rule_priority(const struct sppwk_cls_5tuple *tuple)
+{
+	int32_t prio = 1 + (tuple->src_depth + tuple->dst_depth) * 4;
+
+	if (tuple->proto != 0)
+		prio++;
+	if (tuple->sport_min != 0 || tuple->sport_max != UINT16_MAX)
+		prio++;
+	if (tuple->dport_min != 0 || tuple->dport_max != UINT16_MAX)
+		prio++;
+	return prio;
+}
+
+/* Set a word of IPv6 address and its part of prefix length to a field. */
+static inline void
+set_ipv6_addr_field(struct rte_acl_field *field, const uint8_t *addr,
+		int depth, int word)
+{
+	uint32_t val;
+	int len = depth - word * 32;
+
+	memcpy(&val, addr + word * sizeof(uint32_t), sizeof(val));
+	field->value.u32 = rte_be_to_cpu_32(val);
+	field->mask_range.u32 = RTE_MAX(RTE_MIN(len, 32), 0);
+}
+
+/**
+ * Add the rule to ACL context. Values of fields of the rule are in host
+ * byte order, and userdata is index of TX port plus one because zero means
+ * no match.
+ */
+static int
+add_acl_rule(struct rte_acl_ctx *ctx, const struct sppwk_cls_5tuple *tuple,
+		int tx_idx)
+{
+	int i, port_field;
+	uint32_t val;
+	struct cls5_ipv4_rule rule4;
+	struct cls5_ipv6_rule rule6;
+	struct rte_acl_field *fields;
+	struct rte_acl_rule_data *data;
+
+	if (tuple->ip_ver == 4) {
+		memset(&rule4, 0, sizeof(rule4));
+		data = &rule4.data;
+		fields = rule4.field;
+		memcpy(&val, tuple->src_addr, sizeof(val));
+		fields[CLS5_IPV4_SRC].value.u32 = rte_be_to_cpu_32(val);
+		fields[CLS5_IPV4_SRC].mask_range.u32 = tuple->src_depth;
+		memcpy(&val, tuple->dst_addr, sizeof(val));
+		fields[CLS5_IPV4_DST].value.u32 = rte_be_to_cpu_32(val);
+		fields[CLS5_IPV4_DST].mask_range.u32 = tuple->dst_depth;
+		port_field = CLS5_IPV4_SPORT;
+	} else {
+		memset(&rule6, 0, sizeof(rule6));
+		data = &rule6.data;
+		fields = rule6.field;
+		for (i = 0; i < 4; i++) {
+			set_ipv6_addr_field(&fields[CLS5_IPV6_SRC0 + i],
+					tuple->src_addr, tuple->src_depth, i);
+			set_ipv6_addr_field(&fields[CLS5_IPV6_DST0 + i],
+					tuple->dst_addr, tuple->dst_depth, i);
+		}
+		port_field = CLS5_IPV6_SPORT;
+	}
+
+	/* Proto is the first and ports are the last in both of rules. */
+	fields[0].value.u8 = tuple->proto;
+	fields[0].mask_range.u8 = (tuple->proto != 0) ? UINT8_MAX : 0;
+	fields[port_field].value.u16 = tuple->sport_min;
+	fields[port_field].mask_range.u16 = tuple->sport_max;
+	fields[port_field + 1].value.u16 = tuple->dport_min;
+	fields[port_field + 1].mask_range.u16 = tuple->dport_max;
+
+	data->category_mask = 1;
+	data->priority = get_rule_priority(tuple);
+	data->userdata = tx_idx + 1;
+
+	if (tuple->ip_ver == 4)
+		return rte_acl_add_rules(ctx, (struct rte_acl_rule *)&rule4, 1);
+	return rte_acl_add_rules(ctx, (struct rte_acl_rule *)&rule6, 1);
+}
+
+/*
+ * Create ACL context from rules of given IP version and build it on
+ * `socket_id` which is of the lcore classifying packets.
+ */
+static struct rte_acl_ctx *
+create_acl_ctx(const struct cls5_comp_info *cmp_info, int ip_idx,
+		int socket_id)
+{
+	int i, ret;
+	int ip_ver = (ip_idx == CLS5_IPV4) ? 4 : 6;
+	int nof_fields = (ip_idx == CLS5_IPV4) ?
+			NOF_CLS5_IPV4_FIELDS : NOF_CLS5_IPV6_FIELDS;
+	char name[RTE_ACL_NAMESIZE];
+	struct rte_acl_ctx *ctx;
+	struct rte_acl_config cfg;
+	struct rte_acl_param param;
+
+	/* make context name(require uniqueness between processes) */
+	snprintf(name, sizeof(name), "c5acl_%07x%02hx", getpid(),
+			rte_atomic16_add_return(&g_acl_ctx_count, 1));
+
+	memset(&param, 0, sizeof(param));
+	param.name = name;
+	param.socket_id = socket_id;
+	param.rule_size = RTE_ACL_RULE_SZ(nof_fields);
+	param.max_rule_num = cmp_info->nof_tx_ports;
+
+	ctx = rte_acl_create(&param);
+	if (unlikely(ctx == NULL)) {
+		RTE_LOG(ERR, VF_CLS, "Cannot create ACL context. name=%s\n",
+				name);
+		return NULL;
+	}
+
+	for (i = 0; i < cmp_info->nof_tx_ports; i++) {
+		if (cmp_info->tuples[i].ip_ver != ip_ver ||
+				cmp_info->tuples[i].is_default)
+			continue;
+
+		ret = add_acl_rule(ctx, &cmp_info->tuples[i], i);
+		if (unlikely(ret != 0)) {
+			RTE_LOG(ERR, VF_CLS, "Cannot add ACL rule. "
+					"ret=%d, name=%s, index=%d\n",
+					ret, name, i);
+			rte_acl_free(ctx);
+			return NULL;
+		}
+	}
+
+	memset(&cfg, 0, sizeof(cfg));
+	cfg.num_categories = 1;
+	cfg.num_fields = nof_fields;
+	if (ip_idx == CLS5_IPV4)
+		memcpy(cfg.defs, cls5_ipv4_defs, sizeof(cls5_ipv4_defs));
+	else
+		memcpy(cfg.defs, cls5_ipv6_defs, sizeof(cls5_ipv6_defs));
+
+	ret = rte_acl_build(ctx, &cfg);
+	if (unlikely(ret != 0)) {
+		RTE_LOG(ERR, VF_CLS, "Cannot build ACL context. "
+				"ret=%d, name=%s\n", ret, name);
+		rte_acl_free(ctx);
+		return NULL;
+	}
+
+	return ctx;
+}
+
+/* initialize classifier_5tuple information. */
+static int
+init_component_info(struct cls5_comp_info *cmp_info,
+		const struct sppwk_comp_info *wk_comp_info)
+{
+	int i, ip_idx;
+	int nof_rules[NOF_CLS5_IP] = { 0, 0 };
+	struct cls_port_info *cls_rx_port_info = &cmp_info->rx_port_i;
+	struct cls_port_info *cls_tx_ports_info = cmp_info->tx_ports_i;
+	struct sppwk_port_info *tx_port = NULL;
+	const struct sppwk_cls_5tuple *tuple;
+
+	/* set rx */
+	cls_rx_port_info->iface_type = UNDEF;
+	if (wk_comp_info->nof_rx != 0) {
+		cls_rx_port_info->iface_type =
+			wk_comp_info->rx_ports[0]->iface_type;
+		cls_rx_port_info->queue_no =
+			wk_comp_info->rx_ports[0]->queue_no;
+		cls_rx_port_info->iface_no_global =
+			wk_comp_info->rx_ports[0]->iface_no;
+		cls_rx_port_info->ethdev_port_id =
+			wk_comp_info->rx_ports[0]->ethdev_port_id;
+	}
+
+	/* set tx */
+	cmp_info->nof_tx_ports = wk_comp_info->nof_tx;
+	cmp_info->default_idx[CLS5_IPV4] = -1;
+	cmp_info->default_idx[CLS5_IPV6] = -1;
+	for (i = 0; i < wk_comp_info->nof_tx; i++) {
+		tx_port = wk_comp_info->tx_ports[i];
+		tuple = &tx_port->cls_attrs.tuple;
+
+		/* store ports information */
+		cls_tx_ports_info[i].iface_type = tx_port->iface_type;
+		cls_tx_ports_info[i].iface_no = i;
+		cls_tx_ports_info[i].queue_no = tx_port->queue_no;
+		cls_tx_ports_info[i].iface_no_global = tx_port->iface_no;
+		cls_tx_ports_info[i].ethdev_port_id = tx_port->ethdev_port_id;
+		cls_tx_ports_info[i].nof_pkts = 0;
+		cmp_info->tuples[i] = *tuple;
+
+		if (tuple->ip_ver == 0)
+			continue;
+
+		cmp_info->rule_entry = 1;
+		ip_idx = (tuple->ip_ver == 4) ? CLS5_IPV4 : CLS5_IPV6;
+		if (tuple->is_default)
+			cmp_info->default_idx[ip_idx] = i;
+		else
+			nof_rules[ip_idx]++;
+
+		RTE_LOG(INFO, VF_CLS,
+				"Add entry to classifier_5tuple. "
+				"ipv%d, default=%d, iface_type=%d, "
+				"iface_no=%d, queue_no=%d, ethdev_port_id=%d\n",
+				tuple->ip_ver, tuple->is_default,
+				tx_port->iface_type, tx_port->iface_no,
+				tx_port->queue_no, tx_port->ethdev_port_id);
+	}
+
+	/* IPv4 default is also used as general default. */
+	if (cmp_info->default_idx[CLS5_IPV6] < 0)
+		cmp_info->default_idx[CLS5_IPV6] =
+				cmp_info->default_idx[CLS5_IPV4];
+
+	for (ip_idx = 0; ip_idx < NOF_CLS5_IP; ip_idx++) {
+		if (nof_rules[ip_idx] == 0)
+			continue;
+		cmp_info->acl_ctx[ip_idx] = create_acl_ctx(cmp_info, ip_idx,
+				rte_lcore_to_socket_id(wk_comp_info->lcore_id));
+		if (unlikely(cmp_info->acl_ctx[ip_idx] == NULL))
+			return SPPWK_RET_NG;
+	}
+
+	return SPPWK_RET_OK;
+}
+
+/* Update classifier_5tuple info with two-sided update as classifier. */
+int
+update_classifier_5tuple(struct sppwk_comp_info *wk_comp_info)
+{
+	int ret;
+	int wk_id = wk_comp_info->comp_id;
+	struct cls5_mng_info *mng_info = get_cls5_mng_info(wk_comp_info);
+	struct cls5_comp_info *cls_info = NULL;
+
+	if (unlikely(mng_info == NULL))
+		return SPPWK_RET_NG;
+
+	RTE_LOG(INFO, VF_CLS,
+			"Start updating classifier_5tuple, id=%u.\n", wk_id);
+
+	cls_info = mng_info->comp_list + mng_info->upd_index;
+
+	/**
+	 * Clean old one retired in previous flush. It is no longer referred
+	 * because a grace period has been passed in flush_cmd().
+	 */
+	clean_component_info(cls_info);
+
+	ret = init_component_info(cls_info, wk_comp_info);
+	if (unlikely(ret != SPPWK_RET_OK)) {
+		RTE_LOG(ERR, VF_CLS,
+				"Cannot update classifier_5tuple, ret=%d.\n",
+				ret);
+		return ret;
+	}
+	memcpy(cls_info->name, wk_comp_info->name, STR_LEN_NAME);
+
+	/* Publish update side as reference side. */
+	rte_smp_wmb();
+	mng_info->upd_index = mng_info->ref_index;
+	mng_info->ref_index = (mng_info->upd_index + 1) % TWO_SIDES;
+	mng_info->is_used = 1;
+	trace_swap(TRACE_SWAP_CLS, wk_id, mng_info->ref_index);
+
+	RTE_LOG(INFO, VF_CLS,
+			"Done update classifier_5tuple, id=%u.\n", wk_id);
+
+	return SPPWK_RET_OK;
+}
+
+/* Get L4 ports of TCP, UDP or SCTP at `off` of the packet. */
+static inline void
+get_l4_ports(const struct rte_mbuf *pkt, uint32_t off, uint8_t proto,
+		uint16_t *sport, uint16_t *dport)
+{
+	const uint16_t *ports;
+
+	if (proto != IPPROTO_TCP && proto != IPPROTO_UDP &&
+			proto != IPPROTO_SCTP)
+		return;
+
+	/* Source and destination ports are the first in all of headers. */
+	if (unlikely(rte_pktmbuf_data_len(pkt) < off + 2 * sizeof(uint16_t)))
+		return;
+
+	ports = rte_pktmbuf_mtod_offset(pkt, const uint16_t *, off);
+	*sport = ports[0];
+	*dport = ports[1];
+}
+
+/**
+ * Extract 5-tuple of the packet as a key for IPv4 or IPv6 and return the
+ * IP version, or 0 for non-IP packet. IPv6 extension headers are not
+ * parsed, so that ports are zero for such packets.
+ */
+static inline int
+extract_key(const struct rte_mbuf *pkt, struct cls5_ipv4_key *key4,
+		struct cls5_ipv6_key *key6)
+{
+	const struct rte_ether_hdr *eth;
+	const struct rte_vlan_hdr *vh;
+	const struct rte_ipv4_hdr *ip4;
+	const struct rte_ipv6_hdr *ip6;
+	uint16_t ether_type;
+	uint32_t off = sizeof(struct rte_ether_hdr);
+	uint32_t len = rte_pktmbuf_data_len(pkt);
+
+	eth = rte_pktmbuf_mtod(pkt, const struct rte_ether_hdr *);
+	ether_type = eth->ether_type;
+	if (ether_type == rte_cpu_to_be_16(RTE_ETHER_TYPE_VLAN)) {
+		if (unlikely(len < off + sizeof(struct rte_vlan_hdr)))
+			return 0;
+		vh = rte_pktmbuf_mtod_offset(pkt, const struct rte_vlan_hdr *,
+				off);
+		ether_type = vh->eth_proto;
+		off += sizeof(struct rte_vlan_hdr);
+	}
+
+	if (ether_type == rte_cpu_to_be_16(RTE_ETHER_TYPE_IPV4)) {
+		if (unlikely(len < off + sizeof(struct rte_ipv4_hdr)))
+			return 0;
+		ip4 = rte_pktmbuf_mtod_offset(pkt, const struct rte_ipv4_hdr *,
+				off);
+		key4->proto = ip4->next_proto_id;
+		key4->src_addr = ip4->src_addr;
+		key4->dst_addr = ip4->dst_addr;
+		key4->sport = 0;
+		key4->dport = 0;
+
+		/* Non-first fragments do not have L4 header. */
+		if (ip4->fragment_offset &
+				rte_cpu_to_be_16(RTE_IPV4_HDR_OFFSET_MASK))
+			return 4;
+
+		off += (ip4->version_ihl & RTE_IPV4_HDR_IHL_MASK) *
+				RTE_IPV4_IHL_MULTIPLIER;
+		get_l4_ports(pkt, off, key4->proto, &key4->sport,
+				&key4->dport);
+		return 4;
+	}
+
+	if (ether_type == rte_cpu_to_be_16(RTE_ETHER_TYPE_IPV6)) {
+		if (unlikely(len < off + sizeof(struct rte_ipv6_hdr)))
+			return 0;
+		ip6 = rte_pktmbuf_mtod_offset(pkt, const struct rte_ipv6_hdr *,
+				off);
+		key6->proto = ip6->proto;
+		memcpy(key6->src_addr, ip6->src_addr, sizeof(key6->src_addr));
+		memcpy(key6->dst_addr, ip6->dst_addr, sizeof(key6->dst_addr));
+		key6->sport = 0;
+		key6->dport = 0;
+
+		off += sizeof(struct rte_ipv6_hdr);
+		get_l4_ports(pkt, off, key6->proto, &key6->sport,
+				&key6->dport);
+		return 6;
+	}
+
+	return 0;
+}
+
+/* Classify packets in a burst and push them to TX buffers. */
+static inline void
+_classify_5tuple_packets(struct rte_mbuf **rx_pkts, uint16_t n_rx,
+		struct cls5_comp_info *cmp_info)
+{
+	int i, j, ip_idx;
+	struct cls5_ipv4_key keys4[MAX_PKT_BURST];
+	struct cls5_ipv6_key keys6[MAX_PKT_BURST];
+	const uint8_t *data[NOF_CLS5_IP][MAX_PKT_BURST];
+	uint32_t results[MAX_PKT_BURST];
+	uint16_t pkt_idx[NOF_CLS5_IP][MAX_PKT_BURST];
+	uint16_t nof_keys[NOF_CLS5_IP] = { 0, 0 };
+	int clsd_idx[MAX_PKT_BURST];
+
+	/* Sort packets into IPv4 and IPv6 for lookup in bulk. */
+	for (i = 0; i < n_rx; i++) {
+		switch (extract_key(rx_pkts[i], &keys4[nof_keys[CLS5_IPV4]],
+				&keys6[nof_keys[CLS5_IPV6]])) {
+		case 4:
+			j = nof_keys[CLS5_IPV4]++;
+			data[CLS5_IPV4][j] = (const uint8_t *)&keys4[j];
+			pkt_idx[CLS5_IPV4][j] = i;
+			break;
+		case 6:
+			j = nof_keys[CLS5_IPV6]++;
+			data[CLS5_IPV6][j] = (const uint8_t *)&keys6[j];
+			pkt_idx[CLS5_IPV6][j] = i;
+			break;
+		default:
+			clsd_idx[i] = cmp_info->default_idx[CLS5_IPV4];
+			break;
+		}
+	}
+
+	for (ip_idx = 0; ip_idx < NOF_CLS5_IP; ip_idx++) {
+		if (nof_keys[ip_idx] == 0)
+			continue;
+
+		if (cmp_info->acl_ctx[ip_idx] != NULL)
+			rte_acl_classify(cmp_info->acl_ctx[ip_idx],
+					data[ip_idx], results,
+					nof_keys[ip_idx], 1);
+		else
+			memset(results, 0, sizeof(results));
+
+		for (j = 0; j < nof_keys[ip_idx]; j++) {
+			if (results[j] != 0)
+				clsd_idx[pkt_idx[ip_idx][j]] = results[j] - 1;
+			else
+				clsd_idx[pkt_idx[ip_idx][j]] =
+					cmp_info->default_idx[ip_idx];
+		}
+	}
+
+	for (i = 0; i < n_rx; i++) {
+		if (likely(clsd_idx[i] >= 0)) {
+			trace_cls(cmp_info->rx_port_i.ethdev_port_id,
+					TRACE_NO_VID, cmp_info->tx_ports_i[
+					clsd_idx[i]].ethdev_port_id);
+			push_packet(rx_pkts[i],
+					cmp_info->tx_ports_i + clsd_idx[i]);
+		} else {
+			trace_drop(cmp_info->rx_port_i.ethdev_port_id,
+					TRACE_DROP_NO_DEST, 1);
+			rte_pktmbuf_free(rx_pkts[i]);
+		}
+	}
+}
+
+/* Classify incoming packets on a thread of given `comp_id`. */
+int
+classify_5tuple_packets(int comp_id)
+{
+	int n_rx;
+	struct cls5_mng_info *mng_info = cls5_mng_info_list[comp_id];
+	struct cls5_comp_info *cmp_info = NULL;
+	struct rte_mbuf *rx_pkts[MAX_PKT_BURST];
+	struct cls_port_info *clsd_data_rx = NULL;
+
+	/* Not updated if it is failed to alloc info. */
+	if (unlikely(mng_info == NULL))
+		return SPPWK_RET_OK;
+
+	cmp_info = mng_info->comp_list + mng_info->ref_index;
+	clsd_data_rx = &cmp_info->rx_port_i;
+
+	/* Check if it is ready to do classifying. */
+	if (!(clsd_data_rx->iface_type != UNDEF &&
+			cmp_info->nof_tx_ports >= 1 &&
+			cmp_info->rule_entry == 1))
+		return SPPWK_RET_OK;
+
+	n_rx = sppwk_eth_vlan_rx_burst(clsd_data_rx->ethdev_port_id,
+			clsd_data_rx->queue_no, rx_pkts, MAX_PKT_BURST);
+	if (unlikely(n_rx == 0))
+		return SPPWK_RET_OK;
+
+	_classify_5tuple_packets(rx_pkts, n_rx, cmp_info);
+
+	/**
+	 * Transmit all of classified packets before returning, so that no
+	 * packets are left in reference side which might be retired while
+	 * flushing after the lcore reports its quiescent state.
+	 */
+	transmit_all_packet(cmp_info->tx_ports_i, cmp_info->nof_tx_ports);
+
+	return SPPWK_RET_OK;
+}
+
+/* classifier_5tuple iterate component information */
+int
+get_classifier_5tuple_status(unsigned int lcore_id, int id,
+		struct sppwk_lcore_params *lcore_params)
+{
+	int i;
+	int nof_tx, nof_rx = 0;  /* Num of RX and TX ports. */
+	struct cls5_mng_info *mng_info;
+	struct cls5_comp_info *cmp_info;
+	struct cls_port_info *port_info;
+	struct sppwk_port_idx rx_ports[RTE_MAX_QUEUES_PER_PORT];
+	struct sppwk_port_idx tx_ports[RTE_MAX_QUEUES_PER_PORT];
+
+	mng_info = cls5_mng_info_list[id];
+	if (mng_info == NULL || !mng_info->is_used) {
+		RTE_LOG(ERR, VF_CLS,
+				"Classifier is not used "
+				"(comp_id=%d, lcore_id=%d, type=%d).\n",
+				id, lcore_id, SPPWK_TYPE_CLS_5TUPLE);
+		return SPPWK_RET_NG;
+	}
+
+	cmp_info = mng_info->comp_list + mng_info->ref_index;
+	port_info = cmp_info->tx_ports_i;
+
+	memset(rx_ports, 0x00, sizeof(rx_ports));
+	if (cmp_info->rx_port_i.iface_type != UNDEF) {
+		nof_rx = 1;
+		rx_ports[0].iface_type = cmp_info->rx_port_i.iface_type;
+		rx_ports[0].iface_no = cmp_info->rx_port_i.iface_no_global;
+		rx_ports[0].queue_no = cmp_info->rx_port_i.queue_no;
+	}
+
+	memset(tx_ports, 0x00, sizeof(tx_ports));
+	nof_tx = cmp_info->nof_tx_ports;
+	for (i = 0; i < nof_tx; i++) {
+		tx_ports[i].iface_type = port_info[i].iface_type;
+		tx_ports[i].iface_no = port_info[i].iface_no_global;
+		tx_ports[i].queue_no = port_info[i].queue_no;
+	}
+
+	/* Set the information with the function specified by the command. */
+	if (unlikely((*lcore_params->lcore_proc)(lcore_params, lcore_id,
+			cmp_info->name, SPPWK_TYPE_CLS_5TUPLE_STR,
+			nof_rx, rx_ports, nof_tx, tx_ports) != SPPWK_RET_OK))
+		return SPPWK_RET_NG;
+
+	return SPPWK_RET_OK;
+}
+
+/* Add rules of classifier_5tuple for `status` command. */
+int
+add_classifier_5tuple_table(struct classifier_table_params *params)
+{
+	int i, j;
+	struct cls5_mng_info *mng_info;
+	struct cls5_comp_info *cmp_info;
+	struct sppwk_port_idx port;
+	char rule_str[SPPWK_CLS_5TUPLE_STR_SZ];
+	enum sppwk_cls_type cls_type;
+
+	for (i = 0; i < RTE_MAX_LCORE; i++) {
+		mng_info = cls5_mng_info_list[i];
+		if (mng_info == NULL || !mng_info->is_used)
+			continue;
+
+		cmp_info = mng_info->comp_list + mng_info->ref_index;
+		for (j = 0; j < cmp_info->nof_tx_ports; j++) {
+			if (cmp_info->tuples[j].ip_ver == 0)
+				continue;
+
+			cls_type = SPPWK_CLS_TYPE_IPV4;
+			if (cmp_info->tuples[j].ip_ver == 6)
+				cls_type = SPPWK_CLS_TYPE_IPV6;
+			sppwk_format_cls_5tuple(rule_str,
+					&cmp_info->tuples[j]);
+
+			port.iface_type = cmp_info->tx_ports_i[j].iface_type;
+			port.iface_no =
+				cmp_info->tx_ports_i[j].iface_no_global;
+			port.queue_no = cmp_info->tx_ports_i[j].queue_no;
+
+			/**
+			 * `tbl_proc` is function pointer to
+			 * append_classifier_element_value().
+			 */
+			if (unlikely((*params->tbl_proc)(params, cls_type,
+					ETH_VLAN_ID_MAX, rule_str,
+					&port) < SPPWK_RET_OK))
+				return SPPWK_RET_NG;
+		}
+	}
+
+	return SPPWK_RET_OK;
+}
@@ -0,0 +1,79 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2020 Nippon Telegraph and Telephone Corporation
+ */
+
+#ifndef __CLASSIFIER_5TUPLE_H__
+#define __CLASSIFIER_5TUPLE_H__
+
+#include "classifier.h"
+
+/**
+ * @file
+ * SPP Classifier of 5-tuple
+ *
+ * Classifier_5tuple component provides packet forwarding function from
+ * one port to several ports as same as classifier, but lookups L3 and L4
+ * headers instead of MAC address. Each of TX ports has a rule of IPv4 or
+ * IPv6 5-tuple, which consists of protocol, prefixes of source and
+ * destination addresses and ranges of source and destination ports, and
+ * packets are classified with ACL library in which more specific rule is
+ * preferred. Packets matched no rules are sent to `default` port of the IP
+ * version. Non-IP packets and IPv6 packets without IPv6 default are sent to
+ * IPv4 default.
+ */
+
+/**
+ * Initialize globals of classifier_5tuple.
+ *
+ * @retval SPPWK_RET_OK succeeded.
+ * @retval SPPWK_RET_NG failed.
+ */
+int init_cls_5tuple_mng_info(void);
+
+/**
+ * Initialize classifier_5tuple information.
+ *
+ * @param comp_id The unique component ID.
+ */
+void init_classifier_5tuple_info(int comp_id);
+
+/**
+ * Update classifier_5tuple info.
+ *
+ * @param wk_comp_info Pointer to internal data of classifier_5tuple.
+ * @retval SPPWK_RET_OK If succeeded.
+ * @retval SPPWK_RET_NG If failed.
+ */
+int update_classifier_5tuple(struct sppwk_comp_info *wk_comp_info);
+
+/**
+ * Classify incoming packets by 5-tuple.
+ *
+ * @param comp_id Component ID.
+ * @retval SPPWK_RET_OK succeeded.
+ * @retval SPPWK_RET_NG failed.
+ */
+int classify_5tuple_packets(int comp_id);
+
+/**
+ * Get classifier_5tuple status.
+ *
+ * @param[in] lcore_id Lcore ID for classifier_5tuple.
+ * @param[in] id Unique component ID.
+ * @param[in,out] params Pointer to detailed data of classifier status.
+ * @retval SPPWK_RET_OK If succeeded.
+ * @retval SPPWK_RET_NG If failed.
+ */
+int get_classifier_5tuple_status(unsigned int lcore_id, int id,
+		struct sppwk_lcore_params *params);
+
+/**
+ * Add rules of classifier_5tuple for `classifier_table` of status.
+ *
+ * @param[in,out] params Object which has pointer of operation func and attrs.
+ * @retval SPPWK_RET_OK If succeeded.
+ * @retval SPPWK_RET_NG If failed.
+ */
+int add_classifier_5tuple_table(struct classifier_table_params *params);
+
+#endif /* __CLASSIFIER_5TUPLE_H__ */
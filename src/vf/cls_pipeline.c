@@ -0,0 +1,470 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2020 Nippon Telegraph and Telephone Corporation
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+
+#include <rte_common.h>
+#include <rte_errno.h>
+#include <rte_lcore.h>
+#include <rte_log.h>
+#include <rte_eventdev.h>
+#include <rte_mbuf_dyn.h>
+
+#include "classifier.h"
+#include "cls_pipeline.h"
+#include "flow_hash.h"
+#include "shared/dp_event.h"
+#include "shared/lcore_usage.h"
+#include "shared/secondary/return_codes.h"
+#include "shared/secondary/spp_worker_th/comp_service.h"
+
+#define CLS_PL_DYNFIELD_NAME "spp_dynfield_cls_src"
+
+/* Queue of events to workers, followed by queues back to classifiers. */
+#define CLS_PL_WORKER_QID 0
+
+/**
+ * Two IDs are packed in a dynamic field of a packet passed to workers, lcore
+ * ID and component ID of classifier, because flow_id of the event is hash
+ * of the flow for atomic scheduling. Component ID and index of TX port are
+ * packed in flow_id of an event back to the classifier.
+ */
+#define CLS_PL_ID_BITS 10
+#define CLS_PL_ID_MASK ((1 << CLS_PL_ID_BITS) - 1)
+
+static unsigned int g_nof_workers;  /* Num of workers. */
+static unsigned int g_worker_lcores[RTE_MAX_LCORE];  /* Lcores of workers. */
+static int g_worker_idx[RTE_MAX_LCORE];  /* Index of worker, or -1. */
+
+static uint8_t g_evdev_id;  /* Event device of the pipeline. */
+static int g_is_started;  /* 1 if the event device is started. */
+static int g_src_offset;  /* Offset of dynamic field of source of packet. */
+
+/* Event ports of workers and classifiers, indexed by lcore ID, or -1. */
+static int g_ev_ports[RTE_MAX_LCORE];
+
+/* Queues of events back to classifiers, indexed by lcore ID. */
+static uint8_t g_tx_qids[RTE_MAX_LCORE];
+
+static inline uint32_t
+pack_ids(uint16_t hi, uint16_t lo)
+{
+	return ((uint32_t)hi << CLS_PL_ID_BITS) | lo;
+}
+
+/* Source of a packet passed to workers, packed with pack_ids(). */
+static inline uint32_t *
+pkt_src(struct rte_mbuf *pkt)
+{
+	return RTE_MBUF_DYNFIELD(pkt, g_src_offset, uint32_t *);
+}
+
+/* Add a worker of `lcore_id` if it is not added yet. */
+static int
+add_worker(unsigned long lcore_id)
+{
+	if (lcore_id >= RTE_MAX_LCORE)
+		return -1;
+	if (g_worker_idx[lcore_id] >= 0)
+		return 0;
+
+	g_worker_idx[lcore_id] = g_nof_workers;
+	g_worker_lcores[g_nof_workers++] = lcore_id;
+	return 0;
+}
+
+int
+cls_pipeline_parse_workers(const char *str)
+{
+	unsigned long first, last;
+	char *endptr;
+
+	memset(g_worker_idx, -1, sizeof(g_worker_idx));
+	g_nof_workers = 0;
+
+	while (*str != '\0') {
+		errno = 0;
+		first = strtoul(str, &endptr, 10);
+		if (errno != 0 || endptr == str)
+			return -1;
+
+		last = first;
+		if (*endptr == '-') {
+			str = endptr + 1;
+			last = strtoul(str, &endptr, 10);
+			if (errno != 0 || endptr == str || last < first)
+				return -1;
+		}
+
+		for (; first <= last; first++) {
+			if (add_worker(first) != 0)
+				return -1;
+		}
+
+		if (*endptr == ',')
+			endptr++;
+		else if (*endptr != '\0')
+			return -1;
+		str = endptr;
+	}
+
+	return g_nof_workers > 0 ? 0 : -1;
+}
+
+/* Setup event port of `lcore_id`, which is linked to queue `qid`. */
+static int
+setup_ev_port(unsigned int lcore_id, uint8_t port_id, uint8_t qid)
+{
+	struct rte_event_port_conf conf;
+
+	if (rte_event_port_default_conf_get(g_evdev_id, port_id,
+				&conf) < 0 ||
+			rte_event_port_setup(g_evdev_id, port_id, &conf) < 0 ||
+			rte_event_port_link(g_evdev_id, port_id, &qid, NULL,
+				1) != 1) {
+		RTE_LOG(ERR, VF_CLS,
+				"Failed to setup event port %u of lcore %u.\n",
+				port_id, lcore_id);
+		return SPPWK_RET_NG;
+	}
+	g_ev_ports[lcore_id] = port_id;
+	return SPPWK_RET_OK;
+}
+
+/**
+ * Setup a queue of events to workers scheduled atomically for each of
+ * flows, and a single link queue back to each of lcores of classifiers.
+ */
+static int
+setup_ev_queues(unsigned int nb_queues)
+{
+	struct rte_event_queue_conf conf;
+	unsigned int qid;
+
+	for (qid = 0; qid < nb_queues; qid++) {
+		if (rte_event_queue_default_conf_get(g_evdev_id, qid,
+				&conf) < 0)
+			return SPPWK_RET_NG;
+
+		if (qid == CLS_PL_WORKER_QID) {
+			conf.event_queue_cfg = 0;
+			conf.schedule_type = RTE_SCHED_TYPE_ATOMIC;
+		} else
+			conf.event_queue_cfg = RTE_EVENT_QUEUE_CFG_SINGLE_LINK;
+
+		if (rte_event_queue_setup(g_evdev_id, qid, &conf) < 0) {
+			RTE_LOG(ERR, VF_CLS,
+					"Failed to setup event queue %u.\n",
+					qid);
+			return SPPWK_RET_NG;
+		}
+	}
+	return SPPWK_RET_OK;
+}
+
+int
+cls_pipeline_init(void)
+{
+	static const struct rte_mbuf_dynfield src_params = {
+		.name = CLS_PL_DYNFIELD_NAME,
+		.size = sizeof(uint32_t),
+		.align = __alignof__(uint32_t),
+	};
+	struct rte_event_dev_info info;
+	struct rte_event_dev_config conf;
+	unsigned int i, lcore_id;
+	unsigned int nb_queues = 1, nb_ports = 0;
+	int offset;
+
+	/* Both of IDs packed should fit in 20 bits of flow_id. */
+	RTE_BUILD_BUG_ON(RTE_MAX_LCORE > CLS_PL_ID_MASK + 1);
+	RTE_BUILD_BUG_ON(CLS_MAX_DESTS > CLS_PL_ID_MASK + 1);
+
+	if (g_nof_workers == 0)
+		return SPPWK_RET_OK;
+
+	if (rte_event_dev_count() == 0) {
+		RTE_LOG(ERR, VF_CLS, "No event device for workers, "
+				"such as `--vdev event_sw0`.\n");
+		return SPPWK_RET_NG;
+	}
+	g_evdev_id = 0;
+	rte_event_dev_info_get(g_evdev_id, &info);
+
+	memset(g_ev_ports, -1, sizeof(g_ev_ports));
+	for (i = 0; i < g_nof_workers; i++) {
+		lcore_id = g_worker_lcores[i];
+		if (!rte_lcore_is_enabled(lcore_id) ||
+				lcore_id == rte_get_master_lcore()) {
+			RTE_LOG(ERR, VF_CLS,
+					"Lcore %u cannot be a worker.\n",
+					lcore_id);
+			return SPPWK_RET_NG;
+		}
+		nb_ports++;
+	}
+
+	/* Classifiers can run on any of slave lcores other than workers. */
+	RTE_LCORE_FOREACH_SLAVE(lcore_id) {
+		if (g_worker_idx[lcore_id] >= 0)
+			continue;
+		nb_queues++;
+		nb_ports++;
+	}
+	if (nb_queues > info.max_event_queues ||
+			nb_ports > info.max_event_ports) {
+		RTE_LOG(ERR, VF_CLS, "Too many lcores for event device "
+				"(queues=%u, ports=%u).\n",
+				nb_queues, nb_ports);
+		return SPPWK_RET_NG;
+	}
+
+	memset(&conf, 0, sizeof(conf));
+	conf.nb_event_queues = nb_queues;
+	conf.nb_event_ports = nb_ports;
+	conf.nb_events_limit = info.max_num_events;
+	conf.nb_event_queue_flows = info.max_event_queue_flows;
+	conf.nb_event_port_dequeue_depth = info.max_event_port_dequeue_depth;
+	conf.nb_event_port_enqueue_depth = info.max_event_port_enqueue_depth;
+	conf.dequeue_timeout_ns = info.min_dequeue_timeout;
+	if (rte_event_dev_configure(g_evdev_id, &conf) < 0) {
+		RTE_LOG(ERR, VF_CLS, "Failed to configure event device.\n");
+		return SPPWK_RET_NG;
+	}
+
+	if (setup_ev_queues(nb_queues) != SPPWK_RET_OK)
+		return SPPWK_RET_NG;
+
+	/* Ports of workers, and then ones of lcores of classifiers. */
+	for (i = 0; i < g_nof_workers; i++) {
+		if (setup_ev_port(g_worker_lcores[i], i,
+				CLS_PL_WORKER_QID) != SPPWK_RET_OK)
+			return SPPWK_RET_NG;
+	}
+	nb_queues = 1;
+	RTE_LCORE_FOREACH_SLAVE(lcore_id) {
+		if (g_worker_idx[lcore_id] >= 0)
+			continue;
+		g_tx_qids[lcore_id] = nb_queues++;
+		if (setup_ev_port(lcore_id, i++, g_tx_qids[lcore_id]) !=
+				SPPWK_RET_OK)
+			return SPPWK_RET_NG;
+	}
+
+	offset = rte_mbuf_dynfield_register(&src_params);
+	if (offset < 0) {
+		RTE_LOG(ERR, VF_CLS, "Failed to register %s (%s).\n",
+				CLS_PL_DYNFIELD_NAME, rte_strerror(rte_errno));
+		return SPPWK_RET_NG;
+	}
+	g_src_offset = offset;
+
+	RTE_LOG(INFO, VF_CLS, "Classification is done by %u workers.\n",
+			g_nof_workers);
+	return SPPWK_RET_OK;
+}
+
+int
+cls_pipeline_start(void)
+{
+	uint32_t service_id;
+
+	if (g_nof_workers == 0)
+		return SPPWK_RET_OK;
+
+	/* Scheduler of software event device, such as event_sw. */
+	if (rte_event_dev_service_id_get(g_evdev_id, &service_id) == 0 &&
+			sppwk_map_ext_service(service_id) != SPPWK_RET_OK) {
+		RTE_LOG(ERR, VF_CLS, "Failed to run scheduler of event "
+				"device, which needs a service lcore.\n");
+		return SPPWK_RET_NG;
+	}
+
+	if (rte_event_dev_start(g_evdev_id) < 0) {
+		RTE_LOG(ERR, VF_CLS, "Failed to start event device.\n");
+		return SPPWK_RET_NG;
+	}
+	g_is_started = 1;
+	return SPPWK_RET_OK;
+}
+
+void
+cls_pipeline_fini(void)
+{
+	if (!g_is_started)
+		return;
+
+	rte_event_dev_stop(g_evdev_id);
+	rte_event_dev_close(g_evdev_id);
+	g_is_started = 0;
+}
+
+int
+cls_pipeline_enabled(void)
+{
+	return g_nof_workers > 0;
+}
+
+int
+cls_pipeline_is_worker(unsigned int lcore_id)
+{
+	return g_nof_workers > 0 && g_worker_idx[lcore_id] >= 0;
+}
+
+/* Enqueue events to the port, and release packets not enqueued. */
+static inline void
+enqueue_events(uint8_t port_id, struct rte_event *evs, uint16_t nb_evs)
+{
+	uint16_t i, nb_enq;
+
+	nb_enq = rte_event_enqueue_burst(g_evdev_id, port_id, evs, nb_evs);
+	if (unlikely(nb_enq < nb_evs)) {
+		for (i = nb_enq; i < nb_evs; i++)
+			rte_pktmbuf_free(evs[i].mbuf);
+		dp_event_add(DP_EVENT_RING_FULL, nb_evs - nb_enq);
+	}
+}
+
+/* Pass packets to workers, scheduled atomically by hash of flow. */
+void
+cls_pipeline_dispatch(int comp_id, struct rte_mbuf **pkts, uint16_t nb_pkts)
+{
+	uint16_t i;
+	unsigned int lcore_id = rte_lcore_id();
+	uint32_t src = pack_ids(lcore_id, comp_id);
+	struct rte_event evs[MAX_PKT_BURST];
+
+	for (i = 0; i < nb_pkts; i++) {
+		*pkt_src(pkts[i]) = src;
+		evs[i].event = 0;
+		evs[i].flow_id = get_flow_hash(pkts[i]);
+		evs[i].op = RTE_EVENT_OP_NEW;
+		evs[i].sched_type = RTE_SCHED_TYPE_ATOMIC;
+		evs[i].queue_id = CLS_PL_WORKER_QID;
+		evs[i].event_type = RTE_EVENT_TYPE_CPU;
+		evs[i].mbuf = pkts[i];
+	}
+	enqueue_events(g_ev_ports[lcore_id], evs, nb_pkts);
+}
+
+void
+cls_pipeline_work(unsigned int lcore_id)
+{
+	int j, comp_id, nof_dests;
+	uint16_t i, nb_evs, nb_outs = 0;
+	uint8_t port_id = g_ev_ports[lcore_id];
+	uint32_t src;
+	struct rte_event evs[MAX_PKT_BURST];
+	struct rte_event outs[MAX_PKT_BURST];
+	int dests[CLS_MAX_DESTS];
+
+	nb_evs = rte_event_dequeue_burst(g_evdev_id, port_id, evs,
+			MAX_PKT_BURST, 0);
+	if (nb_evs == 0)
+		return;
+	lcore_usage_add_rx(nb_evs);
+
+	/* Events not forwarded are released implicitly in next dequeue. */
+	for (i = 0; i < nb_evs; i++) {
+		src = *pkt_src(evs[i].mbuf);
+		comp_id = src & CLS_PL_ID_MASK;
+		nof_dests = select_cls_dests(comp_id, evs[i].mbuf, dests);
+
+		for (j = 0; j < nof_dests; j++) {
+			if (nb_outs == MAX_PKT_BURST) {
+				enqueue_events(port_id, outs, nb_outs);
+				nb_outs = 0;
+			}
+			/**
+			 * Copies for TX ports are new events, and the last
+			 * one is forwarded to release the atomic context of
+			 * the flow after all of them. Not ethdev port ID but
+			 * index of TX port is passed, because the port might
+			 * be retired while the packet is in the device.
+			 */
+			outs[nb_outs] = evs[i];
+			outs[nb_outs].op = (j == nof_dests - 1) ?
+				RTE_EVENT_OP_FORWARD : RTE_EVENT_OP_NEW;
+			outs[nb_outs].queue_id =
+				g_tx_qids[src >> CLS_PL_ID_BITS];
+			outs[nb_outs].flow_id = pack_ids(comp_id, dests[j]);
+			nb_outs++;
+		}
+	}
+
+	if (nb_outs > 0)
+		enqueue_events(port_id, outs, nb_outs);
+}
+
+/* Return 1 if the component is run on the lcore, or 0. */
+static inline int
+is_comp_on_lcore(const struct core_info *core, int comp_id)
+{
+	int i;
+
+	for (i = 0; i < core->num; i++) {
+		if (core->id[i] == comp_id)
+			return 1;
+	}
+	return 0;
+}
+
+void
+cls_pipeline_transmit(unsigned int lcore_id)
+{
+	int comp_id;
+	uint16_t i, j, nb_evs, nb_pkts, nb_tx;
+	struct rte_event evs[MAX_PKT_BURST];
+	struct rte_mbuf *pkts[MAX_PKT_BURST];
+	const struct core_info *core;
+	const struct cls_port_info *tx_port;
+	uint32_t flow_id;
+
+	if (g_ev_ports[lcore_id] < 0)
+		return;
+
+	nb_evs = rte_event_dequeue_burst(g_evdev_id, g_ev_ports[lcore_id],
+			evs, MAX_PKT_BURST, 0);
+	if (nb_evs == 0)
+		return;
+	core = get_core_info(lcore_id);
+
+	/* Send packets to the same TX port in a burst. */
+	for (i = 0; i < nb_evs; i = j) {
+		flow_id = evs[i].flow_id;
+		nb_pkts = 0;
+		for (j = i; j < nb_evs && evs[j].flow_id == flow_id; j++)
+			pkts[nb_pkts++] = evs[j].mbuf;
+
+		/**
+		 * TX port is taken from reference side of now, not of when
+		 * classified. Packets of a classifier stopped or moved to
+		 * another lcore are dropped, for not sending to a TX queue
+		 * from two lcores.
+		 */
+		comp_id = flow_id >> CLS_PL_ID_BITS;
+		if (likely(is_comp_on_lcore(core, comp_id)))
+			tx_port = get_cls_tx_port(comp_id,
+					flow_id & CLS_PL_ID_MASK);
+		else
+			tx_port = NULL;
+		if (unlikely(tx_port == NULL)) {
+			for (nb_tx = 0; nb_tx < nb_pkts; nb_tx++)
+				rte_pktmbuf_free(pkts[nb_tx]);
+			continue;
+		}
+
+		/* Latency and trace of TX are recorded in the wrapper. */
+		nb_tx = sppwk_eth_vlan_tx_burst(tx_port->ethdev_port_id,
+				tx_port->queue_no, pkts, nb_pkts);
+		if (unlikely(nb_tx < nb_pkts)) {
+			dp_event_add(DP_EVENT_TX_FULL, nb_pkts - nb_tx);
+			while (nb_tx < nb_pkts)
+				rte_pktmbuf_free(pkts[nb_tx++]);
+		}
+	}
+}
@@ -0,0 +1,85 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2020 Nippon Telegraph and Telephone Corporation
+ */
+
+#ifndef __CLS_PIPELINE_H__
+#define __CLS_PIPELINE_H__
+
+#include <rte_mbuf.h>
+
+/**
+ * @file
+ * SPP pipeline of classifier
+ *
+ * Classification of a classifier is spread to several worker lcores given
+ * as `--cls-workers`, for more than one core's worth of classification for
+ * a single RX port. Stages are built on an event device, such as event_sw
+ * given with EAL option `--vdev event_sw0`. The lcore of the classifier
+ * receives packets and passes them to workers as events, and workers pass
+ * them back after classified, then it sends them to TX ports.
+ *
+ * Events to workers are scheduled as RTE_SCHED_TYPE_ATOMIC for hash of the
+ * flow, so that packets of a flow are not classified on two workers at
+ * once and not reordered, while flows are spread to workers dynamically.
+ * Events back to the classifier are passed through a single link queue of
+ * the lcore, and only the lcore of classifier sends packets to its TX ports
+ * as without workers. The scheduler of event_sw runs as a service on one of
+ * service lcores given with EAL option `-s`.
+ */
+
+/**
+ * Parse lcores of workers given as `--cls-workers LCORES`, a comma
+ * separated list of lcore IDs or ranges, such as `4,5` or `4-7`.
+ *
+ * @param str Lcores of workers.
+ * @return 0 if succeeded, or -1.
+ */
+int cls_pipeline_parse_workers(const char *str);
+
+/**
+ * Configure the event device with a queue to workers and queues back to
+ * lcores of classifiers, and ports of them. It does nothing if no workers
+ * are given.
+ *
+ * @retval SPPWK_RET_OK If succeeded.
+ * @retval SPPWK_RET_NG If failed.
+ */
+int cls_pipeline_init(void);
+
+/**
+ * Map the scheduler of the event device to a service lcore if it needs,
+ * and start the device. It should be called after service lcores are
+ * started.
+ *
+ * @retval SPPWK_RET_OK If succeeded.
+ * @retval SPPWK_RET_NG If failed.
+ */
+int cls_pipeline_start(void);
+
+/* Stop the event device after lcores are stopped. */
+void cls_pipeline_fini(void);
+
+/* Return 1 if classification is done by workers, or 0. */
+int cls_pipeline_enabled(void);
+
+/* Return 1 if the lcore is a worker, which cannot run any component. */
+int cls_pipeline_is_worker(unsigned int lcore_id);
+
+/**
+ * Pass packets received by a classifier to workers. Packets not passed
+ * because the event device is full are dropped.
+ *
+ * @param comp_id Component ID of classifier.
+ * @param pkts Packets received.
+ * @param nb_pkts Num of packets.
+ */
+void cls_pipeline_dispatch(int comp_id, struct rte_mbuf **pkts,
+		uint16_t nb_pkts);
+
+/* Classify packets passed to the worker on `lcore_id`. */
+void cls_pipeline_work(unsigned int lcore_id);
+
+/* Send packets classified by workers for classifiers on `lcore_id`. */
+void cls_pipeline_transmit(unsigned int lcore_id);
+
+#endif /* __CLS_PIPELINE_H__ */
@@ -0,0 +1,398 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2020 Nippon Telegraph and Telephone Corporation
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <math.h>
+
+#include <rte_common.h>
+#include <rte_mbuf.h>
+#include <rte_malloc.h>
+#include <rte_log.h>
+
+#include "distributor.h"
+#include "flow_hash.h"
+#include "shared/secondary/return_codes.h"
+#include "shared/secondary/spp_worker_th/vf_deps.h"
+
+/**
+ * Number of buckets which hash of flow is mapped to. It should be power of
+ * two and much larger than the number of TX ports for accurate weighting.
+ */
+#define DIST_BUCKET_BITS 12
+#define NOF_DIST_BUCKETS (1 << DIST_BUCKET_BITS)
+#define DIST_BUCKET_SHIFT (32 - DIST_BUCKET_BITS)
+
+/* distributor component information */
+struct dist_comp_info {
+	char name[STR_LEN_NAME];  /* component name */
+	int nof_tx_ports;  /* Number of TX ports info entries. */
+	/* Distributor has one RX port and several TX ports. */
+	struct cls_port_info rx_port_i;  /* RX port info distributed. */
+	struct cls_port_info tx_ports_i[RTE_MAX_QUEUES_PER_PORT];
+	/* Weights of TX ports given explicitly, or 0 for default. */
+	int weights[RTE_MAX_QUEUES_PER_PORT];
+	/* Index of TX port for each of buckets. */
+	uint16_t buckets[NOF_DIST_BUCKETS];
+};
+
+/* distributor management information */
+struct dist_mng_info {
+	struct dist_comp_info comp_list[TWO_SIDES];
+	volatile int ref_index;  /* Flag for ref side */
+	volatile int upd_index;  /* Flag for update side */
+	volatile int is_used;
+};
+
+/* distributor information per component, allocated on update. */
+static struct dist_mng_info *dist_mng_info_list[RTE_MAX_LCORE];
+
+/* Initialize distributor information. */
+void
+init_distributor_info(int comp_id)
+{
+	int i;
+	struct dist_mng_info *mng_info = dist_mng_info_list[comp_id];
+
+	if (mng_info == NULL)
+		return;
+
+	mng_info->is_used = 0;
+	for (i = 0; i < TWO_SIDES; i++)
+		memset(mng_info->comp_list + i, 0,
+				sizeof(struct dist_comp_info));
+
+	mng_info->ref_index = 0;
+	mng_info->upd_index = 1;
+}
+
+/* Initialize globals of distributor. */
+int
+init_distributor_mng_info(void)
+{
+	int i;
+
+	for (i = 0; i < RTE_MAX_LCORE; i++) {
+		if (dist_mng_info_list[i] != NULL)
+			dist_mng_info_list[i]->upd_index = 1;
+	}
+	return SPPWK_RET_OK;
+}
+
+/* Get management info of component, or allocate it if it is not yet. */
+static struct dist_mng_info *
+get_dist_mng_info(const struct sppwk_comp_info *wk_comp_info)
+{
+	struct dist_mng_info *mng_info =
+			dist_mng_info_list[wk_comp_info->comp_id];
+
+	if (likely(mng_info != NULL))
+		return mng_info;
+
+	mng_info = rte_zmalloc_socket("dist_mng_info",
+			sizeof(struct dist_mng_info), RTE_CACHE_LINE_SIZE,
+			rte_lcore_to_socket_id(wk_comp_info->lcore_id));
+	if (unlikely(mng_info == NULL)) {
+		RTE_LOG(ERR, VF_CLS,
+				"Cannot alloc distributor info, id=%d.\n",
+				wk_comp_info->comp_id);
+		return NULL;
+	}
+	mng_info->upd_index = 1;
+	dist_mng_info_list[wk_comp_info->comp_id] = mng_info;
+	return mng_info;
+}
+
+/* Mix bits of 64-bit value, as finalizer of splitmix64. */
+static inline uint64_t
+mix64(uint64_t val)
+{
+	val ^= val >> 30;
+	val *= 0xbf58476d1ce4e5b9ULL;
+	val ^= val >> 27;
+	val *= 0x94d049bb133111ebULL;
+	val ^= val >> 31;
+	return val;
+}
+
+/**
+ * Key of TX port for rendezvous hashing. It is decided from the port
+ * itself, not from its index, so that buckets of remained ports are not
+ * moved even if the order of ports is changed.
+ */
+static inline uint64_t
+get_port_key(const struct cls_port_info *port_info)
+{
+	return mix64(((uint64_t)port_info->iface_type << 28) |
+			((uint64_t)port_info->iface_no_global << 16) |
+			(uint64_t)port_info->queue_no);
+}
+
+/**
+ * Assign each of buckets to a TX port with weighted rendezvous hashing.
+ * The score of port is `weight / -log(u)` for uniform random `u` decided
+ * from the pair of bucket and port, and the port of the highest score is
+ * taken. Each port gets buckets in proportion to its weight.
+ */
+static void
+build_bucket_table(struct dist_comp_info *cmp_info)
+{
+	int i, best_idx;
+	uint32_t bucket;
+	uint64_t hash;
+	uint64_t port_keys[RTE_MAX_QUEUES_PER_PORT];
+	double unit, score, best_score;
+	double weights[RTE_MAX_QUEUES_PER_PORT];
+
+	for (i = 0; i < cmp_info->nof_tx_ports; i++) {
+		port_keys[i] = get_port_key(&cmp_info->tx_ports_i[i]);
+		weights[i] = (cmp_info->weights[i] != 0) ?
+				cmp_info->weights[i] : 1;
+	}
+
+	for (bucket = 0; bucket < NOF_DIST_BUCKETS; bucket++) {
+		best_idx = 0;
+		best_score = -1.0;
+		for (i = 0; i < cmp_info->nof_tx_ports; i++) {
+			hash = mix64(((uint64_t)bucket << 32) ^ port_keys[i]);
+			/* Take upper 53 bits as a value in (0, 1). */
+			unit = ((double)(hash >> 11) + 0.5) /
+					(double)(1ULL << 53);
+			score = weights[i] / -log(unit);
+			if (score > best_score) {
+				best_score = score;
+				best_idx = i;
+			}
+		}
+		cmp_info->buckets[bucket] = best_idx;
+	}
+}
+
+/* initialize distributor information. */
+static void
+init_component_info(struct dist_comp_info *cmp_info,
+		const struct sppwk_comp_info *wk_comp_info)
+{
+	int i;
+	struct cls_port_info *rx_port_info = &cmp_info->rx_port_i;
+	struct cls_port_info *tx_ports_info = cmp_info->tx_ports_i;
+	struct sppwk_port_info *tx_port = NULL;
+
+	/* set rx */
+	rx_port_info->iface_type = UNDEF;
+	if (wk_comp_info->nof_rx != 0) {
+		rx_port_info->iface_type =
+			wk_comp_info->rx_ports[0]->iface_type;
+		rx_port_info->queue_no =
+			wk_comp_info->rx_ports[0]->queue_no;
+		rx_port_info->iface_no_global =
+			wk_comp_info->rx_ports[0]->iface_no;
+		rx_port_info->ethdev_port_id =
+			wk_comp_info->rx_ports[0]->ethdev_port_id;
+	}
+
+	/* set tx */
+	cmp_info->nof_tx_ports = wk_comp_info->nof_tx;
+	for (i = 0; i < wk_comp_info->nof_tx; i++) {
+		tx_port = wk_comp_info->tx_ports[i];
+
+		/* store ports information */
+		tx_ports_info[i].iface_type = tx_port->iface_type;
+		tx_ports_info[i].iface_no = i;
+		tx_ports_info[i].queue_no = tx_port->queue_no;
+		tx_ports_info[i].iface_no_global = tx_port->iface_no;
+		tx_ports_info[i].ethdev_port_id = tx_port->ethdev_port_id;
+		tx_ports_info[i].nof_pkts = 0;
+		cmp_info->weights[i] = tx_port->cls_attrs.weight;
+
+		RTE_LOG(INFO, VF_CLS,
+				"Add port to distributor. weight=%d, "
+				"iface_type=%d, iface_no=%d, queue_no=%d, "
+				"ethdev_port_id=%d\n",
+				tx_port->cls_attrs.weight,
+				tx_port->iface_type, tx_port->iface_no,
+				tx_port->queue_no, tx_port->ethdev_port_id);
+	}
+
+	if (cmp_info->nof_tx_ports > 0)
+		build_bucket_table(cmp_info);
+}
+
+/* Update distributor info with two-sided update as classifier. */
+int
+update_distributor(struct sppwk_comp_info *wk_comp_info)
+{
+	int wk_id = wk_comp_info->comp_id;
+	struct dist_mng_info *mng_info = get_dist_mng_info(wk_comp_info);
+	struct dist_comp_info *dist_info = NULL;
+
+	if (unlikely(mng_info == NULL))
+		return SPPWK_RET_NG;
+
+	RTE_LOG(INFO, VF_CLS,
+			"Start updating distributor, id=%u.\n", wk_id);
+
+	dist_info = mng_info->comp_list + mng_info->upd_index;
+
+	/**
+	 * Clean old one retired in previous flush. It is no longer referred
+	 * because a grace period has been passed in flush_cmd().
+	 */
+	memset(dist_info, 0, sizeof(struct dist_comp_info));
+
+	init_component_info(dist_info, wk_comp_info);
+	memcpy(dist_info->name, wk_comp_info->name, STR_LEN_NAME);
+
+	/* Publish update side as reference side. */
+	rte_smp_wmb();
+	mng_info->upd_index = mng_info->ref_index;
+	mng_info->ref_index = (mng_info->upd_index + 1) % TWO_SIDES;
+	mng_info->is_used = 1;
+
+	RTE_LOG(INFO, VF_CLS,
+			"Done update distributor, id=%u.\n", wk_id);
+
+	return SPPWK_RET_OK;
+}
+
+/* Distribute incoming packets on a thread of given `comp_id`. */
+int
+distribute_packets(int comp_id)
+{
+	int i, n_rx;
+	struct dist_mng_info *mng_info = dist_mng_info_list[comp_id];
+	struct dist_comp_info *cmp_info = NULL;
+	struct rte_mbuf *rx_pkts[MAX_PKT_BURST];
+	struct cls_port_info *rx_port_info = NULL;
+	uint16_t tx_idx;
+
+	/* Not updated if it is failed to alloc info. */
+	if (unlikely(mng_info == NULL))
+		return SPPWK_RET_OK;
+
+	cmp_info = mng_info->comp_list + mng_info->ref_index;
+	rx_port_info = &cmp_info->rx_port_i;
+
+	/* Check if it is ready to do distributing. */
+	if (!(rx_port_info->iface_type != UNDEF &&
+			cmp_info->nof_tx_ports >= 1))
+		return SPPWK_RET_OK;
+
+	n_rx = sppwk_eth_vlan_rx_burst(rx_port_info->ethdev_port_id,
+			rx_port_info->queue_no, rx_pkts, MAX_PKT_BURST);
+	if (unlikely(n_rx == 0))
+		return SPPWK_RET_OK;
+
+	/**
+	 * Upper bits of hash are used for bucket as get_tx_idx() of forwarder
+	 * because lower ones of RSS hash decide the RX queue.
+	 */
+	for (i = 0; i < n_rx; i++) {
+		tx_idx = cmp_info->buckets[get_flow_hash(rx_pkts[i]) >>
+				DIST_BUCKET_SHIFT];
+		push_packet(rx_pkts[i], cmp_info->tx_ports_i + tx_idx);
+	}
+
+	/**
+	 * Transmit all of distributed packets before returning, so that no
+	 * packets are left in reference side which might be retired while
+	 * flushing after the lcore reports its quiescent state.
+	 */
+	transmit_all_packet(cmp_info->tx_ports_i, cmp_info->nof_tx_ports);
+
+	return SPPWK_RET_OK;
+}
+
+/* distributor iterate component information */
+int
+get_distributor_status(unsigned int lcore_id, int id,
+		struct sppwk_lcore_params *lcore_params)
+{
+	int i;
+	int nof_tx, nof_rx = 0;  /* Num of RX and TX ports. */
+	struct dist_mng_info *mng_info;
+	struct dist_comp_info *cmp_info;
+	struct cls_port_info *port_info;
+	struct sppwk_port_idx rx_ports[RTE_MAX_QUEUES_PER_PORT];
+	struct sppwk_port_idx tx_ports[RTE_MAX_QUEUES_PER_PORT];
+
+	mng_info = dist_mng_info_list[id];
+	if (mng_info == NULL || !mng_info->is_used) {
+		RTE_LOG(ERR, VF_CLS,
+				"Distributor is not used "
+				"(comp_id=%d, lcore_id=%d, type=%d).\n",
+				id, lcore_id, SPPWK_TYPE_DIST);
+		return SPPWK_RET_NG;
+	}
+
+	cmp_info = mng_info->comp_list + mng_info->ref_index;
+	port_info = cmp_info->tx_ports_i;
+
+	memset(rx_ports, 0x00, sizeof(rx_ports));
+	if (cmp_info->rx_port_i.iface_type != UNDEF) {
+		nof_rx = 1;
+		rx_ports[0].iface_type = cmp_info->rx_port_i.iface_type;
+		rx_ports[0].iface_no = cmp_info->rx_port_i.iface_no_global;
+		rx_ports[0].queue_no = cmp_info->rx_port_i.queue_no;
+	}
+
+	memset(tx_ports, 0x00, sizeof(tx_ports));
+	nof_tx = cmp_info->nof_tx_ports;
+	for (i = 0; i < nof_tx; i++) {
+		tx_ports[i].iface_type = port_info[i].iface_type;
+		tx_ports[i].iface_no = port_info[i].iface_no_global;
+		tx_ports[i].queue_no = port_info[i].queue_no;
+	}
+
+	/* Set the information with the function specified by the command. */
+	if (unlikely((*lcore_params->lcore_proc)(lcore_params, lcore_id,
+			cmp_info->name, SPPWK_TYPE_DIST_STR,
+			nof_rx, rx_ports, nof_tx, tx_ports) != SPPWK_RET_OK))
+		return SPPWK_RET_NG;
+
+	return SPPWK_RET_OK;
+}
+
+/* Add weights of distributor for `status` command. */
+int
+add_distributor_table(struct classifier_table_params *params)
+{
+	int i, j;
+	struct dist_mng_info *mng_info;
+	struct dist_comp_info *cmp_info;
+	struct sppwk_port_idx port;
+	char weight_str[STR_LEN_SHORT];
+
+	for (i = 0; i < RTE_MAX_LCORE; i++) {
+		mng_info = dist_mng_info_list[i];
+		if (mng_info == NULL || !mng_info->is_used)
+			continue;
+
+		cmp_info = mng_info->comp_list + mng_info->ref_index;
+		for (j = 0; j < cmp_info->nof_tx_ports; j++) {
+			if (cmp_info->weights[j] == 0)
+				continue;
+
+			snprintf(weight_str, sizeof(weight_str), "%d",
+					cmp_info->weights[j]);
+
+			port.iface_type = cmp_info->tx_ports_i[j].iface_type;
+			port.iface_no =
+				cmp_info->tx_ports_i[j].iface_no_global;
+			port.queue_no = cmp_info->tx_ports_i[j].queue_no;
+
+			/**
+			 * `tbl_proc` is function pointer to
+			 * append_classifier_element_value().
+			 */
+			if (unlikely((*params->tbl_proc)(params,
+					SPPWK_CLS_TYPE_WEIGHT, ETH_VLAN_ID_MAX,
+					weight_str, &port) < SPPWK_RET_OK))
+				return SPPWK_RET_NG;
+		}
+	}
+
+	return SPPWK_RET_OK;
+}
@@ -0,0 +1,78 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2020 Nippon Telegraph and Telephone Corporation
+ */
+
+#ifndef __DISTRIBUTOR_H__
+#define __DISTRIBUTOR_H__
+
+#include "classifier.h"
+
+/**
+ * @file
+ * SPP Distributor
+ *
+ * Distributor component spreads packets from one port to several ports by
+ * hash of flow, as RSS of NIC. RSS hash given by the device is used if it
+ * is valid, or symmetric hash of 5-tuple is calculated in software, so that
+ * both of directions of a flow are sent to the same port. Hash is mapped to
+ * a port via table of buckets which are assigned with weighted rendezvous
+ * hashing. Each of TX ports has `weight` as its share of buckets, and only
+ * buckets of removed or added port are moved when ports are changed.
+ */
+
+/**
+ * Initialize globals of distributor.
+ *
+ * @retval SPPWK_RET_OK succeeded.
+ * @retval SPPWK_RET_NG failed.
+ */
+int init_distributor_mng_info(void);
+
+/**
+ * Initialize distributor information.
+ *
+ * @param comp_id The unique component ID.
+ */
+void init_distributor_info(int comp_id);
+
+/**
+ * Update distributor info.
+ *
+ * @param wk_comp_info Pointer to internal data of distributor.
+ * @retval SPPWK_RET_OK If succeeded.
+ * @retval SPPWK_RET_NG If failed.
+ */
+int update_distributor(struct sppwk_comp_info *wk_comp_info);
+
+/**
+ * Distribute incoming packets by hash of flow.
+ *
+ * @param comp_id Component ID.
+ * @retval SPPWK_RET_OK succeeded.
+ * @retval SPPWK_RET_NG failed.
+ */
+int distribute_packets(int comp_id);
+
+/**
+ * Get distributor status.
+ *
+ * @param[in] lcore_id Lcore ID for distributor.
+ * @param[in] id Unique component ID.
+ * @param[in,out] params Pointer to detailed data of distributor status.
+ * @retval SPPWK_RET_OK If succeeded.
+ * @retval SPPWK_RET_NG If failed.
+ */
+int get_distributor_status(unsigned int lcore_id, int id,
+		struct sppwk_lcore_params *params);
+
+/**
+ * Add weights of distributor for `classifier_table` of status. Only
+ * weights given explicitly are added.
+ *
+ * @param[in,out] params Object which has pointer of operation func and attrs.
+ * @retval SPPWK_RET_OK If succeeded.
+ * @retval SPPWK_RET_NG If failed.
+ */
+int add_distributor_table(struct classifier_table_params *params);
+
+#endif /* __DISTRIBUTOR_H__ */
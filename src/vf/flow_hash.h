@@ -0,0 +1,145 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2020 Nippon Telegraph and Telephone Corporation
+ */
+
+#ifndef __FLOW_HASH_H__
+#define __FLOW_HASH_H__
+
+#include <netinet/in.h>
+
+#include <rte_common.h>
+#include <rte_mbuf.h>
+#include <rte_byteorder.h>
+#include <rte_ether.h>
+#include <rte_ip.h>
+#include <rte_hash_crc.h>
+
+/**
+ * @file
+ * SPP hash of flow
+ *
+ * Hash of flow for spreading packets to several ports or queues, which is
+ * shared by distributor and forwarder.
+ */
+
+/* Initial value of CRC for software hash. */
+#define FLOW_HASH_INIT_VAL 0xffffffff
+
+/* Add a pair of values to hash in the same order for both directions. */
+static inline uint32_t
+add_sym_pair_32(uint32_t a, uint32_t b, uint32_t hash)
+{
+	hash = rte_hash_crc_4byte(RTE_MIN(a, b), hash);
+	return rte_hash_crc_4byte(RTE_MAX(a, b), hash);
+}
+
+/* Add a pair of byte strings to hash as add_sym_pair_32(). */
+static inline uint32_t
+add_sym_pair(const void *a, const void *b, uint32_t len, uint32_t hash)
+{
+	if (memcmp(a, b, len) > 0) {
+		hash = rte_hash_crc(b, len, hash);
+		return rte_hash_crc(a, len, hash);
+	}
+	hash = rte_hash_crc(a, len, hash);
+	return rte_hash_crc(b, len, hash);
+}
+
+/* Add L4 ports of TCP, UDP or SCTP at `off` of the packet to hash. */
+static inline uint32_t
+add_l4_ports(const struct rte_mbuf *pkt, uint32_t off, uint8_t proto,
+		uint32_t hash)
+{
+	const uint16_t *ports;
+
+	if (proto != IPPROTO_TCP && proto != IPPROTO_UDP &&
+			proto != IPPROTO_SCTP)
+		return hash;
+
+	/* Source and destination ports are the first in all of headers. */
+	if (unlikely(rte_pktmbuf_data_len(pkt) < off + 2 * sizeof(uint16_t)))
+		return hash;
+
+	ports = rte_pktmbuf_mtod_offset(pkt, const uint16_t *, off);
+	return add_sym_pair_32(ports[0], ports[1], hash);
+}
+
+/**
+ * Calculate symmetric hash of 5-tuple of the packet, in which source and
+ * destination are swappable. Hash of MAC addresses is used for non-IP
+ * packets instead.
+ */
+static inline uint32_t
+calc_sym_hash(const struct rte_mbuf *pkt)
+{
+	const struct rte_ether_hdr *eth;
+	const struct rte_vlan_hdr *vh;
+	const struct rte_ipv4_hdr *ip4;
+	const struct rte_ipv6_hdr *ip6;
+	uint16_t ether_type;
+	uint32_t off = sizeof(struct rte_ether_hdr);
+	uint32_t len = rte_pktmbuf_data_len(pkt);
+	uint32_t hash = FLOW_HASH_INIT_VAL;
+
+	eth = rte_pktmbuf_mtod(pkt, const struct rte_ether_hdr *);
+	ether_type = eth->ether_type;
+	if (ether_type == rte_cpu_to_be_16(RTE_ETHER_TYPE_VLAN) &&
+			likely(len >= off + sizeof(struct rte_vlan_hdr))) {
+		vh = rte_pktmbuf_mtod_offset(pkt, const struct rte_vlan_hdr *,
+				off);
+		ether_type = vh->eth_proto;
+		off += sizeof(struct rte_vlan_hdr);
+	}
+
+	if (ether_type == rte_cpu_to_be_16(RTE_ETHER_TYPE_IPV4) &&
+			likely(len >= off + sizeof(struct rte_ipv4_hdr))) {
+		ip4 = rte_pktmbuf_mtod_offset(pkt, const struct rte_ipv4_hdr *,
+				off);
+		hash = rte_hash_crc_1byte(ip4->next_proto_id, hash);
+		hash = add_sym_pair_32(ip4->src_addr, ip4->dst_addr, hash);
+
+		/**
+		 * Ports are not added for fragments, so that all of fragments
+		 * of a packet are sent to the same port.
+		 */
+		if (ip4->fragment_offset &
+				rte_cpu_to_be_16(RTE_IPV4_HDR_OFFSET_MASK |
+				RTE_IPV4_HDR_MF_FLAG))
+			return hash;
+
+		off += (ip4->version_ihl & RTE_IPV4_HDR_IHL_MASK) *
+				RTE_IPV4_IHL_MULTIPLIER;
+		return add_l4_ports(pkt, off, ip4->next_proto_id, hash);
+	}
+
+	if (ether_type == rte_cpu_to_be_16(RTE_ETHER_TYPE_IPV6) &&
+			likely(len >= off + sizeof(struct rte_ipv6_hdr))) {
+		ip6 = rte_pktmbuf_mtod_offset(pkt, const struct rte_ipv6_hdr *,
+				off);
+		hash = rte_hash_crc_1byte(ip6->proto, hash);
+		hash = add_sym_pair(ip6->src_addr, ip6->dst_addr,
+				sizeof(ip6->src_addr), hash);
+
+		off += sizeof(struct rte_ipv6_hdr);
+		return add_l4_ports(pkt, off, ip6->proto, hash);
+	}
+
+	hash = rte_hash_crc_2byte(ether_type, hash);
+	return add_sym_pair(&eth->s_addr, &eth->d_addr,
+			sizeof(struct rte_ether_addr), hash);
+}
+
+/**
+ * Get hash of flow of the packet. RSS hash is used if it is given by the
+ * device. It is symmetric only if the device is configured with symmetric
+ * RSS key.
+ */
+static inline uint32_t
+get_flow_hash(const struct rte_mbuf *pkt)
+{
+	if (pkt->ol_flags & PKT_RX_RSS_HASH)
+		return pkt->hash.rss;
+	return calc_sym_hash(pkt);
+}
+
+#endif /* __FLOW_HASH_H__ */
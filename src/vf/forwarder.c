@@ -3,50 +3,177 @@
  */
 
 #include <rte_cycles.h>
+#include <rte_ether.h>
+#include <rte_malloc.h>
 
 #include "forwarder.h"
+#include "flow_hash.h"
 #include "shared/secondary/return_codes.h"
+#include "shared/secondary/json_helper.h"
 #include "shared/secondary/spp_worker_th/vf_deps.h"
 #include "shared/secondary/spp_worker_th/port_capability.h"
 
 
 #define RTE_LOGTYPE_FORWARD RTE_LOGTYPE_USER1
 
+/**
+ * Quantum of wfq of merger in bytes for weight 1. A RX port can overdraw up
+ * to a burst, and it is paid back in next rounds.
+ */
+#define MRG_WFQ_QUANTUM (RTE_ETHER_MAX_LEN * 8)
+
 /* A set of port info of rx and tx */
 struct forward_rxtx {
 	struct sppwk_port_info rx; /* rx port */
 	struct sppwk_port_info tx; /* tx port */
 };
 
-/* Information on the path used for forward. */
+/* Counters of a RX port of merger. */
+struct merge_rx_stats {
+	uint64_t rx_pkts;  /* Packets received. */
+	uint64_t rx_bytes;  /* Bytes received. */
+	uint64_t tx_pkts;  /* Packets sent to TX port. */
+	uint64_t drop_pkts;  /* Packets dropped for failure of sending. */
+};
+
+/* Scheduling state of a RX port of merger. */
+struct merge_rx_sched {
+	int weight;  /* Weight of the port, or 1 if not given. */
+	int64_t deficit;  /* Bytes can be received in a round of wfq. */
+	struct merge_rx_stats stats;
+};
+
+/* TX burst coalescing packets from several RX ports of merger. */
+struct merge_tx_buf {
+	uint16_t nof_pkts;
+	struct rte_mbuf *pkts[SPPWK_BURST_MAX];
+	uint16_t rx_idx[SPPWK_BURST_MAX];  /* Index of RX port of packets. */
+};
+
+/**
+ * Information on the path used for forward. Arrays of ports are placed
+ * after this struct in the same allocation, and sized to the num of
+ * configured ports.
+ */
 struct forward_path {
 	char name[STR_LEN_NAME];  /* Component name */
 	volatile enum sppwk_worker_type wk_type;
 	int nof_rx;  /* Number of RX ports */
-	int nof_tx;  /* Number of TX ports */
-	struct forward_rxtx ports[RTE_MAX_ETHPORTS];  /* Set of RX and TX */
+	int nof_tx;  /* Number of TX ports, or queues of the same port */
+	uint16_t burst_size;  /* Max num of packets in a burst */
+	int max_ports;  /* Num of entries of arrays of ports */
+	struct forward_rxtx *ports;  /* Set of RX and TX */
+
+	/* Members for merger. They are updated by the lcore, except policy. */
+	enum sppwk_mrg_policy mrg_policy;  /* Scheduling policy of RX ports */
+	int next_rx;  /* RX port served at first in the next round. */
+	struct merge_rx_sched *sched;  /* For each RX port. */
+	int *prio_order;  /* RX ports in order of priority. */
 };
 
 /* Information for forward. */
 struct forward_info {
 	volatile int ref_index; /* index to reference area */
 	volatile int upd_index; /* index to update area    */
-	struct forward_path path[TWO_SIDES];
-				/* Information of data path */
+	struct forward_path *path[TWO_SIDES];
+				/* Information of data path, or NULL */
 };
 
-struct forward_info g_forward_info[RTE_MAX_LCORE];
+/**
+ * Info of components, allocated on the socket of the lcore of a component
+ * when it is updated for the first time. It is kept for reusing the ID.
+ */
+struct forward_info *g_forward_info[RTE_MAX_LCORE];
 
 /* Clear g_forward_info, ref and update indices. */
 void
 init_forwarder(void)
 {
 	int cnt = 0;
-	memset(&g_forward_info, 0x00, sizeof(g_forward_info));
 	for (cnt = 0; cnt < RTE_MAX_LCORE; cnt++) {
-		g_forward_info[cnt].ref_index = 0;
-		g_forward_info[cnt].upd_index = 1;
+		if (g_forward_info[cnt] == NULL)
+			continue;
+		rte_free(g_forward_info[cnt]->path[0]);
+		rte_free(g_forward_info[cnt]->path[1]);
+		memset(g_forward_info[cnt], 0x00, sizeof(struct forward_info));
+		g_forward_info[cnt]->ref_index = 0;
+		g_forward_info[cnt]->upd_index = 1;
+	}
+}
+
+/* Size of forward_path including arrays for `max_ports` ports. */
+static inline size_t
+get_forward_path_size(int max_ports)
+{
+	return sizeof(struct forward_path) + max_ports *
+		(sizeof(struct forward_rxtx) +
+		 sizeof(struct merge_rx_sched) + sizeof(int));
+}
+
+/* Clear path, and set arrays of ports placed after the struct. */
+static void
+reset_forward_path(struct forward_path *path, int max_ports)
+{
+	memset(path, 0x00, get_forward_path_size(max_ports));
+	path->max_ports = max_ports;
+	path->ports = (struct forward_rxtx *)(path + 1);
+	path->sched = (struct merge_rx_sched *)(path->ports + max_ports);
+	path->prio_order = (int *)(path->sched + max_ports);
+}
+
+/**
+ * Get update side of path for `nof_ports` ports. It is allocated again on
+ * the socket of the lcore if it is not enough. Update side is not referred
+ * by the lcore after a grace period, so it is freed safely.
+ */
+static struct forward_path *
+prepare_forward_path(struct forward_info *info,
+		const struct sppwk_comp_info *comp_info, int nof_ports)
+{
+	struct forward_path *path = info->path[info->upd_index];
+
+	if (nof_ports < 1)
+		nof_ports = 1;
+	if (path != NULL && path->max_ports >= nof_ports) {
+		reset_forward_path(path, path->max_ports);
+		return path;
 	}
+
+	path = rte_malloc_socket("forward_path",
+			get_forward_path_size(nof_ports), RTE_CACHE_LINE_SIZE,
+			rte_lcore_to_socket_id(comp_info->lcore_id));
+	if (unlikely(path == NULL)) {
+		RTE_LOG(ERR, FORWARD, "Failed to alloc path (id=%d).\n",
+				comp_info->comp_id);
+		return NULL;
+	}
+	reset_forward_path(path, nof_ports);
+	rte_free(info->path[info->upd_index]);
+	info->path[info->upd_index] = path;
+	return path;
+}
+
+/* Get info of component, or allocate it if it is not allocated yet. */
+static struct forward_info *
+get_forward_info(const struct sppwk_comp_info *comp_info)
+{
+	struct forward_info *info = g_forward_info[comp_info->comp_id];
+
+	if (likely(info != NULL))
+		return info;
+
+	info = rte_zmalloc_socket("forward_info", sizeof(struct forward_info),
+			RTE_CACHE_LINE_SIZE,
+			rte_lcore_to_socket_id(comp_info->lcore_id));
+	if (unlikely(info == NULL)) {
+		RTE_LOG(ERR, FORWARD, "Failed to alloc info (id=%d).\n",
+				comp_info->comp_id);
+		return NULL;
+	}
+	info->ref_index = 0;
+	info->upd_index = 1;
+	g_forward_info[comp_info->comp_id] = info;
+	return info;
 }
 
 /* Get forwarder status. */
@@ -57,11 +184,22 @@ get_forwarder_status(unsigned int lcore_id, int id,
 	int ret = SPPWK_RET_NG;
 	int cnt;
 	const char *component_type = NULL;
-	struct forward_info *fwd_info = &g_forward_info[id];
-	struct forward_path *fwd_path = &fwd_info->path[fwd_info->ref_index];
+	struct forward_info *fwd_info = g_forward_info[id];
+	struct forward_path *fwd_path;
 	struct sppwk_port_idx rx_ports[RTE_MAX_QUEUES_PER_PORT];
 	struct sppwk_port_idx tx_ports[RTE_MAX_QUEUES_PER_PORT];
 
+	if (unlikely(fwd_info == NULL)) {
+		RTE_LOG(ERR, FORWARD, "Forwarder is not updated. "
+				"(id=%d, lcore=%d).\n", id, lcore_id);
+		return SPPWK_RET_NG;
+	}
+	fwd_path = fwd_info->path[fwd_info->ref_index];
+	if (unlikely(fwd_path == NULL)) {
+		RTE_LOG(ERR, FORWARD, "Forwarder is not updated. "
+				"(id=%d, lcore=%d).\n", id, lcore_id);
+		return SPPWK_RET_NG;
+	}
 	if (unlikely(fwd_path->wk_type == SPPWK_TYPE_NONE)) {
 		RTE_LOG(ERR, FORWARD,
 				"Forwarder is not used. "
@@ -99,21 +237,74 @@ get_forwarder_status(unsigned int lcore_id, int id,
 	return SPPWK_RET_OK;
 }
 
+/* Return 1 as true if given ports are the same. */
+static inline int
+is_same_port(const struct sppwk_port_info *a,
+		const struct sppwk_port_info *b)
+{
+	return a->iface_type == b->iface_type &&
+		a->iface_no == b->iface_no &&
+		a->queue_no == b->queue_no;
+}
+
+/**
+ * Setup scheduling of RX ports of merger. Counters of RX ports remained in
+ * the merger are taken over from reference side, but packets counted by
+ * the lcore while taking over are lost.
+ */
+static void
+init_merge_sched(struct forward_path *fwd_path,
+		const struct forward_path *ref_path,
+		const struct sppwk_comp_info *comp_info)
+{
+	int i, j, weight;
+	int is_same_comp = (ref_path != NULL) &&
+		(ref_path->wk_type == SPPWK_TYPE_MRG) &&
+		(strcmp(ref_path->name, fwd_path->name) == 0);
+
+	fwd_path->mrg_policy = comp_info->mrg_policy;
+	for (i = 0; i < fwd_path->nof_rx; i++) {
+		weight = comp_info->rx_ports[i]->cls_attrs.weight;
+		fwd_path->sched[i].weight = (weight != 0) ? weight : 1;
+
+		for (j = 0; is_same_comp && j < ref_path->nof_rx; j++) {
+			if (is_same_port(&fwd_path->ports[i].rx,
+					&ref_path->ports[j].rx)) {
+				fwd_path->sched[i].stats =
+					ref_path->sched[j].stats;
+				break;
+			}
+		}
+
+		/* Insert to sorted order of priority, stable for ties. */
+		for (j = i; j > 0; j--) {
+			if (fwd_path->sched[fwd_path->prio_order[j - 1]].weight
+					>= fwd_path->sched[i].weight)
+				break;
+			fwd_path->prio_order[j] = fwd_path->prio_order[j - 1];
+		}
+		fwd_path->prio_order[j] = i;
+	}
+}
+
 /* Update forward info */
 int
 update_forwarder(struct sppwk_comp_info *comp_info)
 {
 	int cnt = 0;
+	int i;
 	int nof_rx = comp_info->nof_rx;
 	int nof_tx = comp_info->nof_tx;
-	int max = (nof_rx > nof_tx)?nof_rx*nof_tx:nof_tx;
-	struct forward_info *fwd_info = &g_forward_info[comp_info->comp_id];
+	struct forward_info *fwd_info = get_forward_info(comp_info);
 	/* TODO(yasufum) rename `path` of struct forward_path. */
-	struct forward_path *fwd_path = &fwd_info->path[fwd_info->upd_index];
+	struct forward_path *fwd_path;
+
+	if (unlikely(fwd_info == NULL))
+		return SPPWK_RET_NG;
 
 	/**
-	 * Check num of RX and TX ports because forwarder has just a set of
-	 * RX and TX.
+	 * Check num of RX and TX ports because forwarder has just a RX port,
+	 * and TX ports are up to the size of `ends` of spread_tx_burst().
 	 */
 	if ((comp_info->wk_type == SPPWK_TYPE_FWD) &&
 			unlikely(nof_rx > 1)) {
@@ -123,15 +314,49 @@ update_forwarder(struct sppwk_comp_info *comp_info)
 			comp_info->comp_id, comp_info->wk_type, nof_rx);
 		return SPPWK_RET_NG;
 	}
-	if (unlikely(nof_tx != 0) && unlikely(nof_tx != 1)) {
+	if (unlikely(nof_rx > RTE_MAX_ETHPORTS) ||
+			unlikely(nof_tx > RTE_MAX_ETHPORTS)) {
 		RTE_LOG(ERR, FORWARD,
-			"Invalid forwarder type or num of TX ports "
-			"(id=%d, type=%d, nof_tx=%d).\n",
-			comp_info->comp_id, comp_info->wk_type, nof_tx);
+			"Invalid forwarder type or num of ports "
+			"(id=%d, type=%d, nof_rx=%d, nof_tx=%d).\n",
+			comp_info->comp_id, comp_info->wk_type,
+			nof_rx, nof_tx);
 		return SPPWK_RET_NG;
 	}
 
-	memset(fwd_path, 0x00, sizeof(struct forward_path));
+	/**
+	 * Several TX ports are accepted only as different queues of the same
+	 * port, because each of queues must have a single writer.
+	 */
+	for (cnt = 1; cnt < nof_tx; cnt++) {
+		if (unlikely(comp_info->tx_ports[cnt]->iface_type !=
+				comp_info->tx_ports[0]->iface_type) ||
+				unlikely(comp_info->tx_ports[cnt]->iface_no !=
+				comp_info->tx_ports[0]->iface_no)) {
+			RTE_LOG(ERR, FORWARD,
+				"TX ports are not queues of the same port "
+				"(id=%d, type=%d, nof_tx=%d).\n",
+				comp_info->comp_id, comp_info->wk_type,
+				nof_tx);
+			return SPPWK_RET_NG;
+		}
+		for (i = 0; i < cnt; i++) {
+			if (likely(comp_info->tx_ports[cnt]->queue_no !=
+					comp_info->tx_ports[i]->queue_no))
+				continue;
+			RTE_LOG(ERR, FORWARD,
+				"TX queue is given twice "
+				"(id=%d, type=%d, queue_no=%d).\n",
+				comp_info->comp_id, comp_info->wk_type,
+				comp_info->tx_ports[cnt]->queue_no);
+			return SPPWK_RET_NG;
+		}
+	}
+
+	fwd_path = prepare_forward_path(fwd_info, comp_info,
+			RTE_MAX(nof_rx, nof_tx));
+	if (unlikely(fwd_path == NULL))
+		return SPPWK_RET_NG;
 
 	RTE_LOG(INFO, FORWARD,
 			"Start updating forwarder (id=%d, name=%s, type=%d)\n",
@@ -142,18 +367,28 @@ update_forwarder(struct sppwk_comp_info *comp_info)
 	fwd_path->wk_type = comp_info->wk_type;
 	fwd_path->nof_rx = comp_info->nof_rx;
 	fwd_path->nof_tx = comp_info->nof_tx;
+	fwd_path->burst_size = (comp_info->burst_size != 0) ?
+			comp_info->burst_size : MAX_PKT_BURST;
 	for (cnt = 0; cnt < nof_rx; cnt++)
 		memcpy(&fwd_path->ports[cnt].rx, comp_info->rx_ports[cnt],
 				sizeof(struct sppwk_port_info));
 
-	/* TX port is set according with larger nof_rx / nof_tx. */
-	for (cnt = 0; cnt < max; cnt++)
-		memcpy(&fwd_path->ports[cnt].tx, comp_info->tx_ports[0],
+	for (cnt = 0; cnt < nof_tx; cnt++)
+		memcpy(&fwd_path->ports[cnt].tx, comp_info->tx_ports[cnt],
 				sizeof(struct sppwk_port_info));
 
+	if (comp_info->wk_type == SPPWK_TYPE_MRG)
+		init_merge_sched(fwd_path,
+				fwd_info->path[fwd_info->ref_index],
+				comp_info);
+
+	/**
+	 * Publish update side. Retired side is reused after a grace period
+	 * waited in flush_cmd().
+	 */
+	rte_smp_wmb();
 	fwd_info->upd_index = fwd_info->ref_index;
-	while (likely(fwd_info->ref_index == fwd_info->upd_index))
-		rte_delay_us_block(SPPWK_UPDATE_INTERVAL);
+	fwd_info->ref_index = (fwd_info->upd_index + 1) % TWO_SIDES;
 
 	RTE_LOG(INFO, FORWARD,
 			"Done update forwarder. (id=%d, name=%s, type=%d)\n",
@@ -163,18 +398,282 @@ update_forwarder(struct sppwk_comp_info *comp_info)
 	return SPPWK_RET_OK;
 }
 
-/* Change index of forward info */
+/**
+ * Count packets sent or dropped for each of RX ports of merger. Packets
+ * failed in VLAN operation are moved to the tail of `pkts`, so input of
+ * remained ones is found from the order before sending in `orig_pkts`.
+ */
 static inline void
-change_forward_index(int id)
+count_merged_pkts(struct forward_path *path, struct rte_mbuf **pkts,
+		struct rte_mbuf **orig_pkts, const uint16_t *rx_idx,
+		uint16_t nb_pkts, uint16_t nb_tx)
 {
-	struct forward_info *info = &g_forward_info[id];
-	if (info->ref_index == info->upd_index) {
-		/* Change reference index of port ability. */
-		sppwk_swap_two_sides(SPPWK_SWAP_REF, 0, 0);
+	int i, j;
+	uint8_t dropped[SPPWK_BURST_MAX];
 
-		info->ref_index = (info->upd_index+1) % TWO_SIDES;
+	if (likely(nb_tx == nb_pkts)) {
+		for (j = 0; j < nb_pkts; j++)
+			path->sched[rx_idx[j]].stats.tx_pkts++;
+		return;
 	}
+
+	memset(dropped, 0, nb_pkts);
+	for (i = nb_tx; i < nb_pkts; i++) {
+		for (j = 0; j < nb_pkts; j++) {
+			if (orig_pkts[j] == pkts[i])
+				break;
+		}
+		dropped[j] = 1;
+		path->sched[rx_idx[j]].stats.drop_pkts++;
+	}
+
+	for (j = 0; j < nb_pkts; j++) {
+		if (!dropped[j])
+			path->sched[rx_idx[j]].stats.tx_pkts++;
+	}
+}
+
+/**
+ * Send packets to TX port of `tx_idx` and discard remained ones. If
+ * `rx_idx` is given as merger, packets are counted for each of RX ports.
+ */
+static inline void
+send_tx_queue(struct forward_path *path, int tx_idx,
+		struct rte_mbuf **pkts, const uint16_t *rx_idx,
+		uint16_t nb_pkts)
+{
+	int i;
+	int nb_tx = 0;
+	struct sppwk_port_info *tx = &path->ports[tx_idx].tx;
+	struct rte_mbuf *orig_pkts[SPPWK_BURST_MAX];
+
+	/* Order of packets is changed if VLAN operation is failed. */
+	if (rx_idx != NULL)
+		memcpy(orig_pkts, pkts, sizeof(*pkts) * nb_pkts);
+
+	if (tx->ethdev_port_id >= 0)
+		nb_tx = sppwk_eth_vlan_tx_burst(tx->ethdev_port_id,
+				tx->queue_no, pkts, nb_pkts);
+
+	if (rx_idx != NULL)
+		count_merged_pkts(path, pkts, orig_pkts, rx_idx, nb_pkts,
+				nb_tx);
+
+	/* Discard remained packets to release mbuf */
+	for (i = nb_tx; i < nb_pkts; i++)
+		rte_pktmbuf_free(pkts[i]);
 }
+
+/**
+ * Get index of TX queue of the packet from hash of flow. Upper bits of
+ * hash are used because lower ones of RSS hash decide the RX queue, and
+ * packets from a RX queue would go to the same TX queue with them.
+ */
+static inline int
+get_tx_idx(const struct rte_mbuf *pkt, int nof_tx)
+{
+	return ((uint64_t)get_flow_hash(pkt) * nof_tx) >> 32;
+}
+
+/**
+ * Send packets to TX queues by hash of flow. Packets are sorted for each
+ * of TX queues with counting sort for sending in bursts, and the order of
+ * packets in a flow is kept.
+ */
+static void
+spread_tx_burst(struct forward_path *path, struct rte_mbuf **pkts,
+		const uint16_t *rx_idx, uint16_t nb_pkts)
+{
+	int i, tx_idx;
+	uint16_t pos;
+	uint16_t start = 0;
+	uint16_t ends[RTE_MAX_ETHPORTS + 1];
+	uint8_t pkt_tx_idx[SPPWK_BURST_MAX];
+	struct rte_mbuf *sorted[SPPWK_BURST_MAX];
+	uint16_t sorted_rx_idx[SPPWK_BURST_MAX];
+
+	memset(ends, 0x00, sizeof(uint16_t) * (path->nof_tx + 1));
+	sppwk_prefetch_burst_hdrs(pkts, nb_pkts);
+	for (i = 0; i < nb_pkts; i++) {
+		sppwk_prefetch_next_hdr(pkts, i, nb_pkts);
+		pkt_tx_idx[i] = get_tx_idx(pkts[i], path->nof_tx);
+		ends[pkt_tx_idx[i] + 1]++;
+	}
+	for (tx_idx = 1; tx_idx < path->nof_tx; tx_idx++)
+		ends[tx_idx] += ends[tx_idx - 1];
+
+	/* Each of `ends` is moved to the end of packets of its queue. */
+	for (i = 0; i < nb_pkts; i++) {
+		pos = ends[pkt_tx_idx[i]]++;
+		sorted[pos] = pkts[i];
+		if (rx_idx != NULL)
+			sorted_rx_idx[pos] = rx_idx[i];
+	}
+
+	for (tx_idx = 0; tx_idx < path->nof_tx; tx_idx++) {
+		if (ends[tx_idx] > start)
+			send_tx_queue(path, tx_idx, &sorted[start],
+					(rx_idx != NULL) ?
+					&sorted_rx_idx[start] : NULL,
+					ends[tx_idx] - start);
+		start = ends[tx_idx];
+	}
+}
+
+/* Send packets to TX port, or spread them if it has several queues. */
+static inline void
+send_packets(struct forward_path *path, struct rte_mbuf **pkts,
+		const uint16_t *rx_idx, uint16_t nb_pkts)
+{
+	if (likely(path->nof_tx == 1))
+		send_tx_queue(path, 0, pkts, rx_idx, nb_pkts);
+	else
+		spread_tx_burst(path, pkts, rx_idx, nb_pkts);
+}
+
+/* Send coalesced packets of merger and count them for each of RX ports. */
+static inline void
+merge_flush_tx(struct forward_path *path, struct merge_tx_buf *txb)
+{
+	if (txb->nof_pkts == 0)
+		return;
+
+	send_packets(path, txb->pkts, txb->rx_idx, txb->nof_pkts);
+	txb->nof_pkts = 0;
+}
+
+/**
+ * Receive a burst from RX port of `rx_idx` of merger and append it to TX
+ * burst, which is sent if it is filled. Return the number of received
+ * packets, and the total length of them as `bytes`.
+ */
+static inline int
+merge_rx_burst(struct forward_path *path, struct merge_tx_buf *txb,
+		int rx_idx, uint64_t *bytes)
+{
+	int i, nb_rx;
+	uint64_t len = 0;
+	struct sppwk_port_info *rx = &path->ports[rx_idx].rx;
+	struct merge_rx_stats *stats = &path->sched[rx_idx].stats;
+	struct rte_mbuf *bufs[SPPWK_BURST_MAX];
+
+	nb_rx = sppwk_eth_vlan_rx_burst(rx->ethdev_port_id,
+			rx->queue_no, bufs, path->burst_size);
+
+	for (i = 0; i < nb_rx; i++) {
+		len += rte_pktmbuf_pkt_len(bufs[i]);
+		txb->pkts[txb->nof_pkts] = bufs[i];
+		txb->rx_idx[txb->nof_pkts] = rx_idx;
+		if (++txb->nof_pkts == path->burst_size)
+			merge_flush_tx(path, txb);
+	}
+
+	stats->rx_pkts += nb_rx;
+	stats->rx_bytes += len;
+	*bytes = len;
+	return nb_rx;
+}
+
+/**
+ * Round robin, in which each of RX ports receives bursts up to its weight
+ * as a quota in a round. A port is skipped if it is drained.
+ */
+static void
+merge_rr(struct forward_path *path, struct merge_tx_buf *txb)
+{
+	int cnt, idx, quota;
+	uint64_t bytes;
+
+	for (cnt = 0; cnt < path->nof_rx; cnt++) {
+		idx = (path->next_rx + cnt) % path->nof_rx;
+		for (quota = path->sched[idx].weight; quota > 0; quota--) {
+			if (merge_rx_burst(path, txb, idx, &bytes) <
+					path->burst_size)
+				break;
+		}
+	}
+}
+
+/**
+ * Weighted fair queuing as deficit round robin in bytes. Each of RX ports
+ * gets quantum in proportion to its weight in a round, and receives bursts
+ * until it is used up. Overdraft of the last burst is carried to the next
+ * round, but credit of drained port is not kept.
+ */
+static void
+merge_wfq(struct forward_path *path, struct merge_tx_buf *txb)
+{
+	int cnt, idx, nb_rx;
+	uint64_t bytes;
+	struct merge_rx_sched *sched;
+
+	for (cnt = 0; cnt < path->nof_rx; cnt++) {
+		idx = (path->next_rx + cnt) % path->nof_rx;
+		sched = &path->sched[idx];
+		sched->deficit += (int64_t)sched->weight * MRG_WFQ_QUANTUM;
+		while (sched->deficit > 0) {
+			nb_rx = merge_rx_burst(path, txb, idx, &bytes);
+			sched->deficit -= bytes;
+			if (nb_rx < path->burst_size) {
+				if (sched->deficit > 0)
+					sched->deficit = 0;
+				break;
+			}
+		}
+	}
+}
+
+/**
+ * Strict priority, in which RX ports of larger weight are served first.
+ * Bursts as many as RX ports are received in a round, and lower ports are
+ * served only if higher ones are drained.
+ */
+static void
+merge_prio(struct forward_path *path, struct merge_tx_buf *txb)
+{
+	int cnt, idx;
+	int budget = path->nof_rx;
+	uint64_t bytes;
+
+	for (cnt = 0; cnt < path->nof_rx && budget > 0; cnt++) {
+		idx = path->prio_order[cnt];
+		while (budget > 0) {
+			budget--;
+			if (merge_rx_burst(path, txb, idx, &bytes) <
+					path->burst_size)
+				break;
+		}
+	}
+}
+
+/* Merge packets from RX ports with the policy as a round. */
+static void
+merge_packets(struct forward_path *path)
+{
+	struct merge_tx_buf txb;
+
+	txb.nof_pkts = 0;
+	switch (path->mrg_policy) {
+	case SPPWK_MRG_POLICY_WFQ:
+		merge_wfq(path, &txb);
+		break;
+	case SPPWK_MRG_POLICY_PRIO:
+		merge_prio(path, &txb);
+		break;
+	default:
+		merge_rr(path, &txb);
+		break;
+	}
+	path->next_rx = (path->next_rx + 1) % path->nof_rx;
+
+	/**
+	 * Send remained packets before returning, so that no packets are left
+	 * in reference side which might be retired after the lcore reports
+	 * its quiescent state.
+	 */
+	merge_flush_tx(path, &txb);
+}
+
 /**
  * Forward packets as forwarder or merger.
  *
@@ -184,52 +683,133 @@ change_forward_index(int id)
 int
 forward_packets(int id)
 {
-	int cnt, buf;
+	int cnt;
 	int nb_rx = 0;
-	int nb_tx = 0;
-	struct forward_info *info = &g_forward_info[id];
+	struct forward_info *info = g_forward_info[id];
 	struct forward_path *path = NULL;
 	struct sppwk_port_info *rx;
-	struct sppwk_port_info *tx;
-	struct rte_mbuf *bufs[MAX_PKT_BURST];
+	struct rte_mbuf *bufs[SPPWK_BURST_MAX];
 
-	change_forward_index(id);
-	path = &info->path[info->ref_index];
+	/* Not updated if it is failed to alloc info. */
+	if (unlikely(info == NULL))
+		return SPPWK_RET_OK;
+	path = info->path[info->ref_index];
+	if (unlikely(path == NULL))
+		return SPPWK_RET_OK;
 
 	/* Practice condition check */
 	if (path->wk_type == SPPWK_TYPE_MRG) {
 		/* merger */
-		if (!(path->nof_tx == 1 && path->nof_rx >= 1))
+		if (!(path->nof_tx >= 1 && path->nof_rx >= 1))
 			return SPPWK_RET_OK;
+		merge_packets(path);
+		return SPPWK_RET_OK;
 	} else {
 		/* forwarder */
-		if (!(path->nof_tx == 1 && path->nof_rx == 1))
+		if (!(path->nof_tx >= 1 && path->nof_rx == 1))
 			return SPPWK_RET_OK;
 	}
 
 	for (cnt = 0; cnt < path->nof_rx; cnt++) {
 		rx = &path->ports[cnt].rx;
-		tx = &path->ports[cnt].tx;
-
 
 		nb_rx = sppwk_eth_vlan_rx_burst(rx->ethdev_port_id,
-				rx->queue_no, bufs, MAX_PKT_BURST);
+				rx->queue_no, bufs, path->burst_size);
 
 		if (unlikely(nb_rx == 0))
 			continue;
 
-		/* Send packets */
-		if (tx->ethdev_port_id >= 0)
+		/* Send packets, and discard remained ones to release mbuf */
+		send_packets(path, bufs, NULL, nb_rx);
+	}
+	return SPPWK_RET_OK;
+}
 
-			nb_tx = sppwk_eth_vlan_tx_burst(tx->ethdev_port_id,
-					tx->queue_no, bufs, nb_rx);
+/* Append counters of a RX port of merger to given JSON string. */
+static int
+append_merge_rx_value(char **output, const struct sppwk_port_info *rx,
+		const struct merge_rx_sched *sched)
+{
+	int ret;
+	char port_str[CMD_TAG_APPEND_SIZE];
+
+	sppwk_port_uid(port_str, rx->iface_type, rx->iface_no, rx->queue_no);
+	ret = append_json_begin_block(output, "");
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_str_value(output, "port", port_str);
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_int_value(output, "weight", sched->weight);
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_uint64_value(output, "rx_pkts",
+				sched->stats.rx_pkts);
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_uint64_value(output, "rx_bytes",
+				sched->stats.rx_bytes);
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_uint64_value(output, "tx_pkts",
+				sched->stats.tx_pkts);
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_uint64_value(output, "drop_pkts",
+				sched->stats.drop_pkts);
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_end_block(output);
+	return ret;
+}
 
+/* Append policy and counters of a merger to given JSON string. */
+static int
+append_merge_value(char **output, const struct forward_path *path)
+{
+	int cnt;
+	int ret;
+
+	ret = append_json_begin_block(output, "");
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_str_value(output, "name", path->name);
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_str_value(output, "policy",
+				sppwk_mrg_policy_str(path->mrg_policy));
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_begin_array(output, "rx_port");
+	for (cnt = 0; ret == SPPWK_RET_OK && cnt < path->nof_rx; cnt++)
+		ret = append_merge_rx_value(output, &path->ports[cnt].rx,
+				&path->sched[cnt]);
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_end_array(output);
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_end_block(output);
+	return ret;
+}
 
-		/* Discard remained packets to release mbuf */
-		if (unlikely(nb_tx < nb_rx)) {
-			for (buf = nb_tx; buf < nb_rx; buf++)
-				rte_pktmbuf_free(bufs[buf]);
-		}
+/* Add policy and counters of RX ports of mergers in JSON. */
+int
+add_merge_stats(const char *name, char **output,
+		void *tmp __attribute__ ((unused)))
+{
+	int cnt;
+	int ret = SPPWK_RET_OK;
+	struct sppwk_comp_info *comp_info_base = NULL;
+	struct forward_info *fwd_info;
+	struct forward_path *path;
+
+	ret = append_json_begin_array(output, name);
+	sppwk_get_mng_data(NULL, &comp_info_base, NULL, NULL, NULL, NULL);
+	for (cnt = 0; ret == SPPWK_RET_OK && cnt < RTE_MAX_LCORE; cnt++) {
+		/* Reference side is remained after the merger is stopped. */
+		if ((comp_info_base + cnt)->wk_type != SPPWK_TYPE_MRG)
+			continue;
+
+		fwd_info = g_forward_info[cnt];
+		if (fwd_info == NULL)
+			continue;
+		path = fwd_info->path[fwd_info->ref_index];
+		if (path == NULL || path->wk_type != SPPWK_TYPE_MRG)
+			continue;
+
+		ret = append_merge_value(output, path);
 	}
-	return SPPWK_RET_OK;
+
+	if (ret == SPPWK_RET_OK)
+		ret = append_json_end_array(output);
+	return ret;
 }
@@ -20,7 +20,12 @@
  * This component provides packet forwarding function from multiple
  * ports to one port. Incoming packets from multiple ports are to be
  * transferred to one specific port. The flow of this merging process
- * is specified by port command.
+ * is specified by port command. RX ports are scheduled with a policy of
+ * round robin, weighted fair or strict priority, and packets from several
+ * RX ports are coalesced into a TX burst.
+ *
+ * Both of them accept several TX ports as queues of a multi-queue port,
+ * and packets are spread to the queues by hash of flow.
  */
 
 /* Clear g_forward_info, ref and update indices. */
@@ -57,4 +62,15 @@ int
 get_forwarder_status(unsigned int lcore_id, int id,
 		struct sppwk_lcore_params *params);
 
+/**
+ * Add policy and counters of each of RX ports of mergers for `status`.
+ *
+ * @param[in] name Name of the entry, `merge_stats`.
+ * @param[in,out] output Buffer of the response.
+ * @retval SPPWK_RET_OK If succeeded.
+ * @retval SPPWK_RET_NG If failed.
+ */
+int add_merge_stats(const char *name, char **output,
+		void *tmp __attribute__ ((unused)));
+
 #endif /* __SPP_FORWARD_H__ */
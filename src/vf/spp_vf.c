@@ -7,14 +7,21 @@
 #include <getopt.h>
 
 #include "classifier.h"
+#include "classifier_5tuple.h"
+#include "cls_pipeline.h"
+#include "distributor.h"
 #include "forwarder.h"
 #include "shared/secondary/common.h"
+#include "shared/latency.h"
+#include "shared/lcore_usage.h"
+#include "shared/trace.h"
 #include "shared/secondary/utils.h"
 #include "shared/secondary/spp_worker_th/cmd_utils.h"
 #include "shared/secondary/return_codes.h"
 #include "shared/secondary/add_port.h"
 #include "shared/secondary/spp_worker_th/cmd_runner.h"
 #include "shared/secondary/spp_worker_th/cmd_parser.h"
+#include "shared/secondary/spp_worker_th/comp_service.h"
 #include "shared/secondary/spp_worker_th/port_capability.h"
 
 #define RTE_LOGTYPE_SPP_VF RTE_LOGTYPE_USER1
@@ -26,28 +33,33 @@ enum SPP_LONGOPT_RETVAL {
 
 	/* Return value definition for getopt_long(). Only for long option. */
 	SPP_LONGOPT_RETVAL_CLIENT_ID,    /* For `--client-id` */
-	SPP_LONGOPT_RETVAL_VHOST_CLIENT  /* For `--vhost-client` */
+	SPP_LONGOPT_RETVAL_VHOST_CLIENT, /* For `--vhost-client` */
+	SPP_LONGOPT_RETVAL_LATENCY,      /* For `--latency` */
+	SPP_LONGOPT_RETVAL_TRACE,        /* For `--trace` */
+	SPP_LONGOPT_RETVAL_TRACE_DIR,    /* For `--trace-dir` */
+	SPP_LONGOPT_RETVAL_CLS_WORKERS,  /* For `--cls-workers` */
+	SPP_LONGOPT_RETVAL_BALANCE_INTERVAL  /* For `--balance-interval` */
 };
 
 /* Declare global variables */
 /* Interface management information */
 static struct iface_info g_iface_info;
 
-/* Component management information */
-static struct sppwk_comp_info g_component_info[RTE_MAX_LCORE];
-
-/* Core management information */
-static struct core_mng_info g_core_info[RTE_MAX_LCORE];
-
-/* Array of update indicator for core management information */
-static int g_change_core[RTE_MAX_LCORE];
-
-/* Array of update indicator for component management information */
-static int g_change_component[RTE_MAX_LCORE];
+/**
+ * Component and core management information, and arrays of update
+ * indicator of them. They are allocated on the socket of master lcore.
+ */
+static struct sppwk_comp_info *g_component_info;
+static struct core_mng_info *g_core_info;
+static int *g_change_core;
+static int *g_change_component;
 
 /* Backup information for cancel command */
 static struct cancel_backup_info g_backup_info;
 
+/* Interval of balancing components on service lcores in sec, or 0. */
+static int g_balance_interval;
+
 /* Print help message */
 static void
 usage(const char *progname)
@@ -55,11 +67,25 @@ usage(const char *progname)
 	RTE_LOG(INFO, SPP_VF, "Usage: %s [EAL args] --"
 			" --client-id CLIENT_ID"
 			" -s SERVER_IP:SERVER_PORT"
-			" [--vhost-client]\n"
+			" [--vhost-client]"
+			" [--latency SAMPLE_RATE]"
+			" [--trace EVENTS [--trace-dir DIR]]"
+			" [--cls-workers LCORES]"
+			" [--balance-interval SEC]\n"
 			" --client-id CLIENT_ID   : My client ID\n"
 			" -s SERVER_IP:SERVER_PORT  :"
 			" Access information to the server\n"
 			" --vhost-client            : Run vhost on client\n"
+			" --latency SAMPLE_RATE     :"
+			" Record latency of one of SAMPLE_RATE packets\n"
+			" --trace EVENTS            :"
+			" Trace EVENTS, such as `rx,tx,drop` or `all`\n"
+			" --trace-dir DIR           :"
+			" Save trace in DIR, `/tmp` as default\n"
+			" --cls-workers LCORES      :"
+			" Classify packets on LCORES, such as `4-7`\n"
+			" --balance-interval SEC    :"
+			" Balance components on service lcores every SEC\n"
 			, progname);
 }
 
@@ -70,6 +96,9 @@ parse_app_args(int argc, char *argv[])
 	int cli_id;  /* Client ID. */
 	char *ctl_ip;  /* IP address of spp_ctl. */
 	int ctl_port;  /* Port num to connect spp_ctl. */
+	unsigned int sample_rate;
+	uint32_t trace_events = 0;
+	const char *trace_dir = NULL;
 	int ret;
 	int cnt;
 	int option_index, opt;
@@ -86,6 +115,16 @@ parse_app_args(int argc, char *argv[])
 					SPP_LONGOPT_RETVAL_CLIENT_ID },
 			{ "vhost-client", no_argument, NULL,
 					SPP_LONGOPT_RETVAL_VHOST_CLIENT },
+			{ "latency", required_argument, NULL,
+					SPP_LONGOPT_RETVAL_LATENCY },
+			{ "trace", required_argument, NULL,
+					SPP_LONGOPT_RETVAL_TRACE },
+			{ "trace-dir", required_argument, NULL,
+					SPP_LONGOPT_RETVAL_TRACE_DIR },
+			{ "cls-workers", required_argument, NULL,
+					SPP_LONGOPT_RETVAL_CLS_WORKERS },
+			{ "balance-interval", required_argument, NULL,
+					SPP_LONGOPT_RETVAL_BALANCE_INTERVAL },
 			{ 0 },
 	};
 
@@ -117,6 +156,37 @@ parse_app_args(int argc, char *argv[])
 		case SPP_LONGOPT_RETVAL_VHOST_CLIENT:
 			set_vhost_cli_mode(1);
 			break;
+		case SPP_LONGOPT_RETVAL_LATENCY:
+			if (latency_parse_sample_rate(optarg,
+					&sample_rate) != 0) {
+				usage(progname);
+				return SPPWK_RET_NG;
+			}
+			if (latency_init(sample_rate) != 0)
+				return SPPWK_RET_NG;
+			break;
+		case SPP_LONGOPT_RETVAL_TRACE:
+			if (trace_parse_events(optarg, &trace_events) != 0) {
+				usage(progname);
+				return SPPWK_RET_NG;
+			}
+			break;
+		case SPP_LONGOPT_RETVAL_TRACE_DIR:
+			trace_dir = optarg;
+			break;
+		case SPP_LONGOPT_RETVAL_CLS_WORKERS:
+			if (cls_pipeline_parse_workers(optarg) != 0) {
+				usage(progname);
+				return SPPWK_RET_NG;
+			}
+			break;
+		case SPP_LONGOPT_RETVAL_BALANCE_INTERVAL:
+			if (spp_atoi(optarg, &g_balance_interval) != 0 ||
+					g_balance_interval < 0) {
+				usage(progname);
+				return SPPWK_RET_NG;
+			}
+			break;
 		case 's':
 			ret = parse_server(&ctl_ip, &ctl_port, optarg);
 			set_spp_ctl_ip(ctl_ip);
@@ -138,6 +208,10 @@ parse_app_args(int argc, char *argv[])
 		usage(progname);
 		return SPPWK_RET_NG;
 	}
+
+	if (trace_events != 0 &&
+			trace_init("spp_vf", trace_events, trace_dir) != 0)
+		return SPPWK_RET_NG;
 	RTE_LOG(INFO, SPP_VF,
 			"Parsed app args (client_id=%d,server=%s:%d,"
 			"vhost_client=%d)\n",
@@ -145,6 +219,23 @@ parse_app_args(int argc, char *argv[])
 	return SPPWK_RET_OK;
 }
 
+/* Run a component, on a slave lcore or as a service on a service lcore. */
+static int
+run_component(int comp_id)
+{
+	switch (sppwk_get_comp_type(comp_id)) {
+	case SPPWK_TYPE_CLS:
+		return classify_packets(comp_id);
+	case SPPWK_TYPE_CLS_5TUPLE:
+		return classify_5tuple_packets(comp_id);
+	case SPPWK_TYPE_DIST:
+		return distribute_packets(comp_id);
+	default:
+		/* Component type for forward or merge. */
+		return forward_packets(comp_id);
+	}
+}
+
 /* Main process of slave core */
 static int
 slave_main(void *arg __attribute__ ((unused)))
@@ -152,39 +243,52 @@ slave_main(void *arg __attribute__ ((unused)))
 	int ret = 0;
 	int cnt = 0;
 	unsigned int lcore_id = rte_lcore_id();
+	int is_online = 0;
 	enum sppwk_lcore_status status = SPPWK_LCORE_STOPPED;
-	struct core_mng_info *info = &g_core_info[lcore_id];
-	struct core_info *core = get_core_info(lcore_id);
+	struct core_info *core = NULL;
+	struct lcore_usage_poll lcore_poll, comp_poll;
 
 	RTE_LOG(INFO, SPP_VF, "Slave started on lcore %d.\n", lcore_id);
+	sppwk_qsbr_register(lcore_id);
 	set_core_status(lcore_id, SPPWK_LCORE_IDLING);
 
 	while ((status = sppwk_get_lcore_status(lcore_id)) !=
 			SPPWK_LCORE_REQ_STOP) {
-		if (status != SPPWK_LCORE_RUNNING)
+		if (status != SPPWK_LCORE_RUNNING) {
+			/* Master does not wait for idling lcore to flush. */
+			if (is_online) {
+				sppwk_qsbr_offline(lcore_id);
+				is_online = 0;
+			}
 			continue;
+		}
+		if (!is_online) {
+			sppwk_qsbr_online(lcore_id);
+			is_online = 1;
+			/* Time of idling lcore is not included in usage. */
+			lcore_usage_poll_begin(&lcore_poll);
+		}
 
-		if (sppwk_is_lcore_updated(lcore_id) == 1) {
-			/* Setting with the flush command trigger. */
-			info->ref_index = (info->upd_index+1) % TWO_SIDES;
-			core = get_core_info(lcore_id);
+		/* Worker of classifiers does not run any of components. */
+		if (cls_pipeline_is_worker(lcore_id)) {
+			cls_pipeline_work(lcore_id);
+			sppwk_qsbr_quiescent(lcore_id);
+			lcore_usage_poll_end(&lcore_usages[lcore_id],
+					&lcore_poll);
+			continue;
 		}
 
+		/* Reference side is published by master while flushing. */
+		core = get_core_info(lcore_id);
+		comp_poll = lcore_poll;
+
 		/* It is for processing multiple components. */
 		for (cnt = 0; cnt < core->num; cnt++) {
-			/* Component classification to call a function. */
-			if (sppwk_get_comp_type(core->id[cnt]) ==
-					SPPWK_TYPE_CLS) {
-				/* Component type for classifier. */
-				ret = classify_packets(core->id[cnt]);
-				if (unlikely(ret != 0))
-					break;
-			} else {
-				/* Component type for forward or merge. */
-				ret = forward_packets(core->id[cnt]);
-				if (unlikely(ret != 0))
-					break;
-			}
+			ret = run_component(core->id[cnt]);
+			if (unlikely(ret != 0))
+				break;
+			lcore_usage_poll_end(&comp_usages[core->id[cnt]],
+					&comp_poll);
 		}
 		if (unlikely(ret != 0)) {
 			RTE_LOG(ERR, SPP_VF, "Failed to forward on lcore %d. "
@@ -192,8 +296,18 @@ slave_main(void *arg __attribute__ ((unused)))
 					lcore_id, core->id[cnt]);
 			break;
 		}
+
+		/* Send packets classified by workers, if it is enabled. */
+		if (cls_pipeline_enabled())
+			cls_pipeline_transmit(lcore_id);
+
+		/* No data of components is referred until next iteration. */
+		sppwk_qsbr_quiescent(lcore_id);
+		lcore_usage_poll_end(&lcore_usages[lcore_id], &lcore_poll);
 	}
 
+	/* Stopped lcore is no longer waited by master. */
+	sppwk_qsbr_unregister(lcore_id);
 	set_core_status(lcore_id, SPPWK_LCORE_STOPPED);
 	RTE_LOG(INFO, SPP_VF, "Terminated slave on lcore %d.\n", lcore_id);
 	return ret;
@@ -250,6 +364,11 @@ main(int argc, char *argv[])
 		if (unlikely(ret != SPPWK_RET_OK))
 			break;
 
+		ret = sppwk_alloc_mng_tables(&g_component_info, &g_core_info,
+				&g_change_core, &g_change_component);
+		if (unlikely(ret != SPPWK_RET_OK))
+			break;
+
 		if (sppwk_set_mng_data(&g_iface_info, g_component_info,
 					g_core_info, g_change_core,
 					g_change_component,
@@ -267,6 +386,18 @@ main(int argc, char *argv[])
 		if (unlikely(ret != SPPWK_RET_OK))
 			break;
 
+		ret = init_cls_5tuple_mng_info();
+		if (unlikely(ret != SPPWK_RET_OK))
+			break;
+
+		ret = init_distributor_mng_info();
+		if (unlikely(ret != SPPWK_RET_OK))
+			break;
+
+		ret = cls_pipeline_init();
+		if (unlikely(ret != SPPWK_RET_OK))
+			break;
+
 		init_forwarder();
 		sppwk_port_capability_init();
 
@@ -277,6 +408,16 @@ main(int argc, char *argv[])
 		if (unlikely(ret != SPPWK_RET_OK))
 			break;
 
+		/* Components on service lcores are run as services. */
+		ret = sppwk_init_comp_services(run_component,
+				g_balance_interval);
+		if (unlikely(ret != SPPWK_RET_OK))
+			break;
+
+		/* Scheduler of event device runs on a service lcore. */
+		ret = cls_pipeline_start();
+		if (unlikely(ret != SPPWK_RET_OK))
+			break;
 
 		/* Start worker threads of classifier and forwarder */
 		RTE_LCORE_FOREACH_SLAVE(lcore_id) {
@@ -306,6 +447,11 @@ main(int argc, char *argv[])
 			if (unlikely(ret != SPPWK_RET_OK))
 				break;
 
+			if (unlikely(sppwk_balance_comp_services() !=
+					SPPWK_RET_OK))
+				RTE_LOG(ERR, SPP_VF,
+					"Failed to balance components.\n");
+
 		       /*
 			* Wait to avoid CPU overloaded.
 			*/
@@ -323,10 +469,18 @@ main(int argc, char *argv[])
 	}
 
 	/* Finalize to exit */
-	g_core_info[master_lcore].status = SPPWK_LCORE_STOPPED;
-	ret = check_core_status_wait(SPPWK_LCORE_STOPPED);
-	if (unlikely(ret != SPPWK_RET_OK))
-		RTE_LOG(ERR, SPP_VF, "Failed to terminate master thread.\n");
+	if (likely(g_core_info != NULL)) {
+		g_core_info[master_lcore].status = SPPWK_LCORE_STOPPED;
+		ret = check_core_status_wait(SPPWK_LCORE_STOPPED);
+		if (unlikely(ret != SPPWK_RET_OK))
+			RTE_LOG(ERR, SPP_VF,
+				"Failed to terminate master thread.\n");
+	}
+	sppwk_fini_comp_services();
+	cls_pipeline_fini();
+
+	/* Workers are stopped and no more events are recorded. */
+	trace_save();
 
 	/*
 	 * Remove vhost sock file if it is not running
@@ -3,13 +3,18 @@
  */
 
 #include "classifier.h"
+#include "classifier_5tuple.h"
+#include "cls_pipeline.h"
+#include "distributor.h"
 #include "forwarder.h"
+#include "shared/lcore_usage.h"
 #include "shared/secondary/return_codes.h"
 #include "shared/secondary/json_helper.h"
 #include "shared/secondary/spp_worker_th/port_capability.h"
 #include "shared/secondary/spp_worker_th/cmd_parser.h"
 #include "shared/secondary/spp_worker_th/cmd_runner.h"
 #include "shared/secondary/spp_worker_th/cmd_res_formatter.h"
+#include "shared/secondary/spp_worker_th/comp_service.h"
 #include "shared/secondary/spp_worker_th/vf_deps.h"
 
 #define RTE_LOGTYPE_VF_CMD_RUNNER RTE_LOGTYPE_USER1
@@ -23,9 +28,33 @@ const char *CLS_TYPE_A_LIST[] = {
 	"none",
 	"mac",
 	"vlan",
+	"ipv4",
+	"ipv6",
+	"weight",
 	"",  /* termination */
 };
 
+/**
+ * Types of components stopped, whose data are released after the grace
+ * period of flushing, or SPPWK_TYPE_NONE. IDs of them are not reused until
+ * released.
+ */
+static enum sppwk_worker_type g_stopped_types[RTE_MAX_LCORE];
+
+/* Get a free component ID which is not waiting for being released. */
+static int
+get_free_comp_id(void)
+{
+	int cnt;
+
+	for (cnt = 0; cnt < RTE_MAX_LCORE; cnt++) {
+		if (sppwk_get_comp_type(cnt) == SPPWK_TYPE_NONE &&
+				g_stopped_types[cnt] == SPPWK_TYPE_NONE)
+			return cnt;
+	}
+	return SPPWK_RET_NG;
+}
+
 /* Update classifier table with given action, add or del. */
 static int
 update_cls_table(enum sppwk_action wk_action,
@@ -69,6 +98,9 @@ update_cls_table(enum sppwk_action wk_action,
 				port->queue_no);
 		return SPPWK_RET_NG;
 	}
+	if (unlikely(backup_mng_obj(port_info,
+			sizeof(struct sppwk_port_info)) != SPPWK_RET_OK))
+		return SPPWK_RET_NG;
 
 	if (wk_action == SPPWK_ACT_DEL) {
 		if ((port_info->cls_attrs.vlantag.vid != 0) &&
@@ -107,6 +139,13 @@ update_cls_table(enum sppwk_action wk_action,
 					mac_str);
 			return SPPWK_RET_NG;
 		}
+		if (unlikely(port_info->cls_attrs.tuple.ip_ver != 0)) {
+			RTE_LOG(ERR, VF_CMD_RUNNER,
+					"Used port %d:%d nq %d for 5-tuple.\n",
+					port->iface_type, port->iface_no,
+					port->queue_no);
+			return SPPWK_RET_NG;
+		}
 
 		/* Update attrs with validated params. */
 		port_info->cls_attrs.vlantag.vid = vid;
@@ -118,11 +157,133 @@ update_cls_table(enum sppwk_action wk_action,
 	return SPPWK_RET_OK;
 }
 
+/* Update weight of TX port of distributor with given action, add or del. */
+static int
+update_cls_weight(enum sppwk_action wk_action, int weight,
+		const struct sppwk_port_idx *port)
+{
+	struct sppwk_port_info *port_info;
+
+	RTE_LOG(DEBUG, VF_CMD_RUNNER, "Called __func__ with "
+			"weight `%d`, and port `%d:%d nq %d`.\n",
+			weight, port->iface_type, port->iface_no,
+			port->queue_no);
+
+	port_info = get_sppwk_port(port->iface_type, port->iface_no,
+			port->queue_no);
+	if (unlikely(port_info == NULL)) {
+		RTE_LOG(ERR, VF_CMD_RUNNER, "Failed to get port %d:%d nq %d.\n",
+				port->iface_type, port->iface_no,
+				port->queue_no);
+		return SPPWK_RET_NG;
+	}
+	if (unlikely(port_info->iface_type == UNDEF)) {
+		RTE_LOG(ERR, VF_CMD_RUNNER, "Port %d:%d nq %d doesn't exist.\n",
+				port->iface_type, port->iface_no,
+				port->queue_no);
+		return SPPWK_RET_NG;
+	}
+	if (unlikely(backup_mng_obj(port_info,
+			sizeof(struct sppwk_port_info)) != SPPWK_RET_OK))
+		return SPPWK_RET_NG;
+
+	if (wk_action == SPPWK_ACT_DEL) {
+		if (port_info->cls_attrs.weight != weight) {
+			RTE_LOG(ERR, VF_CMD_RUNNER,
+					"Unexpected weight %d.\n", weight);
+			return SPPWK_RET_NG;
+		}
+
+		/* Back to default weight. */
+		port_info->cls_attrs.weight = 0;
+	} else if (wk_action == SPPWK_ACT_ADD) {
+		if (unlikely(port_info->cls_attrs.weight != 0)) {
+			RTE_LOG(ERR, VF_CMD_RUNNER,
+					"Weight of port %d:%d nq %d is "
+					"already set.\n",
+					port->iface_type, port->iface_no,
+					port->queue_no);
+			return SPPWK_RET_NG;
+		}
+
+		/* Update attrs with validated params. */
+		port_info->cls_attrs.weight = weight;
+	}
+
+	/* Weight is referred from RX of merger and TX of distributor. */
+	set_component_change_port(port_info, SPPWK_PORT_DIR_BOTH);
+	return SPPWK_RET_OK;
+}
+
+/* Update 5-tuple rule of classifier_5tuple with given action, add or del. */
+static int
+update_cls_5tuple_table(enum sppwk_action wk_action,
+		const struct sppwk_cls_5tuple *tuple,
+		const struct sppwk_port_idx *port)
+{
+	struct sppwk_port_info *port_info;
+	char rule_str[SPPWK_CLS_5TUPLE_STR_SZ];
+
+	sppwk_format_cls_5tuple(rule_str, tuple);
+	RTE_LOG(DEBUG, VF_CMD_RUNNER, "Called __func__ with "
+			"type `ipv%d`, rule `%s`, and port `%d:%d nq %d`.\n",
+			tuple->ip_ver, rule_str, port->iface_type,
+			port->iface_no, port->queue_no);
+
+	port_info = get_sppwk_port(port->iface_type, port->iface_no,
+			port->queue_no);
+	if (unlikely(port_info == NULL)) {
+		RTE_LOG(ERR, VF_CMD_RUNNER, "Failed to get port %d:%d nq %d.\n",
+				port->iface_type, port->iface_no,
+				port->queue_no);
+		return SPPWK_RET_NG;
+	}
+	if (unlikely(port_info->iface_type == UNDEF)) {
+		RTE_LOG(ERR, VF_CMD_RUNNER, "Port %d:%d nq %d doesn't exist.\n",
+				port->iface_type, port->iface_no,
+				port->queue_no);
+		return SPPWK_RET_NG;
+	}
+	if (unlikely(backup_mng_obj(port_info,
+			sizeof(struct sppwk_port_info)) != SPPWK_RET_OK))
+		return SPPWK_RET_NG;
+
+	if (wk_action == SPPWK_ACT_DEL) {
+		if (memcmp(&port_info->cls_attrs.tuple, tuple,
+				sizeof(struct sppwk_cls_5tuple)) != 0) {
+			RTE_LOG(ERR, VF_CMD_RUNNER,
+					"Unexpected 5-tuple `%s`.\n",
+					rule_str);
+			return SPPWK_RET_NG;
+		}
+
+		/* Initialize deleted attributes again. */
+		memset(&port_info->cls_attrs.tuple, 0x00,
+				sizeof(struct sppwk_cls_5tuple));
+	} else if (wk_action == SPPWK_ACT_ADD) {
+		if (unlikely(port_info->cls_attrs.tuple.ip_ver != 0) ||
+				unlikely(port_info->cls_attrs.mac_addr != 0)) {
+			RTE_LOG(ERR, VF_CMD_RUNNER,
+					"Used port %d:%d nq %d for `%s`.\n",
+					port->iface_type, port->iface_no,
+					port->queue_no, rule_str);
+			return SPPWK_RET_NG;
+		}
+
+		/* Update attrs with validated params. */
+		port_info->cls_attrs.tuple = *tuple;
+	}
+
+	set_component_change_port(port_info, SPPWK_PORT_DIR_TX);
+	return SPPWK_RET_OK;
+}
+
 /* Assign worker thread or remove on specified lcore. */
 /* TODO(yasufum) revise func name for removing term `component` or `comp`. */
 static int
 update_comp(enum sppwk_action wk_action, const char *name,
-		unsigned int lcore_id, enum sppwk_worker_type wk_type)
+		unsigned int lcore_id, enum sppwk_worker_type wk_type,
+		enum sppwk_mrg_policy mrg_policy, int burst_size)
 {
 	int ret;
 	int ret_del;
@@ -151,6 +312,24 @@ update_comp(enum sppwk_action wk_action, const char *name,
 			return SPPWK_RET_NG;
 		}
 
+		if (cls_pipeline_is_worker(lcore_id)) {
+			RTE_LOG(ERR, VF_CMD_RUNNER,
+					"Lcore %d is a worker of "
+					"classifiers.\n",
+					lcore_id);
+			return SPPWK_RET_NG;
+		}
+
+		/* Packets from workers are sent only on slave lcores. */
+		if (cls_pipeline_enabled() && wk_type == SPPWK_TYPE_CLS &&
+				sppwk_is_service_lcore(lcore_id)) {
+			RTE_LOG(ERR, VF_CMD_RUNNER,
+					"Classifier cannot run on service "
+					"lcore %d with workers.\n",
+					lcore_id);
+			return SPPWK_RET_NG;
+		}
+
 		comp_lcore_id = sppwk_get_lcore_id(name);
 		if (comp_lcore_id >= 0) {
 			RTE_LOG(ERR, VF_CMD_RUNNER, "Component name '%s' is already "
@@ -158,19 +337,38 @@ update_comp(enum sppwk_action wk_action, const char *name,
 			return SPPWK_RET_NG;
 		}
 
-		comp_lcore_id = get_free_lcore_id();
+		comp_lcore_id = get_free_comp_id();
 		if (comp_lcore_id < 0) {
 			RTE_LOG(ERR, VF_CMD_RUNNER, "Cannot assign component over the "
 				"maximum number.\n");
 			return SPPWK_RET_NG;
 		}
 
+		if (sppwk_is_service_lcore(lcore_id) &&
+				!sppwk_comp_service_available()) {
+			RTE_LOG(ERR, VF_CMD_RUNNER,
+					"No more service for component on "
+					"lcore %d.\n", lcore_id);
+			return SPPWK_RET_NG;
+		}
+
 		core = &info->core[info->upd_index];
 
 		comp_info = (comp_info_base + comp_lcore_id);
+		if (unlikely(backup_mng_obj(comp_info,
+				sizeof(struct sppwk_comp_info)) !=
+				SPPWK_RET_OK) ||
+				unlikely(backup_mng_obj(core,
+				sizeof(struct core_info)) != SPPWK_RET_OK))
+			return SPPWK_RET_NG;
 		memset(comp_info, 0x00, sizeof(struct sppwk_comp_info));
+		/* Usage of previous component of the same ID is cleared. */
+		memset(&comp_usages[comp_lcore_id], 0x00,
+				sizeof(struct lcore_usage));
 		strcpy(comp_info->name, name);
 		comp_info->wk_type = wk_type;
+		comp_info->mrg_policy = mrg_policy;
+		comp_info->burst_size = burst_size;
 		comp_info->lcore_id = lcore_id;
 		comp_info->comp_id = comp_lcore_id;
 
@@ -188,14 +386,25 @@ update_comp(enum sppwk_action wk_action, const char *name,
 
 		comp_info = (comp_info_base + comp_lcore_id);
 		tmp_lcore_id = comp_info->lcore_id;
-		memset(comp_info, 0x00, sizeof(struct sppwk_comp_info));
-
 		info = (core_info + tmp_lcore_id);
 		core = &info->core[info->upd_index];
+		if (unlikely(backup_mng_obj(comp_info,
+				sizeof(struct sppwk_comp_info)) !=
+				SPPWK_RET_OK) ||
+				unlikely(backup_mng_obj(core,
+				sizeof(struct core_info)) != SPPWK_RET_OK) ||
+				unlikely(backup_mng_obj(
+				&g_stopped_types[comp_lcore_id],
+				sizeof(enum sppwk_worker_type)) !=
+				SPPWK_RET_OK))
+			return SPPWK_RET_NG;
 
-		/* initialize classifier information */
-		if (comp_info->wk_type == SPPWK_TYPE_CLS)
-			init_classifier_info(comp_lcore_id);
+		/* Lcore might be running it until the flush is completed. */
+		g_stopped_types[comp_lcore_id] = comp_info->wk_type;
+		if (unlikely(sppwk_release_comp_ports(comp_info) !=
+				SPPWK_RET_OK))
+			return SPPWK_RET_NG;
+		memset(comp_info, 0x00, sizeof(struct sppwk_comp_info));
 
 		/* The latest lcore is released if worker thread is stopped. */
 		ret_del = del_comp_info(comp_lcore_id, core->num, core->id);
@@ -231,17 +440,20 @@ check_vf_port_count(int component_type, enum sppwk_port_dir dir,
 				" port_type=%d, rx=%d, tx=%d\n",
 				dir, nof_rx, nof_tx);
 	switch (component_type) {
+	/* Several TX ports are for spreading to queues of the same port. */
 	case SPPWK_TYPE_FWD:
-		if (nof_rx > 1 || nof_tx > 1)
+		if (nof_rx > 1 || nof_tx > RTE_MAX_ETHPORTS)
 			return SPPWK_RET_NG;
 		break;
 
 	case SPPWK_TYPE_MRG:
-		if (nof_tx > 1)
+		if (nof_rx > RTE_MAX_ETHPORTS || nof_tx > RTE_MAX_ETHPORTS)
 			return SPPWK_RET_NG;
 		break;
 
 	case SPPWK_TYPE_CLS:
+	case SPPWK_TYPE_CLS_5TUPLE:
+	case SPPWK_TYPE_DIST:
 		if (nof_rx > 1)
 			return SPPWK_RET_NG;
 		break;
@@ -283,8 +495,15 @@ update_port(enum sppwk_action wk_action,
 	sppwk_get_mng_data(NULL, &comp_info_base, NULL, NULL,
 			&change_component, NULL);
 	comp_info = (comp_info_base + comp_lcore_id);
-	port_info = get_sppwk_port(port->iface_type, port->iface_no,
+	port_info = sppwk_prepare_port(port->iface_type, port->iface_no,
 			port->queue_no);
+	if (unlikely(port_info == NULL))
+		return SPPWK_RET_NG;
+	if (unlikely(backup_mng_obj(comp_info,
+			sizeof(struct sppwk_comp_info)) != SPPWK_RET_OK) ||
+			unlikely(backup_mng_obj(port_info,
+			sizeof(struct sppwk_port_info)) != SPPWK_RET_OK))
+		return SPPWK_RET_NG;
 	if (dir == SPPWK_PORT_DIR_RX) {
 		nof_ports = &comp_info->nof_rx;
 		ports = comp_info->rx_ports;
@@ -330,6 +549,12 @@ update_port(enum sppwk_action wk_action,
 			return SPPWK_RET_NG;
 		}
 
+		/* Array of ports might be moved to extend it. */
+		ports = sppwk_prepare_comp_ports(comp_info, dir,
+				*nof_ports + 1);
+		if (unlikely(ports == NULL))
+			return SPPWK_RET_NG;
+
 		if (port_attrs->ops != SPPWK_PORT_OPS_NONE) {
 			while ((cnt < PORT_CAPABL_MAX) &&
 					(port_info->port_attrs[cnt].ops !=
@@ -363,6 +588,12 @@ update_port(enum sppwk_action wk_action,
 					sizeof(struct sppwk_port_attrs));
 		}
 
+		if (*nof_ports > 0) {
+			ports = sppwk_prepare_comp_ports(comp_info, dir,
+					*nof_ports);
+			if (unlikely(ports == NULL))
+				return SPPWK_RET_NG;
+		}
 		ret_del = delete_port_info(port_info, *nof_ports, ports);
 		if (ret_del == 0)
 			(*nof_ports)--; /* If deleted, decrement number. */
@@ -390,14 +621,30 @@ exec_one_cmd(const struct sppwk_cmd_attrs *cmd)
 	switch (cmd->type) {
 	case SPPWK_CMDTYPE_CLS_MAC:
 	case SPPWK_CMDTYPE_CLS_VLAN:
-		ret = update_cls_table(cmd->spec.cls_table.wk_action,
-				cmd->spec.cls_table.cls_type,
-				cmd->spec.cls_table.vid,
-				cmd->spec.cls_table.mac,
-				&cmd->spec.cls_table.port);
+		if (cmd->spec.cls_table.cls_type == SPPWK_CLS_TYPE_WEIGHT)
+			ret = update_cls_weight(
+					cmd->spec.cls_table.wk_action,
+					cmd->spec.cls_table.weight,
+					&cmd->spec.cls_table.port);
+		else if (cmd->spec.cls_table.cls_type ==
+				SPPWK_CLS_TYPE_IPV4 ||
+				cmd->spec.cls_table.cls_type ==
+				SPPWK_CLS_TYPE_IPV6)
+			ret = update_cls_5tuple_table(
+					cmd->spec.cls_table.wk_action,
+					&cmd->spec.cls_table.tuple,
+					&cmd->spec.cls_table.port);
+		else
+			ret = update_cls_table(cmd->spec.cls_table.wk_action,
+					cmd->spec.cls_table.cls_type,
+					cmd->spec.cls_table.vid,
+					cmd->spec.cls_table.mac,
+					&cmd->spec.cls_table.port);
 		if (ret == 0) {
 			RTE_LOG(INFO, VF_CMD_RUNNER, "Exec flush.\n");
 			ret = flush_cmd();
+		} else {
+			cancel_cmd();
 		}
 		break;
 
@@ -406,10 +653,14 @@ exec_one_cmd(const struct sppwk_cmd_attrs *cmd)
 				cmd->spec.comp.wk_action,
 				cmd->spec.comp.name,
 				cmd->spec.comp.core,
-				cmd->spec.comp.wk_type);
+				cmd->spec.comp.wk_type,
+				cmd->spec.comp.mrg_policy,
+				cmd->spec.comp.burst_size);
 		if (ret == 0) {
 			RTE_LOG(INFO, VF_CMD_RUNNER, "Exec flush.\n");
 			ret = flush_cmd();
+		} else {
+			cancel_cmd();
 		}
 		break;
 
@@ -423,6 +674,8 @@ exec_one_cmd(const struct sppwk_cmd_attrs *cmd)
 		if (ret == 0) {
 			RTE_LOG(INFO, VF_CMD_RUNNER, "Exec flush.\n");
 			ret = flush_cmd();
+		} else {
+			cancel_cmd();
 		}
 		break;
 
@@ -445,7 +698,7 @@ iterate_lcore_info(struct sppwk_lcore_params *params)
 	struct sppwk_comp_info *comp_info_base = NULL;
 	struct sppwk_comp_info *comp_info = NULL;
 
-	RTE_LCORE_FOREACH_SLAVE(lcore_id) {
+	SPPWK_LCORE_FOREACH_WORKER(lcore_id) {
 		if (sppwk_get_lcore_status(lcore_id) == SPPWK_LCORE_UNUSED)
 			continue;
 
@@ -470,6 +723,13 @@ iterate_lcore_info(struct sppwk_lcore_params *params)
 			if (comp_info->wk_type == SPPWK_TYPE_CLS) {
 				ret = get_classifier_status(lcore_id,
 						core->id[cnt], params);
+			} else if (comp_info->wk_type ==
+					SPPWK_TYPE_CLS_5TUPLE) {
+				ret = get_classifier_5tuple_status(lcore_id,
+						core->id[cnt], params);
+			} else if (comp_info->wk_type == SPPWK_TYPE_DIST) {
+				ret = get_distributor_status(lcore_id,
+						core->id[cnt], params);
 			} else {
 				ret = get_forwarder_status(lcore_id,
 						core->id[cnt], params);
@@ -495,24 +755,45 @@ add_core(const char *name, char **output,
 {
 	int ret = SPPWK_RET_NG;
 	struct sppwk_lcore_params lcore_params;
-	char *tmp_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
-	if (unlikely(tmp_buff == NULL)) {
-		RTE_LOG(ERR, VF_CMD_RUNNER, "Failed to alloc buff.\n");
+
+	ret = append_json_begin_array(output, name);
+	if (unlikely(ret != SPPWK_RET_OK))
 		return SPPWK_RET_NG;
-	}
 
-	lcore_params.output = tmp_buff;
+	lcore_params.output = *output;
 	lcore_params.lcore_proc = append_core_element_value;
 
+	/* Buffer might be reallocated while appending entries. */
 	ret = iterate_lcore_info(&lcore_params);
-	if (unlikely(ret != SPPWK_RET_OK)) {
-		spp_strbuf_free(lcore_params.output);
+	*output = lcore_params.output;
+	if (unlikely(ret != SPPWK_RET_OK) || unlikely(*output == NULL))
 		return SPPWK_RET_NG;
-	}
 
-	ret = append_json_array_brackets(output, name, lcore_params.output);
-	spp_strbuf_free(lcore_params.output);
-	return ret;
+	return append_json_end_array(output);
+}
+
+/* Release data of components stopped, which are no longer referred. */
+void
+sync_comp_info(void)
+{
+	int cnt;
+
+	for (cnt = 0; cnt < RTE_MAX_LCORE; cnt++) {
+		switch (g_stopped_types[cnt]) {
+		case SPPWK_TYPE_CLS:
+			init_classifier_info(cnt);
+			break;
+		case SPPWK_TYPE_CLS_5TUPLE:
+			init_classifier_5tuple_info(cnt);
+			break;
+		case SPPWK_TYPE_DIST:
+			init_distributor_info(cnt);
+			break;
+		default:
+			break;
+		}
+		g_stopped_types[cnt] = SPPWK_TYPE_NONE;
+	}
 }
 
 /* Activate temporarily stored component info while flushing. */
@@ -533,6 +814,13 @@ update_comp_info(struct sppwk_comp_info *p_comp_info, int *p_change_comp)
 		if (comp_info->wk_type == SPPWK_TYPE_CLS) {
 			ret = update_classifier(comp_info);
 			RTE_LOG(DEBUG, VF_CMD_RUNNER, "Update classifier.\n");
+		} else if (comp_info->wk_type == SPPWK_TYPE_CLS_5TUPLE) {
+			ret = update_classifier_5tuple(comp_info);
+			RTE_LOG(DEBUG, VF_CMD_RUNNER,
+					"Update classifier_5tuple.\n");
+		} else if (comp_info->wk_type == SPPWK_TYPE_DIST) {
+			ret = update_distributor(comp_info);
+			RTE_LOG(DEBUG, VF_CMD_RUNNER, "Update distributor.\n");
 		} else {
 			ret = update_forwarder(comp_info);
 			RTE_LOG(DEBUG, VF_CMD_RUNNER, "Update forwarder.\n");
@@ -561,26 +849,27 @@ append_classifier_element_value(
 		const struct sppwk_port_idx *port)
 {
 	int ret = SPPWK_RET_NG;
-	char *buff, *tmp_buff;
+	char **output = &params->output;
 	char port_str[CMD_TAG_APPEND_SIZE];
-	char value_str[STR_LEN_SHORT];
-	buff = params->output;
-	tmp_buff = spp_strbuf_allocate(CMD_RES_BUF_INIT_SIZE);
-	if (unlikely(tmp_buff == NULL)) {
-		RTE_LOG(ERR, VF_CMD_RUNNER,
-				"Failed to allocate buffer.\n");
+	char value_str[SPPWK_CLS_5TUPLE_STR_SZ];
+
+	/* Output is NULL if it failed to append previous entry. */
+	if (unlikely(*output == NULL))
 		return ret;
-	}
 
 	sppwk_port_uid(port_str, port->iface_type, port->iface_no,
 			port->queue_no);
 
-	ret = append_json_str_value(&tmp_buff, "type",
+	ret = append_json_begin_block(output, "");
+	if (unlikely(ret < SPPWK_RET_OK))
+		return ret;
+
+	ret = append_json_str_value(output, "type",
 			CLS_TYPE_A_LIST[cls_type]);
 	if (unlikely(ret < SPPWK_RET_OK))
 		return ret;
 
-	memset(value_str, 0x00, STR_LEN_SHORT);
+	memset(value_str, 0x00, sizeof(value_str));
 	switch (cls_type) {
 	case SPPWK_CLS_TYPE_MAC:
 		sprintf(value_str, "%s", mac);
@@ -588,23 +877,26 @@ append_classifier_element_value(
 	case SPPWK_CLS_TYPE_VLAN:
 		sprintf(value_str, "%d/%s", vid, mac);
 		break;
+	case SPPWK_CLS_TYPE_IPV4:
+	case SPPWK_CLS_TYPE_IPV6:
+	case SPPWK_CLS_TYPE_WEIGHT:
+		/* Rule of 5-tuple or weight is given as `mac`. */
+		snprintf(value_str, sizeof(value_str), "%s", mac);
+		break;
 	default:
 		/* not used */
 		break;
 	}
 
-	ret = append_json_str_value(&tmp_buff, "value", value_str);
+	ret = append_json_str_value(output, "value", value_str);
 	if (unlikely(ret < 0))
 		return ret;
 
-	ret = append_json_str_value(&tmp_buff, "port", port_str);
+	ret = append_json_str_value(output, "port", port_str);
 	if (unlikely(ret < SPPWK_RET_OK))
 		return ret;
 
-	ret = append_json_block_brackets(&buff, "", tmp_buff);
-	spp_strbuf_free(tmp_buff);
-	params->output = buff;
-	return ret;
+	return append_json_end_block(output);
 }
 
 /* Get component type from string of its name. */
@@ -617,6 +909,12 @@ get_comp_type_from_str(const char *type_str)
 	if (strncmp(type_str, CORE_TYPE_CLASSIFIER_MAC_STR,
 			strlen(CORE_TYPE_CLASSIFIER_MAC_STR)+1) == 0) {
 		return SPPWK_TYPE_CLS;
+	} else if (strncmp(type_str, CORE_TYPE_CLASSIFIER_5TUPLE_STR,
+			strlen(CORE_TYPE_CLASSIFIER_5TUPLE_STR)+1) == 0) {
+		return SPPWK_TYPE_CLS_5TUPLE;
+	} else if (strncmp(type_str, CORE_TYPE_DISTRIBUTOR_STR,
+			strlen(CORE_TYPE_DISTRIBUTOR_STR)+1) == 0) {
+		return SPPWK_TYPE_DIST;
 	} else if (strncmp(type_str, CORE_TYPE_MERGE_STR,
 			strlen(CORE_TYPE_MERGE_STR)+1) == 0) {
 		return SPPWK_TYPE_MRG;
@@ -652,6 +950,9 @@ int get_status_ops(struct cmd_res_formatter_ops *ops_list)
 		{ "master-lcore", add_master_lcore},
 		{ "core", add_core},
 		{ "classifier_table", add_classifier_table},
+		{ "merge_stats", add_merge_stats},
+		{ "latency", add_latency},
+		{ "lcore_usage", add_lcore_usage},
 		{ "", NULL }
 	};
 	memcpy(ops_list, tmp_ops_list, sizeof(tmp_ops_list));
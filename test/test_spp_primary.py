@@ -85,6 +85,14 @@ class TestSppPrimary(TestCase):
         params = {'src': src, 'dst': dst}
         requests.put(url, data=json.dumps(params))
 
+    def _patch_batch(self, patches, reset=False):
+        """Set patches between given ports at once."""
+
+        url = "{baseurl}/primary/patches/batch".format(
+                baseurl=self.base_url)
+        params = {'patches': patches, 'reset': reset}
+        return requests.put(url, data=json.dumps(params))
+
     def _reset_patches(self):
         url = "{baseurl}/primary/patches".format(
                 baseurl=self.base_url)
@@ -140,6 +148,47 @@ class TestSppPrimary(TestCase):
         for port in ports:
             self._del_port(port)
 
+    def test_make_patch_batch(self):
+        """Check if patches are created at once with batch."""
+
+        ports = ['ring:1', 'ring:2']
+
+        for port in ports:
+            self._add_port(port)
+        patches = [{'src': ports[0], 'dst': ports[1]},
+                   {'src': ports[1], 'dst': ports[0]}]
+        response = self._patch_batch(patches, reset=True)
+        self.assertEqual(response.status_code, 204)
+        stat = self._get_status()
+        for patch in patches:
+            self.assertTrue(patch in stat['forwarder']['patches'])
+
+        self._reset_patches()
+        for port in ports:
+            self._del_port(port)
+
+    def test_make_patch_batch_failed(self):
+        """Check if no patches are applied if one of batch is failed."""
+
+        ports = ['ring:1', 'ring:2']
+
+        for port in ports:
+            self._add_port(port)
+        self._patch(ports[0], ports[1])
+
+        # `ring:3` is not added and the last patch is failed.
+        patches = [{'src': ports[1], 'dst': ports[0]},
+                   {'src': ports[0], 'dst': 'ring:3'}]
+        response = self._patch_batch(patches, reset=True)
+        self.assertEqual(response.status_code, 400)
+        stat = self._get_status()
+        self.assertEqual(stat['forwarder']['patches'],
+                         [{'src': ports[0], 'dst': ports[1]}])
+
+        self._reset_patches()
+        for port in ports:
+            self._del_port(port)
+
     def test_forwarding(self):
         """Check if forwarding packet is counted up.
 
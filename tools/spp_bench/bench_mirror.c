@@ -0,0 +1,94 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2020 Nippon Telegraph and Telephone Corporation
+ */
+
+#include <string.h>
+
+#include <rte_ethdev.h>
+#include <rte_mbuf.h>
+
+#include "spp_bench.h"
+
+/**
+ * Refer to mirror_proc() and its mbuf pool defined as static in spp_mirror,
+ * which is built without its main.
+ */
+int spp_mirror_main(int argc, char *argv[]);
+#define main spp_mirror_main
+#include "mirror/spp_mirror.c"
+#undef main
+
+#define BENCH_COMP_ID 0
+
+#ifdef SPP_MIRROR_SHALLOWCOPY
+#define BENCH_MIRROR_NAME "mirror_shallow"
+#define BENCH_MIRROR_DESC "mirror cloning packets with indirect mbufs"
+#else
+#define BENCH_MIRROR_NAME "mirror_deep"
+#define BENCH_MIRROR_DESC "mirror copying packets to mbufs allocated"
+#endif
+
+static struct sppwk_comp_info bench_comp;
+static struct sppwk_port_info rx_port;
+static struct sppwk_port_info tx_ports[2];
+
+/* Setup port as a ring of given index of ethdev port. */
+static void
+init_port_info(struct sppwk_port_info *port, int iface_no, uint16_t port_id)
+{
+	memset(port, 0x00, sizeof(*port));
+	port->iface_type = RING;
+	port->iface_no = iface_no;
+	port->ethdev_port_id = port_id;
+}
+
+/**
+ * Forward packets of the port to itself, and mirror them to a port of
+ * net_null which discards them.
+ */
+static int
+run_mirror(const struct bench_conf *conf, struct bench_result *res)
+{
+	uint16_t port_id, sink_id;
+
+	if (bench_get_loop_port(conf, &port_id) < 0)
+		return -1;
+	if (bench_get_sink_port(conf, &sink_id) < 0)
+		return -1;
+	if (mirror_pool_create(BENCH_COMP_ID) != SPPWK_RET_OK)
+		return -1;
+	mirror_proc_init();
+
+	memset(&bench_comp, 0x00, sizeof(bench_comp));
+	snprintf(bench_comp.name, STR_LEN_NAME, "mir_bench");
+	bench_comp.wk_type = SPPWK_TYPE_MIR;
+	bench_comp.comp_id = BENCH_COMP_ID;
+	bench_comp.nof_rx = 1;
+	bench_comp.nof_tx = 2;
+
+	init_port_info(&rx_port, 0, port_id);
+	init_port_info(&tx_ports[0], 0, port_id);
+	init_port_info(&tx_ports[1], 1, sink_id);
+	bench_comp.rx_ports[0] = &rx_port;
+	bench_comp.tx_ports[0] = &tx_ports[0];
+	bench_comp.tx_ports[1] = &tx_ports[1];
+
+	if (update_mirror(&bench_comp) != SPPWK_RET_OK)
+		return -1;
+	if (bench_fill_port(conf, port_id, BENCH_RING_PKTS) < 0)
+		return -1;
+
+	return bench_run_proc(conf, port_id, mirror_proc, BENCH_COMP_ID, res);
+}
+
+static const struct bench_ops bench_mirror = {
+	.name = BENCH_MIRROR_NAME,
+	.desc = BENCH_MIRROR_DESC,
+	.burst_size = MAX_PKT_BURST,
+	.run = run_mirror,
+};
+
+const struct bench_ops *bench_list[] = {
+	&bench_mirror,
+	NULL,
+};
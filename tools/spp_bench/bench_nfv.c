@@ -0,0 +1,87 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2020 Nippon Telegraph and Telephone Corporation
+ */
+
+#include <string.h>
+
+#include <rte_cycles.h>
+#include <rte_ring.h>
+
+#include "spp_bench.h"
+#include "shared/common.h"
+#include "shared/basic_forwarder.h"
+#include "shared/port_manager.h"
+
+/* Types of ports of spp_nfv for each type of ports of the benchmark. */
+static const enum port_type nfv_port_types[] = {
+	[BENCH_PORT_RING] = RING,
+	[BENCH_PORT_PIPE] = PIPE,
+	[BENCH_PORT_NULL] = NULLPMD,
+};
+
+/**
+ * Register the port to port_map as spp_nfv, and patch it to itself. Ring
+ * of net_ring is accessed directly as RING port of spp_nfv. Ports of
+ * previous run are cleared because port of net_null might be re-created.
+ */
+static int
+setup_patch(const struct bench_conf *conf, uint16_t port_id)
+{
+	port_map_init();
+	forward_array_init();
+
+	port_map[port_id].id = port_id;
+	port_map[port_id].port_type = nfv_port_types[conf->port_type];
+	if (conf->port_type == BENCH_PORT_RING)
+		port_map[port_id].ring = rte_ring_lookup(BENCH_LOOP_RING_NAME);
+	memset(port_map[port_id].stats, 0x00, sizeof(struct stats));
+
+	if (add_patch(port_id, 0, port_id, 0) != 0)
+		return -1;
+	publish_fwd_array();
+
+	return 0;
+}
+
+/* Forward packets of the port patched to itself with forward(). */
+static int
+run_basic_fwd(const struct bench_conf *conf, struct bench_result *res)
+{
+	int cnt;
+	uint16_t port_id;
+	uint64_t start, prev_pkts;
+	struct stats *stats;
+
+	if (bench_get_loop_port(conf, &port_id) < 0)
+		return -1;
+	if (setup_patch(conf, port_id) < 0)
+		return -1;
+	if (bench_fill_port(conf, port_id, BENCH_RING_PKTS) < 0)
+		return -1;
+
+	stats = port_map[port_id].stats;
+	start = rte_rdtsc();
+	do {
+		prev_pkts = stats->rx;
+		for (cnt = 0; cnt < BENCH_POLL_INTERVAL; cnt++)
+			forward();
+		if (unlikely(stats->rx == prev_pkts))
+			return -1;  /* All of packets are dropped. */
+	} while (stats->rx < conf->nof_pkts);
+	res->cycles = rte_rdtsc() - start;
+	res->pkts = stats->rx;
+
+	return 0;
+}
+
+static const struct bench_ops bench_basic_fwd = {
+	.name = "basic_fwd",
+	.desc = "forward() of spp_nfv patching a port to itself",
+	.burst_size = MAX_PKT_BURST,
+	.run = run_basic_fwd,
+};
+
+const struct bench_ops *bench_list[] = {
+	&bench_basic_fwd,
+	NULL,
+};
@@ -0,0 +1,135 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2020 Nippon Telegraph and Telephone Corporation
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <unistd.h>
+
+#include <rte_cycles.h>
+#include <rte_lcore.h>
+#include <rte_mbuf.h>
+#include <rte_ring.h>
+
+#include "spp_bench.h"
+
+/**
+ * Refer to pcap_proc_write() and its options defined as static in spp_pcap,
+ * which is built without its main.
+ */
+int spp_pcap_main(int argc, char *argv[]);
+#define main spp_pcap_main
+#include "pcap/spp_pcap.c"
+#undef main
+
+#define BENCH_PCAP_RING_NAME "spp_bench_pcap"
+#define BENCH_PCAP_RING_SIZE 1024
+#define BENCH_PCAP_FILE_DATE "bench"
+
+/* Setup options of writer of which packets are enqueued by benchmark. */
+static int
+setup_writer(void)
+{
+	struct rte_ring *ring;
+
+	ring = rte_ring_lookup(BENCH_PCAP_RING_NAME);
+	if (ring == NULL)
+		ring = rte_ring_create(BENCH_PCAP_RING_NAME,
+				BENCH_PCAP_RING_SIZE, rte_socket_id(), 0);
+	if (ring == NULL)
+		return -1;
+
+	memset(&g_pcap_option, 0x00, sizeof(g_pcap_option));
+	g_pcap_option.cap_ring = ring;
+	g_pcap_option.port_cap.iface_type = RING;
+	/* Not to roll files while running for comparing results. */
+	g_pcap_option.fsize_limit = UINT64_MAX;
+	snprintf(g_pcap_option.compress_file_path, PCAP_FPATH_STRLEN, "%s",
+			DEFAULT_OUTPUT_DIR);
+	snprintf(g_pcap_option.compress_file_date, PCAP_FDATE_STRLEN, "%s",
+			BENCH_PCAP_FILE_DATE);
+
+	memset(g_pcap_info, 0x00, sizeof(g_pcap_info));
+	g_pcap_info[rte_lcore_id()].thread_no = 1;
+	g_capture_status = SPP_CAPTURE_RUNNING;
+
+	return 0;
+}
+
+/* Stop the writer to close its file, and remove it. */
+static int
+close_writer(void)
+{
+	unsigned int lcore_id = rte_lcore_id();
+	struct pcap_mng_info *info = &g_pcap_info[lcore_id];
+	char fpath[PCAP_FPATH_STRLEN + PCAP_FNAME_STRLEN];
+
+	g_capture_status = SPP_CAPTURE_IDLE;
+	while (info->status != SPP_CAPTURE_IDLE) {
+		if (pcap_proc_write(lcore_id) != SPPWK_RET_OK)
+			return -1;
+	}
+
+	snprintf(fpath, sizeof(fpath), "%s/%s",
+			g_pcap_option.compress_file_path,
+			info->compress_file_name);
+	unlink(fpath);
+	return 0;
+}
+
+/**
+ * Write packets enqueued to the ring as receiver of spp_pcap. Packets of a
+ * burst are reused by incrementing refcnt because writer releases them.
+ */
+static int
+run_pcap_write(const struct bench_conf *conf, struct bench_result *res)
+{
+	int ret = 0;
+	unsigned int lcore_id = rte_lcore_id();
+	uint16_t buf;
+	uint64_t start;
+	struct rte_mbuf *pkts[BENCH_BURST_MAX];
+
+	if (setup_writer() < 0)
+		return -1;
+	if (bench_alloc_pkts(conf, pkts, conf->burst_size) < 0)
+		return -1;
+
+	start = rte_rdtsc();
+	while (res->pkts < conf->nof_pkts) {
+		for (buf = 0; buf < conf->burst_size; buf++)
+			rte_mbuf_refcnt_update(pkts[buf], 1);
+		if (unlikely(rte_ring_enqueue_bulk(g_pcap_option.cap_ring,
+				(void *)pkts, conf->burst_size, NULL) == 0)) {
+			for (buf = 0; buf < conf->burst_size; buf++)
+				rte_mbuf_refcnt_update(pkts[buf], -1);
+			ret = -1;
+			break;
+		}
+
+		if (unlikely(pcap_proc_write(lcore_id) != SPPWK_RET_OK)) {
+			ret = -1;
+			break;
+		}
+		res->pkts += conf->burst_size;
+	}
+	res->cycles = rte_rdtsc() - start;
+
+	if (close_writer() < 0)
+		ret = -1;
+	for (buf = 0; buf < conf->burst_size; buf++)
+		rte_pktmbuf_free(pkts[buf]);
+
+	return ret;
+}
+
+static const struct bench_ops bench_pcap_write = {
+	.name = "pcap_write",
+	.desc = "writer of spp_pcap compressing packets to a file",
+	.run = run_pcap_write,
+};
+
+const struct bench_ops *bench_list[] = {
+	&bench_pcap_write,
+	NULL,
+};
@@ -0,0 +1,292 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2020 Nippon Telegraph and Telephone Corporation
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include <rte_ethdev.h>
+#include <rte_ether.h>
+#include <rte_mbuf.h>
+#include <rte_memcpy.h>
+
+#include "spp_bench.h"
+#include "vf/classifier.h"
+#include "vf/forwarder.h"
+#include "shared/secondary/return_codes.h"
+#include "shared/secondary/spp_worker_th/port_capability.h"
+
+#define BENCH_COMP_ID 0
+
+/* VLAN ID of the first entry of classifier, incremented for each entry. */
+#define BENCH_VLAN_ID_BASE 1
+
+/* Component and its ports, all of which are the same ethdev port. */
+static struct sppwk_comp_info bench_comp;
+static struct sppwk_port_info rx_ports[BENCH_ENTRIES_MAX];
+static struct sppwk_port_info tx_ports[BENCH_ENTRIES_MAX];
+
+/* Setup port as a ring of given index of ethdev port. */
+static void
+init_port_info(struct sppwk_port_info *port, int iface_no, uint16_t port_id)
+{
+	memset(port, 0x00, sizeof(*port));
+	port->iface_type = RING;
+	port->iface_no = iface_no;
+	port->ethdev_port_id = port_id;
+}
+
+/* Get locally administered MAC address of given entry. */
+static void
+get_entry_addr(int entry, struct rte_ether_addr *addr)
+{
+	memset(addr, 0x00, sizeof(*addr));
+	addr->addr_bytes[0] = 0x02;
+	addr->addr_bytes[4] = (entry >> 8) & 0xff;
+	addr->addr_bytes[5] = entry & 0xff;
+}
+
+static void
+free_pkts(struct rte_mbuf **pkts, uint16_t first, uint16_t nb_pkts)
+{
+	uint16_t buf;
+
+	for (buf = first; buf < nb_pkts; buf++)
+		rte_pktmbuf_free(pkts[buf]);
+}
+
+/**
+ * Setup classifier of which TX ports are for each of entries. Each entry
+ * has a MAC address, and also a VLAN ID if `use_vlan` is true.
+ */
+static int
+setup_classifier(const struct bench_conf *conf, uint16_t port_id,
+		int use_vlan)
+{
+	static int is_cls_initialized;
+	struct rte_ether_addr addr;
+	int i;
+
+	sppwk_port_capability_init();
+
+	/* Tables retired by previous run are released while updating. */
+	if (!is_cls_initialized) {
+		init_cls_mng_info();
+		is_cls_initialized = 1;
+	}
+
+	memset(&bench_comp, 0x00, sizeof(bench_comp));
+	snprintf(bench_comp.name, STR_LEN_NAME, "cls_bench");
+	bench_comp.wk_type = SPPWK_TYPE_CLS;
+	bench_comp.comp_id = BENCH_COMP_ID;
+	bench_comp.nof_rx = 1;
+	bench_comp.nof_tx = conf->nof_entries;
+
+	init_port_info(&rx_ports[0], 0, port_id);
+	bench_comp.rx_ports[0] = &rx_ports[0];
+	for (i = 0; i < conf->nof_entries; i++) {
+		init_port_info(&tx_ports[i], i, port_id);
+		get_entry_addr(i, &addr);
+		rte_memcpy(&tx_ports[i].cls_attrs.mac_addr, &addr,
+				RTE_ETHER_ADDR_LEN);
+		tx_ports[i].cls_attrs.vlantag.vid = use_vlan ?
+			BENCH_VLAN_ID_BASE + i : ETH_VLAN_ID_MAX;
+		bench_comp.tx_ports[i] = &tx_ports[i];
+	}
+
+	return update_classifier(&bench_comp);
+}
+
+/**
+ * Send packets destined to each of entries in turn to the port to be
+ * circulated. Packets are tagged with VLAN ID of the entry without changing
+ * frame size if `use_vlan` is true.
+ */
+static int
+fill_cls_pkts(const struct bench_conf *conf, uint16_t port_id, int use_vlan)
+{
+	int entry;
+	unsigned int cnt;
+	uint16_t nb_pkts, nb_tx, buf;
+	struct bench_conf pkt_conf = *conf;
+	struct rte_mbuf *pkts[BENCH_BURST_MAX];
+	struct rte_ether_hdr *eth;
+
+	if (use_vlan)
+		pkt_conf.pkt_size -= sizeof(struct rte_vlan_hdr);
+
+	for (cnt = 0; cnt < BENCH_RING_PKTS; cnt += nb_pkts) {
+		nb_pkts = (BENCH_RING_PKTS - cnt < BENCH_BURST_MAX) ?
+			BENCH_RING_PKTS - cnt : BENCH_BURST_MAX;
+		if (bench_alloc_pkts(&pkt_conf, pkts, nb_pkts) < 0)
+			return -1;
+
+		for (buf = 0; buf < nb_pkts; buf++) {
+			entry = (cnt + buf) % conf->nof_entries;
+			eth = rte_pktmbuf_mtod(pkts[buf],
+					struct rte_ether_hdr *);
+			get_entry_addr(entry, &eth->d_addr);
+			if (!use_vlan)
+				continue;
+
+			pkts[buf]->vlan_tci = BENCH_VLAN_ID_BASE + entry;
+			if (rte_vlan_insert(&pkts[buf]) < 0) {
+				free_pkts(pkts, 0, nb_pkts);
+				return -1;
+			}
+		}
+
+		nb_tx = rte_eth_tx_burst(port_id, 0, pkts, nb_pkts);
+		if (nb_tx < nb_pkts) {
+			free_pkts(pkts, nb_tx, nb_pkts);
+			return -1;
+		}
+	}
+	return 0;
+}
+
+/* Classify packets to TX ports of entries which are the same port. */
+static int
+run_classify(const struct bench_conf *conf, struct bench_result *res,
+		int use_vlan)
+{
+	uint16_t port_id;
+
+	if (bench_get_loop_port(conf, &port_id) < 0)
+		return -1;
+	if (setup_classifier(conf, port_id, use_vlan) != SPPWK_RET_OK)
+		return -1;
+	if (fill_cls_pkts(conf, port_id, use_vlan) < 0)
+		return -1;
+
+	return bench_run_proc(conf, port_id, classify_packets, BENCH_COMP_ID,
+			res);
+}
+
+static int
+run_cls_mac(const struct bench_conf *conf, struct bench_result *res)
+{
+	return run_classify(conf, res, 0);
+}
+
+static int
+run_cls_vlan(const struct bench_conf *conf, struct bench_result *res)
+{
+	return run_classify(conf, res, 1);
+}
+
+/**
+ * Merge packets from RX ports of entries to a TX port with given policy.
+ * Weight of RX ports is the order of them for policies referring it.
+ */
+static int
+run_merge(const struct bench_conf *conf, struct bench_result *res,
+		enum sppwk_mrg_policy policy)
+{
+	uint16_t port_id;
+	int i;
+
+	if (conf->nof_entries > RTE_MAX_ETHPORTS) {
+		fprintf(stderr, "Num of RX ports of merger is up to %d\n",
+				RTE_MAX_ETHPORTS);
+		return -1;
+	}
+	if (bench_get_loop_port(conf, &port_id) < 0)
+		return -1;
+
+	sppwk_port_capability_init();
+	init_forwarder();
+
+	memset(&bench_comp, 0x00, sizeof(bench_comp));
+	snprintf(bench_comp.name, STR_LEN_NAME, "mrg_bench");
+	bench_comp.wk_type = SPPWK_TYPE_MRG;
+	bench_comp.comp_id = BENCH_COMP_ID;
+	bench_comp.nof_rx = conf->nof_entries;
+	bench_comp.nof_tx = 1;
+	bench_comp.mrg_policy = policy;
+	bench_comp.burst_size = conf->burst_size;
+
+	for (i = 0; i < conf->nof_entries; i++) {
+		init_port_info(&rx_ports[i], i, port_id);
+		rx_ports[i].cls_attrs.weight = i + 1;
+		bench_comp.rx_ports[i] = &rx_ports[i];
+	}
+	init_port_info(&tx_ports[0], 0, port_id);
+	bench_comp.tx_ports[0] = &tx_ports[0];
+
+	if (update_forwarder(&bench_comp) != SPPWK_RET_OK)
+		return -1;
+	if (bench_fill_port(conf, port_id, BENCH_RING_PKTS) < 0)
+		return -1;
+
+	return bench_run_proc(conf, port_id, forward_packets, BENCH_COMP_ID,
+			res);
+}
+
+static int
+run_merge_rr(const struct bench_conf *conf, struct bench_result *res)
+{
+	return run_merge(conf, res, SPPWK_MRG_POLICY_RR);
+}
+
+static int
+run_merge_wfq(const struct bench_conf *conf, struct bench_result *res)
+{
+	return run_merge(conf, res, SPPWK_MRG_POLICY_WFQ);
+}
+
+static int
+run_merge_prio(const struct bench_conf *conf, struct bench_result *res)
+{
+	return run_merge(conf, res, SPPWK_MRG_POLICY_PRIO);
+}
+
+static const struct bench_ops bench_cls_mac = {
+	.name = "cls_mac",
+	.desc = "classifier with entries of MAC address",
+	.burst_size = MAX_PKT_BURST,
+	.use_entries = 1,
+	.need_pkts = 1,
+	.run = run_cls_mac,
+};
+
+static const struct bench_ops bench_cls_vlan = {
+	.name = "cls_vlan",
+	.desc = "classifier with entries of MAC address and VLAN ID",
+	.burst_size = MAX_PKT_BURST,
+	.use_entries = 1,
+	.need_pkts = 1,
+	.run = run_cls_vlan,
+};
+
+static const struct bench_ops bench_merge_rr = {
+	.name = "merge_rr",
+	.desc = "merger from RX ports of entries with rr policy",
+	.use_entries = 1,
+	.run = run_merge_rr,
+};
+
+static const struct bench_ops bench_merge_wfq = {
+	.name = "merge_wfq",
+	.desc = "merger from RX ports of entries with wfq policy",
+	.use_entries = 1,
+	.run = run_merge_wfq,
+};
+
+static const struct bench_ops bench_merge_prio = {
+	.name = "merge_prio",
+	.desc = "merger from RX ports of entries with prio policy",
+	.use_entries = 1,
+	.run = run_merge_prio,
+};
+
+const struct bench_ops *bench_list[] = {
+	&bench_fwd_ring,
+	&bench_vlan,
+	&bench_cls_mac,
+	&bench_cls_vlan,
+	&bench_merge_rr,
+	&bench_merge_wfq,
+	&bench_merge_prio,
+	NULL,
+};
@@ -0,0 +1,112 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2020 Nippon Telegraph and Telephone Corporation
+ */
+
+#include <string.h>
+
+#include <rte_cycles.h>
+#include <rte_mbuf.h>
+
+#include "spp_bench.h"
+#include "shared/secondary/spp_worker_th/port_capability.h"
+
+#define BENCH_VLAN_ID 100
+#define BENCH_VLAN_PCP 3
+
+/* Component of which ports are referred for VLAN attributes. */
+static struct sppwk_comp_info bench_comp;
+static struct sppwk_port_info bench_port;
+
+/**
+ * Setup VLAN attributes of the port, which adds a tag in RX and deletes it
+ * in TX so that packets are kept the same while circulated.
+ */
+static void
+setup_vlan_attrs(uint16_t port_id, int use_vlan)
+{
+	struct sppwk_port_attrs *attrs = bench_port.port_attrs;
+
+	sppwk_port_capability_init();
+	if (!use_vlan)
+		return;
+
+	memset(&bench_port, 0x00, sizeof(bench_port));
+	bench_port.iface_type = RING;
+	bench_port.ethdev_port_id = port_id;
+
+	attrs[0].ops = SPPWK_PORT_OPS_ADD_VLAN;
+	attrs[0].dir = SPPWK_PORT_DIR_RX;
+	attrs[0].capability.vlantag.vid = BENCH_VLAN_ID;
+	attrs[0].capability.vlantag.pcp = BENCH_VLAN_PCP;
+	attrs[1].ops = SPPWK_PORT_OPS_DEL_VLAN;
+	attrs[1].dir = SPPWK_PORT_DIR_TX;
+
+	memset(&bench_comp, 0x00, sizeof(bench_comp));
+	bench_comp.nof_rx = 1;
+	bench_comp.nof_tx = 1;
+	bench_comp.rx_ports[0] = &bench_port;
+	bench_comp.tx_ports[0] = &bench_port;
+
+	sppwk_update_port_dir(&bench_comp);
+	sppwk_swap_two_sides(SPPWK_SWAP_REF, 0, SPPWK_PORT_DIR_NONE);
+}
+
+/**
+ * Forward packets from the port to itself as forwarder of spp_vf, with
+ * wrappers of rx and tx burst with VLAN feature.
+ */
+static int
+run_forward(const struct bench_conf *conf, struct bench_result *res,
+		int use_vlan)
+{
+	uint16_t port_id;
+	uint16_t nb_rx, nb_tx, buf;
+	uint64_t start;
+	struct rte_mbuf *bufs[BENCH_BURST_MAX];
+
+	if (bench_get_loop_port(conf, &port_id) < 0)
+		return -1;
+	setup_vlan_attrs(port_id, use_vlan);
+	if (bench_fill_port(conf, port_id, BENCH_RING_PKTS) < 0)
+		return -1;
+
+	start = rte_rdtsc();
+	while (res->pkts < conf->nof_pkts) {
+		nb_rx = sppwk_eth_vlan_rx_burst(port_id, 0, bufs,
+				conf->burst_size);
+		if (unlikely(nb_rx == 0))
+			return -1;  /* All of packets are dropped. */
+
+		nb_tx = sppwk_eth_vlan_tx_burst(port_id, 0, bufs, nb_rx);
+		for (buf = nb_tx; buf < nb_rx; buf++)
+			rte_pktmbuf_free(bufs[buf]);
+		res->pkts += nb_rx;
+	}
+	res->cycles = rte_rdtsc() - start;
+
+	return 0;
+}
+
+static int
+run_fwd_ring(const struct bench_conf *conf, struct bench_result *res)
+{
+	return run_forward(conf, res, 0);
+}
+
+static int
+run_vlan(const struct bench_conf *conf, struct bench_result *res)
+{
+	return run_forward(conf, res, 1);
+}
+
+const struct bench_ops bench_fwd_ring = {
+	.name = "fwd_ring",
+	.desc = "forward between ring ports without VLAN operations",
+	.run = run_fwd_ring,
+};
+
+const struct bench_ops bench_vlan = {
+	.name = "vlan",
+	.desc = "forward with adding VLAN tag in RX and deleting it in TX",
+	.run = run_vlan,
+};
@@ -0,0 +1,617 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2020 Nippon Telegraph and Telephone Corporation
+ */
+
+#include <getopt.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <rte_eal.h>
+#include <rte_dev.h>
+#include <rte_ethdev.h>
+#include <rte_ether.h>
+#include <rte_ip.h>
+#include <rte_udp.h>
+#include <rte_cycles.h>
+#include <rte_lcore.h>
+#include <rte_log.h>
+#include <rte_mbuf.h>
+#include <rte_ring.h>
+#include <rte_eth_ring.h>
+
+#include "spp_bench.h"
+
+#define NUM_MBUFS 8191
+#define MBUF_CACHE_SIZE 512
+#define LOOP_RING_SIZE 4096
+#define MAX_LIST_LEN 16
+#define NOF_FLOWS 1024
+
+#define DEFAULT_NOF_PKTS 10000000
+
+/* spp_pipe refers to a ring of the name of ring port of spp_primary. */
+#define PIPE_RING_NAME "eth_ring0"
+#define PIPE_DEV_NAME "spp_pipe_bench"
+#define PIPE_DEV_ARGS "rx=ring:0,tx=ring:0"
+
+#define NULL_DEV_NAME "net_null_bench"
+#define SINK_DEV_NAME "net_null_bench_sink"
+#define NULL_DEV_ARGS_LEN 32
+
+enum output_format {
+	FORMAT_CSV,
+	FORMAT_JSON,
+};
+
+static const char * const port_type_names[] = {
+	[BENCH_PORT_RING] = "ring",
+	[BENCH_PORT_PIPE] = "pipe",
+	[BENCH_PORT_NULL] = "null",
+};
+
+static const char *bench_name = "all";
+static enum output_format format = FORMAT_CSV;
+static enum bench_port_type port_type = BENCH_PORT_RING;
+static uint64_t nof_pkts = DEFAULT_NOF_PKTS;
+static int nof_pkt_sizes = 4;
+static int pkt_sizes[MAX_LIST_LEN] = { 64, 128, 512, 1518 };
+static int nof_bursts = 4;
+static int bursts[MAX_LIST_LEN] = { 32, 64, 128, 256 };
+static int nof_entries = 3;
+static int entries[MAX_LIST_LEN] = { 1, 8, 32 };
+
+/* Ports created while running, or -1 if not created. */
+static int loop_port_ids[] = {
+	[BENCH_PORT_RING] = -1,
+	[BENCH_PORT_PIPE] = -1,
+	[BENCH_PORT_NULL] = -1,
+};
+static int sink_port_id = -1;
+
+/* Size of packets generated by loop port of net_null. */
+static uint16_t null_pkt_size;
+
+static struct option lopts[] = {
+	{"bench", required_argument, NULL, 'b'},
+	{"pkt-sizes", required_argument, NULL, 's'},
+	{"bursts", required_argument, NULL, 'u'},
+	{"entries", required_argument, NULL, 'e'},
+	{"port", required_argument, NULL, 'p'},
+	{"pkts", required_argument, NULL, 'n'},
+	{"format", required_argument, NULL, 'f'},
+	{NULL, 0, 0, 0}
+};
+
+static void
+usage(const char *progname)
+{
+	int i;
+
+	printf("usage: %s <eal options> -- [--bench NAME] "
+			"[--pkt-sizes S1,S2,..] [--bursts B1,B2,..] "
+			"[--entries E1,E2,..] [--port ring|pipe|null] "
+			"[--pkts NUM] [--format csv|json]\n", progname);
+	printf("benchmarks:\n");
+	for (i = 0; bench_list[i] != NULL; i++)
+		printf("  %-16s %s\n", bench_list[i]->name,
+				bench_list[i]->desc);
+}
+
+/* Parse comma separated list of int in the range of min to max. */
+static int
+parse_int_list(const char *arg, int *list, int min, int max)
+{
+	int nof_vals = 0;
+	long val;
+	char *endptr = NULL;
+	const char *pos = arg;
+
+	while (*pos != '\0') {
+		if (nof_vals >= MAX_LIST_LEN)
+			return -1;
+		val = strtol(pos, &endptr, 10);
+		if (endptr == pos || val < min || val > max)
+			return -1;
+		if (*endptr != ',' && *endptr != '\0')
+			return -1;
+		list[nof_vals++] = val;
+		pos = (*endptr == ',') ? endptr + 1 : endptr;
+	}
+	return nof_vals;
+}
+
+/* Get type of port from its name. */
+static int
+parse_port_type(const char *arg, enum bench_port_type *type)
+{
+	unsigned int i;
+
+	for (i = 0; i < RTE_DIM(port_type_names); i++) {
+		if (strcmp(arg, port_type_names[i]) == 0) {
+			*type = i;
+			return 0;
+		}
+	}
+	return -1;
+}
+
+static int
+parse_args(int argc, char *argv[])
+{
+	int c;
+	char *endptr = NULL;
+
+	while ((c = getopt_long(argc, argv, "", lopts, NULL)) != -1) {
+		switch (c) {
+		case 'b':
+			bench_name = optarg;
+			break;
+		case 's':
+			nof_pkt_sizes = parse_int_list(optarg, pkt_sizes,
+					RTE_ETHER_MIN_LEN, RTE_ETHER_MAX_LEN);
+			if (nof_pkt_sizes <= 0)
+				return -1;
+			break;
+		case 'u':
+			nof_bursts = parse_int_list(optarg, bursts, 1,
+					BENCH_BURST_MAX);
+			if (nof_bursts <= 0)
+				return -1;
+			break;
+		case 'e':
+			nof_entries = parse_int_list(optarg, entries, 1,
+					BENCH_ENTRIES_MAX);
+			if (nof_entries <= 0)
+				return -1;
+			break;
+		case 'p':
+			if (parse_port_type(optarg, &port_type) < 0)
+				return -1;
+			break;
+		case 'n':
+			nof_pkts = strtoull(optarg, &endptr, 10);
+			if (*endptr != '\0' || nof_pkts == 0)
+				return -1;
+			break;
+		case 'f':
+			if (strcmp(optarg, "csv") == 0)
+				format = FORMAT_CSV;
+			else if (strcmp(optarg, "json") == 0)
+				format = FORMAT_JSON;
+			else
+				return -1;
+			break;
+		default:
+			/* invalid option */
+			return -1;
+		}
+	}
+
+	if (optind != argc)
+		return -1;
+
+	return 0;
+}
+
+/* Release all of packets remained in the port. */
+static void
+drain_port(uint16_t port_id)
+{
+	uint16_t nb_rx, buf;
+	struct rte_mbuf *bufs[BENCH_BURST_MAX];
+
+	do {
+		nb_rx = rte_eth_rx_burst(port_id, 0, bufs, BENCH_BURST_MAX);
+		for (buf = 0; buf < nb_rx; buf++)
+			rte_pktmbuf_free(bufs[buf]);
+	} while (nb_rx > 0);
+}
+
+/* Create a port of vdev which has a RX and a TX queue, and start it. */
+static int
+create_vdev_port(const char *name, const char *devargs,
+		struct rte_mempool *mbuf_pool)
+{
+	uint16_t port_id;
+	struct rte_eth_conf port_conf;
+
+	memset(&port_conf, 0x00, sizeof(port_conf));
+	if (rte_eal_hotplug_add("vdev", name, devargs) < 0)
+		return -1;
+	if (rte_eth_dev_get_port_by_name(name, &port_id) < 0)
+		return -1;
+
+	if (rte_eth_dev_configure(port_id, 1, 1, &port_conf) < 0)
+		return -1;
+	if (rte_eth_rx_queue_setup(port_id, 0, LOOP_RING_SIZE,
+			rte_socket_id(), NULL, mbuf_pool) < 0)
+		return -1;
+	if (rte_eth_tx_queue_setup(port_id, 0, LOOP_RING_SIZE,
+			rte_socket_id(), NULL) < 0)
+		return -1;
+	if (rte_eth_dev_start(port_id) < 0)
+		return -1;
+
+	return port_id;
+}
+
+/* Stop and remove a port of vdev. */
+static void
+remove_vdev_port(const char *name, uint16_t port_id)
+{
+	rte_eth_dev_stop(port_id);
+	rte_eth_dev_close(port_id);
+	rte_eal_hotplug_remove("vdev", name);
+}
+
+/* Create loopback port of net_ring. */
+static int
+create_ring_port(void)
+{
+	int ret;
+	struct rte_ring *ring;
+
+	ring = rte_ring_create(BENCH_LOOP_RING_NAME, LOOP_RING_SIZE,
+			rte_socket_id(), RING_F_SP_ENQ | RING_F_SC_DEQ);
+	if (ring == NULL)
+		return -1;
+
+	ret = rte_eth_from_ring(ring);
+	if (ret < 0)
+		return -1;
+
+	if (rte_eth_dev_start(ret) < 0)
+		return -1;
+	return ret;
+}
+
+/* Create loopback port of spp_pipe of which RX and TX are the same ring. */
+static int
+create_pipe_port(struct rte_mempool *mbuf_pool)
+{
+	struct rte_ring *ring;
+
+	ring = rte_ring_create(PIPE_RING_NAME, LOOP_RING_SIZE,
+			rte_socket_id(), RING_F_SP_ENQ | RING_F_SC_DEQ);
+	if (ring == NULL)
+		return -1;
+
+	return create_vdev_port(PIPE_DEV_NAME, PIPE_DEV_ARGS, mbuf_pool);
+}
+
+/**
+ * Create port of net_null generating packets of given size. It is
+ * re-created if the size is changed because it cannot be updated.
+ */
+static int
+create_null_port(const struct bench_conf *conf)
+{
+	char devargs[NULL_DEV_ARGS_LEN];
+
+	if (loop_port_ids[BENCH_PORT_NULL] >= 0) {
+		if (null_pkt_size == conf->pkt_size)
+			return loop_port_ids[BENCH_PORT_NULL];
+		remove_vdev_port(NULL_DEV_NAME,
+				loop_port_ids[BENCH_PORT_NULL]);
+		loop_port_ids[BENCH_PORT_NULL] = -1;
+	}
+
+	snprintf(devargs, sizeof(devargs), "size=%u",
+			conf->pkt_size - RTE_ETHER_CRC_LEN);
+	null_pkt_size = conf->pkt_size;
+	return create_vdev_port(NULL_DEV_NAME, devargs, conf->mbuf_pool);
+}
+
+/* Get ID of loopback port of given type, created at the first call. */
+int
+bench_get_loop_port(const struct bench_conf *conf, uint16_t *port_id)
+{
+	int ret;
+
+	switch (conf->port_type) {
+	case BENCH_PORT_RING:
+		ret = loop_port_ids[BENCH_PORT_RING];
+		if (ret < 0)
+			ret = create_ring_port();
+		break;
+	case BENCH_PORT_PIPE:
+		ret = loop_port_ids[BENCH_PORT_PIPE];
+		if (ret < 0)
+			ret = create_pipe_port(conf->mbuf_pool);
+		break;
+	case BENCH_PORT_NULL:
+		ret = create_null_port(conf);
+		break;
+	default:
+		return -1;
+	}
+	if (ret < 0)
+		return -1;
+	loop_port_ids[conf->port_type] = ret;
+
+	*port_id = ret;
+	/* net_null always generates packets while receiving. */
+	if (conf->port_type != BENCH_PORT_NULL)
+		drain_port(*port_id);
+	return 0;
+}
+
+/* Get ID of port of net_null to which packets are discarded. */
+int
+bench_get_sink_port(const struct bench_conf *conf, uint16_t *port_id)
+{
+	if (sink_port_id < 0) {
+		sink_port_id = create_vdev_port(SINK_DEV_NAME, "",
+				conf->mbuf_pool);
+		if (sink_port_id < 0)
+			return -1;
+	}
+
+	*port_id = sink_port_id;
+	return 0;
+}
+
+/* Build UDP packet of given size and flow. */
+static int
+build_pkt(struct rte_mbuf *pkt, uint16_t pkt_size, unsigned int flow)
+{
+	uint16_t len = pkt_size - RTE_ETHER_CRC_LEN;
+	struct rte_ether_hdr *eth;
+	struct rte_ipv4_hdr *ip;
+	struct rte_udp_hdr *udp;
+
+	eth = (struct rte_ether_hdr *)rte_pktmbuf_append(pkt, len);
+	if (eth == NULL)
+		return -1;
+	memset(eth, 0x00, len);
+
+	/* Locally administered addresses. */
+	eth->d_addr.addr_bytes[0] = 0x02;
+	eth->d_addr.addr_bytes[5] = 0x01;
+	eth->s_addr.addr_bytes[0] = 0x02;
+	eth->s_addr.addr_bytes[5] = 0x02;
+	eth->ether_type = rte_cpu_to_be_16(RTE_ETHER_TYPE_IPV4);
+
+	ip = (struct rte_ipv4_hdr *)&eth[1];
+	ip->version_ihl = 0x45;
+	ip->total_length = rte_cpu_to_be_16(len - sizeof(*eth));
+	ip->time_to_live = 64;
+	ip->next_proto_id = IPPROTO_UDP;
+	ip->src_addr = rte_cpu_to_be_32(RTE_IPV4(192, 168, 0, 1));
+	ip->dst_addr = rte_cpu_to_be_32(RTE_IPV4(192, 168, 1, 1));
+	ip->hdr_checksum = rte_ipv4_cksum(ip);
+
+	udp = (struct rte_udp_hdr *)&ip[1];
+	udp->src_port = rte_cpu_to_be_16(1024 + flow);
+	udp->dst_port = rte_cpu_to_be_16(5001);
+	udp->dgram_len = rte_cpu_to_be_16(len - sizeof(*eth) - sizeof(*ip));
+
+	return 0;
+}
+
+/* Allocate packets of given size, built for flows in turn. */
+int
+bench_alloc_pkts(const struct bench_conf *conf, struct rte_mbuf **pkts,
+		unsigned int nof_pkts)
+{
+	unsigned int cnt;
+
+	for (cnt = 0; cnt < nof_pkts; cnt++) {
+		pkts[cnt] = rte_pktmbuf_alloc(conf->mbuf_pool);
+		if (pkts[cnt] == NULL ||
+				build_pkt(pkts[cnt], conf->pkt_size,
+					cnt % NOF_FLOWS) < 0) {
+			rte_pktmbuf_free(pkts[cnt]);
+			while (cnt > 0)
+				rte_pktmbuf_free(pkts[--cnt]);
+			return -1;
+		}
+	}
+	return 0;
+}
+
+/* Send packets of given size to the port to be circulated. */
+int
+bench_fill_port(const struct bench_conf *conf, uint16_t port_id,
+		unsigned int nof_pkts)
+{
+	unsigned int cnt;
+	uint16_t nb_pkts, nb_tx;
+	struct rte_mbuf *pkts[BENCH_BURST_MAX];
+
+	if (conf->port_type == BENCH_PORT_NULL)
+		return 0;
+
+	for (cnt = 0; cnt < nof_pkts; cnt += nb_pkts) {
+		nb_pkts = (nof_pkts - cnt < BENCH_BURST_MAX) ?
+			nof_pkts - cnt : BENCH_BURST_MAX;
+		if (bench_alloc_pkts(conf, pkts, nb_pkts) < 0)
+			return -1;
+
+		nb_tx = rte_eth_tx_burst(port_id, 0, pkts, nb_pkts);
+		if (nb_tx < nb_pkts) {
+			while (nb_tx < nb_pkts)
+				rte_pktmbuf_free(pkts[nb_tx++]);
+			return -1;
+		}
+	}
+	return 0;
+}
+
+/* Get num of packets received from the port. */
+static uint64_t
+get_rx_pkts(uint16_t port_id)
+{
+	struct rte_eth_stats stats;
+
+	if (rte_eth_stats_get(port_id, &stats) != 0)
+		return 0;
+	return stats.ipackets;
+}
+
+/* Call proc until given num of packets are received from the port. */
+int
+bench_run_proc(const struct bench_conf *conf, uint16_t port_id,
+		int (*proc)(int id), int id, struct bench_result *res)
+{
+	int cnt;
+	uint64_t start, base;
+	uint64_t pkts = 0, prev_pkts;
+
+	base = get_rx_pkts(port_id);
+	start = rte_rdtsc();
+	do {
+		prev_pkts = pkts;
+		for (cnt = 0; cnt < BENCH_POLL_INTERVAL; cnt++)
+			proc(id);
+
+		pkts = get_rx_pkts(port_id) - base;
+		if (unlikely(pkts == prev_pkts))
+			return -1;  /* All of packets are dropped. */
+	} while (pkts < conf->nof_pkts);
+	res->cycles = rte_rdtsc() - start;
+	res->pkts = pkts;
+
+	return 0;
+}
+
+static void
+print_result(const char *name, const struct bench_conf *conf,
+		const struct bench_result *res, int is_first)
+{
+	const char *port = port_type_names[conf->port_type];
+	double cpp = res->pkts ? (double)res->cycles / res->pkts : 0;
+	double mpps = res->cycles ?
+		(double)res->pkts * rte_get_tsc_hz() / res->cycles / 1e6 : 0;
+
+	if (format == FORMAT_CSV) {
+		if (is_first)
+			printf("bench,port,pkt_size,burst,entries,pkts,"
+					"cycles,cycles_per_pkt,mpps\n");
+		printf("%s,%s,%u,%u,%d,%" PRIu64 ",%" PRIu64 ",%.2f,%.3f\n",
+				name, port, conf->pkt_size, conf->burst_size,
+				conf->nof_entries, res->pkts, res->cycles,
+				cpp, mpps);
+	} else {
+		printf("%s{\"bench\": \"%s\", \"port\": \"%s\", "
+				"\"pkt_size\": %u, \"burst\": %u, "
+				"\"entries\": %d, \"pkts\": %" PRIu64 ", "
+				"\"cycles\": %" PRIu64 ", "
+				"\"cycles_per_pkt\": %.2f, \"mpps\": %.3f}",
+				is_first ? "[\n  " : ",\n  ", name, port,
+				conf->pkt_size, conf->burst_size,
+				conf->nof_entries, res->pkts, res->cycles,
+				cpp, mpps);
+	}
+	fflush(stdout);
+}
+
+/**
+ * Run a benchmark for each of combinations of packet sizes, burst sizes
+ * and nums of entries, and return num of results or -1 if failed.
+ */
+static int
+run_bench(const struct bench_ops *ops, struct bench_conf *conf,
+		int nof_results)
+{
+	int i, j, k;
+	int nof_burst_vals = (ops->burst_size != 0) ? 1 : nof_bursts;
+	int nof_entry_vals = ops->use_entries ? nof_entries : 1;
+	struct bench_result res;
+
+	for (i = 0; i < nof_pkt_sizes; i++) {
+		for (j = 0; j < nof_burst_vals; j++) {
+			for (k = 0; k < nof_entry_vals; k++) {
+				conf->pkt_size = pkt_sizes[i];
+				conf->burst_size = (ops->burst_size != 0) ?
+					ops->burst_size : bursts[j];
+				conf->nof_entries = ops->use_entries ?
+					entries[k] : 0;
+
+				memset(&res, 0x00, sizeof(res));
+				if (ops->run(conf, &res) < 0)
+					return -1;
+				print_result(ops->name, conf, &res,
+						nof_results == 0);
+				nof_results++;
+			}
+		}
+	}
+	return nof_results;
+}
+
+int
+main(int argc, char *argv[])
+{
+	int ret;
+	int i;
+	int nof_results = 0, nof_matched = 0;
+	const char *progname = argv[0];
+	struct bench_conf conf;
+
+	ret = rte_eal_init(argc, argv);
+	if (ret < 0)
+		rte_exit(EXIT_FAILURE, "EAL initialization failed\n");
+	argc -= ret;
+	argv += ret;
+
+	ret = parse_args(argc, argv);
+	if (ret < 0) {
+		usage(progname);
+		rte_exit(EXIT_FAILURE, "Invalid arguments\n");
+	}
+
+	/* Not to mix logs of components updated for each run with results. */
+	rte_log_set_level_pattern("user*", RTE_LOG_WARNING);
+
+	memset(&conf, 0x00, sizeof(conf));
+	conf.nof_pkts = nof_pkts;
+	conf.port_type = port_type;
+	conf.mbuf_pool = rte_pktmbuf_pool_create("MBUF_POOL", NUM_MBUFS,
+			MBUF_CACHE_SIZE, 0, RTE_MBUF_DEFAULT_BUF_SIZE,
+			rte_socket_id());
+	if (conf.mbuf_pool == NULL)
+		rte_exit(EXIT_FAILURE, "Cannot create mbuf pool\n");
+
+	for (i = 0; bench_list[i] != NULL; i++) {
+		if (strcmp(bench_name, "all") != 0 &&
+				strcmp(bench_name, bench_list[i]->name) != 0)
+			continue;
+		nof_matched++;
+
+		if (bench_list[i]->need_pkts &&
+				conf.port_type == BENCH_PORT_NULL) {
+			fprintf(stderr, "Skip %s because packets generated "
+					"by net_null are not supported\n",
+					bench_list[i]->name);
+			continue;
+		}
+
+		nof_results = run_bench(bench_list[i], &conf, nof_results);
+		if (nof_results < 0)
+			rte_exit(EXIT_FAILURE, "Failed to run %s\n",
+					bench_list[i]->name);
+	}
+
+	if (nof_matched == 0) {
+		usage(progname);
+		rte_exit(EXIT_FAILURE, "Unknown benchmark %s\n", bench_name);
+	}
+	if (format == FORMAT_JSON)
+		printf("%s]\n", nof_results > 0 ? "\n" : "[");
+
+	for (i = 0; i < (int)RTE_DIM(loop_port_ids); i++) {
+		if (loop_port_ids[i] < 0)
+			continue;
+		if (i != BENCH_PORT_NULL)
+			drain_port(loop_port_ids[i]);
+		rte_eth_dev_stop(loop_port_ids[i]);
+	}
+	if (sink_port_id >= 0)
+		rte_eth_dev_stop(sink_port_id);
+
+	return 0;
+}
@@ -0,0 +1,146 @@
+/* SPDX-License-Identifier: BSD-3-Clause
+ * Copyright(c) 2020 Nippon Telegraph and Telephone Corporation
+ */
+
+#ifndef __SPP_BENCH_H__
+#define __SPP_BENCH_H__
+
+#include <stdint.h>
+
+#include <rte_mbuf.h>
+#include <rte_mempool.h>
+
+/**
+ * @file
+ * SPP benchmark
+ *
+ * Each benchmark runs a path of packet processing of SPP without NICs,
+ * and the number of packets and cycles spent for them are reported for
+ * each of combinations of packet size, burst size and num of entries.
+ * Benchmarks are built as several apps because components of secondary
+ * processes are compiled differently for each of them.
+ */
+
+/* Max num of packets in a burst. */
+#define BENCH_BURST_MAX 256
+
+/* Max num of entries, such as MAC addresses, given to a benchmark. */
+#define BENCH_ENTRIES_MAX 128
+
+/* Num of packets circulated in a ring port while running. */
+#define BENCH_RING_PKTS 2048
+
+/* Num of calls of processing between checking num of received packets. */
+#define BENCH_POLL_INTERVAL 64
+
+/* Name of ring of loopback port of net_ring. */
+#define BENCH_LOOP_RING_NAME "spp_bench_loop"
+
+/* Type of port from which packets are received. */
+enum bench_port_type {
+	BENCH_PORT_RING,  /* net_ring receiving packets sent to itself */
+	BENCH_PORT_PIPE,  /* spp_pipe receiving packets sent to itself */
+	BENCH_PORT_NULL,  /* net_null generating and discarding packets */
+};
+
+/* Conditions given to a benchmark. */
+struct bench_conf {
+	uint16_t pkt_size;  /* Size of frame including FCS. */
+	uint16_t burst_size;  /* Max num of packets in a burst. */
+	int nof_entries;  /* Num of entries, or 0 if not used. */
+	enum bench_port_type port_type;
+	uint64_t nof_pkts;  /* Num of packets to be processed. */
+	struct rte_mempool *mbuf_pool;
+};
+
+/* Result of a benchmark. */
+struct bench_result {
+	uint64_t pkts;  /* Num of packets processed. */
+	uint64_t cycles;  /* TSC cycles spent for processing. */
+};
+
+/* Benchmark to be run from main. */
+struct bench_ops {
+	const char *name;
+	const char *desc;
+
+	/* Burst size fixed in the path, or 0 if it is given from conf. */
+	uint16_t burst_size;
+
+	/* Run for each of num of entries given if it is not 0. */
+	int use_entries;
+
+	/* Skipped for net_null if packets built by SPP bench are required. */
+	int need_pkts;
+
+	/* Run the benchmark, and return 0 if succeeded or -1. */
+	int (*run)(const struct bench_conf *conf, struct bench_result *res);
+};
+
+/* List of benchmarks terminated with NULL, defined for each of apps. */
+extern const struct bench_ops *bench_list[];
+
+/**
+ * Get ID of ethdev of a port of given type. Port of net_ring or spp_pipe
+ * receives packets sent to itself, and net_null generates packets of given
+ * size. The port is created at the first call, and packets remained in it
+ * are released.
+ *
+ * @param conf Conditions of the benchmark.
+ * @param[out] port_id Port ID.
+ * @return 0 if succeeded, or -1.
+ */
+int bench_get_loop_port(const struct bench_conf *conf, uint16_t *port_id);
+
+/**
+ * Get ID of ethdev of a port of net_null to which packets are discarded.
+ *
+ * @param conf Conditions of the benchmark.
+ * @param[out] port_id Port ID.
+ * @return 0 if succeeded, or -1.
+ */
+int bench_get_sink_port(const struct bench_conf *conf, uint16_t *port_id);
+
+/**
+ * Allocate UDP packets of given size, in which 5-tuple is different for
+ * each of flows.
+ *
+ * @param conf Conditions of the benchmark.
+ * @param[out] pkts Packets allocated.
+ * @param nof_pkts Num of packets.
+ * @return 0 if succeeded, or -1.
+ */
+int bench_alloc_pkts(const struct bench_conf *conf, struct rte_mbuf **pkts,
+		unsigned int nof_pkts);
+
+/**
+ * Send packets of given size to the port to be circulated. Nothing is done
+ * for net_null because it generates packets by itself.
+ *
+ * @param conf Conditions of the benchmark.
+ * @param port_id Port ID.
+ * @param nof_pkts Num of packets.
+ * @return 0 if succeeded, or -1.
+ */
+int bench_fill_port(const struct bench_conf *conf, uint16_t port_id,
+		unsigned int nof_pkts);
+
+/**
+ * Call `proc` repeatedly until `nof_pkts` of conf are received from the
+ * port, and count packets and cycles spent for them.
+ *
+ * @param conf Conditions of the benchmark.
+ * @param port_id ID of port from which `proc` receives packets.
+ * @param proc Packet processing, such as forward_packets() of spp_vf.
+ * @param id Argument of `proc`, such as ID of component.
+ * @param[out] res Result.
+ * @return 0 if succeeded, or -1 if no packets are received.
+ */
+int bench_run_proc(const struct bench_conf *conf, uint16_t port_id,
+		int (*proc)(int id), int id, struct bench_result *res);
+
+/* Benchmarks of VLAN operations of spp_vf. */
+extern const struct bench_ops bench_fwd_ring;
+extern const struct bench_ops bench_vlan;
+
+#endif /* __SPP_BENCH_H__ */